@@ -0,0 +1,272 @@
+// Benchmark filtrów pomiaru odległości (uruchamiany natywnie na PC)
+//
+// Porównuje łańcuch z US_DONE (mediana/średnia obcięta + bramka Hampela + EMA)
+// z poprzednią wersją (EMA z progiem 200 mm) oraz z filtrami Hampela, alfa-beta
+// i Kalmana 1-D na syntetycznych
+// scenariuszach zbiornika oraz opcjonalnie na nagranych danych (CSV).
+//
+// Budowanie i uruchomienie (z katalogu głównego repozytorium):
+//   g++ -O2 -std=gnu++11 -Isrc host/filter_bench.cpp src/filters.cpp -o filter_bench
+//   ./filter_bench > bench_output.txt
+//   ./filter_bench nagranie.csv
+//
+// Format CSV: jedna linia na cykl pomiarowy "truth,s1,s2,s3"; -1 oznacza brak
+// echa. Gdy kolumna truth jest pusta, wzorcem jest mediana krocząca z 9 cykli.
+//
+// Wynik to tabela Markdown - deterministyczna (stałe ziarno), więc można ją
+// porównywać między wydaniami.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#include "filters.h"
+
+// Parametry jak w firmware (main.cpp)
+static const int SENSOR_MIN_RANGE = 20;
+static const int SENSOR_MAX_RANGE = 1020;
+static const float EMA_ALPHA = 0.2f;
+static const int SENSOR_AVG_SAMPLES = 3;
+static const int HYSTERESIS = 10;
+static const int ALARM_LEVEL = 550;   // Domyślny reserve_level
+static const int MAX_LAG = 30;        // Maksymalne przesunięcie sprawdzane przy liczeniu opóźnienia
+static const int TIMING_REPEATS = 200;
+
+struct Cycle {
+    float truth;
+    int samples[SENSOR_AVG_SAMPLES];
+};
+
+struct Scenario {
+    std::string name;
+    std::vector<Cycle> cycles;
+};
+
+// Prosty deterministyczny generator (xorshift32), aby tabela była powtarzalna
+static uint32_t rngState = 0x12345678u;
+static uint32_t rngNext() {
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 17;
+    rngState ^= rngState << 5;
+    return rngState;
+}
+static float rngUniform() { return (rngNext() & 0xFFFFFF) / (float)0x1000000; }
+static float rngGauss(float sigma) {
+    float u1 = rngUniform() + 1e-7f, u2 = rngUniform();
+    return sigma * sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+// Zaszumiona próbka czujnika: szum gaussowski, odbicia wielodrogowe, zaniki echa
+static int noisySample(float truth, float sigma, float spikeProb, float dropProb) {
+    if (rngUniform() < dropProb) return -1;
+    float v = truth + rngGauss(sigma);
+    if (rngUniform() < spikeProb) v += 250.0f + rngUniform() * 400.0f;
+    return (int)lroundf(v);
+}
+
+static Scenario makeScenario(const char* name, int n, float (*truthAt)(int), float sigma, float spikeProb, float dropProb) {
+    Scenario s;
+    s.name = name;
+    for (int i = 0; i < n; ++i) {
+        Cycle c;
+        c.truth = truthAt(i);
+        for (int k = 0; k < SENSOR_AVG_SAMPLES; ++k) c.samples[k] = noisySample(c.truth, sigma, spikeProb, dropProb);
+        s.cycles.push_back(c);
+    }
+    return s;
+}
+
+// Przebiegi wzorcowe (odległość czujnik-woda w mm, jeden krok = jeden cykl)
+static float truthFilling(int i) { return std::max(80.0f, 900.0f - 1.5f * i); }
+static float truthPumping(int i) { return i < 50 ? 300.0f : std::min(1000.0f, 300.0f + 6.0f * (i - 50)); }
+static float truthTurbulence(int i) { return 500.0f + 25.0f * sinf(i * 0.7f) + 10.0f * sinf(i * 2.3f); }
+static float truthSteady(int i) { (void)i; return 520.0f; }
+static float truthStep(int i) { return i < 100 ? 300.0f : 700.0f; }
+
+static bool loadCsv(const char* path, Scenario& s) {
+    FILE* f = fopen(path, "r");
+    if (!f) return false;
+    s.name = path;
+    char line[128];
+    std::vector<bool> hasTruth;
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        Cycle c;
+        char* p = line;
+        char* comma = strchr(p, ',');
+        if (!comma) continue;
+        hasTruth.push_back(comma != p);
+        c.truth = comma != p ? (float)atof(p) : 0.0f;
+        p = comma + 1;
+        for (int k = 0; k < SENSOR_AVG_SAMPLES; ++k) {
+            c.samples[k] = (int)strtol(p, &p, 10);
+            if (*p == ',') ++p;
+        }
+        s.cycles.push_back(c);
+    }
+    fclose(f);
+    // Brak wzorca - mediana krocząca z 9 cykli jako przybliżenie
+    for (size_t i = 0; i < s.cycles.size(); ++i) {
+        if (hasTruth[i]) continue;
+        std::vector<int> win;
+        for (int d = -4; d <= 4; ++d) {
+            long j = (long)i + d;
+            if (j < 0 || j >= (long)s.cycles.size()) continue;
+            int r = reduceSamples(s.cycles[j].samples, SENSOR_AVG_SAMPLES, 1);
+            if (r >= 0) win.push_back(r);
+        }
+        std::sort(win.begin(), win.end());
+        s.cycles[i].truth = win.empty() ? 0.0f : (float)win[win.size() / 2];
+    }
+    return !s.cycles.empty();
+}
+
+// Kandydaci - każdy dostaje wynik reduceSamples() po kontroli zakresu (lub -1)
+struct Candidate {
+    const char* name;
+    void (*reset)();
+    float (*update)(int reduced);
+};
+
+static float emaState;
+static void emaReset() { emaState = 0; }
+static float emaUpdate(int r) {
+    if (r >= 0) emaState = emaStep(emaState, (float)r, EMA_ALPHA, 200.0f);
+    return emaState;
+}
+
+static RobustFilter robust;
+static void robustReset() { robustInit(robust); }
+static float robustRun(int r) { return robustUpdate(robust, r, EMA_ALPHA); }
+
+static HampelFilter hampel;
+static void hampelReset() { hampelInit(hampel, 3.0f, 3.0f); }
+static float hampelRun(int r) { return hampelUpdate(hampel, r); }
+
+static AlphaBetaFilter alphaBeta;
+static void alphaBetaReset() { alphaBetaInit(alphaBeta, 0.5f, 0.1f); }
+static float alphaBetaRun(int r) { return alphaBetaUpdate(alphaBeta, (float)r); }
+
+static KalmanFilter1D kalman;
+static void kalmanReset() { kalmanInit(kalman, 16.0f, 25.0f); }
+static float kalmanRun(int r) { return kalmanUpdate(kalman, (float)r); }
+
+static const Candidate CANDIDATES[] = {
+    {"current (trim+robust EMA)", robustReset, robustRun},
+    {"legacy (trim+EMA 200mm)", emaReset, emaUpdate},
+    {"hampel",             hampelReset, hampelRun},
+    {"alpha-beta",         alphaBetaReset, alphaBetaRun},
+    {"kalman-1d",          kalmanReset, kalmanRun},
+};
+
+struct Result {
+    double nsPerSample;
+    double rms;
+    int lag;
+    int falseAlarms;
+};
+
+static int reduceCycle(const Cycle& c) {
+    int r = reduceSamples(c.samples, SENSOR_AVG_SAMPLES, SENSOR_AVG_SAMPLES / 2);
+    if (r >= 0 && (r < SENSOR_MIN_RANGE || r > SENSOR_MAX_RANGE)) r = -1;
+    return r;
+}
+
+static void runOnce(const Candidate& cand, const Scenario& s, std::vector<float>& out) {
+    cand.reset();
+    out.resize(s.cycles.size());
+    for (size_t i = 0; i < s.cycles.size(); ++i) out[i] = cand.update(reduceCycle(s.cycles[i]));
+}
+
+// Liczba włączeń alarmu (z histerezą jak w updateAlarmStates), których nie ma we wzorcu
+static int countFalseAlarms(const Scenario& s, const std::vector<float>& est) {
+    bool alarmTruth = false, alarmEst = false;
+    int falseAlarms = 0;
+    for (size_t i = 0; i < est.size(); ++i) {
+        float t = s.cycles[i].truth;
+        if (t >= ALARM_LEVEL) alarmTruth = true;
+        else if (t < ALARM_LEVEL - HYSTERESIS) alarmTruth = false;
+        if (est[i] <= 0) continue;
+        bool was = alarmEst;
+        if (est[i] >= ALARM_LEVEL) alarmEst = true;
+        else if (est[i] < ALARM_LEVEL - HYSTERESIS) alarmEst = false;
+        if (alarmEst && !was && !alarmTruth) falseAlarms++;
+    }
+    return falseAlarms;
+}
+
+static Result evaluate(const Candidate& cand, const Scenario& s) {
+    Result r;
+    std::vector<float> est;
+
+    auto t0 = std::chrono::steady_clock::now();
+    volatile float sink = 0;
+    for (int rep = 0; rep < TIMING_REPEATS; ++rep) {
+        cand.reset();
+        for (size_t i = 0; i < s.cycles.size(); ++i) sink = sink + cand.update(reduceCycle(s.cycles[i]));
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    r.nsPerSample = std::chrono::duration<double, std::nano>(t1 - t0).count() / (TIMING_REPEATS * (double)s.cycles.size());
+
+    runOnce(cand, s, est);
+
+    double sum = 0;
+    size_t n = 0;
+    for (size_t i = 0; i < est.size(); ++i) {
+        if (est[i] <= 0) continue;
+        double e = est[i] - s.cycles[i].truth;
+        sum += e * e;
+        n++;
+    }
+    r.rms = n ? sqrt(sum / n) : NAN;
+
+    // Opóźnienie: przesunięcie wzorca (w cyklach) minimalizujące błąd RMS
+    double best = 1e30;
+    r.lag = 0;
+    for (int lag = 0; lag <= MAX_LAG; ++lag) {
+        double acc = 0;
+        size_t cnt = 0;
+        for (size_t i = lag; i < est.size(); ++i) {
+            if (est[i] <= 0) continue;
+            double e = est[i] - s.cycles[i - lag].truth;
+            acc += e * e;
+            cnt++;
+        }
+        if (cnt && acc / cnt < best) { best = acc / cnt; r.lag = lag; }
+    }
+
+    r.falseAlarms = countFalseAlarms(s, est);
+    return r;
+}
+
+int main(int argc, char** argv) {
+    std::vector<Scenario> scenarios;
+    scenarios.push_back(makeScenario("filling",    500, truthFilling,    2.0f, 0.00f, 0.02f));
+    scenarios.push_back(makeScenario("pumping",    200, truthPumping,    2.0f, 0.00f, 0.02f));
+    scenarios.push_back(makeScenario("turbulence", 500, truthTurbulence, 12.0f, 0.01f, 0.05f));
+    scenarios.push_back(makeScenario("multipath",  500, truthSteady,     2.0f, 0.10f, 0.02f));
+    scenarios.push_back(makeScenario("dropouts",   500, truthSteady,     2.0f, 0.02f, 0.40f));
+    scenarios.push_back(makeScenario("step",       300, truthStep,       2.0f, 0.00f, 0.02f));
+
+    for (int i = 1; i < argc; ++i) {
+        Scenario s;
+        if (loadCsv(argv[i], s)) scenarios.push_back(s);
+        else fprintf(stderr, "Nie można wczytać %s\n", argv[i]);
+    }
+
+    printf("| scenario | filter | ns/sample | lag [cycles] | RMS [mm] | false alarms |\n");
+    printf("|---|---|---:|---:|---:|---:|\n");
+    for (size_t s = 0; s < scenarios.size(); ++s) {
+        for (size_t c = 0; c < sizeof(CANDIDATES) / sizeof(CANDIDATES[0]); ++c) {
+            Result r = evaluate(CANDIDATES[c], scenarios[s]);
+            printf("| %s | %s | %.1f | %d | %.1f | %d |\n",
+                   scenarios[s].name.c_str(), CANDIDATES[c].name, r.nsPerSample, r.lag, r.rms, r.falseAlarms);
+        }
+    }
+    return 0;
+}
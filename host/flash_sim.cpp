@@ -0,0 +1,61 @@
+#include "flash_sim.h"
+
+FlashSim::FlashSim(size_t sectors)
+    : _data(sectors * FLASH_SECTOR_SIZE, 0xFF), _erases(sectors, 0), _programErrors(0) {}
+
+void FlashSim::read(size_t addr, uint8_t* out, size_t len) const {
+    memcpy(out, &_data[addr], len);
+}
+
+void FlashSim::program(size_t addr, const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t& cell = _data[addr + i];
+        if ((data[i] & ~cell) != 0) _programErrors++;   // 0 -> 1 wymaga kasowania
+        cell &= data[i];
+    }
+}
+
+void FlashSim::erase(size_t sector) {
+    memset(&_data[sector * FLASH_SECTOR_SIZE], 0xFF, FLASH_SECTOR_SIZE);
+    _erases[sector]++;
+}
+
+EEPROMClass::EEPROMClass(FlashSim& flash, size_t sector)
+    : erases(0), _flash(flash), _sector(sector), _dirty(false) {}
+
+void EEPROMClass::begin(size_t size) {
+    size = (size + 3) & ~(size_t)3;     // Jak w rdzeniu: wielokrotność 4 B
+    if (size == 0 || size > FLASH_SECTOR_SIZE) return;
+    _buf.resize(size);
+    _flash.read(_sector * FLASH_SECTOR_SIZE, _buf.data(), size);
+    _dirty = false;
+}
+
+uint8_t EEPROMClass::read(int address) {
+    if (address < 0 || (size_t)address >= _buf.size()) return 0;
+    return _buf[address];
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+    if (address < 0 || (size_t)address >= _buf.size()) return;
+    if (_buf[address] != value) {
+        _buf[address] = value;
+        _dirty = true;
+    }
+}
+
+bool EEPROMClass::commit() {
+    if (_buf.empty()) return false;
+    if (!_dirty) return true;
+    _flash.erase(_sector);
+    _flash.program(_sector * FLASH_SECTOR_SIZE, _buf.data(), _buf.size());
+    erases++;
+    _dirty = false;
+    return true;
+}
+
+bool EEPROMClass::end() {
+    bool ok = commit();
+    _buf.clear();
+    return ok;
+}
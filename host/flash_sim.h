@@ -0,0 +1,81 @@
+#ifndef FLASH_SIM_H
+#define FLASH_SIM_H
+
+// Emulacja flash SPI i EEPROMClass z rdzenia ESP8266 na komputerze
+// (host/flash_wear.cpp). Kompilacja src/config.cpp z -DFLASH_SIM -Ihost
+// podstawia tę klasę zamiast <EEPROM.h>, więc symulowany jest ten sam kod
+// zapisu co na urządzeniu.
+//
+// Model jak w rdzeniu ESP8266 (EEPROM.cpp):
+//   begin(size)  kopia sektora do RAM, dirty = false
+//   write/put    dirty tylko gdy bajty się zmieniają
+//   commit()     bez zmian nic nie robi; inaczej kasuje cały sektor 4 KB
+//                i programuje size bajtów bufora
+//   end()        commit() i zwolnienie bufora
+// Flash NOR: kasowanie ustawia 0xFF, programowanie tylko zeruje bity - zapis
+// wymagający 1 na miejscu 0 bez kasowania jest liczony jako błąd.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include "loop_watchdog.h"
+
+const size_t FLASH_SECTOR_SIZE = 4096;
+
+class FlashSim {
+public:
+    explicit FlashSim(size_t sectors);
+    void read(size_t addr, uint8_t* out, size_t len) const;
+    void program(size_t addr, const uint8_t* data, size_t len);
+    void erase(size_t sector);
+    size_t sectors() const { return _erases.size(); }
+    uint32_t erases(size_t sector) const { return _erases[sector]; }
+    uint32_t programErrors() const { return _programErrors; }
+private:
+    std::vector<uint8_t> _data;
+    std::vector<uint32_t> _erases;
+    uint32_t _programErrors;
+};
+
+class EEPROMClass {
+public:
+    EEPROMClass(FlashSim& flash, size_t sector);
+    void begin(size_t size);
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    bool commit();
+    bool end();
+    uint8_t* getDataPtr() { _dirty = true; return _buf.data(); }
+
+    template<typename T> T& get(int address, T& t) {
+        if (address >= 0 && address + sizeof(T) <= _buf.size()) memcpy(&t, &_buf[address], sizeof(T));
+        else memset(&t, 0, sizeof(T));
+        return t;
+    }
+    template<typename T> const T& put(int address, const T& t) {
+        if (address >= 0 && address + sizeof(T) <= _buf.size() && memcmp(&_buf[address], &t, sizeof(T)) != 0) {
+            memcpy(&_buf[address], &t, sizeof(T));
+            _dirty = true;
+        }
+        return t;
+    }
+
+    uint32_t erases;            // Commity, które skasowały sektor (licznik dla raportu)
+private:
+    FlashSim& _flash;
+    size_t _sector;
+    std::vector<uint8_t> _buf;
+    bool _dirty;
+};
+
+extern EEPROMClass EEPROM;
+
+// Zależności config.cpp spoza EEPROM - bez znaczenia dla zużycia flash
+inline LoopStage loopStage(LoopStage stage) { return stage; }
+inline void platformWatchdogFeed() {}
+inline void noInterrupts() {}
+inline void interrupts() {}
+template<typename T> inline T min(T a, T b) { return a < b ? a : b; }
+
+#endif // FLASH_SIM_H
@@ -0,0 +1,229 @@
+// Symulator zużycia flash dla wszystkich zapisywanych danych (uruchamiany
+// natywnie na PC)
+//
+// Odtwarza lata pracy urządzenia na kodzie zapisu z src/config.cpp
+// skompilowanym z emulacją flash (host/flash_sim.h): przełączenia dźwięku
+// z Home Assistant (onSoundSwitchCommand), zmiany ustawień (PUT /config,
+// formularz), zapis poświadczeń WiFi, zmiany punktu dostępowego lub dzierżawy
+// IP (wpis szybkiego łączenia) i starty urządzenia. Każde kasowanie sektora
+// jest przypisywane ścieżce, która je wywołała.
+//
+// Budowanie i uruchomienie (z katalogu głównego repozytorium):
+//   g++ -O2 -std=gnu++11 -DFLASH_SIM -Isrc -Ihost host/flash_wear.cpp host/flash_sim.cpp
+//       src/config.cpp src/config_schema.cpp src/json_flat.cpp src/strbuf.cpp src/wifi_cache.cpp -o flash_wear
+//   ./flash_wear > wear_report.md
+//   ./flash_wear --years 20 --endurance 10000
+//
+// Wszystkie obszary EEPROM (poświadczenia WiFi, punkt dostępowy, dwa sloty
+// konfiguracji) leżą w jednym sektorze 4 KB, więc każdy commit kasuje ten sam
+// sektor - rotacja slotów chroni przed utratą danych przy zaniku zasilania,
+// ale nie rozkłada zużycia. Żywotność dotyczy więc sumy wszystkich ścieżek;
+// kolumna "sama ścieżka" pokazuje, ile wytrzymałby sektor, gdyby zapisywała
+// tylko ona.
+//
+// Wynik to tabela Markdown - deterministyczna (stałe ziarno), więc można ją
+// porównywać między wydaniami.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "flash_sim.h"
+#include "config.h"
+#include "wifi_cache.h"
+
+// Sektor EEPROM tuż przed systemem plików; pozostałe sektory bez zapisów
+const size_t SIM_SECTORS = 4;
+const size_t EEPROM_SECTOR = 2;
+
+static FlashSim s_flash(SIM_SECTORS);
+EEPROMClass EEPROM(s_flash, EEPROM_SECTOR);
+
+enum WearPath {
+    WP_SOUND,           // onSoundSwitchCommand -> saveConfig
+    WP_CONFIG,          // commitConfigUpdate -> saveConfig
+    WP_WIFI_CREDS,      // handleSave z polem wifi_ssid -> saveNetworkCredentials
+    WP_WIFI_CACHE,      // wifiConnectTask -> saveWifiCache (unieważnienie + nowy wpis)
+    WP_BOOT,            // loadConfig + szybkie łączenie po starcie
+    WP_COUNT
+};
+
+static const char* const PATH_NAMES[WP_COUNT] = {
+    "dźwięk (HA)", "ustawienia", "poświadczenia WiFi", "punkt dostępowy / IP", "start",
+};
+
+// Częstości zdarzeń w profilu użytkowania
+struct Profile {
+    const char* name;
+    double soundPerDay;         // Polecenia przełącznika dźwięku (automatyzacja nocna = 2)
+    double soundRepeat;         // Ułamek poleceń z tym samym stanem (ponowienia)
+    double configPerMonth;      // Zapisy ustawień ze zmianą
+    double wifiSavesPerYear;    // Formularz z polem SSID (zwykle te same dane)
+    double wifiNewPerYear;      // Z tego nowe hasło lub sieć
+    double reconnectsPerDay;    // Ponowne połączenia WiFi (restart routera, zasięg)
+    double apChange;            // Ułamek połączeń z innym BSSID / kanałem / adresem
+    double bootsPerMonth;       // Zaniki zasilania i restarty
+};
+
+static const Profile PROFILES[] = {
+    { "typowy",     2.0, 0.0, 1.0,  1.0,  0.2, 0.5, 0.05, 2.0 },
+    { "intensywny", 12.0, 0.3, 30.0, 12.0, 2.0, 6.0, 0.5, 30.0 },
+};
+
+struct PathStats {
+    uint32_t events;
+    uint32_t erases;
+};
+
+// Powtarzalny generator (xorshift32)
+static uint32_t s_rng = 1;
+static double rnd() {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return (s_rng >> 8) * (1.0 / 16777216.0);
+}
+
+// Liczba zdarzeń w dobie przy średniej mean (Poisson, metoda Knutha)
+static int poisson(double mean) {
+    double limit = exp(-mean), p = 1.0;
+    int k = 0;
+    do { k++; p *= rnd(); } while (p > limit);
+    return k - 1;
+}
+
+static char s_ssid[33] = "dom";
+static char s_pass[65] = "haslo-0";
+static WifiCache s_ap;      // Punkt dostępowy zapamiętany przez urządzenie
+
+static void makeAp(WifiCache& c, uint32_t variant) {
+    memset(&c, 0, sizeof(c));
+    c.bssid[0] = 0x02;
+    c.bssid[5] = (uint8_t)variant;
+    c.channel = 1 + variant % 13;
+    c.ip = 0x3201A8C0UL + (variant << 24);
+    c.gateway = 0x0101A8C0UL;
+    c.mask = 0x00FFFFFFUL;
+    c.dns = 0x0101A8C0UL;
+    wifiCacheSeal(c, s_ssid);
+}
+
+// Połączenie jak wifiConnectTask(): ten sam punkt dostępowy zapisuje wpis bez
+// zmian, inny kończy szybkie łączenie unieważnieniem i nowym wpisem
+static void reconnect(bool changed) {
+    if (changed) {
+        WifiCache empty;
+        memset(&empty, 0, sizeof(empty));
+        saveWifiCache(empty);
+        makeAp(s_ap, (uint32_t)(rnd() * 4));
+    }
+    saveWifiCache(s_ap);
+}
+
+static void runEvent(PathStats& st, uint32_t& erases) {
+    st.events++;
+    st.erases += EEPROM.erases - erases;
+    erases = EEPROM.erases;
+}
+
+static void simulate(const Profile& p, int years, PathStats* stats) {
+    memset(stats, 0, sizeof(PathStats) * WP_COUNT);
+    s_rng = 0x5EED1234UL;
+    loadConfig();
+    saveNetworkCredentials(s_ssid, s_pass);
+    makeAp(s_ap, 0);
+    saveWifiCache(s_ap);
+    uint32_t erases = EEPROM.erases;     // Pierwsza konfiguracja poza statystyką
+
+    for (int day = 0; day < years * 365; ++day) {
+        for (int n = poisson(p.soundPerDay); n > 0; --n) {
+            bool state = rnd() < p.soundRepeat ? config.soundEnabled : !config.soundEnabled;
+            config.soundEnabled = state;
+            saveConfig();
+            runEvent(stats[WP_SOUND], erases);
+        }
+        for (int n = poisson(p.configPerMonth / 30.0); n > 0; --n) {
+            config.pump_delay = config.pump_delay == 5 ? 6 : 5;
+            saveConfig();
+            runEvent(stats[WP_CONFIG], erases);
+        }
+        for (int n = poisson(p.wifiSavesPerYear / 365.0); n > 0; --n) {
+            if (rnd() < p.wifiNewPerYear / p.wifiSavesPerYear) snprintf(s_pass, sizeof(s_pass), "haslo-%d", day);
+            saveNetworkCredentials(s_ssid, s_pass);
+            runEvent(stats[WP_WIFI_CREDS], erases);
+        }
+        for (int n = poisson(p.reconnectsPerDay); n > 0; --n) {
+            reconnect(rnd() < p.apChange);
+            runEvent(stats[WP_WIFI_CACHE], erases);
+        }
+        for (int n = poisson(p.bootsPerMonth / 30.0); n > 0; --n) {
+            loadConfig();
+            reconnect(false);
+            runEvent(stats[WP_BOOT], erases);
+        }
+    }
+}
+
+// Zapisane dane po symulacji odpowiadają stanowi w RAM
+static bool verify() {
+    Config expected = config;
+    char ssid[33], pass[65];
+    WifiCache ap;
+    bool ok = loadConfig() && memcmp(&expected, &config, offsetof(Config, checksum)) == 0;
+    ok = ok && loadNetworkCredentials(ssid, sizeof(ssid), pass, sizeof(pass));
+    ok = ok && strcmp(ssid, s_ssid) == 0 && strcmp(pass, s_pass) == 0;
+    ok = ok && loadWifiCache(ap) && memcmp(&ap, &s_ap, sizeof(ap)) == 0;
+    return ok && s_flash.programErrors() == 0;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "Użycie: %s [--years N] [--endurance CYKLE]\n", prog);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    int years = 10;
+    double endurance = 100000;      // Typowa trwałość sektora flash SPI (kasowania)
+    for (int i = 1; i < argc; ++i) {
+        if (i + 1 < argc && strcmp(argv[i], "--years") == 0) years = atoi(argv[++i]);
+        else if (i + 1 < argc && strcmp(argv[i], "--endurance") == 0) endurance = atof(argv[++i]);
+        else usage(argv[0]);
+    }
+    if (years <= 0 || endurance <= 0) usage(argv[0]);
+
+    printf("Trwałość sektora: %.0f kasowań, symulacja %d lat\n\n", endurance, years);
+    printf("| profil | ścieżka | zdarzenia/rok | kasowania/rok | udział | sama ścieżka [lata] |\n");
+    printf("|---|---|---:|---:|---:|---:|\n");
+    int failures = 0;
+    for (const Profile& p : PROFILES) {
+        // Każdy profil od czystego flash (jak nowy moduł)
+        s_flash = FlashSim(SIM_SECTORS);
+        EEPROM.erases = 0;
+        PathStats stats[WP_COUNT];
+        simulate(p, years, stats);
+        if (!verify()) {
+            fprintf(stderr, "%s: dane w emulowanym flash nie zgadzają się ze stanem\n", p.name);
+            failures++;
+        }
+
+        uint32_t total = 0;
+        for (int w = 0; w < WP_COUNT; ++w) total += stats[w].erases;
+        for (int w = 0; w < WP_COUNT; ++w) {
+            double perYear = (double)stats[w].erases / years;
+            printf("| %s | %s | %.0f | %.1f | %.0f%% | ", p.name, PATH_NAMES[w],
+                   (double)stats[w].events / years, perYear, total ? 100.0 * stats[w].erases / total : 0.0);
+            if (perYear > 0) printf("%.0f |\n", endurance / perYear);
+            else printf("bez zużycia |\n");
+        }
+        double totalPerYear = (double)total / years;
+        printf("| %s | **razem (sektor EEPROM)** | | %.1f | 100%% | **%.0f** |\n", p.name, totalPerYear,
+               totalPerYear > 0 ? endurance / totalPerYear : INFINITY);
+    }
+
+    // Rozkład na sektory z ostatniego profilu - zużywa się tylko sektor EEPROM
+    printf("\nKasowania na sektor:");
+    for (size_t s = 0; s < s_flash.sectors(); ++s) printf(" %u", (unsigned)s_flash.erases(s));
+    printf("\n");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,546 @@
+// Symulator obciążenia floty: setki urządzeń wirtualnych przy lokalnym
+// brokerze MQTT (uruchamiany natywnie na Linuksie)
+//
+// Każde urządzenie to osobny proces z kodem publikacji firmware: ha.cpp
+// (przełączniki, haMqttPoll/haMqttService z ponownym łączeniem i rozrzutem),
+// ha_discovery.cpp (discovery porcjami, skrót na brokerze, stany),
+// updateWaterLevel() i updatePump() z maszyną stanów pompy. Zamiast sprzętu
+// jest model zbiornika (echo HC-SR04, pływak z przerwaniem, pompa), zamiast
+// WiFi i ArduinoHA - gniazda POSIX i minimalny klient MQTT (shim/,
+// mqtt_link.h). Proces nadrzędny subskrybuje ruch urządzeń jako monitor
+// i liczy wiadomości na sekundę, wielkość paczek discovery oraz przebieg
+// burzy ponownych połączeń.
+//
+// Budowanie (z katalogu głównego repozytorium):
+//   g++ -O2 -std=gnu++11 -DARDUINO=10000 -Ihost/fleet/shim -Ihost/fleet -Isrc
+//       host/fleet/fleet_sim.cpp host/fleet/shim_net.cpp host/fleet/mqtt_link.cpp
+//       src/ha.cpp src/ha_discovery.cpp src/measurements.cpp src/pump_control.cpp
+//       src/pump_fsm.cpp src/pump_flow.cpp src/leak_detect.cpp src/filters.cpp
+//       src/sensor_health.cpp src/float_switch.cpp src/control_task.cpp src/loop_stats.cpp
+//       src/buzzer.cpp src/config.cpp src/config_schema.cpp src/json_flat.cpp
+//       src/strbuf.cpp src/status.cpp src/button.cpp src/timers.cpp src/mono_clock.cpp
+//       src/remote_config.cpp -o fleet_sim
+//
+// Uruchomienie (broker np. mosquitto -p 1883, bez limitu połączeń):
+//   ./fleet_sim --devices 300 --duration 180 --storm-at 90 > fleet_report.md
+//   ./fleet_sim --devices 300 --json --id-base 1000           # stany jednym dokumentem, nowe id
+//   ./fleet_sim --devices 300 --restart-cmd "systemctl restart mosquitto"
+//
+// Burza: domyślnie wszystkie urządzenia jednocześnie tracą połączenie
+// (SIGUSR1 - zerwanie TCP jak przy zaniku WiFi); z --restart-cmd zamiast tego
+// wykonywane jest polecenie restartu brokera. Identyfikatory urządzeń są
+// stałe (--id-base), więc kolejne uruchomienie zastaje na brokerze zachowane
+// skróty discovery - tak jak flota po restarcie Home Assistant.
+//
+// Wynik to raport Markdown; --timeline dodaje tabelę sekunda po sekundzie.
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <vector>
+
+#include "globals.h"
+#include "pins.h"
+#include "ha.h"
+#include "measurements.h"
+#include "pump_control.h"
+#include "float_switch.h"
+#include "mono_clock.h"
+#include "buzzer.h"
+#include "loop_watchdog.h"
+#include "warm_restart.h"
+#include "config_schema.h"
+#include <EEPROM.h>
+
+// ** GLOBALNE FIRMWARE (main.cpp) **
+
+const char* SOFTWARE_VERSION = "26.11.24";
+const unsigned long ULTRASONIC_TIMEOUT = 50;
+const unsigned long MEASUREMENT_INTERVAL = 60000;
+const unsigned long PUMP_MEASUREMENT_INTERVAL = 1000;
+const int HYSTERESIS = 10;
+const int SENSOR_MIN_RANGE = 20;
+const int SENSOR_MAX_RANGE = 1020;
+const float EMA_ALPHA = 0.2f;
+const int SENSOR_AVG_SAMPLES = 3;
+const unsigned long SENSOR_STALE_TIMEOUT = 3 * MEASUREMENT_INTERVAL + 10000;
+
+float lastFilteredDistance = 0;
+float lastReportedDistance = 0;
+unsigned long lastMeasurement = 0;
+float currentDistance = 0;
+float volume = 0;
+
+WiFiClient client;
+HADevice device("HydroSense");
+HAMqtt mqtt(client, device, 4);
+PlatformWebServer server(80);
+WebSocketsServer webSocket(81);
+EEPROMClass EEPROM;
+
+// Poza zakresem symulacji: dźwięk, migawki RTC, ślad etapów pętli, dziennik, OTA
+void playConfirmationSound() {}
+void warmCheckpoint() {}
+LoopStage loopStage(LoopStage stage) { return stage; }
+void logRecord(uint8_t, uint16_t, uint8_t, const uint32_t*) {}
+bool httpStreamActive() { return false; }
+
+// Konfiguracja zdalna (remote_config.cpp) bez zapisu do EEPROM; zmiana pól
+// brokera zrywa połączenie - ponowi je haMqttService()
+bool applyConfigUpdate(const ConfigUpdate& u) {
+    if (!u.changed) return false;
+    memcpy(&config, &u.staged, sizeof(Config));
+    return u.needMqttReconnect;
+}
+void reconnectMqttForConfig() {
+    haSetJsonState(config.mqtt_json_state);
+    if (mqtt.isConnected()) mqtt.disconnect();
+}
+void platformWatchdogFeed() {}
+void otaPullBegin(const char*) {}
+bool otaPullMessage(const char*, const uint8_t*, uint16_t) { return false; }
+void otaPullConnected() {}
+uint32_t platformRandom() { return (uint32_t)random(); }
+
+// ** MODEL ZBIORNIKA **
+
+const uint32_t ECHO_DELAY_US = 100;         // Od końca impulsu TRIG do zbocza echa
+const float TANK_REFILL_MM = 900;           // Właściciel dolewa wody do zbiornika
+const float FLOAT_LOW_MM = 3;               // Ubytek w akwarium, przy którym pływak opada
+const float PUMP_FILL_MM_S = 0.5f;          // Uzupełnianie akwarium przez pompę
+const float PUMP_DRAW_MM_S = 2.0f;          // Spadek lustra w zbiorniku przy pracy pompy
+
+struct Tank {
+    float distanceMm;       // Czujnik -> lustro wody w zbiorniku
+    float deficitMm;        // Ubytek wody w akwarium (parowanie)
+    float evapMmS;
+    bool pump;
+    bool trigHigh;
+    uint32_t echoStartUs;
+    uint32_t echoEndUs;
+    uint8_t floatLevel;     // LOW = woda przy pływaku
+    void (*floatIsr)();
+    uint32_t lastStepMs;
+};
+
+static Tank s_tank;
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    if (pin == POMPA_PIN) {
+        s_tank.pump = value == HIGH;
+    } else if (pin == PIN_ULTRASONIC_TRIG) {
+        if (s_tank.trigHigh && value == LOW) {
+            // Koniec impulsu: echo o długości drogi w obie strony, szum ±1 mm
+            float mm = s_tank.distanceMm + (random() % 3) - 1;
+            s_tank.echoStartUs = micros() + ECHO_DELAY_US;
+            s_tank.echoEndUs = s_tank.echoStartUs + (uint32_t)(mm * 2000.0f / 343.0f);
+        }
+        s_tank.trigHigh = value == HIGH;
+    }
+}
+
+int digitalRead(uint8_t pin) {
+    if (pin == PIN_ULTRASONIC_ECHO) {
+        uint32_t now = micros();
+        return (int32_t)(now - s_tank.echoStartUs) >= 0 && (int32_t)(now - s_tank.echoEndUs) < 0 ? HIGH : LOW;
+    }
+    if (pin == PIN_WATER_LEVEL) return s_tank.floatLevel;
+    return HIGH;            // Przycisk niewciśnięty
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int) {
+    if (pin == PIN_WATER_LEVEL) s_tank.floatIsr = isr;
+}
+
+static void tankStep() {
+    uint32_t now = millis();
+    float dt = (now - s_tank.lastStepMs) / 1000.0f;
+    s_tank.lastStepMs = now;
+    s_tank.deficitMm += s_tank.evapMmS * dt;
+    if (s_tank.pump) {
+        s_tank.deficitMm = std::max(0.0f, s_tank.deficitMm - PUMP_FILL_MM_S * dt);
+        s_tank.distanceMm += PUMP_DRAW_MM_S * dt;
+    }
+    if (s_tank.distanceMm > TANK_REFILL_MM) s_tank.distanceMm = config.tank_full + 30;
+
+    uint8_t level = s_tank.deficitMm < FLOAT_LOW_MM ? LOW : HIGH;
+    if (level != s_tank.floatLevel) {
+        s_tank.floatLevel = level;
+        if (s_tank.floatIsr) s_tank.floatIsr();     // Przerwanie na zboczu
+    }
+}
+
+// ** URZĄDZENIE WIRTUALNE **
+
+enum FleetEventType : uint8_t {
+    FE_ATTEMPT,         // mqtt.begin()
+    FE_FAILED,          // Próba nieudana
+    FE_CONNECTED,
+    FE_DISCONNECTED,
+};
+
+struct FleetEvent {
+    uint32_t ms;        // Od startu symulacji
+    uint16_t device;
+    uint8_t type;
+};
+
+struct SimOptions {
+    int devices;
+    int durationS;
+    int stormAtS;               // 0 = bez burzy
+    int spawnMs;                // Odstęp startu kolejnych urządzeń
+    int idBase;
+    bool json;
+    bool timeline;
+    float evapMmH;
+    const char* host;
+    uint16_t port;
+    const char* user;
+    const char* pass;
+    const char* restartCmd;
+};
+
+static uint32_t s_simStartMs;      // millis() liczy od startu programu - wspólne dla procesów
+static volatile sig_atomic_t s_drop = 0;
+static volatile sig_atomic_t s_stop = 0;
+
+static void onDropSignal(int) { s_drop = 1; }
+static void onStopSignal(int) { s_stop = 1; }
+
+static void sendEvent(int fd, uint16_t dev, uint8_t type, uint32_t ms) {
+    FleetEvent e = { ms - s_simStartMs, dev, type };
+    if (write(fd, &e, sizeof(e)) != sizeof(e)) s_stop = 1;     // Proces nadrzędny zniknął
+}
+
+// Pętla jak loop() na ESP8266: sterowanie, potem sieć (bez HTTP, OTA i WiFi)
+static void deviceMain(const SimOptions& opt, uint16_t index, int eventFd) {
+    signal(SIGUSR1, onDropSignal);
+    signal(SIGTERM, onStopSignal);
+    srandom((unsigned)getpid() ^ ((unsigned)index << 16));
+
+    uint32_t id = (uint32_t)opt.idBase + index;
+    const byte mac[6] = { 0x02, 0x48, 0x53, (byte)(id >> 16), (byte)(id >> 8), (byte)id };
+    device.setUniqueId(mac, sizeof(mac));
+
+    loadConfig();   // Pusta EEPROM - ustawienia domyślne
+    snprintf(config.mqtt_server, sizeof(config.mqtt_server), "%s", opt.host);
+    config.mqtt_port = opt.port;
+    snprintf(config.mqtt_user, sizeof(config.mqtt_user), "%s", opt.user);
+    snprintf(config.mqtt_password, sizeof(config.mqtt_password), "%s", opt.pass);
+    config.mqtt_json_state = opt.json;
+    status.soundEnabled = config.soundEnabled;
+
+    s_tank.distanceMm = config.tank_full + 50 + random() % 400;
+    s_tank.deficitMm = (random() % 100) / 100.0f * FLOAT_LOW_MM;
+    s_tank.evapMmS = opt.evapMmH / 3600.0f;
+    s_tank.floatLevel = LOW;
+    s_tank.lastStepMs = millis();
+    floatSwitchBegin();
+
+    // Jak setup() i bootTask(): pierwszy pomiar, pompa, HA, pierwsze połączenie
+    updateWaterLevel();
+    while (!measurementResultReady()) ultrasonicTask();
+    updateWaterLevel();
+    updatePump();
+    setupHA();
+    sensorPumpWorkTime.setValue("0");
+    switchSound.setState(status.soundEnabled, true);
+
+    uint64_t lastMeasurement = millis64();
+    uint32_t attempts = 0, failures = 0;
+    bool connected = false;
+    // Jak connectMQTT() w bootTask(): ustawienia i pierwsza próba od razu
+    mqtt.begin(config.mqtt_server, config.mqtt_port, config.mqtt_user, config.mqtt_password);
+    mqtt.loop();
+
+    while (!s_stop) {
+        uint64_t now = millis64();
+        ultrasonicTask();
+        updatePump();
+        buzzerTask();
+        unsigned long interval = pumpOutputOn(status.pumpState) ? PUMP_MEASUREMENT_INTERVAL : MEASUREMENT_INTERVAL;
+        if (now - lastMeasurement >= interval) {
+            updateWaterLevel();
+            lastMeasurement = now;
+        }
+
+        haMqttPoll();
+        haMqttService(now);
+
+        if (s_drop) {
+            s_drop = 0;
+            client.stop();
+        }
+        if (mqtt.connectAttempts != attempts) {
+            for (; attempts < mqtt.connectAttempts; ++attempts) sendEvent(eventFd, index, FE_ATTEMPT, mqtt.lastAttemptMs);
+        }
+        if (mqtt.connectFailures != failures) {
+            for (; failures < mqtt.connectFailures; ++failures) sendEvent(eventFd, index, FE_FAILED, millis());
+        }
+        if (mqtt.isConnected() != connected) {
+            connected = !connected;
+            sendEvent(eventFd, index, connected ? FE_CONNECTED : FE_DISCONNECTED, millis());
+        }
+
+        tankStep();
+        if (!measurementInProgress()) usleep(1000);
+    }
+    mqtt.disconnect();
+    _exit(0);
+}
+
+// ** MONITOR I RAPORT **
+
+struct Second {
+    uint32_t msgs;
+    uint32_t bytes;
+    uint32_t discMsgs;          // homeassistant/.../config
+    uint32_t discBytes;
+    uint32_t attempts;
+    uint32_t failures;
+    uint32_t connects;
+    uint32_t disconnects;
+};
+
+struct DeviceTrack {
+    bool connected;
+    int64_t firstConnectMs;     // Pierwsze połączenie w bieżącej fazie; -1 = brak
+};
+
+static std::vector<Second> s_seconds;
+
+static Second& secondAt(uint64_t ms) {
+    size_t s = (size_t)(ms / 1000);
+    if (s >= s_seconds.size()) s_seconds.resize(s + 1, Second());
+    return s_seconds[s];
+}
+
+static void onMonitorMessage(void*, const char* topic, const uint8_t*, size_t len, bool retained) {
+    if (retained) return;       // Zachowane z poprzednich uruchomień - to nie ruch floty
+    Second& s = secondAt(millis() - s_simStartMs);
+    size_t bytes = haPublishPacketSize(strlen(topic), len);
+    s.msgs++;
+    s.bytes += bytes;
+    if (strncmp(topic, "homeassistant/", 14) == 0) {
+        s.discMsgs++;
+        s.discBytes += bytes;
+    }
+}
+
+static double percentile(std::vector<int64_t> v, double p) {
+    if (v.empty()) return 0;
+    std::sort(v.begin(), v.end());
+    size_t i = (size_t)(p * (v.size() - 1) + 0.5);
+    return (double)v[i];
+}
+
+// Faza od startMs do endMs: połączenia liczone od początku fazy
+static void reportPhase(const char* name, const SimOptions& opt, uint32_t startMs, uint32_t endMs,
+                        const std::vector<int64_t>& connectMs) {
+    size_t from = startMs / 1000, to = std::min((size_t)(endMs / 1000), s_seconds.size());
+    uint64_t msgs = 0, bytes = 0, disc = 0, discBytes = 0, attempts = 0, failures = 0;
+    uint32_t peakMsgs = 0, peakDisc = 0, peakDiscBytes = 0, peakAttempts = 0;
+    for (size_t i = from; i < to; ++i) {
+        const Second& s = s_seconds[i];
+        msgs += s.msgs;
+        bytes += s.bytes;
+        disc += s.discMsgs;
+        discBytes += s.discBytes;
+        attempts += s.attempts;
+        failures += s.failures;
+        peakMsgs = std::max(peakMsgs, s.msgs);
+        peakDisc = std::max(peakDisc, s.discMsgs);
+        peakDiscBytes = std::max(peakDiscBytes, s.discBytes);
+        peakAttempts = std::max(peakAttempts, s.attempts);
+    }
+    std::vector<int64_t> times;
+    for (int64_t t : connectMs) if (t >= 0) times.push_back(t - startMs);
+    double seconds = std::max(1.0, (endMs - startMs) / 1000.0);
+
+    printf("\n## %s\n\n", name);
+    printf("| wielkość | wartość |\n|---|---:|\n");
+    printf("| połączone urządzenia | %zu / %d |\n", times.size(), opt.devices);
+    printf("| czas do połączenia p50 / p90 / maks. [s] | %.1f / %.1f / %.1f |\n",
+           percentile(times, 0.5) / 1000.0, percentile(times, 0.9) / 1000.0, percentile(times, 1.0) / 1000.0);
+    printf("| próby połączenia (nieudane) | %llu (%llu) |\n", (unsigned long long)attempts, (unsigned long long)failures);
+    printf("| maks. prób na sekundę | %u |\n", peakAttempts);
+    printf("| wiadomości: średnio / maks. na sekundę | %.1f / %u |\n", msgs / seconds, peakMsgs);
+    printf("| ruch PUBLISH średnio [B/s] | %.0f |\n", bytes / seconds);
+    printf("| discovery: wiadomości (bajty) | %llu (%llu) |\n", (unsigned long long)disc, (unsigned long long)discBytes);
+    printf("| discovery: maks. na sekundę wiadomości / bajty | %u / %u |\n", peakDisc, peakDiscBytes);
+}
+
+// Ruch ustalony: ostatnie 10 s przed końcem fazy startowej
+static void reportSteady(uint32_t endMs) {
+    size_t to = std::min((size_t)(endMs / 1000), s_seconds.size());
+    size_t from = to > 10 ? to - 10 : 0;
+    uint64_t msgs = 0, bytes = 0;
+    for (size_t i = from; i < to; ++i) {
+        msgs += s_seconds[i].msgs;
+        bytes += s_seconds[i].bytes;
+    }
+    if (to > from) {
+        printf("\nRuch ustalony (ostatnie %zu s przed burzą): %.1f wiadomości/s, %.0f B/s\n",
+               to - from, (double)msgs / (to - from), (double)bytes / (to - from));
+    }
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "Użycie: %s [--devices N] [--duration S] [--storm-at S] [--spawn-ms MS]\n"
+            "          [--host ADRES] [--port P] [--user U] [--pass H] [--id-base N]\n"
+            "          [--json] [--evap MM_H] [--restart-cmd POLECENIE] [--timeline]\n", prog);
+    exit(2);
+}
+
+int main(int argc, char** argv) {
+    SimOptions opt = { 100, 120, 60, 0, 0, false, false, 60.0f, "127.0.0.1", 1883, "", "", nullptr };
+    for (int i = 1; i < argc; ++i) {
+        const char* a = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (hasValue && strcmp(a, "--devices") == 0) opt.devices = atoi(argv[++i]);
+        else if (hasValue && strcmp(a, "--duration") == 0) opt.durationS = atoi(argv[++i]);
+        else if (hasValue && strcmp(a, "--storm-at") == 0) opt.stormAtS = atoi(argv[++i]);
+        else if (hasValue && strcmp(a, "--spawn-ms") == 0) opt.spawnMs = atoi(argv[++i]);
+        else if (hasValue && strcmp(a, "--host") == 0) opt.host = argv[++i];
+        else if (hasValue && strcmp(a, "--port") == 0) opt.port = (uint16_t)atoi(argv[++i]);
+        else if (hasValue && strcmp(a, "--user") == 0) opt.user = argv[++i];
+        else if (hasValue && strcmp(a, "--pass") == 0) opt.pass = argv[++i];
+        else if (hasValue && strcmp(a, "--id-base") == 0) opt.idBase = atoi(argv[++i]);
+        else if (hasValue && strcmp(a, "--evap") == 0) opt.evapMmH = (float)atof(argv[++i]);
+        else if (hasValue && strcmp(a, "--restart-cmd") == 0) opt.restartCmd = argv[++i];
+        else if (strcmp(a, "--json") == 0) opt.json = true;
+        else if (strcmp(a, "--timeline") == 0) opt.timeline = true;
+        else usage(argv[0]);
+    }
+    if (opt.devices <= 0 || opt.devices > 65535 || opt.durationS <= 0 || opt.stormAtS < 0 ||
+        opt.stormAtS >= opt.durationS) {
+        usage(argv[0]);
+    }
+
+    // Gniazdo na urządzenie + monitor; procesy potomne dziedziczą limit
+    struct rlimit lim;
+    if (getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur < lim.rlim_max) {
+        lim.rlim_cur = lim.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &lim);
+    }
+
+    s_simStartMs = millis();
+    WiFiClient monitorClient;
+    MqttLink monitor(monitorClient);
+    if (!monitor.connect(opt.host, opt.port, "fleet-monitor", opt.user, opt.pass, 30) ||
+        !monitor.subscribe("homeassistant/#") || !monitor.subscribe("aha/#")) {
+        fprintf(stderr, "Brak połączenia z brokerem %s:%u\n", opt.host, opt.port);
+        return 1;
+    }
+
+    int pipeFd[2];
+    if (pipe(pipeFd) != 0) return 1;
+    fcntl(pipeFd[0], F_SETFL, O_NONBLOCK);
+    signal(SIGPIPE, SIG_IGN);
+
+    std::vector<pid_t> pids;
+    std::vector<DeviceTrack> track(opt.devices, DeviceTrack{ false, -1 });
+    std::vector<int64_t> startConnect(opt.devices, -1), stormConnect(opt.devices, -1);
+    uint64_t stormMs = opt.stormAtS ? (uint64_t)opt.stormAtS * 1000 : UINT64_MAX;
+    uint64_t endMs = (uint64_t)opt.durationS * 1000;
+    bool stormDone = false;
+    int spawned = 0;
+
+    for (;;) {
+        uint64_t now = millis() - s_simStartMs;
+        if (now >= endMs) break;
+
+        // Start kolejnych urządzeń (wszystkie naraz przy --spawn-ms 0)
+        while (spawned < opt.devices && now >= (uint64_t)spawned * opt.spawnMs) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                close(pipeFd[0]);
+                if (monitorClient.fd() >= 0) close(monitorClient.fd());    // Gniazdo monitora tylko w rodzicu
+                deviceMain(opt, (uint16_t)spawned, pipeFd[1]);
+            }
+            if (pid < 0) {
+                fprintf(stderr, "fork: %s\n", strerror(errno));
+                break;
+            }
+            pids.push_back(pid);
+            spawned++;
+        }
+        if (!monitor.connected()) {
+            // Ponowne połączenie monitora (po starcie potomków lub restarcie brokera)
+            monitor.connect(opt.host, opt.port, "fleet-monitor", opt.user, opt.pass, 30);
+            monitor.subscribe("homeassistant/#");
+            monitor.subscribe("aha/#");
+        }
+
+        if (!stormDone && now >= stormMs) {
+            stormDone = true;
+            if (opt.restartCmd) {
+                if (system(opt.restartCmd) != 0) fprintf(stderr, "Polecenie restartu brokera nie powiodło się\n");
+            } else {
+                for (pid_t pid : pids) kill(pid, SIGUSR1);
+            }
+        }
+
+        struct pollfd fds[1] = { { pipeFd[0], POLLIN, 0 } };
+        poll(fds, 1, 5);
+        FleetEvent e;
+        while (read(pipeFd[0], &e, sizeof(e)) == sizeof(e)) {
+            if (e.device >= track.size()) continue;
+            Second& s = secondAt(e.ms);
+            DeviceTrack& d = track[e.device];
+            std::vector<int64_t>& phase = e.ms >= stormMs ? stormConnect : startConnect;
+            switch (e.type) {
+                case FE_ATTEMPT: s.attempts++; break;
+                case FE_FAILED: s.failures++; break;
+                case FE_CONNECTED:
+                    s.connects++;
+                    d.connected = true;
+                    if (phase[e.device] < 0) phase[e.device] = e.ms;
+                    break;
+                case FE_DISCONNECTED:
+                    s.disconnects++;
+                    d.connected = false;
+                    break;
+            }
+        }
+        while (monitor.poll(onMonitorMessage, nullptr)) {}
+        monitor.keepAlive(millis());
+    }
+
+    for (pid_t pid : pids) kill(pid, SIGTERM);
+    for (pid_t pid : pids) waitpid(pid, nullptr, 0);
+    monitor.disconnect();
+
+    int connectedAtEnd = 0;
+    for (const DeviceTrack& d : track) connectedAtEnd += d.connected;
+
+    printf("# Symulacja floty: %d urządzeń, %d s\n\n", opt.devices, opt.durationS);
+    printf("Broker %s:%u, stany %s, start co %d ms, burza: %s\n", opt.host, opt.port,
+           opt.json ? "JSON (jeden dokument)" : "temat na sensor", opt.spawnMs,
+           !opt.stormAtS ? "brak" : opt.restartCmd ? "restart brokera" : "zerwanie połączeń");
+    printf("Połączone na końcu: %d / %d\n", connectedAtEnd, opt.devices);
+
+    uint32_t stormAt = opt.stormAtS ? (uint32_t)stormMs : (uint32_t)endMs;
+    reportPhase("Start floty", opt, 0, stormAt, startConnect);
+    reportSteady(stormAt);
+    if (opt.stormAtS) reportPhase("Burza ponownych połączeń", opt, stormAt, (uint32_t)endMs, stormConnect);
+
+    if (opt.timeline) {
+        printf("\n## Przebieg\n\n| s | wiadomości | bajty | discovery | próby | nieudane | połączenia | rozłączenia |\n");
+        printf("|---:|---:|---:|---:|---:|---:|---:|---:|\n");
+        for (size_t i = 0; i < s_seconds.size(); ++i) {
+            const Second& s = s_seconds[i];
+            printf("| %zu | %u | %u | %u | %u | %u | %u | %u |\n", i, s.msgs, s.bytes, s.discMsgs,
+                   s.attempts, s.failures, s.connects, s.disconnects);
+        }
+    }
+    return connectedAtEnd == opt.devices ? 0 : 1;
+}
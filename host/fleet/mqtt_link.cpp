@@ -0,0 +1,197 @@
+#include "mqtt_link.h"
+#include <string.h>
+
+enum {
+    MQTT_CONNECT = 0x10,
+    MQTT_CONNACK = 0x20,
+    MQTT_PUBLISH = 0x30,
+    MQTT_SUBSCRIBE = 0x82,
+    MQTT_PINGREQ = 0xC0,
+    MQTT_DISCONNECT = 0xE0,
+};
+
+// Długość pozostała: 7 bitów na bajt, najstarszy bit = kontynuacja
+static size_t encodeLength(uint8_t* out, size_t len) {
+    size_t n = 0;
+    do {
+        uint8_t b = len & 0x7F;
+        len >>= 7;
+        out[n++] = len ? (b | 0x80) : b;
+    } while (len);
+    return n;
+}
+
+static size_t putString(uint8_t* out, const char* s) {
+    size_t len = strlen(s);
+    out[0] = (uint8_t)(len >> 8);
+    out[1] = (uint8_t)len;
+    memcpy(out + 2, s, len);
+    return len + 2;
+}
+
+MqttLink::MqttLink(WiFiClient& client)
+    : stats(), _client(client), _keepAliveS(0), _packetId(0), _publishLeft(0), _lastOutMs(0) {}
+
+bool MqttLink::send(const uint8_t* data, size_t len) {
+    if (_client.write(data, len) != len) {
+        _client.stop();
+        return false;
+    }
+    stats.bytesOut += len;
+    _lastOutMs = millis();
+    return true;
+}
+
+bool MqttLink::connect(const char* host, uint16_t port, const char* clientId,
+                       const char* user, const char* pass, uint16_t keepAliveS) {
+    _client.stop();
+    if (!_client.connect(host, port)) return false;
+    bool withUser = user && *user;
+    bool withPass = withUser && pass && *pass;
+    uint8_t body[256];
+    size_t n = putString(body, "MQTT");
+    body[n++] = 4;                                              // MQTT 3.1.1
+    body[n++] = 0x02 | (withUser ? 0x80 : 0) | (withPass ? 0x40 : 0);
+    body[n++] = (uint8_t)(keepAliveS >> 8);
+    body[n++] = (uint8_t)keepAliveS;
+    if (strlen(clientId) + (withUser ? strlen(user) : 0) + (withPass ? strlen(pass) : 0) + 6 > sizeof(body) - n) {
+        _client.stop();
+        return false;
+    }
+    n += putString(body + n, clientId);
+    if (withUser) n += putString(body + n, user);
+    if (withPass) n += putString(body + n, pass);
+
+    uint8_t header[5] = { MQTT_CONNECT };
+    size_t h = 1 + encodeLength(header + 1, n);
+    if (!send(header, h) || !send(body, n)) return false;
+    stats.packetsOut++;
+    _keepAliveS = keepAliveS;
+
+    uint32_t start = millis();
+    while (millis() - start < MQTT_CONNACK_TIMEOUT_MS) {
+        if (!_client.connected()) return false;
+        if (_client.available() <= 0) {
+            delay(1);
+            continue;
+        }
+        uint8_t type;
+        size_t len;
+        if (!readPacket(type, len)) return false;
+        if ((type & 0xF0) != MQTT_CONNACK) continue;
+        if (len == 2 && _buf[1] == 0) return true;              // Kod powrotu 0 = przyjęte
+        break;
+    }
+    _client.stop();
+    return false;
+}
+
+bool MqttLink::connected() {
+    return _client.connected();
+}
+
+void MqttLink::stop() {
+    _client.stop();
+}
+
+void MqttLink::disconnect() {
+    static const uint8_t packet[2] = { MQTT_DISCONNECT, 0 };
+    if (_client.connected()) send(packet, sizeof(packet));
+    _client.stop();
+}
+
+bool MqttLink::beginPublish(const char* topic, size_t len, bool retained) {
+    size_t topicLen = strlen(topic);
+    uint8_t header[5 + 2 + 256];
+    if (topicLen > 256) return false;
+    header[0] = MQTT_PUBLISH | (retained ? 1 : 0);
+    size_t h = 1 + encodeLength(header + 1, 2 + topicLen + len);
+    h += putString(header + h, topic);
+    _publishLeft = len;
+    if (!send(header, h)) return false;
+    stats.packetsOut++;
+    return true;
+}
+
+bool MqttLink::write(const uint8_t* data, size_t len) {
+    if (len > _publishLeft) len = _publishLeft;
+    _publishLeft -= len;
+    return send(data, len);
+}
+
+bool MqttLink::endPublish() {
+    if (_publishLeft == 0) return true;
+    _client.stop();                 // Niepełny pakiet - sesja nie do odratowania
+    return false;
+}
+
+bool MqttLink::publish(const char* topic, const uint8_t* payload, size_t len, bool retained) {
+    return beginPublish(topic, len, retained) && write(payload, len) && endPublish();
+}
+
+bool MqttLink::subscribe(const char* topic) {
+    uint8_t packet[5 + 2 + 2 + 256 + 1];
+    size_t topicLen = strlen(topic);
+    if (topicLen > 256) return false;
+    packet[0] = MQTT_SUBSCRIBE;
+    size_t n = 1 + encodeLength(packet + 1, 2 + 2 + topicLen + 1);
+    if (++_packetId == 0) _packetId = 1;
+    packet[n++] = (uint8_t)(_packetId >> 8);
+    packet[n++] = (uint8_t)_packetId;
+    n += putString(packet + n, topic);
+    packet[n++] = 0;                                            // QoS 0
+    if (!send(packet, n)) return false;
+    stats.packetsOut++;
+    return true;
+}
+
+// Pakiet do _buf; za duży jest czytany do końca i zgłaszany z len = 0
+bool MqttLink::readPacket(uint8_t& header, size_t& len) {
+    uint8_t b;
+    if (_client.read(&header, 1) != 1) return false;
+    len = 0;
+    for (int shift = 0; shift < 28; shift += 7) {
+        if (_client.read(&b, 1) != 1) return false;
+        len |= (size_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) break;
+    }
+    stats.packetsIn++;
+    stats.bytesIn += len + 2;
+    if (len > sizeof(_buf)) {
+        for (size_t left = len; left > 0;) {
+            size_t chunk = left < sizeof(_buf) ? left : sizeof(_buf);
+            if (_client.read(_buf, chunk) != (int)chunk) return false;
+            left -= chunk;
+        }
+        len = 0;
+        header = 0;
+        return true;
+    }
+    return len == 0 || _client.read(_buf, len) == (int)len;
+}
+
+bool MqttLink::poll(MqttHandler handler, void* ctx) {
+    if (_client.available() <= 0) return false;
+    uint8_t header;
+    size_t len;
+    if (!readPacket(header, len)) {
+        _client.stop();
+        return false;
+    }
+    if ((header & 0xF0) != MQTT_PUBLISH || len < 2) return true;
+    size_t topicLen = ((size_t)_buf[0] << 8) | _buf[1];
+    size_t offset = 2 + topicLen + ((header & 0x06) ? 2 : 0);   // Identyfikator pakietu przy QoS > 0
+    if (offset > len || topicLen >= 256) return true;
+    char topic[256];
+    memcpy(topic, _buf + 2, topicLen);
+    topic[topicLen] = '\0';
+    if (handler) handler(ctx, topic, _buf + offset, len - offset, (header & 0x01) != 0);
+    return true;
+}
+
+void MqttLink::keepAlive(uint32_t nowMs) {
+    if (!_keepAliveS || !_client.connected()) return;
+    if (nowMs - _lastOutMs < (uint32_t)_keepAliveS * 1000UL) return;
+    static const uint8_t ping[2] = { MQTT_PINGREQ, 0 };
+    if (send(ping, sizeof(ping))) stats.packetsOut++;
+}
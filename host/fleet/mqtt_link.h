@@ -0,0 +1,62 @@
+#ifndef FLEET_MQTT_LINK_H
+#define FLEET_MQTT_LINK_H
+
+// Minimalny klient MQTT 3.1.1 (QoS 0) na WiFiClient z shim/ - warstwa pod
+// HAMqtt urządzeń wirtualnych i pod monitorem ruchu w procesie nadrzędnym
+
+#include <stddef.h>
+#include <stdint.h>
+#include <ESP8266WiFi.h>
+
+const size_t MQTT_LINK_BUFFER = 4096;       // Większe pakiety przychodzące są pomijane
+const uint32_t MQTT_CONNACK_TIMEOUT_MS = 5000;
+
+// Odebrany PUBLISH; retained = wiadomość zachowana, dostarczona przy subskrypcji
+typedef void (*MqttHandler)(void* ctx, const char* topic, const uint8_t* payload, size_t len, bool retained);
+
+struct MqttLinkStats {
+    uint32_t packetsOut;
+    uint32_t bytesOut;
+    uint32_t packetsIn;
+    uint32_t bytesIn;
+};
+
+class MqttLink {
+public:
+    explicit MqttLink(WiFiClient& client);
+
+    // TCP + CONNECT, czeka na CONNACK; czysta sesja, bez LWT
+    bool connect(const char* host, uint16_t port, const char* clientId,
+                 const char* user, const char* pass, uint16_t keepAliveS);
+    bool connected();
+    void stop();
+    // DISCONNECT i zamknięcie (zwykłe rozłączenie, bez ostatniej woli)
+    void disconnect();
+
+    bool publish(const char* topic, const uint8_t* payload, size_t len, bool retained);
+    // Nagłówek i temat od razu, payload strumieniowo (jak PubSubClient)
+    bool beginPublish(const char* topic, size_t len, bool retained);
+    bool write(const uint8_t* data, size_t len);
+    bool endPublish();
+    bool subscribe(const char* topic);
+
+    // Jeden pakiet przychodzący, jeśli czeka w gnieździe; false gdy nic nie było
+    bool poll(MqttHandler handler, void* ctx);
+    // PINGREQ po keepAlive bez ruchu wychodzącego
+    void keepAlive(uint32_t nowMs);
+
+    MqttLinkStats stats;
+
+private:
+    bool send(const uint8_t* data, size_t len);
+    bool readPacket(uint8_t& header, size_t& len);
+
+    WiFiClient& _client;
+    uint16_t _keepAliveS;
+    uint16_t _packetId;
+    size_t _publishLeft;
+    uint32_t _lastOutMs;
+    uint8_t _buf[MQTT_LINK_BUFFER];
+};
+
+#endif // FLEET_MQTT_LINK_H
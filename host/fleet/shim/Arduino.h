@@ -0,0 +1,94 @@
+#ifndef FLEET_ARDUINO_H
+#define FLEET_ARDUINO_H
+
+// Rdzeń Arduino dla urządzeń wirtualnych symulatora floty (host/fleet).
+// Czas to zegar monotoniczny procesu, piny obsługuje model zbiornika
+// w fleet_sim.cpp (echo HC-SR04, pływak, pompa). Tylko to, czego używają
+// moduły firmware kompilowane do symulatora.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+using std::abs;
+using std::min;
+using std::max;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x00
+#define OUTPUT 0x01
+#define INPUT_PULLUP 0x02
+#define CHANGE 3
+#define IRAM_ATTR
+#define PROGMEM
+#define PI 3.1415926535897932384626433832795
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define strlen_P strlen
+#define memcpy_P memcpy
+#define F(s) (s)
+#define constrain(x, lo, hi) ((x) < (lo) ? (lo) : ((x) > (hi) ? (hi) : (x)))
+#define digitalPinToInterrupt(p) (p)
+
+// Numery GPIO płytki D1 mini (pins.h)
+enum { D0 = 16, D1 = 5, D2 = 4, D3 = 0, D4 = 2, D5 = 14, D6 = 12, D7 = 13, D8 = 15 };
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+inline void yield() {}
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode);
+inline void noInterrupts() {}
+inline void interrupts() {}
+inline void tone(uint8_t, unsigned int) {}
+inline void noTone(uint8_t) {}
+
+inline char* dtostrf(double value, signed char width, unsigned char prec, char* out) {
+    sprintf(out, "%*.*f", width, prec, value);
+    return out;
+}
+
+#if !defined(__GLIBC__) || !__GLIBC_PREREQ(2, 38)     // Nowsza glibc ma własne
+inline size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t len = strlen(src);
+    if (size) {
+        size_t n = len < size ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+#endif
+
+inline char* itoa(int value, char* out, int base) {
+    if (base == 16) sprintf(out, "%x", value);
+    else sprintf(out, "%d", value);
+    return out;
+}
+
+// Tylko porównanie z literałem (server.arg() w handlerach HTTP)
+class String {
+public:
+    String(const char* s = "") { snprintf(_buf, sizeof(_buf), "%s", s); }
+    bool operator==(const char* s) const { return strcmp(_buf, s) == 0; }
+    const char* c_str() const { return _buf; }
+
+private:
+    char _buf[64];
+};
+
+#endif // FLEET_ARDUINO_H
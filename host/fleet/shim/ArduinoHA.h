@@ -0,0 +1,121 @@
+#ifndef FLEET_ARDUINOHA_H
+#define FLEET_ARDUINOHA_H
+
+// Podzbiór ArduinoHA 2.x używany przez firmware (HADevice, HAMqtt, HASwitch)
+// na kliencie mqtt_link.h. Zachowanie sieciowe jak w bibliotece: po każdym
+// połączeniu przełączniki publikują discovery i stan oraz subskrybują tematy
+// poleceń - ten ruch należy do burzy ponownych połączeń tak samo jak sensory
+// z ha_discovery.cpp.
+
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include "mqtt_link.h"
+
+class HAMqtt;
+
+class HADevice {
+public:
+    explicit HADevice(const char* uniqueId);
+    // Identyfikator z adresu MAC (małe litery hex, jak HAUtils)
+    bool setUniqueId(const byte* id, uint16_t length);
+    const char* getUniqueId() const { return _id; }
+    void setName(const char* name) { _name = name; }
+    void setModel(const char* model) { _model = model; }
+    void setManufacturer(const char* manufacturer) { _manufacturer = manufacturer; }
+    void setSoftwareVersion(const char* version) { _swVersion = version; }
+    // uniq_id encji jako <urządzenie>_<id> zamiast samego <id>
+    void enableExtendedUniqueIds() { _extendedUniqueIds = true; }
+    bool isExtendedUniqueIdsEnabled() const { return _extendedUniqueIds; }
+
+    const char* _name;
+    const char* _model;
+    const char* _manufacturer;
+    const char* _swVersion;
+    bool _extendedUniqueIds;
+
+private:
+    char _id[32];
+};
+
+class HASwitch {
+public:
+    explicit HASwitch(const char* objectId);
+    // Publikacja tylko przy zmianie (lub force) i przy aktywnym połączeniu
+    bool setState(bool state, bool force = false);
+    bool getCurrentState() const { return _state; }
+    const char* uniqueId() const { return _id; }
+    void setName(const char* name) { _name = name; }
+    void setIcon(const char* icon) { _icon = icon; }
+    void onCommand(void (*callback)(bool state, HASwitch* sender)) { _callback = callback; }
+
+    // Wywoływane przez HAMqtt
+    void onMqttConnected(HAMqtt& mqtt);
+    bool onMqttMessage(HAMqtt& mqtt, const char* topic, const uint8_t* payload, size_t len);
+    HASwitch* next() const { return _next; }
+    static HASwitch* head() { return s_head; }
+
+private:
+    void buildTopic(HAMqtt& mqtt, char* out, size_t size, const char* suffix) const;
+
+    const char* _id;
+    const char* _name;
+    const char* _icon;
+    bool _state;
+    void (*_callback)(bool state, HASwitch* sender);
+    HASwitch* _next;
+    static HASwitch* s_head;
+};
+
+class HAMqtt {
+public:
+    static const uint16_t KEEP_ALIVE_S = 15;
+    static const uint32_t RECONNECT_INTERVAL_MS = 10000;   // HAMqtt::ReconnectInterval
+
+    HAMqtt(WiFiClient& client, HADevice& device, uint8_t maxDeviceTypes);
+    static HAMqtt* instance() { return s_instance; }
+
+    // Jak ArduinoHA 2.x: begin() tylko zapamiętuje ustawienia (false, gdy klient
+    // już zainicjowany), łączy loop() - od razu po begin(), potem najwyżej co
+    // RECONNECT_INTERVAL_MS i bez rozrzutu; disconnect() cofa inicjalizację
+    bool begin(const char* host, uint16_t port, const char* user = nullptr, const char* pass = nullptr);
+    bool disconnect();
+    void loop();
+    bool isConnected();
+    void onConnected(void (*callback)()) { _connectedCallback = callback; }
+
+    bool publish(const char* topic, const char* payload, bool retained = false);
+    bool beginPublish(const char* topic, uint16_t payloadLength, bool retained = false);
+    void writePayload(const char* data, uint16_t length);
+    void writePayload(const uint8_t* data, uint16_t length);
+    bool endPublish();
+    bool subscribe(const char* topic);
+    void setBufferSize(uint16_t) {}     // Bufor odbioru MqttLink ma stały rozmiar
+    void onMessage(void (*callback)(const char* topic, const uint8_t* payload, uint16_t length)) { _callback = callback; }
+
+    HADevice& device() { return _device; }
+    MqttLink& link() { return _link; }
+
+    // Symulator: liczniki prób połączenia
+    uint32_t connectAttempts;
+    uint32_t connectFailures;
+    uint32_t lastAttemptMs;     // Początek ostatniej próby (begin() blokuje do CONNACK)
+
+private:
+    static void dispatch(void* ctx, const char* topic, const uint8_t* payload, size_t len, bool retained);
+    void connectToServer();
+
+    HADevice& _device;
+    MqttLink _link;
+    bool _initialized;
+    bool _connected;
+    uint32_t _lastConnectionAttemptAt;      // 0 = pierwsza próba bez czekania
+    const char* _host;
+    uint16_t _port;
+    const char* _user;
+    const char* _pass;
+    void (*_connectedCallback)();
+    void (*_callback)(const char* topic, const uint8_t* payload, uint16_t length);
+    static HAMqtt* s_instance;
+};
+
+#endif // FLEET_ARDUINOHA_H
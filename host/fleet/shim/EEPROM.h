@@ -0,0 +1,32 @@
+#ifndef FLEET_EEPROM_H
+#define FLEET_EEPROM_H
+
+// EEPROM w RAM - każde urządzenie wirtualne startuje z czystą pamięcią
+// (konfiguracja domyślna); zużycie flash liczy host/flash_wear.cpp
+
+#include <Arduino.h>
+
+class EEPROMClass {
+public:
+    EEPROMClass() { memset(_data, 0xFF, sizeof(_data)); }
+    void begin(size_t) {}
+    uint8_t read(int address) { return _data[address]; }
+    void write(int address, uint8_t value) { _data[address] = value; }
+    bool commit() { return true; }
+    bool end() { return true; }
+    template<typename T> T& get(int address, T& value) {
+        memcpy(&value, _data + address, sizeof(T));
+        return value;
+    }
+    template<typename T> const T& put(int address, const T& value) {
+        memcpy(_data + address, &value, sizeof(T));
+        return value;
+    }
+
+private:
+    uint8_t _data[4096];
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // FLEET_EEPROM_H
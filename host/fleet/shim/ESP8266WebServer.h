@@ -0,0 +1,18 @@
+#ifndef FLEET_ESP8266WEBSERVER_H
+#define FLEET_ESP8266WEBSERVER_H
+
+// Urządzenia wirtualne nie udostępniają HTTP - tylko deklaracje dla handlerów
+
+#include <Arduino.h>
+
+struct HTTPUpload {};
+
+class ESP8266WebServer {
+public:
+    explicit ESP8266WebServer(int) {}
+    String arg(const char*) { return String(); }
+    bool hasArg(const char*) { return false; }
+    void send(int, const char*, const char*) {}
+};
+
+#endif // FLEET_ESP8266WEBSERVER_H
@@ -0,0 +1,26 @@
+#ifndef FLEET_ESP8266WIFI_H
+#define FLEET_ESP8266WIFI_H
+
+// Klient TCP na gniazdach POSIX (shim_net.cpp) - to przez niego HAMqtt
+// rozmawia z brokerem, jak PubSubClient przez WiFiClient w urządzeniu
+
+#include <Arduino.h>
+
+class WiFiClient {
+public:
+    WiFiClient() : _fd(-1) {}
+    // Łączenie z limitem czasu; TCP_NODELAY jak w lwIP
+    int connect(const char* host, uint16_t port);
+    size_t write(const uint8_t* data, size_t len);
+    int available();
+    // Blokujący odczyt len bajtów (limit czasu jak setTimeout w rdzeniu)
+    int read(uint8_t* buf, size_t len);
+    void stop();
+    uint8_t connected();
+    int fd() const { return _fd; }  // Symulator: zamknięcie w procesie potomnym
+
+private:
+    int _fd;
+};
+
+#endif // FLEET_ESP8266WIFI_H
@@ -0,0 +1,4 @@
+#ifndef FLEET_UPDATER_H
+#define FLEET_UPDATER_H
+// Bez OTA w symulatorze floty
+#endif // FLEET_UPDATER_H
@@ -0,0 +1,13 @@
+#ifndef FLEET_WEBSOCKETSSERVER_H
+#define FLEET_WEBSOCKETSSERVER_H
+
+#include <stdint.h>
+
+enum WStype_t { WStype_DISCONNECTED, WStype_CONNECTED, WStype_TEXT };
+
+class WebSocketsServer {
+public:
+    explicit WebSocketsServer(int) {}
+};
+
+#endif // FLEET_WEBSOCKETSSERVER_H
@@ -0,0 +1,302 @@
+// Sieć urządzeń wirtualnych: WiFiClient na gniazdach POSIX i podzbiór
+// ArduinoHA (shim/ArduinoHA.h) na mqtt_link.h
+
+#include <Arduino.h>
+#include <ArduinoHA.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+const int TCP_CONNECT_TIMEOUT_MS = 3000;
+const int TCP_IO_TIMEOUT_MS = 2000;         // Jak domyślny setTimeout klienta w rdzeniu
+
+// ** CZAS **
+
+static uint64_t monotonicUs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// Zegar od startu procesu, z przepełnieniem jak w urządzeniu
+static const uint64_t s_startUs = monotonicUs();
+
+uint32_t millis() {
+    return (uint32_t)((monotonicUs() - s_startUs) / 1000);
+}
+
+uint32_t micros() {
+    return (uint32_t)(monotonicUs() - s_startUs);
+}
+
+void delay(uint32_t ms) {
+    usleep(ms * 1000);
+}
+
+void delayMicroseconds(uint32_t us) {
+    usleep(us);
+}
+
+// ** WiFiClient **
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+    stop();
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* res = nullptr;
+    if (getaddrinfo(host, service, &hints, &res) != 0 || !res) return 0;
+
+    int fd = socket(res->ai_family, res->ai_socktype | SOCK_CLOEXEC, res->ai_protocol);
+    if (fd < 0) {
+        freeaddrinfo(res);
+        return 0;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    int rc = ::connect(fd, res->ai_addr, res->ai_addrlen);
+    freeaddrinfo(res);
+    if (rc < 0 && errno == EINPROGRESS) {
+        struct pollfd p = { fd, POLLOUT, 0 };
+        int err = 0;
+        socklen_t errLen = sizeof(err);
+        if (poll(&p, 1, TCP_CONNECT_TIMEOUT_MS) == 1 &&
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &errLen) == 0 && err == 0) {
+            rc = 0;
+        }
+    }
+    if (rc < 0) {
+        close(fd);
+        return 0;
+    }
+    fcntl(fd, F_SETFL, 0);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    struct timeval tv = { TCP_IO_TIMEOUT_MS / 1000, (TCP_IO_TIMEOUT_MS % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+    _fd = fd;
+    return 1;
+}
+
+size_t WiFiClient::write(const uint8_t* data, size_t len) {
+    size_t sent = 0;
+    while (_fd >= 0 && sent < len) {
+        ssize_t n = send(_fd, data + sent, len - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+            stop();
+            break;
+        }
+        sent += (size_t)n;
+    }
+    return sent;
+}
+
+int WiFiClient::available() {
+    if (_fd < 0) return 0;
+    int n = 0;
+    if (ioctl(_fd, FIONREAD, &n) < 0) n = 0;
+    if (n > 0) return n;
+    // Zamknięcie przez broker widać tylko jako odczyt zera bajtów
+    uint8_t b;
+    ssize_t r = recv(_fd, &b, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) stop();
+    return 0;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t len) {
+    if (_fd < 0) return -1;
+    ssize_t n = recv(_fd, buf, len, MSG_WAITALL);
+    if (n != (ssize_t)len) {
+        stop();
+        return -1;
+    }
+    return (int)n;
+}
+
+void WiFiClient::stop() {
+    if (_fd >= 0) close(_fd);
+    _fd = -1;
+}
+
+uint8_t WiFiClient::connected() {
+    if (_fd >= 0) available();
+    return _fd >= 0;
+}
+
+// ** HADevice **
+
+HADevice::HADevice(const char* uniqueId)
+    : _name(nullptr), _model(nullptr), _manufacturer(nullptr), _swVersion(nullptr), _extendedUniqueIds(false) {
+    snprintf(_id, sizeof(_id), "%s", uniqueId);
+}
+
+bool HADevice::setUniqueId(const byte* id, uint16_t length) {
+    if (length * 2 >= sizeof(_id)) return false;
+    for (uint16_t i = 0; i < length; ++i) snprintf(_id + i * 2, 3, "%02x", id[i]);
+    return true;
+}
+
+// ** HASwitch **
+
+HASwitch* HASwitch::s_head = nullptr;
+
+HASwitch::HASwitch(const char* objectId)
+    : _id(objectId), _name(nullptr), _icon(nullptr), _state(false), _callback(nullptr), _next(s_head) {
+    s_head = this;
+}
+
+void HASwitch::buildTopic(HAMqtt& mqtt, char* out, size_t size, const char* suffix) const {
+    snprintf(out, size, "aha/%s/%s/%s", mqtt.device().getUniqueId(), _id, suffix);
+}
+
+bool HASwitch::setState(bool state, bool force) {
+    if (!force && state == _state) return true;
+    _state = state;
+    HAMqtt* mqtt = HAMqtt::instance();
+    if (!mqtt || !mqtt->isConnected()) return false;
+    char topic[96];
+    buildTopic(*mqtt, topic, sizeof(topic), "stat_t");
+    return mqtt->publish(topic, state ? "ON" : "OFF", true);
+}
+
+// Discovery jak HASwitch::buildSerializer w ArduinoHA (skrócone klucze)
+void HASwitch::onMqttConnected(HAMqtt& mqtt) {
+    HADevice& dev = mqtt.device();
+    char topic[128];
+    char stateTopic[96];
+    char commandTopic[96];
+    char payload[768];
+    buildTopic(mqtt, stateTopic, sizeof(stateTopic), "stat_t");
+    buildTopic(mqtt, commandTopic, sizeof(commandTopic), "cmd_t");
+    snprintf(topic, sizeof(topic), "homeassistant/switch/%s/%s/config", dev.getUniqueId(), _id);
+    snprintf(payload, sizeof(payload),
+             "{\"name\":\"%s\",\"uniq_id\":\"%s%s%s\",\"ic\":\"%s\","
+             "\"dev\":{\"ids\":\"%s\",\"name\":\"%s\",\"mdl\":\"%s\",\"mf\":\"%s\",\"sw\":\"%s\"},"
+             "\"stat_t\":\"%s\",\"cmd_t\":\"%s\"}",
+             _name ? _name : _id,
+             dev.isExtendedUniqueIdsEnabled() ? dev.getUniqueId() : "", dev.isExtendedUniqueIdsEnabled() ? "_" : "",
+             _id, _icon ? _icon : "",
+             dev.getUniqueId(), dev._name ? dev._name : "", dev._model ? dev._model : "",
+             dev._manufacturer ? dev._manufacturer : "", dev._swVersion ? dev._swVersion : "",
+             stateTopic, commandTopic);
+    mqtt.publish(topic, payload, true);
+    mqtt.publish(stateTopic, _state ? "ON" : "OFF", true);
+    mqtt.subscribe(commandTopic);
+}
+
+bool HASwitch::onMqttMessage(HAMqtt& mqtt, const char* topic, const uint8_t* payload, size_t len) {
+    char commandTopic[96];
+    buildTopic(mqtt, commandTopic, sizeof(commandTopic), "cmd_t");
+    if (strcmp(topic, commandTopic) != 0) return false;
+    bool on = len == 2 && memcmp(payload, "ON", 2) == 0;
+    bool off = len == 3 && memcmp(payload, "OFF", 3) == 0;
+    if ((on || off) && _callback) _callback(on, this);
+    return true;
+}
+
+// ** HAMqtt **
+
+HAMqtt* HAMqtt::s_instance = nullptr;
+
+HAMqtt::HAMqtt(WiFiClient& client, HADevice& device, uint8_t)
+    : connectAttempts(0), connectFailures(0), lastAttemptMs(0), _device(device), _link(client),
+      _initialized(false), _connected(false), _lastConnectionAttemptAt(0), _host(nullptr), _port(0),
+      _user(nullptr), _pass(nullptr), _connectedCallback(nullptr), _callback(nullptr) {
+    s_instance = this;
+}
+
+bool HAMqtt::begin(const char* host, uint16_t port, const char* user, const char* pass) {
+    if (_initialized) return false;
+    _host = host;
+    _port = port;
+    _user = user;
+    _pass = pass;
+    _initialized = true;
+    return true;
+}
+
+bool HAMqtt::disconnect() {
+    if (!_initialized) return false;
+    _initialized = false;
+    _lastConnectionAttemptAt = 0;
+    _link.disconnect();
+    _connected = false;
+    return true;
+}
+
+// Jak HAMqtt::connectToServer(): stały odstęp prób, połączenie blokuje do CONNACK
+void HAMqtt::connectToServer() {
+    uint32_t now = millis();
+    if (_lastConnectionAttemptAt > 0 && now - _lastConnectionAttemptAt < RECONNECT_INTERVAL_MS) return;
+    _lastConnectionAttemptAt = now;
+    connectAttempts++;
+    lastAttemptMs = now;
+    _connected = _link.connect(_host, _port, _device.getUniqueId(), _user, _pass, KEEP_ALIVE_S);
+    if (!_connected) {
+        connectFailures++;
+        return;
+    }
+    for (HASwitch* sw = HASwitch::head(); sw; sw = sw->next()) sw->onMqttConnected(*this);
+    if (_connectedCallback) _connectedCallback();
+}
+
+bool HAMqtt::isConnected() {
+    if (_connected && !_link.connected()) _connected = false;
+    return _connected;
+}
+
+void HAMqtt::dispatch(void* ctx, const char* topic, const uint8_t* payload, size_t len, bool) {
+    HAMqtt* self = static_cast<HAMqtt*>(ctx);
+    if (self->_callback) self->_callback(topic, payload, (uint16_t)len);
+    for (HASwitch* sw = HASwitch::head(); sw; sw = sw->next()) {
+        if (sw->onMqttMessage(*self, topic, payload, len)) break;
+    }
+}
+
+// Jeden pakiet na wywołanie, jak PubSubClient::loop(); bez połączenia - próba
+// połączenia w tym samym wywołaniu, jak w bibliotece
+void HAMqtt::loop() {
+    if (!_initialized) return;
+    if (isConnected()) {
+        _link.poll(dispatch, this);
+        _link.keepAlive(millis());
+        if (isConnected()) return;
+    }
+    connectToServer();
+}
+
+bool HAMqtt::publish(const char* topic, const char* payload, bool retained) {
+    if (!isConnected()) return false;
+    return _link.publish(topic, (const uint8_t*)payload, strlen(payload), retained);
+}
+
+bool HAMqtt::beginPublish(const char* topic, uint16_t payloadLength, bool retained) {
+    if (!isConnected()) return false;
+    return _link.beginPublish(topic, payloadLength, retained);
+}
+
+void HAMqtt::writePayload(const char* data, uint16_t length) {
+    _link.write((const uint8_t*)data, length);
+}
+
+void HAMqtt::writePayload(const uint8_t* data, uint16_t length) {
+    _link.write(data, length);
+}
+
+bool HAMqtt::endPublish() {
+    return _link.endPublish();
+}
+
+bool HAMqtt::subscribe(const char* topic) {
+    if (!isConnected()) return false;
+    return _link.subscribe(topic);
+}
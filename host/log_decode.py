@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+# Dekoder binarnego dziennika urządzenia (src/log_ring.h).
+#
+# Pobiera GET /log?raw=1 (albo czyta zapisany zrzut) i formatuje wpisy
+# według tabeli komunikatów z src/log_formats.h - urządzenie przechowuje
+# tylko numer komunikatu i surowe argumenty. Z --follow odpytuje urządzenie
+# co --interval sekund i wypisuje tylko nowe wpisy (?since=).
+#
+# Uruchomienie (tylko biblioteka standardowa):
+#   python3 host/log_decode.py 192.168.1.50
+#   python3 host/log_decode.py hydrosense.local --follow
+#   curl -s 'http://192.168.1.50/log?raw=1' > log.bin && python3 host/log_decode.py --file log.bin
+
+import argparse
+import os
+import re
+import struct
+import sys
+import time
+import urllib.request
+
+RAW_MAGIC = 0x474C5348  # "HSLG"
+RAW_VERSION = 1
+HEADER = struct.Struct('<IBBHII')
+ENTRY = struct.Struct('<IHBB4I')
+LEVELS = 'DIWE'
+
+DEFAULT_FORMATS = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'src', 'log_formats.h')
+MESSAGE_RE = re.compile(r'X\(\s*(LM_\w+)\s*,\s*"((?:[^"\\]|\\.)*)"\s*\)')
+SPEC_RE = re.compile(r'%(%|[-+ #0-9.]*[diuxXcf])')
+
+
+def load_formats(path):
+    with open(path, encoding='utf-8') as f:
+        return [fmt.encode().decode('unicode_escape').encode('latin-1').decode('utf-8')
+                for _, fmt in MESSAGE_RE.findall(f.read())]
+
+
+def format_message(formats, msg, args):
+    if msg >= len(formats):
+        return '? komunikat %d' % msg
+    it = iter(args)
+
+    def spec(m):
+        if m.group(1) == '%':
+            return '%'
+        conv = m.group(1)[-1]
+        try:
+            raw = next(it)
+        except StopIteration:
+            return '?'
+        if conv == 'f':
+            value = struct.unpack('<f', struct.pack('<I', raw))[0]
+        elif conv in 'di':
+            value = struct.unpack('<i', struct.pack('<I', raw))[0]
+        elif conv == 'c':
+            value = chr(raw & 0xFF)
+        else:
+            value = raw
+        return ('%' + m.group(1).replace('u', 'd')) % value
+
+    return SPEC_RE.sub(spec, formats[msg])
+
+
+def decode(data, formats):
+    if len(data) < HEADER.size:
+        raise ValueError('za krótki zrzut (%d B)' % len(data))
+    magic, version, entry_size, count, first, now_ms = HEADER.unpack_from(data)
+    if magic != RAW_MAGIC or version != RAW_VERSION or entry_size != ENTRY.size:
+        raise ValueError('nieznany format zrzutu (magic %08x, wersja %d, wpis %d B)' % (magic, version, entry_size))
+    lines = []
+    for i in range(count):
+        off = HEADER.size + i * ENTRY.size
+        if off + ENTRY.size > len(data):
+            break
+        ms, msg, level, argc, *args = ENTRY.unpack_from(data, off)
+        if msg == len(formats) and argc == 0 and ms == 0:
+            continue  # Wpis nadpisany w trakcie wysyłki
+        text = format_message(formats, msg, args[:argc])
+        lvl = LEVELS[level] if level < len(LEVELS) else '?'
+        lines.append('%d %d.%03d %s %s' % (first + i, ms // 1000, ms % 1000, lvl, text))
+    return first + count, now_ms, lines
+
+
+def fetch(host, since, timeout):
+    url = 'http://%s/log?raw=1' % host
+    if since is not None:
+        url += '&since=%d' % since
+    with urllib.request.urlopen(url, timeout=timeout) as r:
+        return r.read()
+
+
+def main():
+    ap = argparse.ArgumentParser(description='Dekoder dziennika HydroSense')
+    ap.add_argument('host', nargs='?', help='adres urządzenia')
+    ap.add_argument('--file', help='zapisany zrzut GET /log?raw=1 zamiast urządzenia')
+    ap.add_argument('--formats', default=DEFAULT_FORMATS, help='ścieżka do src/log_formats.h')
+    ap.add_argument('--follow', action='store_true', help='odpytuj urządzenie i wypisuj nowe wpisy')
+    ap.add_argument('--interval', type=float, default=2.0)
+    ap.add_argument('--timeout', type=float, default=5.0)
+    opts = ap.parse_args()
+    if not opts.host and not opts.file:
+        ap.error('podaj adres urządzenia albo --file')
+
+    formats = load_formats(opts.formats)
+    if opts.file:
+        with open(opts.file, 'rb') as f:
+            _, _, lines = decode(f.read(), formats)
+        print('\n'.join(lines))
+        return
+
+    since = None
+    while True:
+        since, _, lines = decode(fetch(opts.host, since, opts.timeout), formats)
+        if lines:
+            print('\n'.join(lines), flush=True)
+        if not opts.follow:
+            break
+        time.sleep(opts.interval)
+
+
+if __name__ == '__main__':
+    try:
+        main()
+    except KeyboardInterrupt:
+        sys.exit(0)
@@ -0,0 +1,87 @@
+#!/usr/bin/env python3
+# Przygotowanie obrazu i manifestu dla aktualizacji pobieranej przez
+# urządzenie (src/ota_pull.h).
+#
+# Kompresuje obraz firmware (gzip -9, bez znacznika czasu - ten sam obraz daje
+# te same bajty i tę samą sumę MD5), zapisuje go w katalogu wyjściowym razem
+# z manifest.json i opcjonalnie udostępnia katalog zwykłym serwerem HTTP.
+# Urządzenie dostaje adres manifestu w polu konfiguracji ota_url.
+# ESP32 nie rozpakowuje obrazu gzip - dla niego --no-gzip.
+#
+# Uruchomienie (tylko biblioteka standardowa):
+#   python3 host/ota_publish.py .pio/build/d1_mini/firmware.bin --base-url http://10.0.0.5:8000 --serve 8000
+#   python3 host/ota_publish.py .pio/build/esp32dev/firmware.bin --no-gzip --out ota32 --base-url http://10.0.0.5:8001/
+#   curl -X PUT -d '{"ota_url":"http://10.0.0.5:8000/manifest.json"}' http://hydrosense.local/config
+
+import argparse
+import functools
+import gzip
+import hashlib
+import http.server
+import json
+import os
+import re
+import sys
+
+DEFAULT_MAIN = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'src', 'main.cpp')
+VERSION_RE = re.compile(r'SOFTWARE_VERSION\s*=\s*"([^"]+)"')
+ESP_IMAGE_MAGIC = 0xE9
+
+
+def source_version(path):
+    with open(path, encoding='utf-8') as f:
+        m = VERSION_RE.search(f.read())
+    if not m:
+        sys.exit(f'Brak SOFTWARE_VERSION w {path}')
+    return m.group(1)
+
+
+def main():
+    p = argparse.ArgumentParser(description='Obraz i manifest dla aktualizacji pobieranej przez urządzenie')
+    p.add_argument('firmware', help='firmware.bin z katalogu .pio/build/<środowisko>')
+    p.add_argument('--out', default='ota', help='katalog wyjściowy (domyślnie ota/)')
+    p.add_argument('--version', help='wersja w manifeście (domyślnie SOFTWARE_VERSION z src/main.cpp)')
+    p.add_argument('--base-url', required=True, help='adres katalogu wyjściowego widziany przez urządzenie')
+    p.add_argument('--no-gzip', action='store_true', help='obraz bez kompresji (ESP32)')
+    p.add_argument('--serve', type=int, metavar='PORT', help='udostępnij katalog przez HTTP na tym porcie')
+    args = p.parse_args()
+
+    with open(args.firmware, 'rb') as f:
+        image = f.read()
+    if not image or image[0] != ESP_IMAGE_MAGIC:
+        sys.exit(f'{args.firmware}: to nie jest obraz aplikacji ESP (pierwszy bajt 0x{ESP_IMAGE_MAGIC:02X})')
+    version = args.version or source_version(DEFAULT_MAIN)
+
+    name = f'hydrosense-{version}.bin'
+    data = image
+    if not args.no_gzip:
+        name += '.gz'
+        data = gzip.compress(image, compresslevel=9, mtime=0)
+
+    os.makedirs(args.out, exist_ok=True)
+    with open(os.path.join(args.out, name), 'wb') as f:
+        f.write(data)
+    manifest = {
+        'version': version,
+        'url': args.base_url.rstrip('/') + '/' + name,
+        'size': len(data),
+        'md5': hashlib.md5(data).hexdigest(),
+    }
+    with open(os.path.join(args.out, 'manifest.json'), 'w') as f:
+        json.dump(manifest, f)
+    print(f'{name}: {len(image)} B -> {len(data)} B ({100.0 * len(data) / len(image):.0f}%), md5 {manifest["md5"]}')
+    print(f'manifest: {args.base_url.rstrip("/")}/manifest.json')
+
+    if args.serve:
+        # HTTP/1.0 i Content-Length - tak jak oczekuje urządzenie
+        handler = functools.partial(http.server.SimpleHTTPRequestHandler, directory=args.out)
+        with http.server.ThreadingHTTPServer(('', args.serve), handler) as httpd:
+            print(f'serwer HTTP na porcie {args.serve} (Ctrl+C kończy)')
+            try:
+                httpd.serve_forever()
+            except KeyboardInterrupt:
+                pass
+
+
+if __name__ == '__main__':
+    main()
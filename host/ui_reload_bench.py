@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+# Benchmark opóźnienia pętli głównej przy wielokrotnym przeładowaniu strony
+# konfiguracji (symulacja telefonu odświeżającego UI).
+#
+# Dla kolejnych liczb równoległych klientów: zeruje statystyki pętli
+# (GET /loop?reset=1), przez zadany czas pobiera w kółko GET /, po czym
+# odczytuje GET /loop. Wynik to tabela Markdown z najgorszym i 99. percentylem
+# czasu iteracji loop() oraz czasem pobrania strony.
+#
+# Uruchomienie (tylko biblioteka standardowa):
+#   python3 host/ui_reload_bench.py 192.168.1.50
+#   python3 host/ui_reload_bench.py hydrosense.local --clients 1,2,3,4 --seconds 20
+
+import argparse
+import json
+import threading
+import time
+import urllib.request
+
+
+def fetch(url, timeout):
+    with urllib.request.urlopen(url, timeout=timeout) as r:
+        return r.read()
+
+
+def reload_worker(url, deadline, timeout, results):
+    while time.monotonic() < deadline:
+        t0 = time.monotonic()
+        try:
+            body = fetch(url, timeout)
+            results.append(("ok", time.monotonic() - t0, len(body)))
+        except Exception as e:  # 503 przy braku wolnego miejsca w puli, timeouty
+            results.append((type(e).__name__, time.monotonic() - t0, 0))
+
+
+def run(host, clients, seconds, timeout):
+    base = "http://%s" % host
+    fetch(base + "/loop?reset=1", timeout)
+    results = []
+    deadline = time.monotonic() + seconds
+    threads = [threading.Thread(target=reload_worker, args=(base + "/", deadline, timeout, results))
+               for _ in range(clients)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    stats = json.loads(fetch(base + "/loop", timeout))
+    ok = [r for r in results if r[0] == "ok"]
+    failed = len(results) - len(ok)
+    page_ms = 1000.0 * sum(r[1] for r in ok) / len(ok) if ok else 0.0
+    page_kb = ok[0][2] / 1024.0 if ok else 0.0
+    return stats, len(ok), failed, page_ms, page_kb
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__)
+    ap.add_argument("host")
+    ap.add_argument("--clients", default="1,2,3")
+    ap.add_argument("--seconds", type=float, default=15.0)
+    ap.add_argument("--timeout", type=float, default=10.0)
+    args = ap.parse_args()
+
+    print("| klienci | przeładowania | błędy | strona [KB] | pobranie [ms] | loop max [us] | loop p99 [us] | iteracje |")
+    print("|---|---|---|---|---|---|---|---|")
+    for n in [int(c) for c in args.clients.split(",")]:
+        stats, ok, failed, page_ms, page_kb = run(args.host, n, args.seconds, args.timeout)
+        p99 = stats["p99_us"]
+        p99 = ">%d" % (1 << (7 + len(stats["hist"]) - 2)) if p99 >= 0xFFFFFFFF else str(p99)
+        print("| %d | %d | %d | %.1f | %.0f | %d | %s | %d |" %
+              (n, ok, failed, page_kb, page_ms, stats["max_us"], p99, stats["count"]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,120 @@
+#include "boot_timeline.h"
+#include <stddef.h>
+#include <string.h>
+#include "rtc_store.h"
+#ifdef ARDUINO
+#include "globals.h"
+#include "strbuf.h"
+#endif
+
+static_assert(RTC_BLOCK_BOOT_TIMELINE + RTC_BLOCKS(BootTimeline) <= RTC_BLOCK_FREE, "Oś czasu startu nie mieści się w przydziale RTC");
+
+void bootTimelineBegin(BootTimeline& t, uint32_t bootCount, uint8_t resetReason) {
+    memset(&t, 0, sizeof(t));
+    t.magic = BOOT_TIMELINE_MAGIC;
+    t.bootCount = bootCount;
+    t.resetReason = resetReason;
+    bootTimelineSeal(t);
+}
+
+bool bootTimelineMark(BootTimeline& t, BootStage stage, uint32_t atUs) {
+    if (stage >= BOOT_STAGE_COUNT || t.count >= BOOT_STAGE_COUNT) return false;
+    if (bootTimelineAt(t, stage) != 0) return false;
+    t.marks[t.count].stage = stage;
+    t.marks[t.count].atUs = atUs ? atUs : 1;  // 0 oznacza "brak etapu"
+    t.count++;
+    bootTimelineSeal(t);
+    return true;
+}
+
+uint32_t bootTimelineAt(const BootTimeline& t, BootStage stage) {
+    for (uint8_t i = 0; i < t.count && i < BOOT_STAGE_COUNT; ++i) {
+        if (t.marks[i].stage == stage) return t.marks[i].atUs;
+    }
+    return 0;
+}
+
+void bootTimelineSeal(BootTimeline& t) {
+    t.checksum = rtcChecksum(&t, offsetof(BootTimeline, checksum));
+}
+
+bool bootTimelineValid(const BootTimeline& t) {
+    return t.magic == BOOT_TIMELINE_MAGIC && t.count <= BOOT_STAGE_COUNT &&
+           t.checksum == rtcChecksum(&t, offsetof(BootTimeline, checksum));
+}
+
+const char* bootStageName(BootStage stage) {
+    switch (stage) {
+        case BOOT_PINS: return "pins";
+        case BOOT_CONFIG: return "config";
+        case BOOT_FIRST_MEASUREMENT: return "first_measurement";
+        case BOOT_PUMP_ARMED: return "pump_armed";
+        case BOOT_WIFI_STARTED: return "wifi_started";
+        case BOOT_WEB_SERVER: return "web_server";
+        case BOOT_HA: return "ha";
+        case BOOT_OTA: return "ota";
+        case BOOT_WIFI_CONNECTED: return "wifi_connected";
+        case BOOT_MQTT_CONNECTED: return "mqtt_connected";
+        default: return "?";
+    }
+}
+
+#ifdef ARDUINO
+static BootTimeline s_current;
+static BootTimeline s_previous;
+static bool s_hasPrevious = false;
+
+// Odczyt osi poprzedniego startu z RTC i rozpoczęcie bieżącej
+void bootRecorderInit() {
+    rtcRead(RTC_BLOCK_BOOT_TIMELINE, &s_previous, sizeof(s_previous));
+    s_hasPrevious = bootTimelineValid(s_previous);
+    uint32_t bootCount = s_hasPrevious ? s_previous.bootCount + 1 : 1;
+    bootTimelineBegin(s_current, bootCount, platformResetReason());
+    rtcWrite(RTC_BLOCK_BOOT_TIMELINE, &s_current, sizeof(s_current));
+}
+
+void bootMark(BootStage stage) {
+    if (!bootTimelineMark(s_current, stage, micros())) return;
+    rtcWrite(RTC_BLOCK_BOOT_TIMELINE, &s_current, sizeof(s_current));
+    DEBUG_PRINTF("Start: %s po %lu us\n", bootStageName(stage), (unsigned long)bootTimelineAt(s_current, stage));
+}
+
+bool bootReached(BootStage stage) {
+    return bootTimelineAt(s_current, stage) != 0;
+}
+
+const BootTimeline& bootCurrent() {
+    return s_current;
+}
+
+static void appendTimeline(StrBuf& sb, const BootTimeline& t) {
+    sbAppend(sb, "{\"boot\":");
+    sbAppendUInt(sb, t.bootCount);
+    sbAppend(sb, ",\"reset_reason\":");
+    sbAppendUInt(sb, t.resetReason);
+    sbAppend(sb, ",\"stages_us\":{");
+    for (uint8_t i = 0; i < t.count; ++i) {
+        if (i) sbAppendChar(sb, ',');
+        sbAppendChar(sb, '"');
+        sbAppend(sb, bootStageName((BootStage)t.marks[i].stage));
+        sbAppend(sb, "\":");
+        sbAppendUInt(sb, t.marks[i].atUs);
+    }
+    sbAppend(sb, "}}");
+}
+
+// GET /boot - oś czasu bieżącego i poprzedniego startu
+void handleBootTimeline() {
+    static char out[768];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    sbAppend(sb, "{\"armed_target_us\":");
+    sbAppendUInt(sb, BOOT_ARMED_TARGET_US);
+    sbAppend(sb, ",\"current\":");
+    appendTimeline(sb, s_current);
+    sbAppend(sb, ",\"previous\":");
+    if (s_hasPrevious) appendTimeline(sb, s_previous); else sbAppend(sb, "null");
+    sbAppendChar(sb, '}');
+    server.send(200, "application/json", out);
+}
+#endif
@@ -0,0 +1,60 @@
+#ifndef BOOT_TIMELINE_H
+#define BOOT_TIMELINE_H
+
+#include <stdint.h>
+
+// Oś czasu startu: chwila (µs od resetu) zakończenia każdego etapu. Bieżąca
+// oś jest zapisywana w pamięci RTC po każdym etapie, więc po resecie
+// (także w trakcie startu) dostępna jest oś poprzedniego uruchomienia.
+
+enum BootStage : uint8_t {
+    BOOT_PINS,                // GPIO w stanie bezpiecznym (pompa wyłączona)
+    BOOT_CONFIG,              // Konfiguracja wczytana
+    BOOT_FIRST_MEASUREMENT,   // Pierwszy pomiar poziomu
+    BOOT_PUMP_ARMED,          // Maszyna stanów pompy działa na aktualnych danych
+    BOOT_WIFI_STARTED,        // Łączenie WiFi rozpoczęte (w tle)
+    BOOT_WEB_SERVER,
+    BOOT_HA,                  // Encje HA skonfigurowane, MQTT rozpoczęte
+    BOOT_OTA,
+    BOOT_WIFI_CONNECTED,
+    BOOT_MQTT_CONNECTED,
+    BOOT_STAGE_COUNT
+};
+
+const uint32_t BOOT_TIMELINE_MAGIC = 0x48534254UL;  // "HSBT"
+const uint32_t BOOT_ARMED_TARGET_US = 200000UL;     // Cel: pompa uzbrojona do 200 ms od resetu
+
+struct BootStageMark {
+    uint8_t stage;
+    uint8_t reserved[3];
+    uint32_t atUs;
+};
+
+struct BootTimeline {
+    uint32_t magic;
+    uint32_t bootCount;
+    uint8_t count;
+    uint8_t resetReason;
+    uint16_t reserved;
+    BootStageMark marks[BOOT_STAGE_COUNT];
+    uint32_t checksum;
+};
+
+void bootTimelineBegin(BootTimeline& t, uint32_t bootCount, uint8_t resetReason);
+// Zapisuje etap (każdy tylko raz); false gdy już był
+bool bootTimelineMark(BootTimeline& t, BootStage stage, uint32_t atUs);
+// Chwila zakończenia etapu [µs] albo 0, gdy etap nie został osiągnięty
+uint32_t bootTimelineAt(const BootTimeline& t, BootStage stage);
+void bootTimelineSeal(BootTimeline& t);
+bool bootTimelineValid(const BootTimeline& t);
+const char* bootStageName(BootStage stage);
+
+#ifdef ARDUINO
+void bootRecorderInit();
+void bootMark(BootStage stage);
+bool bootReached(BootStage stage);
+const BootTimeline& bootCurrent();
+void handleBootTimeline();
+#endif
+
+#endif // BOOT_TIMELINE_H
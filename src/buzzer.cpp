@@ -0,0 +1,88 @@
+#include "buzzer.h"
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "globals.h"
+#include "pins.h"
+#include "mono_clock.h"
+#else
+#define PROGMEM
+#define pgm_read_word(addr) (*(const uint16_t*)(addr))
+#endif
+
+bool buzzerStart(BuzzerSeq& seq, const BuzzerStep* steps, uint8_t priority) {
+    if (seq.active && priority < seq.priority) return false;
+    seq.steps = steps;
+    seq.priority = priority;
+    seq.index = 0;
+    seq.active = true;
+    seq.stepEndsAt = 0;     // Pierwszy krok przy najbliższym wywołaniu buzzerTick
+    return true;
+}
+
+// Stały koszt, gdy krok trwa; odczyt PROGMEM tylko na granicy kroków
+BuzzerOutput buzzerTick(BuzzerSeq& seq, uint64_t nowMs) {
+    BuzzerOutput out = { false, 0 };
+    if (!seq.active || nowMs < seq.stepEndsAt) return out;
+
+    const BuzzerStep* step = seq.steps + seq.index;
+    uint16_t freq = pgm_read_word(&step->freq);
+    uint16_t ms = pgm_read_word(&step->ms);
+    if (ms == 0) {
+        seq.active = false;
+        freq = 0;
+    } else {
+        seq.index++;
+        seq.stepEndsAt = nowMs + ms;
+    }
+    if (freq != seq.outputFreq) {
+        seq.outputFreq = freq;
+        out.change = true;
+        out.freq = freq;
+    }
+    return out;
+}
+
+#ifdef ARDUINO
+// Wzorce dźwięków: {częstotliwość, czas}, {0, 0} kończy wzorzec
+static const BuzzerStep CONFIRM_STEPS[] PROGMEM = { {2000, 200}, {0, 0} };
+static const BuzzerStep WARNING_STEPS[] PROGMEM = { {2000, 100}, {0, 0} };
+static const BuzzerStep WELCOME_STEPS[] PROGMEM = {
+    {1397, 100}, {0, 50},   // F6
+    {1568, 100}, {0, 50},   // G6
+    {1760, 150}, {0, 0},    // A6
+};
+static const BuzzerStep DRY_RUN_STEPS[] PROGMEM = {
+    {2800, 120}, {0, 80}, {2800, 120}, {0, 80}, {2800, 120}, {0, 400},
+    {2800, 120}, {0, 80}, {2800, 120}, {0, 80}, {2800, 120}, {0, 0},
+};
+static const BuzzerStep PUMP_ALARM_STEPS[] PROGMEM = {
+    {1800, 500}, {0, 150}, {2400, 150}, {0, 400},
+    {1800, 500}, {0, 150}, {2400, 150}, {0, 0},
+};
+
+struct BuzzerSoundDef {
+    const BuzzerStep* steps;
+    uint8_t priority;
+};
+
+static const BuzzerSoundDef SOUNDS[SOUND_COUNT] = {
+    { CONFIRM_STEPS, BUZZ_PRIO_INFO },
+    { WARNING_STEPS, BUZZ_PRIO_WARNING },
+    { WELCOME_STEPS, BUZZ_PRIO_INFO },
+    { DRY_RUN_STEPS, BUZZ_PRIO_ALARM },
+    { PUMP_ALARM_STEPS, BUZZ_PRIO_ALARM },
+};
+
+static BuzzerSeq buzzer = {};
+
+bool buzzerPlay(BuzzerSound sound) {
+    if (!config.soundEnabled || sound >= SOUND_COUNT) return false;
+    return buzzerStart(buzzer, SOUNDS[sound].steps, SOUNDS[sound].priority);
+}
+
+void buzzerTask() {
+    BuzzerOutput out = buzzerTick(buzzer, millis64());
+    if (!out.change) return;
+    if (out.freq) tone(BUZZER_PIN, out.freq); else noTone(BUZZER_PIN);
+}
+#endif
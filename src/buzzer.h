@@ -0,0 +1,54 @@
+#ifndef BUZZER_H
+#define BUZZER_H
+
+#include <stdint.h>
+
+// Sekwencer dźwięków buzzera. Wzorce (nuta/pauza) leżą w PROGMEM, a kolejne
+// kroki przełącza buzzerTask() z pętli głównej - bez delay(). Wzorzec o
+// wyższym priorytecie przerywa bieżący, niższy jest odrzucany.
+
+struct BuzzerStep {
+    uint16_t freq;      // Hz, 0 = pauza
+    uint16_t ms;        // Czas kroku, 0 = koniec wzorca
+};
+
+enum BuzzerPriority : uint8_t {
+    BUZZ_PRIO_INFO = 1,         // Potwierdzenia, powitanie
+    BUZZ_PRIO_WARNING = 2,      // Cykliczne przypomnienie o alarmie / serwisie
+    BUZZ_PRIO_ALARM = 3,        // Nowy alarm pompy
+};
+
+struct BuzzerSeq {
+    const BuzzerStep* steps;    // Wzorzec w PROGMEM
+    uint8_t priority;
+    uint8_t index;              // Następny krok do odtworzenia
+    bool active;
+    uint64_t stepEndsAt;
+    uint16_t outputFreq;        // Aktualnie grana częstotliwość (0 = cisza)
+};
+
+// Zmiana wyjścia do wykonania przez warstwę sprzętową
+struct BuzzerOutput {
+    bool change;
+    uint16_t freq;              // 0 = wyłącz
+};
+
+bool buzzerStart(BuzzerSeq& seq, const BuzzerStep* steps, uint8_t priority);
+BuzzerOutput buzzerTick(BuzzerSeq& seq, uint64_t nowMs);
+
+enum BuzzerSound : uint8_t {
+    SOUND_CONFIRM,
+    SOUND_WARNING,
+    SOUND_WELCOME,
+    SOUND_ALARM_DRY_RUN,        // Brak wody w zbiorniku
+    SOUND_ALARM_PUMP,           // Przekroczony czas pracy / pompa nie tłoczy wody
+    SOUND_COUNT
+};
+
+#ifdef ARDUINO
+// Odtwarza dźwięk (gdy dźwięk włączony w konfiguracji); false gdy gra ważniejszy
+bool buzzerPlay(BuzzerSound sound);
+void buzzerTask();
+#endif
+
+#endif // BUZZER_H
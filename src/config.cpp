@@ -1,40 +1,66 @@
 #include "config.h"
+#include "config_schema.h"
+#include "wifi_cache.h"
 #ifdef ARDUINO
 #include <EEPROM.h>
+#include "loop_watchdog.h"
+#include "platform.h"
+#define CONFIG_EEPROM 1
+#elif defined(FLASH_SIM)
+// Emulacja flash na komputerze (host/flash_wear.cpp) - ten sam kod zapisu
+#include "flash_sim.h"
+#define CONFIG_EEPROM 1
 #endif
 
 Config config;
 
-#ifdef ARDUINO
-// EEPROM layout helpers for config and network creds
-const size_t CFG_SLOT_METADATA = sizeof(uint32_t);
-const size_t CFG_SLOT_SIZE = CFG_SLOT_METADATA + sizeof(Config);
-const int CFG_SLOTS = 2;
+#ifdef CONFIG_EEPROM
+// Układ EEPROM (stałe adresy, niezależne od sizeof(Config)):
+//   0..279     dwa sloty w starym formacie: seq(4) + Config(136) - tylko odczyt przy migracji
+//   280..376   dane WiFi (SSID, hasło, suma kontrolna) - adres jak w starszych wersjach
+//   384..411   ostatni punkt dostępowy i dzierżawa IP (WifiCache, własna suma kontrolna)
+//   512..1023  dwa sloty: seq(4) + len(2) + dane(len) + suma(1); pojemność 256 B na slot
+const size_t LEGACY_SLOT_SIZE = sizeof(uint32_t) + 136;
+const size_t LEGACY_DATA_LEN = 132;                 // offsetof(checksum) w starym układzie
 const size_t WIFI_SSID_MAX = 32;
 const size_t WIFI_PASS_MAX = 64;
-const size_t NETWORK_BASE = CFG_SLOT_SIZE * CFG_SLOTS;
+const size_t NETWORK_BASE = LEGACY_SLOT_SIZE * 2;
+const size_t WIFI_CACHE_BASE = 384;
+const size_t CFG_BASE = 512;
+const size_t CFG_SLOT_HEADER = sizeof(uint32_t) + sizeof(uint16_t);
+const size_t CFG_SLOT_CAPACITY = 256;
+const int CFG_SLOTS = 2;
+const size_t EEPROM_SIZE = CFG_BASE + CFG_SLOT_CAPACITY * CFG_SLOTS;
+
+static_assert(CFG_SLOT_HEADER + offsetof(Config, checksum) + 1 <= CFG_SLOT_CAPACITY, "Config nie mieści się w slocie EEPROM");
+static_assert(NETWORK_BASE + WIFI_SSID_MAX + WIFI_PASS_MAX + 1 <= WIFI_CACHE_BASE, "Dane WiFi nachodzą na wpis punktu dostępowego");
+static_assert(WIFI_CACHE_BASE + sizeof(WifiCache) <= CFG_BASE, "Wpis punktu dostępowego nachodzi na sloty konfiguracji");
 #endif
 
+// Wartości domyślne bez zapisu (używane też przy migracji starszych zapisów)
+void fillDefaultConfig(Config& cfg) {
+    memset(&cfg, 0, sizeof(Config));
+    cfg.version = 1;
+    configFillDefaults(cfg);  // Wartości domyślne z tabeli pól (config_schema.cpp)
+    cfg.checksum = calculateChecksum(cfg);
+}
+
+void applyConfigPrefix(Config& cfg, const uint8_t* data, size_t len) {
+    fillDefaultConfig(cfg);
+    if (len > offsetof(Config, checksum)) len = offsetof(Config, checksum);
+    memcpy(&cfg, data, len);
+    cfg.checksum = calculateChecksum(cfg);
+}
+
 void setDefaultConfig() {
-    config.soundEnabled = true;
-    strlcpy(config.mqtt_server, "", sizeof(config.mqtt_server));
-    config.mqtt_port = 1883;
-    strlcpy(config.mqtt_user, "", sizeof(config.mqtt_user));
-    strlcpy(config.mqtt_password, "", sizeof(config.mqtt_password));
-    config.tank_full = 50;
-    config.tank_empty = 1050;
-    config.reserve_level = 550;
-    config.tank_diameter = 100;
-    config.pump_delay = 5;
-    config.pump_work_time = 30;
-    config.checksum = calculateChecksum(config);
+    fillDefaultConfig(config);
     saveConfig();
 }
 
 bool loadNetworkCredentials(char* ssidOut, size_t ssidSize, char* passOut, size_t passSize) {
-#ifdef ARDUINO
+#ifdef CONFIG_EEPROM
     if (!ssidOut || !passOut) return false;
-    EEPROM.begin(NETWORK_BASE + WIFI_SSID_MAX + WIFI_PASS_MAX + 8);
+    EEPROM.begin(EEPROM_SIZE);
     uint8_t bufSSID[WIFI_SSID_MAX];
     uint8_t bufPASS[WIFI_PASS_MAX];
     for (size_t i = 0; i < WIFI_SSID_MAX; ++i) bufSSID[i] = EEPROM.read(NETWORK_BASE + i);
@@ -61,8 +87,8 @@ bool loadNetworkCredentials(char* ssidOut, size_t ssidSize, char* passOut, size_
 }
 
 void saveNetworkCredentials(const char* ssid, const char* pass) {
-#ifdef ARDUINO
-    EEPROM.begin(NETWORK_BASE + WIFI_SSID_MAX + WIFI_PASS_MAX + 8);
+#ifdef CONFIG_EEPROM
+    EEPROM.begin(EEPROM_SIZE);
     uint8_t bufSSID[WIFI_SSID_MAX];
     uint8_t bufPASS[WIFI_PASS_MAX];
     memset(bufSSID, 0, WIFI_SSID_MAX);
@@ -75,50 +101,138 @@ void saveNetworkCredentials(const char* ssid, const char* pass) {
     for (size_t i = 0; i < WIFI_SSID_MAX; ++i) checksum ^= bufSSID[i];
     for (size_t i = 0; i < WIFI_PASS_MAX; ++i) checksum ^= bufPASS[i];
     EEPROM.write(NETWORK_BASE + WIFI_SSID_MAX + WIFI_PASS_MAX, checksum);
-    ESP.wdtFeed();
+    platformWatchdogFeed();
+    LoopStage prev = loopStage(LS_EEPROM_COMMIT);
     EEPROM.commit();
+    loopStage(prev);
     EEPROM.end();
 #else
     (void)ssid; (void)pass;
 #endif
 }
 
-bool loadConfig() {
-#ifdef ARDUINO
-    // Simple 2-slot wear-leveling: each slot contains a uint32_t seq + Config
-    const size_t SLOT_METADATA = sizeof(uint32_t);
-    const size_t SLOT_SIZE = SLOT_METADATA + sizeof(Config);
-    const int SLOTS = 2;
-    EEPROM.begin(SLOT_SIZE * SLOTS + 8);
+bool loadWifiCache(WifiCache& out) {
+#ifdef CONFIG_EEPROM
+    EEPROM.begin(EEPROM_SIZE);
+    EEPROM.get(WIFI_CACHE_BASE, out);
+    EEPROM.end();
+    return true;  // Poprawność (suma kontrolna, SSID) sprawdza wifiCacheValid()
+#else
+    (void)out;
+    return false;
+#endif
+}
+
+void saveWifiCache(const WifiCache& c) {
+#ifdef CONFIG_EEPROM
+    EEPROM.begin(EEPROM_SIZE);
+    WifiCache stored;
+    EEPROM.get(WIFI_CACHE_BASE, stored);
+    if (memcmp(&stored, &c, sizeof(c)) != 0) {
+        EEPROM.put(WIFI_CACHE_BASE, c);
+        LoopStage prev = loopStage(LS_EEPROM_COMMIT);
+        EEPROM.commit();
+        loopStage(prev);
+    }
+    EEPROM.end();
+#else
+    (void)c;
+#endif
+}
+
+#ifdef CONFIG_EEPROM
+static void readBytes(size_t addr, uint8_t* out, size_t len) {
+    for (size_t i = 0; i < len; ++i) out[i] = EEPROM.read(addr + i);
+}
 
+static uint8_t xorBytes(const uint8_t* p, size_t len) {
+    uint8_t sum = 0;
+    for (size_t i = 0; i < len; ++i) sum ^= p[i];
+    return sum;
+}
+
+// Slot zawiera dokładnie te dane (długość, bajty, suma kontrolna)
+static bool slotHolds(size_t base, const uint8_t* data, uint16_t len) {
+    uint16_t stored = 0;
+    readBytes(base + sizeof(uint32_t), (uint8_t*)&stored, sizeof(stored));
+    if (stored != len) return false;
+    for (size_t i = 0; i < len; ++i) {
+        if (EEPROM.read(base + CFG_SLOT_HEADER + i) != data[i]) return false;
+    }
+    return EEPROM.read(base + CFG_SLOT_HEADER + len) == xorBytes(data, len);
+}
+
+// Długość danych poprawnego slotu w bieżącym formacie (0: pusty lub uszkodzony)
+static uint16_t readSlot(int s, uint8_t* data, uint32_t& seq) {
+    size_t base = CFG_BASE + s * CFG_SLOT_CAPACITY;
+    uint16_t len = 0;
+    readBytes(base, (uint8_t*)&seq, sizeof(seq));
+    readBytes(base + sizeof(seq), (uint8_t*)&len, sizeof(len));
+    if (len == 0 || len > CFG_SLOT_CAPACITY - CFG_SLOT_HEADER - 1) return 0;
+    readBytes(base + CFG_SLOT_HEADER, data, len + 1);
+    return xorBytes(data, len) == data[len] ? len : 0;
+}
+
+// Slot, który wczytuje loadConfig() (-1: brak poprawnego)
+static int newestSlot() {
+    static uint8_t data[CFG_SLOT_CAPACITY];
     uint32_t bestSeq = 0;
-    Config bestCfg;
-    bool found = false;
+    int best = -1;
+    for (int s = 0; s < CFG_SLOTS; ++s) {
+        uint32_t seq = 0;
+        if (!readSlot(s, data, seq)) continue;
+        if (best < 0 || seq > bestSeq) {
+            bestSeq = seq;
+            best = s;
+        }
+    }
+    return best;
+}
 
-    for (int s = 0; s < SLOTS; ++s) {
-        size_t base = s * SLOT_SIZE;
+// Najnowszy poprawny slot w bieżącym formacie
+static bool loadCurrentSlots(Config& out) {
+    static uint8_t data[CFG_SLOT_CAPACITY];
+    int s = newestSlot();
+    if (s < 0) return false;
+    uint32_t seq = 0;
+    applyConfigPrefix(out, data, readSlot(s, data, seq));
+    return true;
+}
+
+// Sloty zapisane przez wersje sprzed stałego układu EEPROM
+static bool loadLegacySlots(Config& out) {
+    static uint8_t data[LEGACY_DATA_LEN + 1];
+    uint32_t bestSeq = 0;
+    bool found = false;
+    for (int s = 0; s < 2; ++s) {
+        size_t base = s * LEGACY_SLOT_SIZE;
         uint32_t seq = 0;
-        uint8_t *seqP = (uint8_t*)&seq;
-        for (size_t i = 0; i < SLOT_METADATA; ++i) seqP[i] = EEPROM.read(base + i);
-
-        Config tempConfig;
-        uint8_t *p = (uint8_t*)&tempConfig;
-        for (size_t i = 0; i < sizeof(Config); i++) p[i] = EEPROM.read(base + SLOT_METADATA + i);
-
-        char calculatedChecksum = calculateChecksum(tempConfig);
-        if (calculatedChecksum == tempConfig.checksum) {
-            if (!found || seq > bestSeq) {
-                bestSeq = seq;
-                memcpy(&bestCfg, &tempConfig, sizeof(Config));
-                found = true;
-            }
+        readBytes(base, (uint8_t*)&seq, sizeof(seq));
+        readBytes(base + sizeof(seq), data, sizeof(data));
+        if (xorBytes(data, LEGACY_DATA_LEN) != data[LEGACY_DATA_LEN]) continue;
+        if (!found || seq > bestSeq) {
+            bestSeq = seq;
+            applyConfigPrefix(out, data, LEGACY_DATA_LEN);
+            found = true;
         }
     }
+    return found;
+}
+#endif
 
+bool loadConfig() {
+#ifdef CONFIG_EEPROM
+    // 2-slot wear-leveling; slot: seq, długość danych, dane i suma kontrolna
+    EEPROM.begin(EEPROM_SIZE);
+    static Config loaded;
+    bool found = loadCurrentSlots(loaded);
+    bool migrated = false;
+    if (!found) found = migrated = loadLegacySlots(loaded);
     EEPROM.end();
 
     if (found) {
-        memcpy(&config, &bestCfg, sizeof(Config));
+        memcpy(&config, &loaded, sizeof(Config));
+        if (migrated) saveConfig();  // przeniesienie do nowego układu (stare sloty zostają nietknięte)
         return true;
     } else {
         setDefaultConfig();
@@ -132,38 +246,43 @@ bool loadConfig() {
 }
 
 void saveConfig() {
-#ifdef ARDUINO
+#ifdef CONFIG_EEPROM
     // Write atomically to rotating slot (2-slot wear-leveling)
-    const size_t SLOT_METADATA = sizeof(uint32_t);
-    const size_t SLOT_SIZE = SLOT_METADATA + sizeof(Config);
-    const int SLOTS = 2;
-    EEPROM.begin(SLOT_SIZE * SLOTS + 8);
+    EEPROM.begin(EEPROM_SIZE);
 
     // Read current seq values
-    uint32_t seqs[SLOTS] = {0};
-    for (int s = 0; s < SLOTS; ++s) {
-        size_t base = s * SLOT_SIZE;
-        uint32_t seq = 0;
-        uint8_t *seqP = (uint8_t*)&seq;
-        for (size_t i = 0; i < SLOT_METADATA; ++i) seqP[i] = EEPROM.read(base + i);
-        seqs[s] = seq;
-    }
+    uint32_t seqs[CFG_SLOTS] = {0};
+    for (int s = 0; s < CFG_SLOTS; ++s) readBytes(CFG_BASE + s * CFG_SLOT_CAPACITY, (uint8_t*)&seqs[s], sizeof(uint32_t));
 
     int target = (seqs[0] <= seqs[1]) ? 0 : 1; // write to the older slot (or slot 0 if equal)
     uint32_t nextSeq = (seqs[target] == 0xFFFFFFFF) ? 1 : seqs[target] + 1;
 
     config.checksum = calculateChecksum(config);
-    size_t base = target * SLOT_SIZE;
+    const uint16_t len = offsetof(Config, checksum);
+    size_t base = CFG_BASE + target * CFG_SLOT_CAPACITY;
+
+    // Najnowszy slot zawiera już te dane (np. ponowione polecenie z HA) - bez
+    // kasowania sektora; sam nowy seq zużyłby flash tak jak zmiana ustawień
+    int newest = newestSlot();
+    if (newest >= 0 && slotHolds(CFG_BASE + newest * CFG_SLOT_CAPACITY, (const uint8_t*)&config, len)) {
+        EEPROM.end();
+        return;
+    }
 
     noInterrupts();
-    // write seq
-    uint8_t *seqP = (uint8_t*)&nextSeq;
-    for (size_t i = 0; i < SLOT_METADATA; ++i) EEPROM.write(base + i, seqP[i]);
-    // write config
-    uint8_t *p = (uint8_t*)&config;
-    for (size_t i = 0; i < sizeof(Config); ++i) EEPROM.write(base + SLOT_METADATA + i, p[i]);
-    ESP.wdtFeed();
+    // write seq + data length
+    const uint8_t *seqP = (const uint8_t*)&nextSeq;
+    for (size_t i = 0; i < sizeof(nextSeq); ++i) EEPROM.write(base + i, seqP[i]);
+    const uint8_t *lenP = (const uint8_t*)&len;
+    for (size_t i = 0; i < sizeof(len); ++i) EEPROM.write(base + sizeof(nextSeq) + i, lenP[i]);
+    // write config prefix + checksum
+    const uint8_t *p = (const uint8_t*)&config;
+    for (size_t i = 0; i < len; ++i) EEPROM.write(base + CFG_SLOT_HEADER + i, p[i]);
+    EEPROM.write(base + CFG_SLOT_HEADER + len, (uint8_t)config.checksum);
+    platformWatchdogFeed();
+    LoopStage prev = loopStage(LS_EEPROM_COMMIT);
     EEPROM.commit();
+    loopStage(prev);
     interrupts();
     EEPROM.end();
 #else
@@ -1,7 +1,12 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef ARDUINO
 #include <Arduino.h>
+#endif
 
 struct Config {
     uint8_t version;
@@ -16,17 +21,38 @@ struct Config {
     int tank_diameter;
     int pump_delay;
     int pump_work_time;
+    // Nowe pola dopisywać wyłącznie tutaj (przed checksum) - starsze zapisy
+    // wczytują się jako prefiks, a brakujące pola dostają wartości domyślne
+    int flow_check_window;      // Okno kontroli przepływu pompy [s] (0 = wyłączone)
+    int flow_min_drawdown;      // Minimalny spadek poziomu w oknie [mm]
+    int loop_stall_ms;          // Próg zawieszenia iteracji loop() [ms]
+    int leak_limit;             // Próg alarmu wycieku - ubytek w postoju pompy [mm/dobę] (0 = wyłączony)
+    int leak_window;            // Okno oceny ubytku [h]
+    bool mqtt_json_state;       // Stany HA jednym dokumentem JSON zamiast tematu na sensor
+    int log_level;              // Najniższy poziom zapisywany w dzienniku (log_ring.h; 4 = wyłączony)
+    uint32_t remote_rev_fleet;  // Ostatni zastosowany dokument zdalny (remote_config.h) - poza tabelą pól
+    uint32_t remote_rev_device;
+    char ota_url[64];           // Manifest aktualizacji pobieranej przez urządzenie (ota_pull.h; pusty = wyłączone)
+    int ota_interval;           // Sprawdzanie manifestu co [h] (0 = tylko na polecenie)
+    int ota_stagger;            // Okno losowego opóźnienia sprawdzenia [min]
     char checksum;
 };
 
 extern Config config;
 
+void fillDefaultConfig(Config& cfg);
 void setDefaultConfig();
+// Wczytuje prefiks danych konfiguracji zapisany przez starszą wersję (len <= offsetof(checksum))
+void applyConfigPrefix(Config& cfg, const uint8_t* data, size_t len);
 bool loadConfig();
 void saveConfig();
 char calculateChecksum(const Config& cfg);
 // Network credentials helpers (stored separately from main Config)
 bool loadNetworkCredentials(char* ssidOut, size_t ssidSize, char* passOut, size_t passSize);
 void saveNetworkCredentials(const char* ssid, const char* pass);
+// Ostatni punkt dostępowy (wifi_cache.h) - zapis do flash tylko gdy wpis się zmienił
+struct WifiCache;
+bool loadWifiCache(WifiCache& out);
+void saveWifiCache(const WifiCache& c);
 
 #endif // CONFIG_H
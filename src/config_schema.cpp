@@ -0,0 +1,320 @@
+#include "config_schema.h"
+#include "json_flat.h"
+#include <string.h>
+#include <stdlib.h>
+
+#define CFG_FIELD(key, member, type, flags, minV, maxV, def) \
+    { key, type, flags, (uint16_t)offsetof(Config, member), (uint16_t)sizeof(((Config*)0)->member), minV, maxV, def }
+
+const ConfigField CONFIG_FIELDS[] = {
+    CFG_FIELD("sound_enabled",     soundEnabled,      CFT_BOOL, 0,                     0, 1,     1),
+    CFG_FIELD("mqtt_server",       mqtt_server,       CFT_STR,  CFF_MQTT,              0, 0,     0),
+    CFG_FIELD("mqtt_port",         mqtt_port,         CFT_U16,  CFF_MQTT,              1, 65535, 1883),
+    CFG_FIELD("mqtt_user",         mqtt_user,         CFT_STR,  CFF_MQTT,              0, 0,     0),
+    CFG_FIELD("mqtt_password",     mqtt_password,     CFT_STR,  CFF_MQTT | CFF_SECRET, 0, 0,     0),
+    CFG_FIELD("tank_full",         tank_full,         CFT_INT,  0,                     0, 5000,  50),
+    CFG_FIELD("tank_empty",        tank_empty,        CFT_INT,  0,                     0, 5000,  1050),
+    CFG_FIELD("reserve_level",     reserve_level,     CFT_INT,  0,                     0, 5000,  550),
+    CFG_FIELD("tank_diameter",     tank_diameter,     CFT_INT,  0,                     1, 10000, 100),
+    CFG_FIELD("pump_delay",        pump_delay,        CFT_INT,  0,                     0, 3600,  5),
+    CFG_FIELD("pump_work_time",    pump_work_time,    CFT_INT,  0,                     1, 3600,  30),
+    CFG_FIELD("flow_check_window", flow_check_window, CFT_INT,  0,                     0, 3600,  15),
+    CFG_FIELD("flow_min_drawdown", flow_min_drawdown, CFT_INT,  0,                     0, 1000,  2),
+    CFG_FIELD("loop_stall_ms",     loop_stall_ms,     CFT_INT,  0,                     50, 7000, 500),
+    CFG_FIELD("leak_limit",        leak_limit,        CFT_INT,  0,                     0, 1000,  10),
+    CFG_FIELD("leak_window",       leak_window,       CFT_INT,  0,                     1, 168,   12),
+    CFG_FIELD("mqtt_json_state",   mqtt_json_state,   CFT_BOOL, CFF_MQTT,              0, 1,     0),
+    CFG_FIELD("log_level",         log_level,         CFT_INT,  0,                     0, 4,     1),
+    CFG_FIELD("ota_url",           ota_url,           CFT_STR,  0,                     0, 0,     0),
+    CFG_FIELD("ota_interval",      ota_interval,      CFT_INT,  0,                     0, 720,   24),
+    CFG_FIELD("ota_stagger",       ota_stagger,       CFT_INT,  0,                     0, 1440,  30),
+};
+
+#undef CFG_FIELD
+
+const uint8_t CONFIG_FIELD_COUNT = sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]);
+
+static_assert(sizeof(CONFIG_FIELDS) / sizeof(CONFIG_FIELDS[0]) <= 32, "Maska zmian ConfigUpdate.changed ma 32 bity");
+
+static uint8_t* fieldPtr(Config& cfg, const ConfigField& f) { return (uint8_t*)&cfg + f.offset; }
+static const uint8_t* fieldPtr(const Config& cfg, const ConfigField& f) { return (const uint8_t*)&cfg + f.offset; }
+
+static long readNumber(const Config& cfg, const ConfigField& f) {
+    const uint8_t* p = fieldPtr(cfg, f);
+    switch (f.type) {
+        case CFT_BOOL: { bool b; memcpy(&b, p, sizeof(b)); return b ? 1 : 0; }
+        case CFT_U16: { uint16_t v; memcpy(&v, p, sizeof(v)); return v; }
+        case CFT_INT: { int v; memcpy(&v, p, sizeof(v)); return v; }
+        default: return 0;
+    }
+}
+
+static void writeNumber(Config& cfg, const ConfigField& f, long value) {
+    uint8_t* p = fieldPtr(cfg, f);
+    switch (f.type) {
+        case CFT_BOOL: { bool b = value != 0; memcpy(p, &b, sizeof(b)); break; }
+        case CFT_U16: { uint16_t v = (uint16_t)value; memcpy(p, &v, sizeof(v)); break; }
+        case CFT_INT: { int v = (int)value; memcpy(p, &v, sizeof(v)); break; }
+        default: break;
+    }
+}
+
+void configFillDefaults(Config& cfg) {
+    for (uint8_t i = 0; i < CONFIG_FIELD_COUNT; ++i) {
+        const ConfigField& f = CONFIG_FIELDS[i];
+        if (f.type == CFT_STR) memset(fieldPtr(cfg, f), 0, f.size);
+        else writeNumber(cfg, f, f.defValue);
+    }
+}
+
+int configFieldIndex(const char* key, size_t keyLen) {
+    for (uint8_t i = 0; i < CONFIG_FIELD_COUNT; ++i) {
+        const char* k = CONFIG_FIELDS[i].key;
+        if (strlen(k) == keyLen && memcmp(k, key, keyLen) == 0) return i;
+    }
+    return -1;
+}
+
+static void addIssue(ConfigUpdate& u, int8_t field, ConfigFieldError e) {
+    if (u.issueCount < CONFIG_MAX_ISSUES) {
+        u.issues[u.issueCount].field = field;
+        u.issues[u.issueCount].error = e;
+    }
+    if (u.issueCount < 255) u.issueCount++;
+}
+
+static ConfigFieldError setNumber(ConfigUpdate& u, const ConfigField& f, long value) {
+    if (value < f.minValue || value > f.maxValue) return CFE_RANGE;
+    writeNumber(u.staged, f, value);
+    return CFE_NONE;
+}
+
+void configUpdateBegin(ConfigUpdate& u, const Config& current) {
+    memset(&u, 0, sizeof(u));
+    memcpy(&u.staged, &current, sizeof(Config));
+}
+
+void configUpdateText(ConfigUpdate& u, int field, const char* text) {
+    if (field < 0 || field >= CONFIG_FIELD_COUNT || !text) return;
+    const ConfigField& f = CONFIG_FIELDS[field];
+    ConfigFieldError e = CFE_NONE;
+    if (f.type == CFT_STR) {
+        if ((f.flags & CFF_SECRET) && !text[0]) return;  // Hasło nie jest wyświetlane w formularzu
+        size_t len = strlen(text);
+        if (len >= f.size) e = CFE_TOO_LONG;
+        else memcpy(fieldPtr(u.staged, f), text, len + 1);
+    } else if (f.type == CFT_BOOL) {
+        if (!strcmp(text, "1") || !strcmp(text, "true") || !strcmp(text, "on")) writeNumber(u.staged, f, 1);
+        else if (!strcmp(text, "0") || !strcmp(text, "false") || !strcmp(text, "off")) writeNumber(u.staged, f, 0);
+        else e = CFE_TYPE;
+    } else {
+        char* end = NULL;
+        long v = strtol(text, &end, 10);
+        if (end == text || *end != '\0') e = CFE_TYPE;
+        else e = setNumber(u, f, v);
+    }
+    if (e != CFE_NONE) addIssue(u, (int8_t)field, e);
+}
+
+void configFormBegin(ConfigUpdate& u, ConfigForm& form, const Config& current) {
+    configUpdateBegin(u, current);
+    form.wifiSsid[0] = '\0';
+    form.wifiPass[0] = '\0';
+}
+
+static void copyField(char* out, size_t cap, const char* value) {
+    size_t len = strnlen(value, cap - 1);
+    memcpy(out, value, len);
+    out[len] = '\0';
+}
+
+void configFormArg(ConfigUpdate& u, ConfigForm& form, const char* name, const char* value) {
+    if (!strcmp(name, "wifi_ssid")) copyField(form.wifiSsid, sizeof(form.wifiSsid), value);
+    else if (!strcmp(name, "wifi_pass")) copyField(form.wifiPass, sizeof(form.wifiPass), value);
+    else configUpdateText(u, configFieldIndex(name, strlen(name)), value);
+}
+
+static void onJsonPair(const char* key, size_t keyLen, const JsonValue& v, void* ctx) {
+    ConfigUpdate& u = *(ConfigUpdate*)ctx;
+
+    if (keyLen == 7 && memcmp(key, "version", 7) == 0) {
+        if (v.type != JSON_INT || v.integer < 1 || v.integer > CONFIG_SCHEMA_VERSION) addIssue(u, CONFIG_DOC_FIELD, CFE_VERSION);
+        return;
+    }
+    if (keyLen == 3 && memcmp(key, "rev", 3) == 0) {
+        if (v.type != JSON_INT || v.integer < 1 || (unsigned long)v.integer > 0xFFFFFFFFUL) addIssue(u, CONFIG_DOC_FIELD, CFE_TYPE);
+        else u.rev = (uint32_t)v.integer;
+        return;
+    }
+
+    int idx = configFieldIndex(key, keyLen);
+    if (idx < 0) {
+        if (u.ignoredCount == 0) {
+            size_t n = keyLen < sizeof(u.ignoredKey) - 1 ? keyLen : sizeof(u.ignoredKey) - 1;
+            memcpy(u.ignoredKey, key, n);
+            u.ignoredKey[n] = '\0';
+        }
+        if (u.ignoredCount < 255) u.ignoredCount++;
+        return;
+    }
+
+    const ConfigField& f = CONFIG_FIELDS[idx];
+    ConfigFieldError e = CFE_NONE;
+    switch (f.type) {
+        case CFT_STR:
+            if (v.type != JSON_STRING) e = CFE_TYPE;
+            else {
+                char buf[64];
+                int n = jsonUnescape(v.raw, v.rawLen, buf, sizeof(buf) < f.size ? sizeof(buf) : f.size);
+                if (n < 0) e = CFE_TOO_LONG;
+                else memcpy(fieldPtr(u.staged, f), buf, (size_t)n + 1);
+            }
+            break;
+        case CFT_BOOL:
+            if (v.type != JSON_BOOL) e = CFE_TYPE;
+            else writeNumber(u.staged, f, v.boolean ? 1 : 0);
+            break;
+        default:
+            if (v.type != JSON_INT) e = CFE_TYPE;
+            else e = setNumber(u, f, v.integer);
+            break;
+    }
+    if (e != CFE_NONE) addIssue(u, (int8_t)idx, e);
+}
+
+void configUpdateJson(ConfigUpdate& u, const char* json, size_t len) {
+    u.syntaxPos = jsonFlatParse(json, len, onJsonPair, &u);
+    if (u.syntaxPos) addIssue(u, CONFIG_DOC_FIELD, CFE_SYNTAX);
+}
+
+bool configUpdateFinish(ConfigUpdate& u, const Config& current) {
+    if (u.staged.tank_empty <= u.staged.tank_full) {
+        addIssue(u, (int8_t)configFieldIndex("tank_empty", 10), CFE_CONFLICT);
+    }
+
+    u.changed = 0;
+    u.needMqttReconnect = false;
+    for (uint8_t i = 0; i < CONFIG_FIELD_COUNT; ++i) {
+        const ConfigField& f = CONFIG_FIELDS[i];
+        bool differs = (f.type == CFT_STR)
+            ? strncmp((const char*)fieldPtr(u.staged, f), (const char*)fieldPtr(current, f), f.size) != 0
+            : readNumber(u.staged, f) != readNumber(current, f);
+        if (!differs) continue;
+        u.changed |= 1UL << i;
+        if (f.flags & CFF_MQTT) u.needMqttReconnect = true;
+    }
+    if (u.issueCount) {
+        u.changed = 0;
+        u.needMqttReconnect = false;
+    }
+    return u.issueCount == 0;
+}
+
+void configExportJson(StrBuf& sb, const Config& cfg) {
+    sbAppend(sb, "{\"version\":");
+    sbAppendUInt(sb, CONFIG_SCHEMA_VERSION);
+    for (uint8_t i = 0; i < CONFIG_FIELD_COUNT; ++i) {
+        const ConfigField& f = CONFIG_FIELDS[i];
+        if (f.flags & CFF_SECRET) continue;
+        sbAppend(sb, ",\"");
+        sbAppend(sb, f.key);
+        sbAppend(sb, "\":");
+        if (f.type == CFT_STR) {
+            const char* s = (const char*)fieldPtr(cfg, f);
+            sbAppendJsonString(sb, s, strnlen(s, f.size));
+        } else if (f.type == CFT_BOOL) {
+            sbAppend(sb, readNumber(cfg, f) ? "true" : "false");
+        } else {
+            sbAppendInt(sb, readNumber(cfg, f));
+        }
+    }
+    sbAppendChar(sb, '}');
+}
+
+static uint32_t fnv1a(uint32_t h, const void* data, size_t n) {
+    const uint8_t* p = (const uint8_t*)data;
+    for (size_t i = 0; i < n; ++i) {
+        h ^= p[i];
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+uint32_t configHash(const Config& cfg) {
+    uint32_t h = 2166136261UL;
+    for (uint8_t i = 0; i < CONFIG_FIELD_COUNT; ++i) {
+        const ConfigField& f = CONFIG_FIELDS[i];
+        if (f.flags & CFF_SECRET) continue;
+        h = fnv1a(h, f.key, strlen(f.key) + 1);
+        if (f.type == CFT_STR) {
+            const char* s = (const char*)fieldPtr(cfg, f);
+            h = fnv1a(h, s, strnlen(s, f.size));
+        } else {
+            int32_t v = (int32_t)readNumber(cfg, f);    // Niezależnie od szerokości pola
+            h = fnv1a(h, &v, sizeof(v));
+        }
+    }
+    return h;
+}
+
+void configHashHex(const Config& cfg, char* out) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    uint32_t h = configHash(cfg);
+    for (int i = 0; i < 8; ++i) out[i] = HEX_DIGITS[(h >> (28 - 4 * i)) & 0xF];
+    out[8] = '\0';
+}
+
+const char* configErrorName(ConfigFieldError e) {
+    switch (e) {
+        case CFE_TYPE: return "type";
+        case CFE_RANGE: return "range";
+        case CFE_TOO_LONG: return "too_long";
+        case CFE_CONFLICT: return "conflict";
+        case CFE_VERSION: return "version";
+        case CFE_SYNTAX: return "syntax";
+        default: return "none";
+    }
+}
+
+void configUpdateReport(StrBuf& sb, const ConfigUpdate& u) {
+    if (u.issueCount) {
+        sbAppend(sb, "{\"status\":\"error\",\"errors\":{");
+        uint8_t stored = u.issueCount < CONFIG_MAX_ISSUES ? u.issueCount : CONFIG_MAX_ISSUES;
+        for (uint8_t i = 0; i < stored; ++i) {
+            const ConfigFieldIssue& is = u.issues[i];
+            if (i) sbAppendChar(sb, ',');
+            sbAppendChar(sb, '"');
+            if (is.field >= 0) sbAppend(sb, CONFIG_FIELDS[is.field].key);
+            else sbAppend(sb, is.error == CFE_VERSION ? "version" : "document");
+            sbAppend(sb, "\":\"");
+            sbAppend(sb, configErrorName(is.error));
+            sbAppendChar(sb, '"');
+        }
+        sbAppendChar(sb, '}');
+        if (u.syntaxPos) {
+            sbAppend(sb, ",\"pos\":");
+            sbAppendUInt(sb, (unsigned long)u.syntaxPos);
+        }
+        sbAppendChar(sb, '}');
+        return;
+    }
+
+    sbAppend(sb, "{\"status\":\"ok\",\"changed\":[");
+    bool first = true;
+    for (uint8_t i = 0; i < CONFIG_FIELD_COUNT; ++i) {
+        if (!(u.changed & (1UL << i))) continue;
+        if (!first) sbAppendChar(sb, ',');
+        first = false;
+        sbAppendChar(sb, '"');
+        sbAppend(sb, CONFIG_FIELDS[i].key);
+        sbAppendChar(sb, '"');
+    }
+    sbAppendChar(sb, ']');
+    if (u.ignoredCount) {
+        sbAppend(sb, ",\"ignored\":");
+        sbAppendUInt(sb, u.ignoredCount);
+        sbAppend(sb, ",\"ignored_first\":");
+        sbAppendJsonString(sb, u.ignoredKey, strlen(u.ignoredKey));
+    }
+    sbAppendChar(sb, '}');
+}
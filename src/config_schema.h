@@ -0,0 +1,104 @@
+#ifndef CONFIG_SCHEMA_H
+#define CONFIG_SCHEMA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "strbuf.h"
+
+// Tabela pól konfiguracji - jedno źródło nazw, typów, zakresów i wartości
+// domyślnych dla formularza WWW, dokumentu JSON (GET/PUT /config)
+// i fillDefaultConfig(). Nowe pole Config = nowy wiersz w CONFIG_FIELDS.
+
+const uint8_t CONFIG_SCHEMA_VERSION = 1;    // Pole "version" dokumentu JSON
+
+enum ConfigFieldType : uint8_t {
+    CFT_BOOL,
+    CFT_INT,
+    CFT_U16,
+    CFT_STR,                // Bufor char[size]; domyślnie pusty
+};
+
+enum ConfigFieldFlags : uint8_t {
+    CFF_MQTT = 1,           // Zmiana wymaga ponownego połączenia z brokerem
+    CFF_SECRET = 2,         // Nie jest eksportowane; puste pole formularza = bez zmian
+};
+
+struct ConfigField {
+    const char* key;
+    ConfigFieldType type;
+    uint8_t flags;
+    uint16_t offset;
+    uint16_t size;
+    int32_t minValue;
+    int32_t maxValue;
+    int32_t defValue;
+};
+
+extern const ConfigField CONFIG_FIELDS[];
+extern const uint8_t CONFIG_FIELD_COUNT;
+
+enum ConfigFieldError : uint8_t {
+    CFE_NONE,
+    CFE_TYPE,               // Zły typ wartości (np. łańcuch zamiast liczby)
+    CFE_RANGE,              // Poza zakresem min..max
+    CFE_TOO_LONG,           // Łańcuch nie mieści się w polu
+    CFE_CONFLICT,           // Niespójne z innym polem (tank_empty <= tank_full)
+    CFE_VERSION,            // Dokument w nowszej, nieobsługiwanej wersji
+    CFE_SYNTAX,             // Błąd składni JSON
+};
+
+const int8_t CONFIG_DOC_FIELD = -1;         // Błąd dotyczy całego dokumentu
+const uint8_t CONFIG_MAX_ISSUES = 8;
+
+struct ConfigFieldIssue {
+    int8_t field;           // Indeks w CONFIG_FIELDS albo CONFIG_DOC_FIELD
+    ConfigFieldError error;
+};
+
+// Wynik jednej aktualizacji; zmiany trafiają do kopii roboczej, a do
+// bieżącej konfiguracji dopiero gdy żadne pole nie zgłosiło błędu
+struct ConfigUpdate {
+    Config staged;
+    uint32_t changed;       // Bit i = CONFIG_FIELDS[i] ma nową wartość
+    bool needMqttReconnect;
+    uint8_t issueCount;     // Liczba wszystkich błędów (zapisane pierwsze CONFIG_MAX_ISSUES)
+    ConfigFieldIssue issues[CONFIG_MAX_ISSUES];
+    uint8_t ignoredCount;   // Nieznane klucze (np. z nowszej wersji) - pomijane
+    char ignoredKey[24];    // Pierwszy z nich
+    size_t syntaxPos;
+    uint32_t rev;           // Pole "rev" dokumentu zdalnego (remote_config.h); 0 = brak
+};
+
+void configFillDefaults(Config& cfg);
+int configFieldIndex(const char* key, size_t keyLen);
+
+void configUpdateBegin(ConfigUpdate& u, const Config& current);
+// Wartość z formularza WWW (tekst); bool przyjmuje 1/0, true/false, on/off
+void configUpdateText(ConfigUpdate& u, int field, const char* text);
+// Cały dokument JSON {"version":1,"tank_full":50,...}
+void configUpdateJson(ConfigUpdate& u, const char* json, size_t len);
+// Walidacja między polami i maska zmian; true gdy można zapisać
+bool configUpdateFinish(ConfigUpdate& u, const Config& current);
+
+// Formularz POST /save: pola tabeli trafiają do ConfigUpdate, poświadczenia
+// WiFi (zapisywane osobno, config.h) do stałych buforów - bez String
+const size_t CONFIG_FORM_VALUE_MAX = 96;    // Dłuższa wartość i tak przekracza każde pole
+struct ConfigForm {
+    char wifiSsid[33];
+    char wifiPass[65];
+};
+void configFormBegin(ConfigUpdate& u, ConfigForm& form, const Config& current);
+// Jedna para nazwa=wartość; nieznane nazwy pomijane
+void configFormArg(ConfigUpdate& u, ConfigForm& form, const char* name, const char* value);
+
+void configExportJson(StrBuf& sb, const Config& cfg);
+// Skrót pól z tabeli bez sekretów (FNV-1a) - te same ustawienia = ten sam skrót
+uint32_t configHash(const Config& cfg);
+// 8 znaków hex + NUL
+void configHashHex(const Config& cfg, char* out);
+// {"status":"ok","changed":[...]} albo {"status":"error","errors":{"pole":"range",...}}
+void configUpdateReport(StrBuf& sb, const ConfigUpdate& u);
+const char* configErrorName(ConfigFieldError e);
+
+#endif // CONFIG_SCHEMA_H
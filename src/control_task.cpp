@@ -0,0 +1,213 @@
+#include "control_task.h"
+#include "globals.h"
+#include "pump_control.h"
+
+static LoopStats s_latency;
+static uint32_t s_latencyOver = 0;
+static bool s_rxStamped = false;    // Trwa obsługa pakietu MQTT (zadanie sieci)
+static uint32_t s_rxUs = 0;
+
+void controlCommandReceived(uint32_t rxUs) {
+    s_rxStamped = true;
+    s_rxUs = rxUs;
+}
+
+void controlCommandDone() {
+    s_rxStamped = false;
+}
+
+const LoopStats& controlLatency() {
+    return s_latency;
+}
+
+uint32_t controlLatencyOverTarget() {
+    return s_latencyOver;
+}
+
+void controlLatencyReset() {
+    loopStatsReset(s_latency);
+    s_latencyOver = 0;
+}
+
+// Czas od odbioru polecenia mierzony tuż przed wykonaniem: przekaźnik
+// ustawia początek applyPumpOutputs(), a publikacja stanu do HA (zapis do
+// gniazda MQTT) nie jest częścią opóźnienia wykonania
+static void dispatchTimed(PumpEvent event, bool stamped, uint32_t rxUs) {
+    if (stamped) {
+        uint32_t us = micros() - rxUs;
+        loopStatsAdd(s_latency, us);
+        if (us > COMMAND_LATENCY_TARGET_US) s_latencyOver++;
+    }
+    pumpDispatch(event);
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <string.h>
+#include <esp_task_wdt.h>
+#include "measurements.h"
+#include "mono_clock.h"
+#include "spsc_queue.h"
+
+const uint16_t CONTROL_COMMAND_QUEUE = 16;      // Sieć -> sterowanie
+const uint16_t CONTROL_UPDATE_QUEUE = 32;       // Sterowanie -> sieć, tylko zmienione wartości sensorów
+const uint16_t CONTROL_SWITCH_QUEUE = 16;       // Sterowanie -> sieć, stany przełączników HA
+const uint32_t CONTROL_TASK_STACK = 4096;
+const uint32_t NETWORK_TASK_STACK = 8192;
+const UBaseType_t CONTROL_TASK_PRIORITY = configMAX_PRIORITIES - 2;
+const UBaseType_t NETWORK_TASK_PRIORITY = 1;
+const BaseType_t CONTROL_TASK_CORE = 1;
+const BaseType_t NETWORK_TASK_CORE = 0;         // Rdzeń stosu WiFi
+
+enum CommandKind : uint8_t { CMD_PUMP_EVENT, CMD_SOUND };
+
+struct ControlCommand {
+    CommandKind kind;
+    uint8_t arg;
+    bool stamped;           // Polecenie z MQTT - pomiar opóźnienia
+    uint32_t rxUs;
+};
+
+struct SensorUpdate {
+    HsSensor* sensor;
+    char value[HA_VALUE_MAX];
+};
+
+// Przełączniki mają własną kolejkę: wartości sensorów nie mogą jej zapełnić.
+// Stany zmieniają tylko przejścia pompy (najwyżej dwa na przejście, przejścia
+// co najmniej sekundy od siebie), więc 16 miejsc starcza na długą przerwę sieci.
+struct SwitchUpdate {
+    HASwitch* sw;
+    bool state;
+    bool force;
+};
+
+static SpscQueue<ControlCommand, CONTROL_COMMAND_QUEUE> s_commands;
+static SpscQueue<SensorUpdate, CONTROL_UPDATE_QUEUE> s_updates;
+static SpscQueue<SwitchUpdate, CONTROL_SWITCH_QUEUE> s_switches;
+static TaskHandle_t s_controlTask = nullptr;
+static ControlIteration s_control = nullptr;
+static ControlIteration s_network = nullptr;
+
+bool controlInTask() {
+    return s_controlTask && xTaskGetCurrentTaskHandle() == s_controlTask;
+}
+
+// Polecenia wykonuje zadanie sterowania; przed jego startem (setup) - wprost
+static bool postCommand(CommandKind kind, uint8_t arg) {
+    if (!s_controlTask || controlInTask()) return false;
+    ControlCommand cmd = { kind, arg, s_rxStamped, s_rxUs };
+    if (!spscPush(s_commands, cmd)) DEBUG_PRINT(F("Kolejka poleceń sterowania pełna"));
+    xTaskNotifyGive(s_controlTask);     // Wybudzenie przed upływem ticku
+    return true;
+}
+
+void controlPostEvent(PumpEvent event) {
+    if (!postCommand(CMD_PUMP_EVENT, event)) dispatchTimed(event, s_rxStamped, s_rxUs);
+}
+
+void controlPostSound(BuzzerSound sound) {
+    if (!postCommand(CMD_SOUND, sound)) buzzerPlay(sound);
+}
+
+// Do kolejki trafia tylko wartość różna od ostatnio odłożonej - updatePump()
+// wywołuje setValue() w każdej iteracji. Gdy kolejka jest pełna, wartość nie
+// jest zapamiętana, więc następne setValue() ponawia próbę z aktualną wartością.
+bool controlDeferSensor(HsSensor& sensor, const char* value) {
+    if (!controlInTask()) return false;
+    if (sensor._hasQueued && strncmp(sensor._queued, value, sizeof(sensor._queued) - 1) == 0) return true;
+    SensorUpdate u = { &sensor, {0} };
+    strncpy(u.value, value, sizeof(u.value) - 1);
+    if (spscPush(s_updates, u)) {
+        memcpy(sensor._queued, u.value, sizeof(sensor._queued));
+        sensor._hasQueued = true;
+    }
+    return true;
+}
+
+void controlSetSwitch(HASwitch& sw, bool state, bool force) {
+    if (!controlInTask()) {
+        sw.setState(state, force);
+        return;
+    }
+    SwitchUpdate u = { &sw, state, force };
+    if (!spscPush(s_switches, u)) DEBUG_PRINT(F("Kolejka przełączników HA pełna"));
+}
+
+void controlDrainNetwork() {
+    SwitchUpdate s;
+    while (spscPop(s_switches, s)) s.sw->setState(s.state, s.force);
+    SensorUpdate u;
+    while (spscPop(s_updates, u)) u.sensor->setValue(u.value);
+}
+
+void controlDrainCommands() {
+    ControlCommand cmd;
+    while (spscPop(s_commands, cmd)) {
+        if (cmd.kind == CMD_PUMP_EVENT) dispatchTimed((PumpEvent)cmd.arg, cmd.stamped, cmd.rxUs);
+        else buzzerPlay((BuzzerSound)cmd.arg);
+    }
+}
+
+uint32_t controlDropped() {
+    return s_commands.dropped + s_updates.dropped + s_switches.dropped;
+}
+
+static void controlTaskMain(void*) {
+    s_controlTask = xTaskGetCurrentTaskHandle();  // Przed pierwszą iteracją, niezależnie od xTaskCreate
+    esp_task_wdt_add(NULL);
+    for (;;) {
+        controlDrainCommands();
+        s_control(millis64());
+        esp_task_wdt_reset();
+        // Czas echa mierzony odpytywaniem micros() - w trakcie pomiaru bez uśpienia
+        if (measurementInProgress()) taskYIELD();
+        else ulTaskNotifyTake(pdTRUE, 1);   // Tick albo polecenie z sieci (postCommand)
+    }
+}
+
+static void networkTaskMain(void*) {
+    for (;;) {
+        controlDrainNetwork();
+        s_network(millis64());
+        vTaskDelay(1);
+    }
+}
+
+void controlStartTasks(ControlIteration control, ControlIteration network) {
+    s_control = control;
+    s_network = network;
+    xTaskCreatePinnedToCore(controlTaskMain, "control", CONTROL_TASK_STACK, nullptr,
+                            CONTROL_TASK_PRIORITY, &s_controlTask, CONTROL_TASK_CORE);
+    xTaskCreatePinnedToCore(networkTaskMain, "network", NETWORK_TASK_STACK, nullptr,
+                            NETWORK_TASK_PRIORITY, nullptr, NETWORK_TASK_CORE);
+    esp_task_wdt_delete(NULL);  // Zadanie setup()/loop() kończy pracę
+}
+
+#else
+
+// Jedna pętla - wszystko wprost, kolejki nie są potrzebne
+
+void controlPostEvent(PumpEvent event) {
+    dispatchTimed(event, s_rxStamped, s_rxUs);
+}
+
+void controlPostSound(BuzzerSound sound) {
+    buzzerPlay(sound);
+}
+
+bool controlDeferSensor(HsSensor&, const char*) {
+    return false;
+}
+
+void controlSetSwitch(HASwitch& sw, bool state, bool force) {
+    sw.setState(state, force);
+}
+
+void controlDrainNetwork() {}
+void controlDrainCommands() {}
+
+uint32_t controlDropped() {
+    return 0;
+}
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef CONTROL_TASK_H
+#define CONTROL_TASK_H
+
+#include <stdint.h>
+#include "pump_fsm.h"
+#include "buzzer.h"
+#include "loop_stats.h"
+
+// Podział pracy na sterowanie (pomiar, pompa, przycisk, buzzer) i sieć
+// (WiFi, HTTP, MQTT, OTA). Na ESP8266 obie części działają w jednej pętli
+// loop() i wszystko idzie wprost. Na ESP32 sterowanie jest zadaniem o wysokim
+// priorytecie na rdzeniu 1, a sieć zadaniem na rdzeniu 0; wymiana wyłącznie
+// przez kolejki SPSC, więc zawieszenie sieci nie opóźnia wyłączenia pompy.
+
+class HsSensor;
+class HASwitch;
+
+// Zdarzenie pompy / dźwięk z dowolnego miejsca (HA, przycisk, sieć)
+void controlPostEvent(PumpEvent event);
+void controlPostSound(BuzzerSound sound);
+
+// Publikacja z zadania sterowania - true = wartość odłożona dla sieci
+bool controlDeferSensor(HsSensor& sensor, const char* value);
+void controlSetSwitch(HASwitch& sw, bool state, bool force = false);
+
+// Opróżnianie kolejek: aktualizacje HA (sieć) i polecenia (sterowanie)
+void controlDrainNetwork();
+void controlDrainCommands();
+
+// Elementy odrzucone przy pełnych kolejkach (GET /loop)
+uint32_t controlDropped();
+
+// Opóźnienie polecenie MQTT -> wykonanie w maszynie stanów pompy. Początek
+// pomiaru (micros(), zob. haMqttPoll) dostają zdarzenia pompy wysłane
+// w trakcie obsługi pakietu (onPumpAlarmCommand, onServiceSwitchCommand).
+const uint32_t COMMAND_LATENCY_TARGET_US = 10000;
+void controlCommandReceived(uint32_t rxUs);
+void controlCommandDone();
+const LoopStats& controlLatency();
+uint32_t controlLatencyOverTarget();    // Polecenia powyżej COMMAND_LATENCY_TARGET_US
+void controlLatencyReset();
+
+#if defined(ARDUINO_ARCH_ESP32)
+typedef void (*ControlIteration)(uint64_t nowMs);
+// Uruchamia oba zadania; wywoływane na końcu setup()
+void controlStartTasks(ControlIteration control, ControlIteration network);
+bool controlInTask();
+#endif
+
+#endif // CONTROL_TASK_H
@@ -0,0 +1,227 @@
+#include "filters.h"
+#include <math.h>
+#include <stdlib.h>
+
+// Sortowanie przez wstawianie - dla kilku próbek szybsze niż cokolwiek innego
+static void sortSmall(int* a, int n) {
+    for (int i = 1; i < n; ++i) {
+        int v = a[i];
+        int j = i - 1;
+        while (j >= 0 && a[j] > v) { a[j + 1] = a[j]; --j; }
+        a[j + 1] = v;
+    }
+}
+
+int reduceSamples(const int* samples, int count, int minValid) {
+    int tmp[8];
+    int validCount = 0;
+    for (int i = 0; i < count && validCount < 8; ++i) {
+        if (samples[i] != -1) tmp[validCount++] = samples[i];
+    }
+    if (validCount == 0 || validCount < minValid) return -1;
+
+    sortSmall(tmp, validCount);
+    // Przy więcej niż 2 próbkach średnia obcięta (bez min/max) jest stabilniejsza
+    if (validCount > 2) {
+        long sum = 0;
+        for (int i = 1; i < validCount - 1; ++i) sum += tmp[i];
+        return (int)(sum / (validCount - 2));
+    }
+    return (validCount % 2 == 0) ? ((tmp[validCount / 2 - 1] + tmp[validCount / 2]) / 2) : tmp[validCount / 2];
+}
+
+float emaStep(float prev, float sample, float alpha, float spikeLimit) {
+    if (prev <= 0) return sample;
+    float delta = fabsf(sample - prev);
+    if (delta > spikeLimit) return prev;  // ignoruj skok
+    return (1.0f - alpha) * prev + alpha * sample;
+}
+
+void hampelInit(HampelFilter& f, float k, float minMad) {
+    f.count = 0;
+    f.head = 0;
+    f.k = k;
+    f.minMad = minMad;
+}
+
+// Mediana i skalowane MAD okna (n <= HAMPEL_WINDOW)
+static int medianAndMad(const int* window, int n, float& mad) {
+    int sorted[HAMPEL_WINDOW];
+    for (int i = 0; i < n; ++i) sorted[i] = window[i];
+    sortSmall(sorted, n);
+    int median = sorted[n / 2];
+
+    int dev[HAMPEL_WINDOW];
+    for (int i = 0; i < n; ++i) dev[i] = abs(sorted[i] - median);
+    sortSmall(dev, n);
+    mad = 1.4826f * (float)dev[n / 2];
+    return median;
+}
+
+float hampelUpdate(HampelFilter& f, int sample) {
+    float mad;
+    if (sample < 0) {
+        // Brak próbki - zwróć medianę tego, co jest w oknie
+        if (f.count == 0) return -1;
+        return (float)medianAndMad(f.window, f.count, mad);
+    }
+
+    f.window[f.head] = sample;
+    f.head = (f.head + 1) % HAMPEL_WINDOW;
+    if (f.count < HAMPEL_WINDOW) f.count++;
+
+    int median = medianAndMad(f.window, f.count, mad);
+    if (mad < f.minMad) mad = f.minMad;
+
+    if (fabsf((float)(sample - median)) > f.k * mad) return (float)median;
+    return (float)sample;
+}
+
+void robustInit(RobustFilter& f) {
+    f.count = 0;
+    f.head = 0;
+    f.median = 0;
+    f.gate = (int)ROBUST_MIN_GATE;
+    f.pendingCount = 0;
+    f.value = 0;
+    f.rejected = 0;
+    f.steps = 0;
+}
+
+// Dodaj odczyt do okna, utrzymując posortowaną kopię bez pełnego sortowania,
+// i przelicz medianę oraz bramkę. W pełnym oknie nowy odczyt zajmuje miejsce
+// najstarszego w posortowanej kopii i jest przesuwany tylko w jedną stronę.
+static void robustPush(RobustFilter& f, int sample) {
+    int n = f.count;
+    int i;
+    if (n == HAMPEL_WINDOW) {
+        int old = f.window[f.head];
+        if (old == sample) {            // okno bez zmian - mediana i bramka też
+            if (++f.head == HAMPEL_WINDOW) f.head = 0;
+            return;
+        }
+        i = 0;
+        while (f.sorted[i] != old) ++i;
+        while (i > 0 && f.sorted[i - 1] > sample) { f.sorted[i] = f.sorted[i - 1]; --i; }
+        while (i < n - 1 && f.sorted[i + 1] < sample) { f.sorted[i] = f.sorted[i + 1]; ++i; }
+    } else {
+        i = n++;
+        while (i > 0 && f.sorted[i - 1] > sample) { f.sorted[i] = f.sorted[i - 1]; --i; }
+        f.count = n;
+    }
+    f.sorted[i] = sample;
+    f.window[f.head] = sample;
+    if (++f.head == HAMPEL_WINDOW) f.head = 0;
+
+    int mid = n / 2;
+    f.median = f.sorted[mid];
+    int dev;
+    if (n == 5) {
+        // MAD z 5 odczytów = drugie najmniejsze z odchyleń s[1], s[0] (rosnące)
+        // i s[3], s[4] (rosnące): min(max(a, c), min(b, d))
+        int a = f.median - f.sorted[1], b = f.median - f.sorted[0];
+        int c = f.sorted[3] - f.median, d = f.sorted[4] - f.median;
+        int hi = a > c ? a : c, lo = b < d ? b : d;
+        dev = hi < lo ? hi : lo;
+    } else {
+        // MAD jako k-ty element scalenia odchyleń po obu stronach mediany
+        int l = mid - 1, r = mid + 1;
+        dev = 0;
+        for (int k = 0; k < mid; ++k) {
+            int dl = (l >= 0) ? f.median - f.sorted[l] : INT32_MAX;
+            int dr = (r < n) ? f.sorted[r] - f.median : INT32_MAX;
+            if (dl <= dr) { dev = dl; --l; } else { dev = dr; ++r; }
+        }
+    }
+    // Odchylenia są całkowite, więc |d| <= bramka <=> |d| <= floor(bramka)
+    float gate = ROBUST_GATE_K * 1.4826f * (float)dev;
+    f.gate = gate < ROBUST_MIN_GATE ? (int)ROBUST_MIN_GATE : (int)gate;
+}
+
+float robustUpdate(RobustFilter& f, int sample, float alpha) {
+    if (sample < 0) return f.value;
+
+    if (f.count == 0) {
+        robustPush(f, sample);
+        f.value = (float)sample;
+        return f.value;
+    }
+
+    int d = sample - f.median;
+    if (d <= f.gate && -d <= f.gate) {
+        f.rejected += f.pendingCount;   // wcześniejsze odczyty poza bramką były skokami
+        f.pendingCount = 0;
+        robustPush(f, sample);
+        f.value = (1.0f - alpha) * f.value + alpha * (float)sample;
+        return f.value;
+    }
+
+    // Poza bramką: skok albo początek nowego poziomu. Kolejne odczyty muszą
+    // być zgodne z pierwszym odczytem poza bramką, inaczej zaczynamy od nowa.
+    if (f.pendingCount > 0 && fabsf((float)(sample - f.pending[0])) > ROBUST_MIN_GATE) {
+        f.rejected += f.pendingCount;
+        f.pendingCount = 0;
+    }
+    f.pending[f.pendingCount++] = sample;
+
+    if (f.pendingCount < ROBUST_CONFIRM) return f.value;
+
+    // Potwierdzona zmiana poziomu - okno budujemy od nowa z potwierdzonych odczytów
+    f.count = 0;
+    f.head = 0;
+    for (int i = 0; i < f.pendingCount; ++i) robustPush(f, f.pending[i]);
+    f.pendingCount = 0;
+    f.steps++;
+    f.value = (float)f.median;
+    return f.value;
+}
+
+void alphaBetaInit(AlphaBetaFilter& f, float alpha, float beta) {
+    f.alpha = alpha;
+    f.beta = beta;
+    f.x = 0;
+    f.v = 0;
+    f.initialized = false;
+}
+
+float alphaBetaUpdate(AlphaBetaFilter& f, float sample) {
+    if (sample < 0) {
+        if (f.initialized) f.x += f.v;
+        return f.initialized ? f.x : -1;
+    }
+    if (!f.initialized) {
+        f.x = sample;
+        f.v = 0;
+        f.initialized = true;
+        return f.x;
+    }
+    float predicted = f.x + f.v;
+    float residual = sample - predicted;
+    f.x = predicted + f.alpha * residual;
+    f.v = f.v + f.beta * residual;
+    return f.x;
+}
+
+void kalmanInit(KalmanFilter1D& f, float q, float r) {
+    f.q = q;
+    f.r = r;
+    f.x = 0;
+    f.p = r;
+    f.initialized = false;
+}
+
+float kalmanUpdate(KalmanFilter1D& f, float sample) {
+    if (!f.initialized) {
+        if (sample < 0) return -1;
+        f.x = sample;
+        f.p = f.r;
+        f.initialized = true;
+        return f.x;
+    }
+    f.p += f.q;
+    if (sample < 0) return f.x;  // sama predykcja
+    float gain = f.p / (f.p + f.r);
+    f.x += gain * (sample - f.x);
+    f.p *= (1.0f - gain);
+    return f.x;
+}
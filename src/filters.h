@@ -0,0 +1,83 @@
+#ifndef FILTERS_H
+#define FILTERS_H
+
+#include <stdint.h>
+
+// Filtry pomiaru odległości. Moduł nie zależy od Arduino, dzięki czemu te same
+// funkcje są używane w firmware (measurements.cpp) i w benchmarku natywnym.
+
+// Redukcja serii próbek jednego cyklu pomiarowego: mediana, a przy >2 próbkach
+// średnia obcięta (bez min/max). Próbki -1 są pomijane.
+// Zwraca -1, gdy ważnych próbek jest mniej niż minValid.
+int reduceSamples(const int* samples, int count, int minValid);
+
+// Krok filtra EMA z odrzucaniem skoków większych niż spikeLimit (mm).
+// prev <= 0 oznacza filtr niezainicjalizowany - zwracana jest próbka.
+float emaStep(float prev, float sample, float alpha, float spikeLimit);
+
+// Filtr Hampela: próbka odstająca od mediany okna o więcej niż k * MAD
+// zastępowana jest medianą.
+const int HAMPEL_WINDOW = 5;
+
+struct HampelFilter {
+    int window[HAMPEL_WINDOW];
+    uint8_t count;
+    uint8_t head;
+    float k;          // Krotność (skalowanego) MAD uznawana za odstającą
+    float minMad;     // Dolne ograniczenie MAD (mm), aby nie odrzucać szumu kwantyzacji
+};
+
+void hampelInit(HampelFilter& f, float k, float minMad);
+float hampelUpdate(HampelFilter& f, int sample);
+
+// Odporny filtr pomiaru: bramka Hampela (mediana + MAD z ostatnich
+// zaakceptowanych wyników) przed EMA. Pojedyncze skoki są odrzucane, ale
+// ROBUST_CONFIRM kolejnych zgodnych ze sobą odczytów poza bramką oznacza
+// rzeczywistą zmianę poziomu - filtr przeskakuje wtedy na nowy poziom.
+const int ROBUST_CONFIRM = 3;
+const float ROBUST_MIN_GATE = 30.0f;   // Minimalna szerokość bramki (mm)
+const float ROBUST_GATE_K = 4.0f;      // Krotność MAD wyznaczająca bramkę
+
+struct RobustFilter {
+    int window[HAMPEL_WINDOW];       // Zaakceptowane odczyty w kolejności napływania
+    int sorted[HAMPEL_WINDOW];       // Te same odczyty posortowane (aktualizowane przyrostowo)
+    uint8_t count;
+    uint8_t head;
+    int median;                      // Mediana i bramka okna (przeliczane tylko po zmianie okna)
+    int gate;                        // Bramka zaokrąglona w dół - odczyty są całkowite
+    int pending[ROBUST_CONFIRM];     // Kolejne odczyty poza bramką
+    uint8_t pendingCount;
+    float value;                     // Wyjście filtra, 0 = brak inicjalizacji
+    uint32_t rejected;               // Liczba odrzuconych skoków
+    uint32_t steps;                  // Liczba zaakceptowanych zmian skokowych
+};
+
+void robustInit(RobustFilter& f);
+// Zwraca nową wartość filtra; sample < 0 pozostawia stan bez zmian
+float robustUpdate(RobustFilter& f, int sample, float alpha);
+
+// Filtr alfa-beta (poziom + prędkość zmian na cykl pomiarowy)
+struct AlphaBetaFilter {
+    float alpha;
+    float beta;
+    float x;
+    float v;
+    bool initialized;
+};
+
+void alphaBetaInit(AlphaBetaFilter& f, float alpha, float beta);
+float alphaBetaUpdate(AlphaBetaFilter& f, float sample);
+
+// Jednowymiarowy filtr Kalmana (model stałego poziomu z szumem procesu q)
+struct KalmanFilter1D {
+    float q;    // Wariancja szumu procesu (mm^2 / cykl)
+    float r;    // Wariancja szumu pomiaru (mm^2)
+    float x;
+    float p;
+    bool initialized;
+};
+
+void kalmanInit(KalmanFilter1D& f, float q, float r);
+float kalmanUpdate(KalmanFilter1D& f, float sample);
+
+#endif // FILTERS_H
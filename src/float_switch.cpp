@@ -0,0 +1,60 @@
+#include "float_switch.h"
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "pins.h"
+#include "spsc_queue.h"
+#endif
+
+void floatInit(FloatDebounce& d, uint8_t level, uint32_t nowMs) {
+    d.stable = level;
+    d.pending = level;
+    d.pendingMs = nowMs;
+    d.edges = 0;
+}
+
+void floatEdge(FloatDebounce& d, const FloatEdge& e) {
+    d.pending = e.level;
+    d.pendingMs = e.ms;
+    d.edges++;
+}
+
+bool floatSettle(FloatDebounce& d, uint32_t nowMs) {
+    if (d.pending == d.stable) return false;
+    // Ze znakiem: zbocze z przerwania może być późniejsze niż nowMs pętli
+    if ((int32_t)(nowMs - d.pendingMs) < (int32_t)FLOAT_DEBOUNCE_MS) return false;
+    d.stable = d.pending;
+    return true;
+}
+
+#ifdef ARDUINO
+static SpscQueue<FloatEdge, FLOAT_QUEUE_SIZE> s_edges;
+static FloatDebounce s_float;
+static uint32_t s_droppedSeen = 0;
+
+// Producent kolejki; spscPush jest wstawiany w miejscu wywołania (IRAM)
+static void IRAM_ATTR floatSwitchIsr() {
+    FloatEdge e = { (uint32_t)millis(), (uint8_t)digitalRead(PIN_WATER_LEVEL) };
+    spscPush(s_edges, e);
+}
+
+void floatSwitchBegin() {
+    floatInit(s_float, (uint8_t)digitalRead(PIN_WATER_LEVEL), millis());
+    attachInterrupt(digitalPinToInterrupt(PIN_WATER_LEVEL), floatSwitchIsr, CHANGE);
+}
+
+bool floatSwitchWater() {
+    FloatEdge e;
+    while (spscPop(s_edges, e)) floatEdge(s_float, e);
+    if (s_edges.dropped != s_droppedSeen) {
+        // Seria zboczy zapełniła kolejkę - ostatni poziom mógł przepaść
+        s_droppedSeen = s_edges.dropped;
+        floatEdge(s_float, { (uint32_t)millis(), (uint8_t)digitalRead(PIN_WATER_LEVEL) });
+    }
+    floatSettle(s_float, millis());
+    return s_float.stable == LOW;
+}
+
+uint32_t floatSwitchEdges() {
+    return s_float.edges;
+}
+#endif
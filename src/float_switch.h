@@ -0,0 +1,43 @@
+#ifndef FLOAT_SWITCH_H
+#define FLOAT_SWITCH_H
+
+#include <stdint.h>
+
+// Pływak (PIN_WATER_LEVEL) obsługiwany przerwaniem: procedura przerwania
+// zapisuje poziom i czas zbocza do kolejki (spsc_queue.h), a pętla sterowania
+// przepuszcza zbocza przez filtr czasowy. Nowy poziom obowiązuje dopiero, gdy
+// utrzyma się FLOAT_DEBOUNCE_MS od ostatniego zbocza - drgania styku i fale
+// nie przełączają maszyny stanów pompy ani nie zerują odliczania opóźnienia.
+// Czas liczony jest od chwili zbocza, nie od chwili obsłużenia go w pętli.
+
+const uint32_t FLOAT_DEBOUNCE_MS = 100;
+const uint16_t FLOAT_QUEUE_SIZE = 16;       // Potęga 2; przepełnienie = ponowny odczyt pinu
+
+struct FloatEdge {
+    uint32_t ms;            // millis() w przerwaniu
+    uint8_t level;          // Poziom pinu po zboczu (LOW = woda)
+};
+
+struct FloatDebounce {
+    uint8_t stable;         // Poziom po filtrze
+    uint8_t pending;        // Ostatni poziom ze zbocza
+    uint32_t pendingMs;     // Czas ostatniego zbocza
+    uint32_t edges;         // Wszystkie zbocza (statystyka drgań)
+};
+
+void floatInit(FloatDebounce& d, uint8_t level, uint32_t nowMs);
+// Zbocze z kolejki - każde otwiera okno filtra od nowa
+void floatEdge(FloatDebounce& d, const FloatEdge& e);
+// true, gdy poziom po filtrze właśnie się zmienił
+bool floatSettle(FloatDebounce& d, uint32_t nowMs);
+
+#ifdef ARDUINO
+// Stan początkowy i przerwanie na obu zboczach (po pinMode)
+void floatSwitchBegin();
+// Zbocza z przerwania przez filtr; poziom po filtrze: true = woda
+bool floatSwitchWater();
+// Zbocza od startu (GET /loop) - wiele na jedną zmianę poziomu = drgania
+uint32_t floatSwitchEdges();
+#endif
+
+#endif // FLOAT_SWITCH_H
@@ -3,28 +3,42 @@
 
 #include <Arduino.h>
 #include <ArduinoHA.h>
-#include <ESP8266WebServer.h>
+#include "platform.h"
 #include <WebSocketsServer.h>
 
 #include "config.h"
 #include "status.h"
 #include "button.h"
 #include "timers.h"
+#include "ha_discovery.h"
 
 extern WiFiClient client;
 extern HADevice device;
 extern HAMqtt mqtt;
-extern ESP8266WebServer server;
+extern PlatformWebServer server;
 extern WebSocketsServer webSocket;
 
-extern HASensor sensorDistance;
-extern HASensor sensorLevel;
-extern HASensor sensorVolume;
-extern HASensor sensorPumpWorkTime;
-extern HASensor sensorPump;
-extern HASensor sensorWater;
-extern HASensor sensorAlarm;
-extern HASensor sensorReserve;
+extern HsSensor sensorDistance;
+extern HsSensor sensorLevel;
+extern HsSensor sensorVolume;
+extern HsSensor sensorPumpWorkTime;
+extern HsSensor sensorPump;
+extern HsSensor sensorWater;
+extern HsSensor sensorPumpFlow;
+extern HsSensor sensorPumpFlowTrend;
+extern HsSensor sensorPumpNoFlow;
+extern HsSensor sensorLeakRate;
+extern HsSensor sensorLeak;
+extern HsSensor sensorAlarm;
+extern HsSensor sensorReserve;
+extern HsSensor sensorHeapFreeMin;
+extern HsSensor sensorHeapBlockMin;
+extern HsSensor sensorHeapFragMax;
+extern HsSensor sensorBootArmed;
+extern HsSensor sensorResetCause;
+extern HsSensor sensorLoopStalls;
+extern HsSensor sensorSignalQuality;
+extern HsSensor sensorStale;
 
 extern HASwitch switchPumpAlarm;
 extern HASwitch switchService;
@@ -40,6 +54,7 @@ extern const int SENSOR_MAX_RANGE;
 extern const float EMA_ALPHA;
 extern const int SENSOR_AVG_SAMPLES;
 extern const unsigned long ULTRASONIC_TIMEOUT;
+extern const unsigned long SENSOR_STALE_TIMEOUT;
 
 // Shared runtime state used by measurements
 extern float lastFilteredDistance;
@@ -57,8 +72,8 @@ extern float volume;
 	#define DEBUG_PRINT(x) Serial.println(x)
 	#define DEBUG_PRINTF(format, ...) Serial.printf(format, __VA_ARGS__)
 #else
-	#define DEBUG_PRINT(x)
-	#define DEBUG_PRINTF(format, ...)
+	#define DEBUG_PRINT(x) ((void)0)
+	#define DEBUG_PRINTF(format, ...) ((void)0)
 #endif
 
 // Globalne stałe/funcje dostępne w programie
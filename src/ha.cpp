@@ -1,32 +1,56 @@
 #include "ha.h"
 #include "globals.h"
 #include "pins.h"
-
-// Definicje sensorów i przełączników używanych w projekcie
-HASensor sensorDistance("water_level");
-HASensor sensorLevel("water_level_percent");
-HASensor sensorVolume("water_volume");
-HASensor sensorPumpWorkTime("pump_work_time");
-
-HASensor sensorPump("pump");
-HASensor sensorWater("water");
-
-HASensor sensorAlarm("water_alarm");
-HASensor sensorReserve("water_reserve");
+#include "pump_control.h"
+#include "ha_discovery.h"
+#include "control_task.h"
+#include "loop_watchdog.h"
+#include "log_ring.h"
+#include "remote_config.h"
+#include "ota_pull.h"
+
+// Definicje sensorów i przełączników używanych w projekcie.
+// Sensory publikuje ha_discovery.cpp (porcjami, z pamięcią podręczną discovery),
+// przełączniki obsługuje ArduinoHA.
+HsSensor sensorDistance("water_level");
+HsSensor sensorLevel("water_level_percent");
+HsSensor sensorVolume("water_volume");
+HsSensor sensorPumpWorkTime("pump_work_time");
+
+HsSensor sensorPump("pump");
+HsSensor sensorWater("water");
+
+HsSensor sensorPumpFlow("pump_flow");
+HsSensor sensorPumpFlowTrend("pump_flow_trend");
+HsSensor sensorPumpNoFlow("pump_no_flow");
+HsSensor sensorLeakRate("leak_rate");
+HsSensor sensorLeak("leak");
+
+HsSensor sensorAlarm("water_alarm");
+HsSensor sensorReserve("water_reserve");
+
+HsSensor sensorSignalQuality("signal_quality");
+HsSensor sensorStale("sensor_stale");
+
+HsSensor sensorHeapFreeMin("heap_free_min");
+HsSensor sensorHeapBlockMin("heap_block_min");
+HsSensor sensorHeapFragMax("heap_frag_max");
+HsSensor sensorBootArmed("boot_armed_ms");
+HsSensor sensorResetCause("reset_cause");
+HsSensor sensorLoopStalls("loop_stalls");
 
 HASwitch switchPumpAlarm("pump_alarm");
 HASwitch switchService("service_mode");
 HASwitch switchSound("sound_switch");
 
-void onPumpAlarmCommand(bool state, HASwitch* sender) {
+void onPumpAlarmCommand(bool state, HASwitch*) {
     if (!state) {
         playConfirmationSound();
-        status.pumpSafetyLock = false;
-        switchPumpAlarm.setState(false);
+        controlPostEvent(EV_ALARM_RESET);
     }
 }
 
-void onSoundSwitchCommand(bool state, HASwitch* sender) {
+void onSoundSwitchCommand(bool state, HASwitch*) {
     status.soundEnabled = state;
     config.soundEnabled = state;
     saveConfig();
@@ -34,30 +58,35 @@ void onSoundSwitchCommand(bool state, HASwitch* sender) {
     if (state) playConfirmationSound();
 }
 
-void onServiceSwitchCommand(bool state, HASwitch* sender) {
+void onServiceSwitchCommand(bool state, HASwitch*) {
     playConfirmationSound();
-    status.isServiceMode = state;
     buttonState.lastState = HIGH;
-    switchService.setState(state);
-
-    if (state) {
-        if (status.isPumpActive) {
-            digitalWrite(POMPA_PIN, LOW);
-            status.isPumpActive = false;
-            status.pumpStartTime = 0;
-            sensorPump.setValue("OFF");
-        }
-    } else {
-        status.isPumpDelayActive = false;
-        status.pumpDelayStartTime = 0;
-    }
+    controlPostEvent(state ? EV_SERVICE_ON : EV_SERVICE_OFF);
+    switchService.setState(state);  // Maszyna stanów zawsze przyjmuje zmianę trybu serwisowego
+}
+
+// Jedno wywołanie zwrotne klienta - tematy rozdzielane między moduły
+static void onMqttMessage(const char* topic, const uint8_t* payload, uint16_t length) {
+    if (haDiscoveryMessage(topic, payload, length)) return;
+    if (remoteConfigMessage(topic, payload, length)) return;
+    otaPullMessage(topic, payload, length);
+}
+
+// Wywoływane przez bibliotekę po każdym połączeniu, także gdy zerwanie
+// i ponowne połączenie zmieściły się w jednym mqtt.loop()
+static void onMqttConnected() {
+    haDiscoveryConnected();
+    remoteConfigConnected();
+    otaPullConnected();
 }
 
 void setupHA() {
-    device.setName("HydroSense");
-    device.setModel("HS ESP8266");
-    device.setManufacturer("PMW");
-    device.setSoftwareVersion(SOFTWARE_VERSION);
+    const HaDeviceInfo info = { device.getUniqueId(), "HydroSense", PLATFORM_MODEL, "PMW", SOFTWARE_VERSION };
+    device.setName(info.name);
+    device.setModel(info.model);
+    device.setManufacturer(info.manufacturer);
+    device.setSoftwareVersion(info.swVersion);
+    device.enableExtendedUniqueIds();  // uniq_id przełączników: <urządzenie>_<id>, jak sensory
 
     sensorDistance.setName("Pomiar odległości");
     sensorDistance.setIcon("mdi:ruler");
@@ -81,17 +110,63 @@ void setupHA() {
     sensorWater.setName("Czujnik wody");
     sensorWater.setIcon("mdi:electric-switch");
 
+    sensorPumpFlow.setName("Wydajność pompy");
+    sensorPumpFlow.setIcon("mdi:waves-arrow-right");
+    sensorPumpFlow.setUnitOfMeasurement("L/min");
+
+    sensorPumpFlowTrend.setName("Trend wydajności pompy");
+    sensorPumpFlowTrend.setIcon("mdi:trending-down");
+    sensorPumpFlowTrend.setUnitOfMeasurement("%");
+
+    sensorPumpNoFlow.setName("Pompa nie tłoczy wody");
+    sensorPumpNoFlow.setIcon("mdi:pump-off");
+
+    sensorLeakRate.setName("Ubytek wody w postoju");
+    sensorLeakRate.setIcon("mdi:water-minus");
+    sensorLeakRate.setUnitOfMeasurement("L/d");
+
+    sensorLeak.setName("Wyciek wody");
+    sensorLeak.setIcon("mdi:pipe-leak");
+
     sensorAlarm.setName("Brak wody");
     sensorAlarm.setIcon("mdi:alarm-light");
 
     sensorReserve.setName("Rezerwa wody");
     sensorReserve.setIcon("mdi:alarm-light-outline");
 
+    sensorSignalQuality.setName("Jakość sygnału czujnika");
+    sensorSignalQuality.setIcon("mdi:signal");
+    sensorSignalQuality.setUnitOfMeasurement("%");
+
+    sensorStale.setName("Brak aktualnego pomiaru");
+    sensorStale.setIcon("mdi:timer-alert-outline");
+
+    sensorHeapFreeMin.setName("Min. wolna pamięć");
+    sensorHeapFreeMin.setIcon("mdi:memory");
+    sensorHeapFreeMin.setUnitOfMeasurement("B");
+
+    sensorHeapBlockMin.setName("Min. największy blok pamięci");
+    sensorHeapBlockMin.setIcon("mdi:memory");
+    sensorHeapBlockMin.setUnitOfMeasurement("B");
+
+    sensorHeapFragMax.setName("Maks. fragmentacja pamięci");
+    sensorHeapFragMax.setIcon("mdi:memory");
+    sensorHeapFragMax.setUnitOfMeasurement("%");
+
+    sensorBootArmed.setName("Start: pompa gotowa po");
+    sensorBootArmed.setIcon("mdi:timer-play-outline");
+    sensorBootArmed.setUnitOfMeasurement("ms");
+
+    sensorResetCause.setName("Przyczyna resetu");
+    sensorResetCause.setIcon("mdi:restart-alert");
+
+    sensorLoopStalls.setName("Zawieszenia pętli");
+    sensorLoopStalls.setIcon("mdi:timer-sand-complete");
+
     switchService.setName("Serwis");
     switchService.setIcon("mdi:account-wrench-outline");
     switchService.onCommand(onServiceSwitchCommand);
-    status.isServiceMode = false;
-    switchService.setState(false, true);
+    switchService.setState(pumpIsService(status.pumpState), true);
 
     switchSound.setName("Dźwięk");
     switchSound.setIcon("mdi:volume-high");
@@ -101,4 +176,80 @@ void setupHA() {
     switchPumpAlarm.setName("Alarm pompy");
     switchPumpAlarm.setIcon("mdi:alert");
     switchPumpAlarm.onCommand(onPumpAlarmCommand);
+    switchPumpAlarm.setState(pumpIsLocked(status.pumpState), true);  // Blokada przywrócona po ciepłym restarcie
+
+    haSetJsonState(config.mqtt_json_state);
+    haDiscoveryBegin(info);  // Payloady discovery składane raz, po ustawieniu nazw
+    static const char* const switchIds[] = {
+        switchPumpAlarm.uniqueId(), switchService.uniqueId(), switchSound.uniqueId()
+    };
+    haDiscoveryClearLegacy(switchIds, sizeof(switchIds) / sizeof(switchIds[0]));
+    remoteConfigBegin(info.id);
+    otaPullBegin(info.id);
+    mqtt.setBufferSize(REMOTE_CONFIG_MQTT_BUFFER);  // Dokument konfiguracji w jednym pakiecie
+    mqtt.onMessage(onMqttMessage);
+    mqtt.onConnected(onMqttConnected);
+}
+
+// Polecenia HA bez czekania na MQTT_LOOP_INTERVAL: available() to tylko
+// odczyt długości bufora lwIP, więc sprawdzenie w każdej iteracji nic nie
+// kosztuje. Zdarzenia pompy dostają czas ostatniego sprawdzenia z pustym
+// gniazdem - pakiet przyszedł później, więc opóźnienie w GET /loop ("cmd")
+// obejmuje też czekanie w gnieździe na koniec blokującego etapu pętli.
+void haMqttPoll() {
+    static bool idleSeen = false;
+    static uint32_t idleUs = 0;     // Ostatnie sprawdzenie z pustym gniazdem
+    if (client.available() <= 0 || !mqtt.isConnected()) {
+        idleSeen = true;
+        idleUs = micros();
+        return;
+    }
+    if (!idleSeen) idleUs = micros();   // Dane już przy pierwszym sprawdzeniu
+    loopStage(LS_MQTT);
+    for (uint8_t n = 0; n < MQTT_DRAIN_MAX && client.available() > 0; ++n) {
+        controlCommandReceived(idleUs);
+        mqtt.loop();
+    }
+    controlCommandDone();
+}
+
+void haMqttService(uint64_t nowMs) {
+    if (nowMs - timers.lastMQTTLoop >= MQTT_LOOP_INTERVAL) {
+        loopStage(LS_MQTT);
+        // Bez połączenia mqtt.loop() łączy się sam co 10 s, bez rozrzutu -
+        // próby idą tylko niżej, w terminie z losowym dodatkiem. Zostaje jedna
+        // próba biblioteki, gdy zerwanie wykryje sam loop() (brak odpowiedzi
+        // na keepalive) - te terminy i tak są różne w każdym urządzeniu.
+        if (mqtt.isConnected()) mqtt.loop();
+        loopStage(LS_HA_DISCOVERY);
+        haDiscoveryLoop();  // Discovery i stany sensorów HA (limit bajtów na wywołanie)
+        remoteConfigLoop();  // Dokumenty konfiguracji zdalnej odebrane w mqtt.loop()
+        timers.lastMQTTLoop = nowMs;  // Aktualizacja znacznika czasu ostatniej pętli MQTT
+    }
+
+    static unsigned long mqttRetryJitter = 0;
+    static bool mqttWasConnected = true;    // Nieudane connectMQTT() przy starcie - jak zerwanie
+    bool mqttConnected = mqtt.isConnected();
+    if (mqttConnected != mqttWasConnected) {
+        mqttWasConnected = mqttConnected;
+        if (!mqttConnected) {
+            // Zerwanie połączenia: pierwsza próba też po odstępie z losowym
+            // dodatkiem, inaczej cała flota łączy się naraz po restarcie brokera
+            timers.lastMQTTRetry = nowMs;
+            mqttRetryJitter = platformRandom() % MQTT_RETRY_JITTER;
+        }
+    }
+    if (!mqttConnected &&
+        (nowMs - timers.lastMQTTRetry >= MQTT_RETRY_INTERVAL + mqttRetryJitter)) {
+        timers.lastMQTTRetry = nowMs;                                  // Aktualizacja znacznika czasu ostatniej próby połączenia MQTT
+        mqttRetryJitter = platformRandom() % MQTT_RETRY_JITTER;        // Rozproszenie prób wielu urządzeń
+        LOG_I(LM_MQTT_RETRY);
+        loopStage(LS_MQTT_CONNECT);
+        // begin() na zainicjowanym kliencie nic nie robi, a disconnect() zeruje
+        // też odstęp biblioteki - loop() łączy się od razu
+        mqtt.disconnect();
+        mqtt.begin(config.mqtt_server, config.mqtt_port, config.mqtt_user, config.mqtt_password);
+        mqtt.loop();
+        if (mqtt.isConnected()) DEBUG_PRINT(F("MQTT połączono ponownie!"));
+    }
 }
@@ -4,7 +4,17 @@
 #include <Arduino.h>
 #include <ArduinoHA.h>
 
+const unsigned long MQTT_LOOP_INTERVAL = 100;    // Keepalive i discovery; polecenia od razu (haMqttPoll)
+const uint8_t MQTT_DRAIN_MAX = 16;                 // Pakietów na iterację (mqtt.loop() czyta jeden)
+const unsigned long MQTT_RETRY_INTERVAL = 10000;
+const unsigned long MQTT_RETRY_JITTER = 5000;  // Losowy dodatek do odstępu prób (restart brokera)
+
 void setupHA();
+// Polecenia HA zaraz po nadejściu danych - w każdej iteracji pętli sieci
+void haMqttPoll();
+// Keepalive, discovery i stany co MQTT_LOOP_INTERVAL oraz ponowne łączenie.
+// Ten sam kod obsługuje urządzenia wirtualne symulatora floty (host/fleet).
+void haMqttService(uint64_t nowMs);
 void onPumpAlarmCommand(bool state, HASwitch* sender);
 void onSoundSwitchCommand(bool state, HASwitch* sender);
 void onServiceSwitchCommand(bool state, HASwitch* sender);
@@ -0,0 +1,428 @@
+#include "ha_discovery.h"
+#include <string.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <ArduinoHA.h>
+#include "mono_clock.h"
+#include "globals.h"
+#include "control_task.h"
+#endif
+
+static const char HA_DISCOVERY_PREFIX[] = "homeassistant";
+static const char HA_DATA_PREFIX[] = "aha";
+
+// Rejestr sensorów w kolejności definicji (wskaźniki zerowane przed konstruktorami globalnymi)
+static HsSensor* s_head = nullptr;
+static HsSensor* s_tail = nullptr;
+
+static char s_pool[HA_DISCOVERY_POOL];
+static size_t s_poolUsed = 0;
+static char s_hash[9] = "";
+static bool s_jsonState = false;
+static HaDeviceInfo s_device;
+
+HsSensor::HsSensor(const char* objectId)
+    : _id(objectId), _name(nullptr), _icon(nullptr), _unit(nullptr),
+      _hasValue(false), _dirty(false), _configOffset(0), _configLength(0), _next(nullptr) {
+    _value[0] = '\0';
+#if defined(ARDUINO_ARCH_ESP32)
+    _queued[0] = '\0';
+    _hasQueued = false;
+#endif
+    if (s_tail) s_tail->_next = this; else s_head = this;
+    s_tail = this;
+}
+
+bool HsSensor::setValue(const char* value) {
+    if (!value) return false;
+#if defined(ARDUINO_ARCH_ESP32)
+    if (controlDeferSensor(*this, value)) return true;  // Zadanie sterowania - zapis wykona sieć
+#endif
+    if (_hasValue && strncmp(_value, value, sizeof(_value) - 1) == 0) return true;  // bez zmian
+    strncpy(_value, value, sizeof(_value) - 1);
+    _value[sizeof(_value) - 1] = '\0';
+    _hasValue = true;
+    _dirty = true;
+    return true;
+}
+
+static void appendField(StrBuf& sb, const char* key, const char* value, bool first = false) {
+    if (!first) sbAppendChar(sb, ',');
+    sbAppendChar(sb, '"');
+    sbAppend(sb, key);
+    sbAppend(sb, "\":");
+    sbAppendJsonString(sb, value, strlen(value));
+}
+
+// Klucze skrócone jak w ArduinoHA, dzięki czemu istniejące encje w HA pozostają te same
+void haBuildSensorConfig(StrBuf& sb, const HsSensor& s, const HaDeviceInfo& dev, bool withDevice) {
+    sbAppendChar(sb, '{');
+    appendField(sb, "name", s._name ? s._name : s._id, true);
+    // Jak HADevice::enableExtendedUniqueIds() dla przełączników: <urządzenie>_<id>
+    sbAppend(sb, ",\"uniq_id\":\"");
+    sbAppend(sb, dev.id);
+    sbAppendChar(sb, '_');
+    sbAppend(sb, s._id);
+    sbAppendChar(sb, '"');
+    if (s._icon) appendField(sb, "ic", s._icon);
+    if (s._unit) appendField(sb, "unit_of_meas", s._unit);
+    sbAppend(sb, ",\"stat_t\":\"");
+    if (s_jsonState) {
+        haBuildJsonStateTopic(sb, dev);
+        sbAppend(sb, "\",\"val_tpl\":\"{{value_json.");
+        sbAppend(sb, s._id);
+        sbAppend(sb, "}}");
+    } else {
+        haBuildStateTopic(sb, dev, s._id);
+    }
+    sbAppend(sb, "\",\"dev\":{");
+    appendField(sb, "ids", dev.id, true);
+    if (withDevice) {
+        appendField(sb, "name", dev.name);
+        appendField(sb, "mdl", dev.model);
+        appendField(sb, "mf", dev.manufacturer);
+        appendField(sb, "sw", dev.swVersion);
+    }
+    sbAppend(sb, "}}");
+}
+
+void haBuildStateTopic(StrBuf& sb, const HaDeviceInfo& dev, const char* objectId) {
+    sbAppend(sb, HA_DATA_PREFIX);
+    sbAppendChar(sb, '/');
+    sbAppend(sb, dev.id);
+    sbAppendChar(sb, '/');
+    sbAppend(sb, objectId);
+    sbAppend(sb, "/stat_t");
+}
+
+void haBuildJsonStateTopic(StrBuf& sb, const HaDeviceInfo& dev) {
+    sbAppend(sb, HA_DATA_PREFIX);
+    sbAppendChar(sb, '/');
+    sbAppend(sb, dev.id);
+    sbAppend(sb, "/state");
+}
+
+// Liczba w zapisie JSON (bez wykładnika) - wpisywana bez cudzysłowów
+static bool isJsonNumber(const char* v) {
+    if (*v == '-') v++;
+    if (*v < '0' || *v > '9') return false;
+    if (*v == '0' && v[1] >= '0' && v[1] <= '9') return false;  // wiodące zero
+    while (*v >= '0' && *v <= '9') v++;
+    if (*v == '.') {
+        v++;
+        if (*v < '0' || *v > '9') return false;
+        while (*v >= '0' && *v <= '9') v++;
+    }
+    return *v == '\0';
+}
+
+void haBuildStateDocument(StrBuf& sb) {
+    sbAppendChar(sb, '{');
+    bool first = true;
+    for (HsSensor* s = s_head; s; s = s->_next) {
+        if (!s->_hasValue) continue;
+        if (!first) sbAppendChar(sb, ',');
+        first = false;
+        sbAppendChar(sb, '"');
+        sbAppend(sb, s->_id);
+        sbAppend(sb, "\":");
+        if (isJsonNumber(s->_value)) sbAppend(sb, s->_value);
+        else sbAppendJsonString(sb, s->_value, strlen(s->_value));
+    }
+    sbAppendChar(sb, '}');
+}
+
+void haBuildDiscoveryTopic(StrBuf& sb, const char* component, const char* deviceId, const char* objectId) {
+    sbAppend(sb, HA_DISCOVERY_PREFIX);
+    sbAppendChar(sb, '/');
+    sbAppend(sb, component);
+    sbAppendChar(sb, '/');
+    sbAppend(sb, deviceId);
+    sbAppendChar(sb, '/');
+    sbAppend(sb, objectId);
+    sbAppend(sb, "/config");
+}
+
+void haBuildConfigTopic(StrBuf& sb, const HaDeviceInfo& dev, const char* objectId) {
+    haBuildDiscoveryTopic(sb, "sensor", dev.id, objectId);
+}
+
+static uint32_t fnv1a(uint32_t h, const char* p, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        h ^= (uint8_t)p[i];
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+bool haDiscoveryBuild(const HaDeviceInfo& dev) {
+    StrBuf sb;
+    sbInit(sb, s_pool, sizeof(s_pool));
+    char topicBuf[96];
+    uint32_t h = 2166136261UL;
+    for (HsSensor* s = s_head; s; s = s->_next) {
+        size_t start = sb.len;
+        haBuildSensorConfig(sb, *s, dev, s == s_head);
+        if (sb.overflow) return false;
+        s->_configOffset = (uint16_t)start;
+        s->_configLength = (uint16_t)(sb.len - start);
+        sbAppendChar(sb, '\0');  // każdy payload zakończony zerem w puli
+
+        StrBuf topic;
+        sbInit(topic, topicBuf, sizeof(topicBuf));
+        haBuildConfigTopic(topic, dev, s->_id);
+        h = fnv1a(h, topicBuf, topic.len);
+        h = fnv1a(h, s_pool + start, s->_configLength);
+    }
+    s_poolUsed = sb.len;
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    for (int i = 0; i < 8; ++i) s_hash[i] = HEX_DIGITS[(h >> (28 - 4 * i)) & 0xF];
+    s_hash[8] = '\0';
+    return true;
+}
+
+const char* haDiscoveryHash() { return s_hash; }
+size_t haDiscoveryPoolUsed() { return s_poolUsed; }
+
+void haSetJsonState(bool enabled) {
+    if (s_jsonState == enabled) return;
+    s_jsonState = enabled;
+    // Przed haDiscoveryBegin() urządzenie nie jest jeszcze znane - pula powstanie tam
+    if (s_device.id) haDiscoveryBuild(s_device);
+}
+
+bool haJsonState() { return s_jsonState; }
+
+size_t haPublishPacketSize(size_t topicLen, size_t payloadLen) {
+    size_t remaining = 2 + topicLen + payloadLen;
+    size_t lenBytes = 1;
+    for (size_t r = remaining; r >= 128; r /= 128) lenBytes++;
+    return 1 + lenBytes + remaining;
+}
+
+void haPublishCount(HaPublishStats& st, size_t topicLen, size_t payloadLen) {
+    st.packets++;
+    st.bytes += (uint32_t)haPublishPacketSize(topicLen, payloadLen);
+}
+
+#ifdef ARDUINO
+enum HaPublishPhase : uint8_t {
+    HA_OFFLINE,       // Nowe połączenie z brokerem (haDiscoveryConnected)
+    HA_JITTER,        // Losowe opóźnienie po połączeniu (rozproszenie wielu urządzeń)
+    HA_LEGACY,        // Czyszczenie discovery spod stałego identyfikatora sprzed wersji z MAC
+    HA_WAIT_HASH,     // Oczekiwanie na zachowany skrót konfiguracji
+    HA_CONFIG,        // Publikacja discovery porcjami
+    HA_HASH,          // Zapis nowego skrótu
+    HA_STATES,        // Praca: publikacja zmienionych stanów
+};
+
+static HaPublishPhase s_phase = HA_OFFLINE;
+static uint64_t s_phaseUntil = 0;
+static HsSensor* s_cursor = nullptr;
+static bool s_brokerHashMatches = false;
+static char s_hashTopic[64];
+static char s_topic[96];
+static char s_stateDoc[HA_STATE_DOC_MAX];
+static uint64_t s_nextStateDoc = 0;
+static bool s_stateDocOverflowLogged = false;
+static HaPublishStats s_stats = {};
+static const char* const* s_legacySwitches = nullptr;
+static uint8_t s_legacySwitchCount = 0;
+static uint8_t s_legacyIndex = 0;
+static bool s_legacyPending = false;    // Raz na uruchomienie, po pierwszym połączeniu
+
+bool haDiscoveryMessage(const char* topic, const uint8_t* payload, uint16_t length) {
+    if (strcmp(topic, s_hashTopic) != 0) return false;
+    if (s_phase != HA_WAIT_HASH) return true;
+    s_brokerHashMatches = (length == 8 && memcmp(payload, s_hash, 8) == 0);
+    s_phaseUntil = 0;  // odpowiedź jest - nie czekaj dalej
+    return true;
+}
+
+void haDiscoveryBegin(const HaDeviceInfo& dev) {
+    s_device = dev;
+    if (!haDiscoveryBuild(dev)) {
+        DEBUG_PRINT(F("BŁĄD: pula discovery HA za mała"));
+    }
+    StrBuf sb;
+    sbInit(sb, s_hashTopic, sizeof(s_hashTopic));
+    sbAppend(sb, HA_DATA_PREFIX);
+    sbAppendChar(sb, '/');
+    sbAppend(sb, dev.id);
+    sbAppend(sb, "/disc_hash");
+}
+
+void haDiscoveryClearLegacy(const char* const* switchIds, uint8_t count) {
+    s_legacySwitches = switchIds;
+    s_legacySwitchCount = count;
+    s_legacyIndex = 0;
+    s_legacyPending = strcmp(s_device.id, HA_LEGACY_DEVICE_ID) != 0;
+}
+
+// Pusty zachowany payload usuwa encję z HA i wiadomość z brokera
+static bool publishLegacyClear(const char* component, const char* objectId) {
+    StrBuf sb;
+    sbInit(sb, s_topic, sizeof(s_topic));
+    haBuildDiscoveryTopic(sb, component, HA_LEGACY_DEVICE_ID, objectId);
+    return mqtt.publish(s_topic, "", true);
+}
+
+static void startHashWait(uint64_t now) {
+    s_brokerHashMatches = false;
+    mqtt.subscribe(s_hashTopic);
+    s_phaseUntil = now + HA_HASH_WAIT_MS;
+    s_phase = HA_WAIT_HASH;
+}
+
+static bool publishConfig(HsSensor* s) {
+    StrBuf sb;
+    sbInit(sb, s_topic, sizeof(s_topic));
+    haBuildConfigTopic(sb, s_device, s->_id);
+    if (!mqtt.beginPublish(s_topic, s->_configLength, true)) return false;
+    mqtt.writePayload(s_pool + s->_configOffset, s->_configLength);
+    return mqtt.endPublish();
+}
+
+static bool publishState(HsSensor* s) {
+    StrBuf sb;
+    sbInit(sb, s_topic, sizeof(s_topic));
+    haBuildStateTopic(sb, s_device, s->_id);
+    if (!mqtt.publish(s_topic, s->_value, true)) return false;
+    haPublishCount(s_stats, sb.len, strlen(s->_value));
+    return true;
+}
+
+// Tryb JSON: jeden dokument ze wszystkimi stanami, gdy którykolwiek się zmienił
+static size_t publishStateDocument(uint64_t now) {
+    bool dirty = false;
+    for (HsSensor* s = s_head; s; s = s->_next) dirty |= s->_dirty;
+    if (!dirty || now < s_nextStateDoc) return 0;
+
+    StrBuf doc;
+    sbInit(doc, s_stateDoc, sizeof(s_stateDoc));
+    haBuildStateDocument(doc);
+    if (doc.overflow) {
+        // Błąd zgłaszany raz; kolejna próba dopiero po HA_STATE_DOC_RETRY_MS,
+        // zamiast budować dokument w każdej iteracji pętli
+        if (!s_stateDocOverflowLogged) DEBUG_PRINT(F("BŁĄD: dokument stanów HA za duży"));
+        s_stateDocOverflowLogged = true;
+        s_nextStateDoc = now + HA_STATE_DOC_RETRY_MS;
+        return 0;
+    }
+    s_stateDocOverflowLogged = false;
+    StrBuf topic;
+    sbInit(topic, s_topic, sizeof(s_topic));
+    haBuildJsonStateTopic(topic, s_device);
+    if (!mqtt.publish(s_topic, s_stateDoc, true)) return 0;
+    haPublishCount(s_stats, topic.len, doc.len);
+    for (HsSensor* s = s_head; s; s = s->_next) s->_dirty = false;
+    s_nextStateDoc = now + HA_STATE_DOC_MIN_MS;
+    return doc.len;
+}
+
+void haDiscoveryConnected() {
+    s_phase = HA_OFFLINE;
+}
+
+// Wywoływane cyklicznie z pętli głównej; wysyła co najwyżej HA_PUBLISH_BUDGET bajtów
+// (zawsze przynajmniej jedną wiadomość), więc pętla nigdy nie stoi na MQTT
+
+void haDiscoveryLoop() {
+    if (!mqtt.isConnected()) return;
+
+    uint64_t now = millis64();
+    size_t spent = 0;
+
+    switch (s_phase) {
+        case HA_OFFLINE:
+            // Nowe połączenie - po opóźnieniu wszystkie znane stany idą ponownie
+            for (HsSensor* s = s_head; s; s = s->_next) s->_dirty = s->_hasValue;
+            s_phaseUntil = now + platformRandom() % HA_CONNECT_JITTER_MS;
+            s_phase = HA_JITTER;
+            break;
+
+        case HA_JITTER:
+            if (now < s_phaseUntil) break;
+            if (s_legacyPending) {
+                s_cursor = s_head;
+                s_legacyIndex = 0;
+                s_phase = HA_LEGACY;
+                break;
+            }
+            startHashWait(now);
+            break;
+
+        case HA_LEGACY:
+            while (s_cursor && spent < HA_PUBLISH_BUDGET) {
+                if (!publishLegacyClear("sensor", s_cursor->_id)) return;
+                spent += strlen(s_topic);
+                s_cursor = s_cursor->_next;
+            }
+            while (!s_cursor && s_legacyIndex < s_legacySwitchCount && spent < HA_PUBLISH_BUDGET) {
+                if (!publishLegacyClear("switch", s_legacySwitches[s_legacyIndex])) return;
+                spent += strlen(s_topic);
+                s_legacyIndex++;
+            }
+            if (s_cursor || s_legacyIndex < s_legacySwitchCount) break;
+            s_legacyPending = false;
+            startHashWait(now);
+            break;
+
+        case HA_WAIT_HASH:
+            if (now < s_phaseUntil) break;
+            if (s_brokerHashMatches) {
+                DEBUG_PRINT(F("Discovery HA aktualne - pomijam"));
+                s_phase = HA_STATES;
+            } else {
+                s_cursor = s_head;
+                s_phase = HA_CONFIG;
+            }
+            break;
+
+        case HA_CONFIG:
+            while (s_cursor && spent < HA_PUBLISH_BUDGET) {
+                if (!publishConfig(s_cursor)) return;
+                spent += s_cursor->_configLength;
+                s_cursor = s_cursor->_next;
+            }
+            if (!s_cursor) s_phase = HA_HASH;
+            break;
+
+        case HA_HASH:
+            if (mqtt.publish(s_hashTopic, s_hash, true)) s_phase = HA_STATES;
+            break;
+
+        case HA_STATES:
+            if (s_jsonState) {
+                publishStateDocument(now);
+                break;
+            }
+            for (HsSensor* s = s_head; s && spent < HA_PUBLISH_BUDGET; s = s->_next) {
+                if (!s->_dirty) continue;
+                if (!publishState(s)) return;
+                s->_dirty = false;
+                spent += strlen(s->_value) + strlen(s_topic);
+            }
+            break;
+    }
+}
+
+void handleMqttStats() {
+    if (server.arg("reset") == "1") {
+        s_stats = HaPublishStats();
+        server.send(200, "application/json", "{\"status\":\"ok\"}");
+        return;
+    }
+    static char out[96];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    sbAppend(sb, "{\"mode\":\"");
+    sbAppend(sb, s_jsonState ? "json" : "topics");
+    sbAppend(sb, "\",\"state_packets\":");
+    sbAppendUInt(sb, s_stats.packets);
+    sbAppend(sb, ",\"state_bytes\":");
+    sbAppendUInt(sb, s_stats.bytes);
+    sbAppendChar(sb, '}');
+    server.send(200, "application/json", out);
+}
+#endif
@@ -0,0 +1,116 @@
+#ifndef HA_DISCOVERY_H
+#define HA_DISCOVERY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "strbuf.h"
+
+// Własna publikacja sensorów Home Assistant (zamiast HASensor z ArduinoHA).
+// Konfiguracje discovery są składane raz do statycznej puli, a po połączeniu
+// z brokerem publikowane porcjami w kolejnych iteracjach pętli, z losowym
+// opóźnieniem startu. Gdy zachowany (retained) skrót konfiguracji na brokerze
+// zgadza się z bieżącym, discovery jest pomijane. Stany trafiają do kolejki
+// (flaga dirty) i wysyłane są w tym samym limicie bajtów.
+//
+// Tryb JSON (config.mqtt_json_state): zamiast osobnej wiadomości na sensor
+// wszystkie stany trafiają jednym dokumentem na wspólny temat
+// aha/<urządzenie>/state, a discovery wskazuje pole przez value_template.
+
+const size_t HA_VALUE_MAX = 24;               // Maks. długość wartości stanu
+const size_t HA_DISCOVERY_POOL = 6656;        // Pula na payloady discovery (~230 B na encję)
+const size_t HA_PUBLISH_BUDGET = 512;         // Bajty na jedno wywołanie haDiscoveryLoop()
+const uint32_t HA_CONNECT_JITTER_MS = 5000;   // Maks. losowe opóźnienie po połączeniu
+const uint32_t HA_HASH_WAIT_MS = 1500;        // Czas oczekiwania na zachowany skrót
+const size_t HA_STATE_DOC_MAX = 896;          // Dokument stanów w trybie JSON (21 encji z wartościami HA_VALUE_MAX - 1 = 849 B)
+const uint32_t HA_STATE_DOC_MIN_MS = 500;     // Łączenie zmian z jednej iteracji pomiarowej w jeden dokument
+const uint32_t HA_STATE_DOC_RETRY_MS = 60000; // Ponowna próba po przepełnieniu dokumentu stanów
+// Stały identyfikator urządzenia sprzed identyfikatora z adresu MAC
+const char HA_LEGACY_DEVICE_ID[] = "HydroSense";
+
+class HsSensor {
+public:
+    // Tylko obiekty globalne - konstruktor dopisuje sensor do rejestru publikacji
+    explicit HsSensor(const char* objectId);
+    HsSensor(const HsSensor&) = delete;
+    HsSensor& operator=(const HsSensor&) = delete;
+
+    void setName(const char* name) { _name = name; }
+    void setIcon(const char* icon) { _icon = icon; }
+    void setUnitOfMeasurement(const char* unit) { _unit = unit; }
+    // Zapamiętuje wartość i kolejkuje publikację (tylko przy zmianie)
+    bool setValue(const char* value);
+
+    const char* objectId() const { return _id; }
+    const char* value() const { return _value; }
+
+    // Stan wewnętrzny - używany przez ha_discovery.cpp
+    const char* _id;
+    const char* _name;
+    const char* _icon;
+    const char* _unit;
+    char _value[HA_VALUE_MAX];
+    bool _hasValue;
+    bool _dirty;
+#if defined(ARDUINO_ARCH_ESP32)
+    char _queued[HA_VALUE_MAX]; // Ostatnia wartość odłożona przez zadanie sterowania (tylko ono ją zmienia)
+    bool _hasQueued;
+#endif
+    uint16_t _configOffset;     // Położenie payloadu discovery w puli
+    uint16_t _configLength;
+    HsSensor* _next;
+};
+
+struct HaDeviceInfo {
+    const char* id;             // Identyfikator urządzenia (jak w HADevice)
+    const char* name;
+    const char* model;
+    const char* manufacturer;
+    const char* swVersion;
+};
+
+// Payload discovery jednego sensora; pełny opis urządzenia tylko gdy withDevice
+void haBuildSensorConfig(StrBuf& sb, const HsSensor& s, const HaDeviceInfo& dev, bool withDevice);
+// Temat stanu sensora (zgodny z ArduinoHA: aha/<urządzenie>/<id>/stat_t)
+void haBuildStateTopic(StrBuf& sb, const HaDeviceInfo& dev, const char* objectId);
+void haBuildConfigTopic(StrBuf& sb, const HaDeviceInfo& dev, const char* objectId);
+// homeassistant/<component>/<urządzenie>/<id>/config
+void haBuildDiscoveryTopic(StrBuf& sb, const char* component, const char* deviceId, const char* objectId);
+// Wspólny temat stanów w trybie JSON (aha/<urządzenie>/state)
+void haBuildJsonStateTopic(StrBuf& sb, const HaDeviceInfo& dev);
+// Dokument stanów: {"<id>":wartość,...}; liczby bez cudzysłowów, sensory bez wartości pominięte
+void haBuildStateDocument(StrBuf& sb);
+
+// Tryb publikacji stanów; zmiana przebudowuje payloady discovery (inny skrót)
+void haSetJsonState(bool enabled);
+bool haJsonState();
+
+// Ruch MQTT stanów (PUBLISH QoS 0: nagłówek stały + długość tematu + temat + payload)
+struct HaPublishStats {
+    uint32_t packets;
+    uint32_t bytes;
+};
+size_t haPublishPacketSize(size_t topicLen, size_t payloadLen);
+void haPublishCount(HaPublishStats& st, size_t topicLen, size_t payloadLen);
+
+// Składa wszystkie payloady do puli i liczy skrót; false gdy pula za mała
+bool haDiscoveryBuild(const HaDeviceInfo& dev);
+// Skrót konfiguracji (FNV-1a, 8 znaków hex + NUL)
+const char* haDiscoveryHash();
+size_t haDiscoveryPoolUsed();
+
+#ifdef ARDUINO
+void haDiscoveryBegin(const HaDeviceInfo& dev);
+// Po haDiscoveryBegin(): po pierwszym połączeniu publikuje puste zachowane
+// konfiguracje pod HA_LEGACY_DEVICE_ID (sensory i podane przełączniki), żeby
+// HA nie trzymał starych encji z tym samym uniq_id. Bez działania, gdy
+// urządzenie nadal ma stary identyfikator.
+void haDiscoveryClearLegacy(const char* const* switchIds, uint8_t count);
+// Nowe połączenie (HAMqtt::onConnected) - discovery i stany od początku
+void haDiscoveryConnected();
+void haDiscoveryLoop();
+// Wiadomość MQTT (wywołanie zwrotne w ha.cpp); true gdy temat skrótu discovery
+bool haDiscoveryMessage(const char* topic, const uint8_t* payload, uint16_t length);
+void handleMqttStats();     // GET /mqtt[?reset=1] - pakiety i bajty stanów
+#endif
+
+#endif // HA_DISCOVERY_H
@@ -0,0 +1,52 @@
+#include "heap_stats.h"
+#include "globals.h"
+#include "strbuf.h"
+
+HeapStats heapStats = {0, UINT32_MAX, 0, UINT32_MAX, 0, 0};
+
+// Odczytaj stan sterty i zaktualizuj najgorsze wartości
+void heapStatsUpdate() {
+    uint32_t freeHeap = 0;
+    uint32_t maxBlock = 0;
+    uint8_t frag = 0;
+    platformHeapStats(&freeHeap, &maxBlock, &frag);
+
+    heapStats.freeHeap = freeHeap;
+    heapStats.maxFreeBlock = maxBlock;
+    heapStats.fragmentation = frag;
+    if (freeHeap < heapStats.minFreeHeap) heapStats.minFreeHeap = freeHeap;
+    if (maxBlock < heapStats.minMaxFreeBlock) heapStats.minMaxFreeBlock = maxBlock;
+    if (frag > heapStats.maxFragmentation) heapStats.maxFragmentation = frag;
+}
+
+// Wyślij najgorsze wartości do Home Assistant
+void heapStatsPublish() {
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%lu", (unsigned long)heapStats.minFreeHeap);
+    sensorHeapFreeMin.setValue(buf);
+    snprintf(buf, sizeof(buf), "%lu", (unsigned long)heapStats.minMaxFreeBlock);
+    sensorHeapBlockMin.setValue(buf);
+    snprintf(buf, sizeof(buf), "%u", heapStats.maxFragmentation);
+    sensorHeapFragMax.setValue(buf);
+}
+
+// GET /heap - bieżący stan sterty i najgorsze wartości od startu
+void handleHeapStats() {
+    static char out[192];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    sbAppend(sb, "{\"free\":");
+    sbAppendUInt(sb, heapStats.freeHeap);
+    sbAppend(sb, ",\"free_min\":");
+    sbAppendUInt(sb, heapStats.minFreeHeap);
+    sbAppend(sb, ",\"max_block\":");
+    sbAppendUInt(sb, heapStats.maxFreeBlock);
+    sbAppend(sb, ",\"max_block_min\":");
+    sbAppendUInt(sb, heapStats.minMaxFreeBlock);
+    sbAppend(sb, ",\"frag\":");
+    sbAppendUInt(sb, heapStats.fragmentation);
+    sbAppend(sb, ",\"frag_max\":");
+    sbAppendUInt(sb, heapStats.maxFragmentation);
+    sbAppendChar(sb, '}');
+    server.send(200, "application/json", out);
+}
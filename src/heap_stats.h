@@ -0,0 +1,22 @@
+#ifndef HEAP_STATS_H
+#define HEAP_STATS_H
+
+#include <Arduino.h>
+
+// Stan sterty z najgorszymi wartościami od startu (low-water marks)
+struct HeapStats {
+    uint32_t freeHeap;
+    uint32_t minFreeHeap;
+    uint32_t maxFreeBlock;
+    uint32_t minMaxFreeBlock;
+    uint8_t fragmentation;
+    uint8_t maxFragmentation;
+};
+
+extern HeapStats heapStats;
+
+void heapStatsUpdate();
+void heapStatsPublish();
+void handleHeapStats();
+
+#endif // HEAP_STATS_H
@@ -0,0 +1,197 @@
+#include "http_stream.h"
+#include <string.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "globals.h"
+#include "mono_clock.h"
+#else
+#define pgm_read_byte(addr) (*(const uint8_t*)(addr))
+#endif
+
+void tplBegin(TplStream& s, const char* tplProgmem, TplResolver resolve) {
+    memset(&s, 0, sizeof(s));
+    s.tpl = tplProgmem;
+    s.resolve = resolve;
+}
+
+static char valueAt(const TplValue& v, size_t i) {
+    return v.progmem ? (char)pgm_read_byte(v.text + i) : v.text[i];
+}
+
+static const char* htmlEntity(char c) {
+    switch (c) {
+        case '&': return "&amp;";
+        case '<': return "&lt;";
+        case '>': return "&gt;";
+        case '"': return "&quot;";
+        case '\'': return "&#39;";
+        default: return NULL;
+    }
+}
+
+// Długość znacznika %NAZWA% zaczynającego się na pos (0 = to zwykły znak %)
+static size_t placeholderLen(const char* tpl, size_t pos) {
+    for (size_t i = 1; i <= TPL_NAME_MAX + 1; ++i) {
+        char c = (char)pgm_read_byte(tpl + pos + i);
+        if (c == '%') return i > 1 ? i + 1 : 0;
+        if (!((c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_')) return 0;
+    }
+    return 0;
+}
+
+size_t tplRead(TplStream& s, char* out, size_t cap) {
+    size_t n = 0;
+    while (n < cap) {
+        if (s.inValue) {
+            char c = valueAt(s.value, s.valuePos);
+            if (!c) { s.inValue = false; continue; }
+            const char* ent = s.value.escape ? htmlEntity(c) : NULL;
+            if (ent) {
+                size_t el = strlen(ent);
+                if (n + el > cap) break;    // Encja w następnej porcji
+                memcpy(out + n, ent, el);
+                n += el;
+            } else {
+                out[n++] = c;
+            }
+            s.valuePos++;
+            continue;
+        }
+
+        char c = (char)pgm_read_byte(s.tpl + s.pos);
+        if (!c) break;
+        if (c == '%') {
+            size_t len = placeholderLen(s.tpl, s.pos);
+            if (len) {
+                char name[TPL_NAME_MAX + 1];
+                for (size_t i = 0; i < len - 2; ++i) name[i] = (char)pgm_read_byte(s.tpl + s.pos + 1 + i);
+                name[len - 2] = '\0';
+                TplValue v = s.resolve ? s.resolve(name, len - 2, s.scratch, sizeof(s.scratch)) : TplValue{NULL, false, false};
+                if (v.text) {
+                    s.pos += len;
+                    s.value = v;
+                    s.valuePos = 0;
+                    s.inValue = true;
+                    continue;
+                }
+            }
+        }
+        out[n++] = c;
+        s.pos++;
+    }
+    return n;
+}
+
+size_t httpChunkFrame(char* buf, size_t len, size_t* frameLen) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    char hex[4];
+    size_t digits = 0;
+    size_t v = len;
+    do {
+        hex[digits++] = HEX_DIGITS[v & 0xF];
+        v >>= 4;
+    } while (v && digits < sizeof(hex));
+
+    size_t start = HTTP_CHUNK_HEAD - digits - 2;
+    for (size_t i = 0; i < digits; ++i) buf[start + i] = hex[digits - 1 - i];
+    buf[HTTP_CHUNK_HEAD - 2] = '\r';
+    buf[HTTP_CHUNK_HEAD - 1] = '\n';
+    buf[HTTP_CHUNK_HEAD + len] = '\r';
+    buf[HTTP_CHUNK_HEAD + len + 1] = '\n';
+    *frameLen = HTTP_CHUNK_HEAD - start + len + 2;   // Dla len == 0: "0\r\n\r\n"
+    return start;
+}
+
+#ifdef ARDUINO
+struct HttpStreamSlot {
+    WiFiClient client;
+    bool active;
+    bool finished;          // Wygenerowano fragment kończący
+    TplStream tpl;
+    char buf[HTTP_CHUNK_HEAD + HTTP_CHUNK_DATA + 2];
+    size_t pendingPos;      // Niewysłana część ramki w buf
+    size_t pendingEnd;
+    uint64_t lastProgress;
+};
+
+static HttpStreamSlot slots[HTTP_STREAM_SLOTS];
+static uint8_t nextSlot = 0;    // Kolejność obsługi - każde połączenie dostaje swoją kolej
+
+// Bez stop(): stop() czeka na potwierdzenie wysłanych danych. Połączenie
+// zamyka stos TCP po zwolnieniu ostatniej referencji (także przez serwer).
+static void releaseSlot(HttpStreamSlot& s) {
+    s.client = WiFiClient();
+    s.active = false;
+}
+
+bool httpStreamBegin(const char* contentType, const char* tplProgmem, TplResolver resolve) {
+    for (uint8_t i = 0; i < HTTP_STREAM_SLOTS; ++i) {
+        HttpStreamSlot& s = slots[i];
+        if (s.active) continue;
+        s.client = server.client();
+        s.active = true;
+        s.finished = false;
+        s.lastProgress = millis64();
+        tplBegin(s.tpl, tplProgmem, resolve);
+        // Nagłówki też przechodzą przez budżet - pierwsza porcja w buf
+        int n = snprintf(s.buf, sizeof(s.buf),
+                         "HTTP/1.1 200 OK\r\nContent-Type: %s\r\nTransfer-Encoding: chunked\r\n"
+                         "Cache-Control: no-store\r\nConnection: close\r\n\r\n", contentType);
+        s.pendingPos = 0;
+        s.pendingEnd = (n > 0 && (size_t)n < sizeof(s.buf)) ? (size_t)n : 0;
+        return true;
+    }
+    return false;
+}
+
+// Wysyła z jednego połączenia co najwyżej budget bajtów; zwraca wysłane
+static size_t serviceSlot(HttpStreamSlot& s, size_t budget, uint64_t now) {
+    if (!s.client.connected() || now - s.lastProgress > HTTP_STREAM_TIMEOUT_MS) {
+        releaseSlot(s);
+        return 0;
+    }
+
+    size_t sent = 0;
+    while (sent < budget) {
+        if (s.pendingPos == s.pendingEnd) {
+            if (s.finished) {
+                releaseSlot(s);     // Cała odpowiedź w buforze TCP
+                break;
+            }
+            size_t len = tplRead(s.tpl, s.buf + HTTP_CHUNK_HEAD, HTTP_CHUNK_DATA);
+            size_t frameLen = 0;
+            s.pendingPos = httpChunkFrame(s.buf, len, &frameLen);
+            s.pendingEnd = s.pendingPos + frameLen;
+            s.finished = (len == 0);
+        }
+        // Tylko tyle, ile stos TCP przyjmie od razu - write() nie czeka na ACK
+        size_t room = platformClientRoom(s.client);
+        size_t n = s.pendingEnd - s.pendingPos;
+        if (n > room) n = room;
+        if (n > budget - sent) n = budget - sent;
+        if (n == 0) break;
+        n = s.client.write((const uint8_t*)s.buf + s.pendingPos, n);
+        if (n == 0) break;
+        s.pendingPos += n;
+        sent += n;
+        s.lastProgress = now;
+    }
+    return sent;
+}
+
+void httpStreamLoop() {
+    uint64_t now = millis64();
+    size_t budget = HTTP_STREAM_BUDGET;
+    for (uint8_t k = 0; k < HTTP_STREAM_SLOTS && budget > 0; ++k) {
+        HttpStreamSlot& s = slots[(nextSlot + k) % HTTP_STREAM_SLOTS];
+        if (s.active) budget -= serviceSlot(s, budget, now);
+    }
+    nextSlot = (nextSlot + 1) % HTTP_STREAM_SLOTS;
+}
+
+uint8_t httpStreamActive() {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < HTTP_STREAM_SLOTS; ++i) n += slots[i].active ? 1 : 0;
+    return n;
+}
+#endif
@@ -0,0 +1,59 @@
+#ifndef HTTP_STREAM_H
+#define HTTP_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Strumieniowe odpowiedzi HTTP. Treść produkuje wznawialny generator
+// (szablon w PROGMEM z podstawianiem %NAZWA%), a pula połączeń wysyła co
+// najwyżej HTTP_STREAM_BUDGET bajtów na iterację loop(), bez blokowania
+// na potwierdzeniach TCP. Część szablonowa nie zależy od Arduino.
+
+const uint8_t HTTP_STREAM_SLOTS = 3;        // Jednocześnie obsługiwane odpowiedzi
+const size_t HTTP_STREAM_BUDGET = 1024;     // Bajty na iterację loop() (wszystkie połączenia)
+const size_t HTTP_CHUNK_DATA = 256;         // Dane w jednym fragmencie chunked
+const uint32_t HTTP_STREAM_TIMEOUT_MS = 5000;   // Brak postępu = zerwane połączenie
+const size_t TPL_NAME_MAX = 32;             // Najdłuższa nazwa znacznika
+const size_t TPL_MIN_READ = 8;              // Minimalny bufor tplRead (najdłuższa encja HTML)
+
+// Wartość znacznika: tekst w RAM lub PROGMEM, opcjonalnie z zamianą & < > " ' na encje
+struct TplValue {
+    const char* text;       // NULL = nieznany znacznik (zostaje w treści bez zmian)
+    bool progmem;
+    bool escape;
+};
+
+// scratch (TPL_SCRATCH bajtów) na wartości wyliczane, np. liczby
+const size_t TPL_SCRATCH = 24;
+typedef TplValue (*TplResolver)(const char* name, size_t len, char* scratch, size_t cap);
+
+struct TplStream {
+    const char* tpl;        // Szablon w PROGMEM
+    size_t pos;
+    TplResolver resolve;
+    TplValue value;         // Bieżąco wstawiana wartość
+    size_t valuePos;
+    bool inValue;
+    char scratch[TPL_SCRATCH];
+};
+
+void tplBegin(TplStream& s, const char* tplProgmem, TplResolver resolve);
+// Kolejna porcja treści (cap >= TPL_MIN_READ); 0 = koniec
+size_t tplRead(TplStream& s, char* out, size_t cap);
+
+// Ramka fragmentu chunked: "<hex>\r\n" przed danymi i "\r\n" za nimi.
+// data leży w buf od HTTP_CHUNK_HEAD; zwraca przesunięcie początku ramki w buf,
+// a *frameLen długość całej ramki. len == 0 daje fragment kończący.
+const size_t HTTP_CHUNK_HEAD = 6;           // Do 4 cyfr hex + CRLF
+size_t httpChunkFrame(char* buf, size_t len, size_t* frameLen);
+
+#ifdef ARDUINO
+// Przejęcie bieżącego żądania serwera HTTP; false = brak wolnego miejsca
+// (handler powinien wtedy odpowiedzieć 503)
+bool httpStreamBegin(const char* contentType, const char* tplProgmem, TplResolver resolve);
+// Wysyłka kolejnych porcji w ramach budżetu - wywoływane w każdej iteracji loop()
+void httpStreamLoop();
+uint8_t httpStreamActive();
+#endif
+
+#endif // HTTP_STREAM_H
@@ -0,0 +1,166 @@
+#include "json_flat.h"
+#include <string.h>
+#include <limits.h>
+
+static size_t skipWs(const char* p, size_t i, size_t len) {
+    while (i < len && (p[i] == ' ' || p[i] == '\t' || p[i] == '\r' || p[i] == '\n')) i++;
+    return i;
+}
+
+// Pozycja za zamykającym cudzysłowem albo 0 przy błędzie; i wskazuje na otwierający
+static size_t scanString(const char* p, size_t i, size_t len) {
+    for (++i; i < len; ++i) {
+        if (p[i] == '\\') { i++; continue; }
+        if (p[i] == '"') return i + 1;
+        if ((uint8_t)p[i] < 0x20) return 0;
+    }
+    return 0;
+}
+
+// Pomija zagnieżdżony obiekt/tablicę (dla JSON_UNSUPPORTED); 0 przy błędzie
+static size_t skipNested(const char* p, size_t i, size_t len) {
+    int depth = 0;
+    while (i < len) {
+        char c = p[i];
+        if (c == '"') {
+            i = scanString(p, i, len);
+            if (!i) return 0;
+            continue;
+        }
+        if (c == '{' || c == '[') depth++;
+        else if (c == '}' || c == ']') {
+            if (--depth == 0) return i + 1;
+        }
+        i++;
+    }
+    return 0;
+}
+
+static bool matchWord(const char* p, size_t i, size_t len, const char* word) {
+    size_t n = strlen(word);
+    return i + n <= len && memcmp(p + i, word, n) == 0;
+}
+
+size_t jsonFlatParse(const char* p, size_t len, JsonPairCallback cb, void* ctx) {
+    size_t i = skipWs(p, 0, len);
+    if (i >= len || p[i] != '{') return i + 1;
+    i = skipWs(p, i + 1, len);
+    if (i < len && p[i] == '}') return skipWs(p, i + 1, len) == len ? 0 : i + 2;
+
+    while (i < len) {
+        if (p[i] != '"') return i + 1;
+        size_t keyEnd = scanString(p, i, len);
+        if (!keyEnd) return i + 1;
+        const char* key = p + i + 1;
+        size_t keyLen = keyEnd - i - 2;
+
+        i = skipWs(p, keyEnd, len);
+        if (i >= len || p[i] != ':') return i + 1;
+        i = skipWs(p, i + 1, len);
+        if (i >= len) return i + 1;
+
+        JsonValue v;
+        memset(&v, 0, sizeof(v));
+        char c = p[i];
+        if (c == '"') {
+            size_t end = scanString(p, i, len);
+            if (!end) return i + 1;
+            v.type = JSON_STRING;
+            v.raw = p + i + 1;
+            v.rawLen = end - i - 2;
+            i = end;
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            bool neg = (c == '-');
+            size_t j = neg ? i + 1 : i;
+            if (j >= len || p[j] < '0' || p[j] > '9') return j + 1;
+            long value = 0;
+            bool overflow = false;
+            for (; j < len && p[j] >= '0' && p[j] <= '9'; ++j) {
+                if (value > (LONG_MAX - (p[j] - '0')) / 10) overflow = true;
+                else value = value * 10 + (p[j] - '0');
+            }
+            v.type = JSON_INT;
+            if (j < len && (p[j] == '.' || p[j] == 'e' || p[j] == 'E')) {
+                v.type = JSON_UNSUPPORTED;
+                while (j < len && (strchr("0123456789.eE+-", p[j]) != NULL)) j++;
+            }
+            if (overflow) v.type = JSON_UNSUPPORTED;
+            v.integer = neg ? -value : value;
+            i = j;
+        } else if (matchWord(p, i, len, "true")) {
+            v.type = JSON_BOOL; v.boolean = true; i += 4;
+        } else if (matchWord(p, i, len, "false")) {
+            v.type = JSON_BOOL; v.boolean = false; i += 5;
+        } else if (matchWord(p, i, len, "null")) {
+            v.type = JSON_NULL; i += 4;
+        } else if (c == '{' || c == '[') {
+            size_t end = skipNested(p, i, len);
+            if (!end) return i + 1;
+            v.type = JSON_UNSUPPORTED;
+            i = end;
+        } else {
+            return i + 1;
+        }
+
+        cb(key, keyLen, v, ctx);
+
+        i = skipWs(p, i, len);
+        if (i >= len) return i + 1;
+        if (p[i] == '}') return skipWs(p, i + 1, len) == len ? 0 : i + 2;
+        if (p[i] != ',') return i + 1;
+        i = skipWs(p, i + 1, len);
+    }
+    return len + 1;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+int jsonUnescape(const char* raw, size_t rawLen, char* out, size_t cap) {
+    if (cap == 0) return -1;
+    size_t o = 0;
+    for (size_t i = 0; i < rawLen; ++i) {
+        char c = raw[i];
+        char buf[3];
+        size_t n = 1;
+        buf[0] = c;
+        if (c == '\\') {
+            if (++i >= rawLen) return -1;
+            switch (raw[i]) {
+                case '"': buf[0] = '"'; break;
+                case '\\': buf[0] = '\\'; break;
+                case '/': buf[0] = '/'; break;
+                case 'b': buf[0] = '\b'; break;
+                case 'f': buf[0] = '\f'; break;
+                case 'n': buf[0] = '\n'; break;
+                case 'r': buf[0] = '\r'; break;
+                case 't': buf[0] = '\t'; break;
+                case 'u': {
+                    if (i + 4 >= rawLen) return -1;
+                    unsigned cp = 0;
+                    for (int k = 1; k <= 4; ++k) {
+                        int h = hexValue(raw[i + k]);
+                        if (h < 0) return -1;
+                        cp = (cp << 4) | (unsigned)h;
+                    }
+                    i += 4;
+                    if (cp == 0 || (cp >= 0xD800 && cp <= 0xDFFF)) return -1;  // bez par zastępczych
+                    if (cp < 0x80) { buf[0] = (char)cp; }
+                    else if (cp < 0x800) { buf[0] = (char)(0xC0 | (cp >> 6)); buf[1] = (char)(0x80 | (cp & 0x3F)); n = 2; }
+                    else { buf[0] = (char)(0xE0 | (cp >> 12)); buf[1] = (char)(0x80 | ((cp >> 6) & 0x3F)); buf[2] = (char)(0x80 | (cp & 0x3F)); n = 3; }
+                    break;
+                }
+                default: return -1;
+            }
+        }
+        if (o + n >= cap) return -1;
+        memcpy(out + o, buf, n);
+        o += n;
+    }
+    out[o] = '\0';
+    return (int)o;
+}
@@ -0,0 +1,38 @@
+#ifndef JSON_FLAT_H
+#define JSON_FLAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Parser płaskich obiektów JSON ({"klucz": wartość, ...}) bez alokacji.
+// Wartości: liczby całkowite, true/false, null i łańcuchy. Zagnieżdżone
+// obiekty/tablice oraz liczby ułamkowe są zgłaszane jako błąd typu pola
+// (JSON_UNSUPPORTED), a nie całego dokumentu.
+
+enum JsonValueType : uint8_t {
+    JSON_NULL,
+    JSON_BOOL,
+    JSON_INT,
+    JSON_STRING,
+    JSON_UNSUPPORTED,
+};
+
+struct JsonValue {
+    JsonValueType type;
+    bool boolean;
+    long integer;
+    const char* raw;        // Łańcuch bez cudzysłowów (jeszcze z sekwencjami \)
+    size_t rawLen;
+};
+
+// Wywoływane dla każdej pary; klucz nie jest zakończony zerem
+typedef void (*JsonPairCallback)(const char* key, size_t keyLen, const JsonValue& value, void* ctx);
+
+// Zwraca 0 albo pozycję (1..len) pierwszego błędu składni
+size_t jsonFlatParse(const char* json, size_t len, JsonPairCallback cb, void* ctx);
+
+// Dekoduje łańcuch (\" \\ \/ \b \f \n \r \t \uXXXX -> UTF-8) do out z zerem na końcu.
+// Zwraca długość albo -1, gdy nie mieści się w cap lub sekwencja jest błędna.
+int jsonUnescape(const char* raw, size_t rawLen, char* out, size_t cap);
+
+#endif // JSON_FLAT_H
@@ -0,0 +1,101 @@
+#include "leak_detect.h"
+#include <math.h>
+#include <string.h>
+
+static const float MS_PER_HOUR = 3600000.0f;
+
+void leakReset(LeakDetector& l) {
+    memset(&l, 0, sizeof(l));
+}
+
+// Zamknięcie odcinka: do sum wspólnych trafia tylko zmienność wewnątrz odcinka
+static void closeSegment(LeakDetector& l) {
+    if (l.w > 0) {
+        l.pooledTT += l.sumTT - l.sumT * l.sumT / l.w;
+        l.pooledTD += l.sumTD - l.sumT * l.sumD / l.w;
+    }
+    l.w = l.sumT = l.sumD = l.sumTT = l.sumTD = 0;
+}
+
+static void openSegment(LeakDetector& l, float distanceMm) {
+    closeSegment(l);
+    l.refDistance = distanceMm;
+}
+
+void leakSample(LeakDetector& l, uint64_t nowMs, float distanceMm, float windowH) {
+    if (distanceMm <= 0 || l.paused) return;
+    if (!l.active) {
+        leakReset(l);
+        l.active = true;
+        l.startMs = l.lastMs = nowMs;
+        l.refDistance = distanceMm;
+    }
+
+    // Przesunięcie początku osi czasu na bieżący pomiar (t' = t - dt) i zapominanie
+    float dt = (float)(nowMs - l.lastMs) / MS_PER_HOUR;
+    l.sumTT += dt * (dt * l.w - 2 * l.sumT);
+    l.sumTD -= dt * l.sumD;
+    l.sumT -= dt * l.w;
+    float decay = expf(-dt / windowH);
+    l.w *= decay;
+    l.sumT *= decay;
+    l.sumD *= decay;
+    l.sumTT *= decay;
+    l.sumTD *= decay;
+    l.pooledTT *= decay;
+    l.pooledTD *= decay;
+    l.weight *= decay;
+    l.lastMs = nowMs;
+
+    if (l.settle > 0) {
+        if (--l.settle > 0) return;
+        openSegment(l, distanceMm);  // Poziom po pracy pompy ustabilizowany
+    }
+
+    float d = distanceMm - l.refDistance;
+    if (l.w > 0 && l.sumD / l.w - d > LEAK_REFILL_MM) {
+        openSegment(l, distanceMm);
+        d = 0;
+    }
+
+    // Nowy pomiar w t = 0 zmienia tylko wagę i sumę odległości
+    l.w += 1;
+    l.sumD += d;
+    l.weight += 1;
+}
+
+void leakPause(LeakDetector& l) {
+    if (!l.active || l.paused) return;
+    closeSegment(l);
+    l.paused = true;
+    l.settle = 0;
+}
+
+void leakResume(LeakDetector& l) {
+    if (!l.paused) return;
+    l.paused = false;
+    l.settle = LEAK_SETTLE_SAMPLES;
+}
+
+float leakRateMmPerDay(const LeakDetector& l) {
+    if (!l.active || l.weight < (float)LEAK_MIN_SAMPLES) return 0;
+    float tt = l.pooledTT, td = l.pooledTD;
+    if (l.w > 0) {
+        tt += l.sumTT - l.sumT * l.sumT / l.w;
+        td += l.sumTD - l.sumT * l.sumD / l.w;
+    }
+    if (tt <= 0) return 0;
+    return td / tt * 24.0f;
+}
+
+bool leakUpdateAlarm(LeakDetector& l, uint64_t nowMs, float limitMmPerDay, float windowH) {
+    if (limitMmPerDay <= 0) {
+        l.alarm = false;
+        return false;
+    }
+    if (!l.active || (float)(nowMs - l.startMs) / MS_PER_HOUR < windowH) return l.alarm;
+    float rate = leakRateMmPerDay(l);
+    if (rate >= limitMmPerDay) l.alarm = true;
+    else if (rate < limitMmPerDay / 2) l.alarm = false;
+    return l.alarm;
+}
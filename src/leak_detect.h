@@ -0,0 +1,45 @@
+#ifndef LEAK_DETECT_H
+#define LEAK_DETECT_H
+
+#include <stdint.h>
+
+// Wykrywanie wycieku / nieszczelnego zaworu zwrotnego. Czysta logika (bez Arduino):
+// regresja liniowa odległości w czasie z wykładniczym zapominaniem, liczona
+// wyłącznie z pomiarów w czasie postoju pompy. Każdy odcinek postoju ma własny
+// wyraz wolny (praca pompy i dolanie wody zmieniają poziom skokowo), nachylenie
+// jest wspólne. Stała pamięć, aktualizacja O(1) na próbkę - starsze pomiary
+// tracą wagę ze stałą czasową okna (windowH).
+
+const int LEAK_MIN_SAMPLES = 10;        // Minimum pomiarów do oceny nachylenia
+const int LEAK_SETTLE_SAMPLES = 10;     // Pomiary pomijane po pracy pompy (opóźnienie filtra)
+const float LEAK_REFILL_MM = 20.0f;     // Wzrost poziomu ponad średnią odcinka = dolanie wody
+
+struct LeakDetector {
+    bool active;            // Seria pomiarów rozpoczęta
+    bool paused;            // Pompa pracuje - pomiary pomijane
+    bool alarm;
+    uint8_t settle;         // Pozostałe pomiary do pominięcia po pracy pompy
+    uint64_t startMs;       // Początek serii
+    uint64_t lastMs;        // Ostatni pomiar
+    float weight;           // Łączna waga pomiarów serii
+    // Zamknięte odcinki: ważone sumy centrowane (t*t i t*d względem średnich odcinka)
+    float pooledTT, pooledTD;
+    // Bieżący odcinek: t [h] względem ostatniego pomiaru (<= 0), d = odległość - ref [mm]
+    float refDistance;
+    float w, sumT, sumD, sumTT, sumTD;
+};
+
+void leakReset(LeakDetector& l);
+// Pomiar w czasie postoju pompy; windowH - stała czasowa okna [h]
+void leakSample(LeakDetector& l, uint64_t nowMs, float distanceMm, float windowH);
+// Start pompy: zmiana poziomu do leakResume() nie jest liczona jako ubytek
+void leakPause(LeakDetector& l);
+void leakResume(LeakDetector& l);
+
+// Szacowany ubytek [mm/dobę] (dodatni = woda ubywa), 0 przy zbyt małej liczbie pomiarów
+float leakRateMmPerDay(const LeakDetector& l);
+// Alarm, gdy seria trwa co najmniej jedno okno i ubytek >= limit; kasowany poniżej
+// połowy limitu. limitMmPerDay <= 0 wyłącza alarm.
+bool leakUpdateAlarm(LeakDetector& l, uint64_t nowMs, float limitMmPerDay, float windowH);
+
+#endif // LEAK_DETECT_H
@@ -0,0 +1,41 @@
+#ifndef LOG_FORMATS_H
+#define LOG_FORMATS_H
+
+#include <stdint.h>
+
+// Tabela komunikatów dziennika (log_ring.h). Wpis w pamięci zawiera tylko
+// numer komunikatu - kolejność wierszy wyznacza numery, więc nowe komunikaty
+// dopisywać wyłącznie na końcu. host/log_decode.py czyta ten plik.
+// Argumenty: %d %i %u %x %X %c oraz %f (liczba zmiennoprzecinkowa) z
+// opcjonalną szerokością i precyzją; bez %s - wskaźników nie da się odczytać
+// na komputerze. Stany i etapy jako liczby (pump_fsm.h, loop_watchdog.h).
+
+#define LOG_MESSAGES(X) \
+    X(LM_BOOT,              "Start: reset %u, etap sprzed resetu %u") \
+    X(LM_WARM_RESTORE,      "Ciepły restart: migawka %u, odległość %.0f mm, pompa %u") \
+    X(LM_PUMP_STATE,        "Pompa: %u -> %u") \
+    X(LM_PUMP_FLOW,         "Wydajność pompy: %.2f l/min") \
+    X(LM_ALARM_RUN_TIMEOUT, "ALARM: pompa pracowała za długo - blokada") \
+    X(LM_ALARM_DRY_RUN,     "ALARM: brak wody w zbiorniku - pompa zatrzymana") \
+    X(LM_ALARM_NO_FLOW,     "ALARM: pompa nie tłoczy wody") \
+    X(LM_ALARM_CLEAR,       "Alarm pompy skasowany") \
+    X(LM_LEAK_ALARM,        "ALARM: ubytek wody w postoju %.1f L/dobę") \
+    X(LM_LEAK_CLEAR,        "Alarm wycieku skasowany") \
+    X(LM_LOOP_STALL,        "Zawieszenie pętli: %u ms, najdłużej etap %u (%u ms)") \
+    X(LM_WIFI_CONNECTED,    "WiFi połączono (tryb %u) w %u ms") \
+    X(LM_WIFI_FALLBACK,     "WiFi: szybkie łączenie nieudane - pełne skanowanie") \
+    X(LM_WIFI_RETRY,        "WiFi: próba %d, następna za %u ms") \
+    X(LM_MQTT_RETRY,        "MQTT: brak połączenia - próba połączenia") \
+    X(LM_CONFIG_SAVED,      "Konfiguracja: zmienione pola 0x%08x") \
+    X(LM_REMOTE_CONFIG,     "Konfiguracja zdalna: źródło %u, rev %u, wynik %u") \
+    X(LM_OTA_PULL_START,    "OTA: pobieranie obrazu %u B") \
+    X(LM_OTA_PULL_RESULT,   "OTA: wynik %u, pobrano %u z %u B")
+
+enum LogMsg : uint16_t {
+#define LOG_ENUM(id, fmt) id,
+    LOG_MESSAGES(LOG_ENUM)
+#undef LOG_ENUM
+    LOG_MSG_COUNT
+};
+
+#endif // LOG_FORMATS_H
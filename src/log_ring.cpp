@@ -0,0 +1,174 @@
+#include "log_ring.h"
+#include <stdio.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "globals.h"
+#include "strbuf.h"
+#endif
+
+#define LOG_FORMAT(id, fmt) fmt,
+static const char* const LOG_FORMATS[LOG_MSG_COUNT] = { LOG_MESSAGES(LOG_FORMAT) };
+#undef LOG_FORMAT
+
+bool logGet(const LogRing& r, uint32_t seq, LogEntry& out) {
+    if (seq >= r.next || seq < logOldest(r)) return false;
+    out = r.entries[seq & (LOG_RING_ENTRIES - 1)];
+    return true;
+}
+
+char logLevelChar(uint8_t level) {
+    static const char LEVELS[] = "DIWE";
+    return level < LOG_LEVEL_OFF ? LEVELS[level] : '?';
+}
+
+static size_t append(char* out, size_t cap, size_t len, const char* text, size_t n) {
+    if (len + n > cap - 1) n = cap - 1 - len;
+    memcpy(out + len, text, n);
+    return len + n;
+}
+
+size_t logFormatMessage(const LogEntry& e, char* out, size_t cap) {
+    if (cap == 0) return 0;
+    if (e.msg >= LOG_MSG_COUNT) {
+        int n = snprintf(out, cap, "? komunikat %u", (unsigned)e.msg);
+        return n < 0 ? 0 : ((size_t)n < cap ? (size_t)n : cap - 1);
+    }
+    const char* f = LOG_FORMATS[e.msg];
+    size_t len = 0;
+    uint8_t arg = 0;
+    while (*f && len < cap - 1) {
+        if (*f != '%') {
+            const char* lit = f;
+            while (*f && *f != '%') f++;
+            len = append(out, cap, len, lit, f - lit);
+            continue;
+        }
+        if (f[1] == '%') {
+            len = append(out, cap, len, "%", 1);
+            f += 2;
+            continue;
+        }
+        // Specyfikacja: flagi, szerokość, precyzja i konwersja
+        char spec[12];
+        size_t s = 0;
+        spec[s++] = *f++;
+        while (*f && strchr("-+ #0123456789.", *f) && s < sizeof(spec) - 2) spec[s++] = *f++;
+        char conv = *f ? *f++ : 0;
+        spec[s++] = conv;
+        spec[s] = 0;
+
+        char buf[24];
+        int n;
+        if (arg >= e.argc) {
+            n = snprintf(buf, sizeof(buf), "?");
+        } else if (conv == 'f') {
+            float v;
+            memcpy(&v, &e.args[arg], sizeof(v));
+            n = snprintf(buf, sizeof(buf), spec, (double)v);
+        } else if (conv == 'd' || conv == 'i' || conv == 'c') {
+            n = snprintf(buf, sizeof(buf), spec, (int)(int32_t)e.args[arg]);
+        } else if (conv == 'u' || conv == 'x' || conv == 'X') {
+            n = snprintf(buf, sizeof(buf), spec, (unsigned)e.args[arg]);
+        } else {
+            n = snprintf(buf, sizeof(buf), "?");
+        }
+        arg++;
+        if (n > 0) len = append(out, cap, len, buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+    }
+    out[len] = 0;
+    return len;
+}
+
+size_t logFormatLine(const LogEntry& e, char* out, size_t cap) {
+    int n = snprintf(out, cap, "%lu.%03lu %c ", (unsigned long)(e.ms / 1000), (unsigned long)(e.ms % 1000), logLevelChar(e.level));
+    if (n < 0 || (size_t)n >= cap) return cap ? cap - 1 : 0;
+    return n + logFormatMessage(e, out + n, cap - n);
+}
+
+#ifdef ARDUINO
+static LogRing s_log;
+#if defined(ARDUINO_ARCH_ESP32)
+// Zapis z zadań sterowania i sieci na dwóch rdzeniach
+static portMUX_TYPE s_logMux = portMUX_INITIALIZER_UNLOCKED;
+#define LOG_LOCK() portENTER_CRITICAL(&s_logMux)
+#define LOG_UNLOCK() portEXIT_CRITICAL(&s_logMux)
+#else
+#define LOG_LOCK()
+#define LOG_UNLOCK()
+#endif
+
+const uint8_t LOG_WS_PER_LOOP = 2;      // Wiadomości WebSocket na iterację pętli sieci
+static uint32_t s_wsNext = 0;
+
+void logRecord(uint8_t level, uint16_t msg, uint8_t argc, const uint32_t* args) {
+    uint32_t now = millis();
+    LOG_LOCK();
+    logPush(s_log, now, level, msg, argc, args);
+    LOG_UNLOCK();
+#if DEBUG
+    LogEntry e = { now, msg, level, argc, { args[0], args[1], args[2], args[3] } };
+    char line[LOG_LINE_MAX];
+    logFormatLine(e, line, sizeof(line));
+    Serial.println(line);
+#endif
+}
+
+static bool logRead(uint32_t seq, LogEntry& out) {
+    LOG_LOCK();
+    bool ok = logGet(s_log, seq, out);
+    LOG_UNLOCK();
+    return ok;
+}
+
+void handleLog() {
+    uint32_t first = logOldest(s_log);
+    uint32_t next = s_log.next;
+    if (server.hasArg("since")) {
+        uint32_t since = strtoul(server.arg("since").c_str(), nullptr, 10);
+        if (since > first) first = since < next ? since : next;
+    }
+    server.sendHeader("X-Log-Next", String(next));
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    bool raw = server.arg("raw") == "1";
+    server.send(200, raw ? "application/octet-stream" : "text/plain", "");
+    if (raw) {
+        LogRawHeader h = { LOG_RAW_MAGIC, LOG_RAW_VERSION, (uint8_t)sizeof(LogEntry), (uint16_t)(next - first), first, (uint32_t)millis() };
+        server.sendContent((const char*)&h, sizeof(h));
+    }
+    char line[LOG_LINE_MAX + 16];
+    for (uint32_t seq = first; seq < next; ++seq) {
+        LogEntry e;
+        if (!logRead(seq, e)) {
+            // Nadpisany w trakcie wysyłki - zerowy wpis zachowuje numerację odczytu binarnego
+            if (!raw) continue;
+            memset(&e, 0, sizeof(e));
+            e.msg = LOG_MSG_COUNT;
+        }
+        if (raw) {
+            server.sendContent((const char*)&e, sizeof(e));
+        } else {
+            int n = snprintf(line, sizeof(line), "%lu ", (unsigned long)seq);
+            size_t len = n + logFormatLine(e, line + n, sizeof(line) - n - 1);
+            line[len++] = '\n';
+            server.sendContent(line, len);
+        }
+    }
+    server.sendContent("");
+}
+
+void logWebSocketLoop() {
+    uint32_t next = s_log.next;
+    if (webSocket.connectedClients() == 0) {
+        s_wsNext = next;    // Nowy klient dostaje wpisy od chwili połączenia
+        return;
+    }
+    if (s_wsNext < logOldest(s_log)) s_wsNext = logOldest(s_log);
+    char line[LOG_LINE_MAX + 4] = "log:";
+    for (uint8_t k = 0; k < LOG_WS_PER_LOOP && s_wsNext < next; ++k, ++s_wsNext) {
+        LogEntry e;
+        if (!logRead(s_wsNext, e)) continue;
+        logFormatLine(e, line + 4, sizeof(line) - 4);
+        webSocket.broadcastTXT(line);
+    }
+}
+#endif
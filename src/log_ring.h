@@ -0,0 +1,111 @@
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "log_formats.h"
+
+// Dziennik binarny z odroczonym formatowaniem. Zapis to numer komunikatu
+// (log_formats.h), poziom, czas i do LOG_MAX_ARGS surowych argumentów
+// 32-bitowych w buforze cyklicznym w RAM - bez printf i bez UART. Tekst
+// powstaje dopiero przy odczycie (GET /log, WebSocket) albo na komputerze
+// (host/log_decode.py) z tej samej tabeli formatów.
+
+enum LogLevel : uint8_t {
+    LOG_LEVEL_DEBUG,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_ERROR,
+    LOG_LEVEL_OFF,          // config.log_level: nic nie jest zapisywane
+};
+
+const uint8_t LOG_MAX_ARGS = 4;
+const uint16_t LOG_RING_ENTRIES = 64;           // Potęga 2 (1,5 KB)
+const size_t LOG_LINE_MAX = 112;                // Wiersz tekstowy wpisu
+const uint32_t LOG_RAW_MAGIC = 0x474C5348UL;    // "HSLG"
+const uint8_t LOG_RAW_VERSION = 1;
+
+struct LogEntry {
+    uint32_t ms;            // millis() w chwili zapisu
+    uint16_t msg;           // LogMsg
+    uint8_t level;
+    uint8_t argc;
+    uint32_t args[LOG_MAX_ARGS];    // Liczby całkowite lub bity float
+};
+
+struct LogRing {
+    uint32_t next;          // Numer kolejny następnego wpisu (od startu)
+    LogEntry entries[LOG_RING_ENTRIES];
+};
+
+// Nagłówek odczytu binarnego (GET /log?raw=1); po nim count wpisów LogEntry
+// od numeru firstSeq (little-endian, jak w pamięci)
+struct LogRawHeader {
+    uint32_t magic;
+    uint8_t version;
+    uint8_t entrySize;
+    uint16_t count;
+    uint32_t firstSeq;
+    uint32_t nowMs;
+};
+
+static_assert((LOG_RING_ENTRIES & (LOG_RING_ENTRIES - 1)) == 0, "LOG_RING_ENTRIES musi być potęgą 2");
+static_assert(sizeof(LogEntry) == 24, "Układ LogEntry czyta host/log_decode.py");
+
+// Argumenty zapisywane bez formatowania; float jako bity IEEE 754
+template <typename T> inline uint32_t logArg(T v) { return (uint32_t)v; }
+inline uint32_t logArg(float v) { uint32_t u; memcpy(&u, &v, sizeof(u)); return u; }
+inline uint32_t logArg(double v) { return logArg((float)v); }
+template <typename T> uint32_t logArg(T* v) = delete;   // Wskaźnik nic nie znaczy poza urządzeniem
+
+// args zawsze LOG_MAX_ARGS słów (nieużyte = 0) - stały koszt kopiowania
+inline void logPush(LogRing& r, uint32_t ms, uint8_t level, uint16_t msg, uint8_t argc, const uint32_t* args) {
+    LogEntry& e = r.entries[r.next & (LOG_RING_ENTRIES - 1)];
+    e.ms = ms;
+    e.msg = msg;
+    e.level = level;
+    e.argc = argc;
+    memcpy(e.args, args, sizeof(e.args));
+    r.next++;
+}
+
+// Najstarszy numer wpisu wciąż obecny w buforze
+inline uint32_t logOldest(const LogRing& r) {
+    return r.next > LOG_RING_ENTRIES ? r.next - LOG_RING_ENTRIES : 0;
+}
+
+bool logGet(const LogRing& r, uint32_t seq, LogEntry& out);
+// Treść komunikatu bez czasu i poziomu
+size_t logFormatMessage(const LogEntry& e, char* out, size_t cap);
+// Wiersz "<s.ms> <poziom> <treść>"
+size_t logFormatLine(const LogEntry& e, char* out, size_t cap);
+char logLevelChar(uint8_t level);
+
+#ifdef ARDUINO
+#include "config.h"
+
+void logRecord(uint8_t level, uint16_t msg, uint8_t argc, const uint32_t* args);
+
+// Poziom sprawdzany w miejscu wywołania - wpis poniżej config.log_level
+// kosztuje jedno porównanie
+template <typename... A>
+inline void logWrite(LogLevel level, LogMsg msg, A... a) {
+    static_assert(sizeof...(A) <= LOG_MAX_ARGS, "Za dużo argumentów wpisu dziennika");
+    if (level < config.log_level) return;
+    const uint32_t args[LOG_MAX_ARGS] = { logArg(a)... };
+    logRecord(level, msg, sizeof...(A), args);
+}
+
+#define LOG_D(...) logWrite(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define LOG_I(...) logWrite(LOG_LEVEL_INFO, __VA_ARGS__)
+#define LOG_W(...) logWrite(LOG_LEVEL_WARN, __VA_ARGS__)
+#define LOG_E(...) logWrite(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+// GET /log[?since=N][&raw=1] - wiersze tekstowe albo LogRawHeader + wpisy
+void handleLog();
+// Nowe wpisy do klientów WebSocket ("log:<wiersz>"), kilka na iterację
+void logWebSocketLoop();
+#endif
+
+#endif // LOG_RING_H
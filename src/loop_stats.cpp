@@ -0,0 +1,96 @@
+#include "loop_stats.h"
+#include <string.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#include "globals.h"
+#include "strbuf.h"
+#include "http_stream.h"
+#include "control_task.h"
+#include "float_switch.h"
+
+LoopStats loopStats = {};
+#endif
+
+void loopStatsReset(LoopStats& s) {
+    memset(&s, 0, sizeof(s));
+}
+
+static uint8_t bucketOf(uint32_t us) {
+    uint8_t b = 0;
+    uint32_t limit = 1UL << LOOP_HIST_SHIFT;
+    while (b < LOOP_HIST_BUCKETS - 1 && us >= limit) {
+        b++;
+        limit <<= 1;
+    }
+    return b;
+}
+
+void loopStatsAdd(LoopStats& s, uint32_t us) {
+    s.count++;
+    if (us > s.maxUs) s.maxUs = us;
+    s.hist[bucketOf(us)]++;
+}
+
+void loopStatsTick(LoopStats& s, uint32_t nowUs) {
+    if (s.started) loopStatsAdd(s, nowUs - s.lastUs);   // Odporne na przepełnienie micros()
+    s.started = true;
+    s.lastUs = nowUs;
+}
+
+uint32_t loopStatsPercentile(const LoopStats& s, uint8_t pct) {
+    if (!s.count) return 0;
+    uint64_t target = ((uint64_t)s.count * pct + 99) / 100;
+    uint64_t seen = 0;
+    for (uint8_t b = 0; b < LOOP_HIST_BUCKETS; ++b) {
+        seen += s.hist[b];
+        if (seen >= target) return b == LOOP_HIST_BUCKETS - 1 ? UINT32_MAX : (1UL << (LOOP_HIST_SHIFT + b));
+    }
+    return UINT32_MAX;
+}
+
+#ifdef ARDUINO
+void loopStatsRecord() {
+    loopStatsTick(loopStats, micros());
+}
+
+void handleLoopStats() {
+    if (server.arg("reset") == "1") {
+        loopStatsReset(loopStats);
+        controlLatencyReset();
+        server.send(200, "application/json", "{\"status\":\"ok\"}");
+        return;
+    }
+    static char out[448];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    sbAppend(sb, "{\"count\":");
+    sbAppendUInt(sb, loopStats.count);
+    sbAppend(sb, ",\"max_us\":");
+    sbAppendUInt(sb, loopStats.maxUs);
+    sbAppend(sb, ",\"p99_us\":");
+    sbAppendUInt(sb, loopStatsPercentile(loopStats, 99));
+    sbAppend(sb, ",\"streams\":");
+    sbAppendUInt(sb, httpStreamActive());
+    sbAppend(sb, ",\"queue_dropped\":");
+    sbAppendUInt(sb, controlDropped());
+    sbAppend(sb, ",\"float_edges\":");
+    sbAppendUInt(sb, floatSwitchEdges());
+    const LoopStats& cmd = controlLatency();
+    sbAppend(sb, ",\"cmd\":{\"count\":");
+    sbAppendUInt(sb, cmd.count);
+    sbAppend(sb, ",\"max_us\":");
+    sbAppendUInt(sb, cmd.maxUs);
+    sbAppend(sb, ",\"p99_us\":");
+    sbAppendUInt(sb, loopStatsPercentile(cmd, 99));
+    sbAppend(sb, ",\"over_target\":");
+    sbAppendUInt(sb, controlLatencyOverTarget());
+    sbAppendChar(sb, '}');
+    sbAppend(sb, ",\"hist\":[");
+    for (uint8_t b = 0; b < LOOP_HIST_BUCKETS; ++b) {
+        if (b) sbAppendChar(sb, ',');
+        sbAppendUInt(sb, loopStats.hist[b]);
+    }
+    sbAppend(sb, "]}");
+    server.send(200, "application/json", out);
+}
+#endif
@@ -0,0 +1,34 @@
+#ifndef LOOP_STATS_H
+#define LOOP_STATS_H
+
+#include <stdint.h>
+
+// Opóźnienie pętli głównej: czas między kolejnymi wejściami do loop()
+// (łącznie z pracą stosu WiFi). Histogram w przedziałach potęg dwójki,
+// od < 128 us do >= 128 ms.
+
+const uint8_t LOOP_HIST_BUCKETS = 12;
+const uint8_t LOOP_HIST_SHIFT = 7;          // Górna granica przedziału 0: 2^7 us
+
+struct LoopStats {
+    bool started;
+    uint32_t lastUs;
+    uint32_t count;
+    uint32_t maxUs;
+    uint32_t hist[LOOP_HIST_BUCKETS];
+};
+
+void loopStatsReset(LoopStats& s);
+void loopStatsTick(LoopStats& s, uint32_t nowUs);
+// Pojedyncza próbka czasu (np. opóźnienie polecenia w control_task.cpp)
+void loopStatsAdd(LoopStats& s, uint32_t us);
+// Górna granica przedziału zawierającego percentyl pct (UINT32_MAX dla ostatniego)
+uint32_t loopStatsPercentile(const LoopStats& s, uint8_t pct);
+
+#ifdef ARDUINO
+extern LoopStats loopStats;
+void loopStatsRecord();     // Na początku każdej iteracji loop()
+void handleLoopStats();     // GET /loop[?reset=1]
+#endif
+
+#endif // LOOP_STATS_H
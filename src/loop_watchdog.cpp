@@ -0,0 +1,182 @@
+#include "loop_watchdog.h"
+#include "rtc_store.h"
+#include <string.h>
+#ifdef ARDUINO
+#include "globals.h"
+#include "strbuf.h"
+#include "control_task.h"
+#include "log_ring.h"
+#endif
+
+void loopWatchdogBegin(LoopWatchdog& w, uint32_t nowMs) {
+    memset(&w, 0, sizeof(w));
+    w.stage = LS_SETUP;
+    w.stageSinceMs = nowMs;
+    w.iterStartMs = nowMs;
+}
+
+// Czas bieżącego etapu wliczany do najdłuższego w iteracji
+static void closeStage(LoopWatchdog& w, uint32_t nowMs) {
+    uint32_t spent = nowMs - w.stageSinceMs;
+    if (spent >= w.worstMs) {
+        w.worstMs = spent;
+        w.worstStage = w.stage;
+    }
+}
+
+LoopStage loopWatchdogEnter(LoopWatchdog& w, LoopStage stage, uint32_t nowMs) {
+    LoopStage prev = (LoopStage)w.stage;
+    closeStage(w, nowMs);
+    w.stage = stage;
+    w.stageSinceMs = nowMs;
+    return prev;
+}
+
+bool loopWatchdogIteration(LoopWatchdog& w, uint32_t nowMs, uint32_t stallMs) {
+    closeStage(w, nowMs);
+    uint32_t iteration = nowMs - w.iterStartMs;
+    bool stalled = iteration > stallMs;
+    if (stalled) {
+        w.last.magic = LOOP_STALL_MAGIC;
+        w.last.count++;
+        w.last.stage = w.worstStage;
+        w.last.stageMs = w.worstMs;
+        w.last.iterationMs = iteration;
+        w.last.atMs = nowMs;
+        w.last.checksum = rtcChecksum(&w.last, offsetof(LoopStall, checksum));
+    }
+    w.iterStartMs = nowMs;
+    w.stageSinceMs = nowMs;
+    w.worstMs = 0;
+    w.worstStage = w.stage;
+    return stalled;
+}
+
+bool loopStallValid(const LoopStall& s) {
+    return s.magic == LOOP_STALL_MAGIC && s.stage < LOOP_STAGE_COUNT &&
+           s.checksum == rtcChecksum(&s, offsetof(LoopStall, checksum));
+}
+
+bool loopCrumbDecode(uint32_t word, LoopStage* stage) {
+    if ((word >> 16) != LOOP_CRUMB_MAGIC || (word & 0xFFFF) >= LOOP_STAGE_COUNT) return false;
+    *stage = (LoopStage)(word & 0xFFFF);
+    return true;
+}
+
+const char* loopStageName(uint8_t stage) {
+    static const char* const NAMES[LOOP_STAGE_COUNT] = {
+        "none", "setup", "ultrasonic", "pump", "boot_task", "button", "alarms", "buzzer",
+        "http", "http_stream", "websocket", "measurement", "heap_stats", "mqtt", "ha_discovery",
+        "ota", "wifi", "mqtt_connect", "wifi_scan", "eeprom_commit", "ota_write",
+    };
+    return stage < LOOP_STAGE_COUNT ? NAMES[stage] : "?";
+}
+
+const char* resetReasonName(uint8_t reason) {
+    switch (reason) {
+        case 0: return "power_on";
+        case 1: return "hw_wdt";
+        case 2: return "exception";
+        case 3: return "soft_wdt";
+        case 4: return "restart";
+        case 5: return "deep_sleep";
+        case 6: return "ext_reset";
+        default: return "?";
+    }
+}
+
+#ifdef ARDUINO
+static LoopWatchdog s_wd;
+static uint8_t s_prevReason = 0;
+static bool s_prevCrumbValid = false;
+static LoopStage s_prevStage = LS_NONE;
+static uint32_t s_prevStageAtMs = 0;
+static LoopStall s_prevStall;
+
+void loopWatchdogInit() {
+    uint32_t crumb[2] = {0, 0};
+    rtcRead(RTC_BLOCK_WATCHDOG, crumb, sizeof(crumb));
+    rtcRead(RTC_BLOCK_WATCHDOG + 2, &s_prevStall, sizeof(s_prevStall));
+    s_prevCrumbValid = loopCrumbDecode(crumb[0], &s_prevStage);
+    s_prevStageAtMs = crumb[1];
+    s_prevReason = platformResetReason();
+
+    uint32_t now = millis();
+    loopWatchdogBegin(s_wd, now);
+    rtcWrite(RTC_BLOCK_WATCHDOG + 2, &s_wd.last, sizeof(s_wd.last));  // Bez zawieszeń w tym uruchomieniu
+    rtcWriteWord(RTC_BLOCK_WATCHDOG, loopCrumbWord(LS_SETUP));
+    rtcWriteWord(RTC_BLOCK_WATCHDOG + 1, now);
+
+    char buf[24];
+    if (s_prevCrumbValid && s_prevReason != 0) {
+        snprintf(buf, sizeof(buf), "%s/%s", resetReasonName(s_prevReason), loopStageName(s_prevStage));
+    } else {
+        snprintf(buf, sizeof(buf), "%s", resetReasonName(s_prevReason));
+    }
+    sensorResetCause.setValue(buf);
+    sensorLoopStalls.setValue("0");
+    LOG_I(LM_BOOT, s_prevReason, s_prevCrumbValid ? s_prevStage : LS_NONE);
+}
+
+LoopStage loopStage(LoopStage stage) {
+#if defined(ARDUINO_ARCH_ESP32)
+    // Ślad dotyczy pętli sieci - zadanie sterowania pilnuje watchdog zadań
+    if (controlInTask()) return stage;
+#endif
+    uint32_t now = millis();
+    LoopStage prev = loopWatchdogEnter(s_wd, stage, now);
+    rtcWriteWord(RTC_BLOCK_WATCHDOG, loopCrumbWord(stage));
+    rtcWriteWord(RTC_BLOCK_WATCHDOG + 1, now);
+    return prev;
+}
+
+void loopWatchdogTick() {
+    if (!loopWatchdogIteration(s_wd, millis(), (uint32_t)config.loop_stall_ms)) return;
+    rtcWrite(RTC_BLOCK_WATCHDOG + 2, &s_wd.last, sizeof(s_wd.last));
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%lu", (unsigned long)s_wd.last.count);
+    sensorLoopStalls.setValue(buf);
+    LOG_W(LM_LOOP_STALL, s_wd.last.iterationMs, s_wd.last.stage, s_wd.last.stageMs);
+}
+
+static void appendStall(StrBuf& sb, const LoopStall& s) {
+    if (!loopStallValid(s)) { sbAppend(sb, "null"); return; }
+    sbAppend(sb, "{\"count\":");
+    sbAppendUInt(sb, s.count);
+    sbAppend(sb, ",\"stage\":\"");
+    sbAppend(sb, loopStageName(s.stage));
+    sbAppend(sb, "\",\"stage_ms\":");
+    sbAppendUInt(sb, s.stageMs);
+    sbAppend(sb, ",\"iteration_ms\":");
+    sbAppendUInt(sb, s.iterationMs);
+    sbAppend(sb, ",\"at_ms\":");
+    sbAppendUInt(sb, s.atMs);
+    sbAppendChar(sb, '}');
+}
+
+// GET /watchdog - bieżący etap, zawieszenia i ślad poprzedniego uruchomienia
+void handleLoopWatchdog() {
+    static char out[448];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    sbAppend(sb, "{\"stall_ms\":");
+    sbAppendInt(sb, config.loop_stall_ms);
+    sbAppend(sb, ",\"last_stall\":");
+    appendStall(sb, s_wd.last);
+    sbAppend(sb, ",\"previous\":{\"reset_reason\":\"");
+    sbAppend(sb, resetReasonName(s_prevReason));
+    sbAppend(sb, "\",\"stage\":");
+    if (s_prevCrumbValid) {
+        sbAppendChar(sb, '"');
+        sbAppend(sb, loopStageName(s_prevStage));
+        sbAppend(sb, "\",\"stage_at_ms\":");
+        sbAppendUInt(sb, s_prevStageAtMs);
+    } else {
+        sbAppend(sb, "null");
+    }
+    sbAppend(sb, ",\"last_stall\":");
+    appendStall(sb, s_prevStall);
+    sbAppend(sb, "}}");
+    server.send(200, "application/json", out);
+}
+#endif
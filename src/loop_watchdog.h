@@ -0,0 +1,86 @@
+#ifndef LOOP_WATCHDOG_H
+#define LOOP_WATCHDOG_H
+
+#include <stdint.h>
+
+// Programowy watchdog pętli głównej. Każde przejście do kolejnego etapu
+// loop() (i do operacji mogących blokować: skan WiFi, łączenie MQTT, zapis
+// EEPROM, zapis OTA) zostawia ślad w pamięci RTC - dwa słowa zapisywane
+// bezpośrednio. Po resecie sprzętowego watchdoga wiadomo, który etap się
+// zawiesił. Iteracje dłuższe niż próg (config.loop_stall_ms) są liczone,
+// a najdłuższy etap ostatniej z nich także trafia do RTC.
+
+enum LoopStage : uint8_t {
+    LS_NONE,
+    LS_SETUP,
+    LS_ULTRASONIC,
+    LS_PUMP,
+    LS_BOOT_TASK,
+    LS_BUTTON,
+    LS_ALARMS,
+    LS_BUZZER,
+    LS_HTTP,
+    LS_HTTP_STREAM,
+    LS_WEBSOCKET,
+    LS_MEASUREMENT,
+    LS_HEAP_STATS,
+    LS_MQTT,
+    LS_HA_DISCOVERY,
+    LS_OTA,
+    LS_WIFI,
+    LS_MQTT_CONNECT,
+    LS_WIFI_SCAN,
+    LS_EEPROM_COMMIT,
+    LS_OTA_WRITE,
+    LOOP_STAGE_COUNT
+};
+
+const uint32_t LOOP_CRUMB_MAGIC = 0xB7C5UL;     // Górne 16 bitów słowa etapu
+const uint32_t LOOP_STALL_MAGIC = 0x48535354UL; // "HSST"
+
+// Ostatnia zbyt długa iteracja
+struct LoopStall {
+    uint32_t magic;
+    uint32_t count;         // Zawieszenia od startu
+    uint8_t stage;          // Najdłuższy etap tej iteracji
+    uint8_t reserved[3];
+    uint32_t stageMs;
+    uint32_t iterationMs;
+    uint32_t atMs;          // Czas od startu
+    uint32_t checksum;
+};
+
+struct LoopWatchdog {
+    uint8_t stage;
+    uint32_t stageSinceMs;
+    uint32_t iterStartMs;
+    uint8_t worstStage;     // Najdłuższy etap bieżącej iteracji
+    uint32_t worstMs;
+    LoopStall last;
+};
+
+void loopWatchdogBegin(LoopWatchdog& w, uint32_t nowMs);
+// Przejście do etapu; zwraca poprzedni (do przywrócenia po operacji blokującej)
+LoopStage loopWatchdogEnter(LoopWatchdog& w, LoopStage stage, uint32_t nowMs);
+// Koniec iteracji (początek następnej); true gdy przekroczyła stallMs
+bool loopWatchdogIteration(LoopWatchdog& w, uint32_t nowMs, uint32_t stallMs);
+bool loopStallValid(const LoopStall& s);
+
+// Słowo śladu w RTC i jego odczyt
+inline uint32_t loopCrumbWord(LoopStage stage) { return (LOOP_CRUMB_MAGIC << 16) | stage; }
+bool loopCrumbDecode(uint32_t word, LoopStage* stage);
+
+const char* loopStageName(uint8_t stage);
+// Nazwa rst_info.reason (REASON_DEFAULT_RST ... REASON_EXT_SYS_RST)
+const char* resetReasonName(uint8_t reason);
+
+#ifdef ARDUINO
+// Po bootRecorderInit(): odczyt śladu poprzedniego uruchomienia z RTC
+void loopWatchdogInit();
+LoopStage loopStage(LoopStage stage);
+void loopWatchdogTick();        // Na początku każdej iteracji loop()
+void loopWatchdogPublish();     // Przyczyna resetu i ślad do HA (raz po starcie)
+void handleLoopWatchdog();      // GET /watchdog
+#endif
+
+#endif // LOOP_WATCHDOG_H
@@ -3,11 +3,8 @@
 #include <Arduino.h>
 #include <ArduinoHA.h>
 #include <ArduinoOTA.h>
-#include <ESP8266WiFi.h>
 #include <WiFiManager.h>
-#include <ESP8266WebServer.h>
 #include <WebSocketsServer.h>
-#include <ESP8266HTTPUpdateServer.h>
 
 #include "pins.h"
 #include "config.h"
@@ -19,6 +16,19 @@
 #include "ha.h"
 #include "pump_control.h"
 #include "network.h"
+#include "heap_stats.h"
+#include "mono_clock.h"
+#include "boot_timeline.h"
+#include "buzzer.h"
+#include "http_stream.h"
+#include "loop_stats.h"
+#include "loop_watchdog.h"
+#include "warm_restart.h"
+#include "platform.h"
+#include "control_task.h"
+#include "log_ring.h"
+#include "float_switch.h"
+#include "ota_pull.h"
 
 
 
@@ -27,13 +37,12 @@ const char* SOFTWARE_VERSION = "26.11.24";
 // USTAWIENIA CZASOWE
 const unsigned long ULTRASONIC_TIMEOUT = 50;
 const unsigned long MEASUREMENT_INTERVAL = 60000;
+const unsigned long PUMP_MEASUREMENT_INTERVAL = 1000;  // Szybkie pomiary w trakcie pracy pompy (przepływ)
 const unsigned long WATCHDOG_TIMEOUT = 8000;
 const unsigned long LONG_PRESS_TIME = 1000;
-const unsigned long MQTT_LOOP_INTERVAL = 100;
 const unsigned long OTA_CHECK_INTERVAL = 1000;
-const unsigned long MQTT_RETRY_INTERVAL = 10000;
 const unsigned long WIFI_RETRY_INTERVAL = 10000;
-const unsigned long MILLIS_OVERFLOW_THRESHOLD = 4294967295U - 60000;
+const unsigned long HEAP_STATS_INTERVAL = 1000;
 
 // globalne instancje `config`, `status`, `buttonState` i `timers`
 // są zadeklarowane w osobnych plikach źródłowych (config.cpp, status.cpp, button.cpp, timers.cpp)
@@ -51,6 +60,7 @@ const int SENSOR_MIN_RANGE = 20;    // Minimalny zakres czujnika (mm)
 const int SENSOR_MAX_RANGE = 1020;  // Maksymalny zakres czujnika (mm)
 const float EMA_ALPHA = 0.2f;       // Współczynnik wygładzania dla średniej wykładniczej (0-1)
 const int SENSOR_AVG_SAMPLES = 3;   // Liczba próbek do uśrednienia pomiaru
+const unsigned long SENSOR_STALE_TIMEOUT = 3 * MEASUREMENT_INTERVAL + 10000;  // Alarm po trzech cyklach bez poprawnego pomiaru
 
 float lastFilteredDistance = 0;     // Dla filtra EMA (Exponential Moving Average)
 float lastReportedDistance = 0;     // Ostatnia zgłoszona wartość odległości
@@ -64,11 +74,12 @@ float waterLevelBeforePump = 0;     // Poziom wody przed uruchomieniem pompy
 
 // Wi-Fi, MQTT i Home Assistant
 WiFiClient client;              // Klient połączenia WiFi
-HADevice device("HydroSense");  // Definicja urządzenia dla Home Assistant
-HAMqtt mqtt(client, device);    // Klient MQTT dla Home Assistant
+HADevice device(HA_LEGACY_DEVICE_ID);  // Identyfikator z MAC ustawiany w bootTask() przed setupHA()
+const uint8_t HA_MAX_ENTITIES = 4;  // Tylko przełączniki HASwitch - sensory publikuje ha_discovery.cpp
+HAMqtt mqtt(client, device, HA_MAX_ENTITIES);  // Klient MQTT dla Home Assistant
 
 // Serwer HTTP i WebSockets
-ESP8266WebServer server(80);     // Tworzenie instancji serwera HTTP na porcie 80
+PlatformWebServer server(80);     // Tworzenie instancji serwera HTTP na porcie 80
 WebSocketsServer webSocket(81);  // Tworzenie instancji serwera WebSockets na porcie 81
 
 // Czujniki i przełączniki dla Home Assistant
@@ -85,41 +96,19 @@ void factoryReset() {
     
     WiFiManager wm;
     wm.resetSettings();
-    ESP.eraseConfig();
+    platformEraseWifiConfig();
     
     setDefaultConfig();
     saveConfig();
     
+    warmInvalidate();  // Bez przywracania stanu sprzed ustawień fabrycznych
     delay(100);
-    ESP.reset();
+    platformReset();
 }
 
 // Reset urządzenia
 void rebootDevice() {
-    ESP.restart();
-}
-
-// Przepełnienie licznika millis()
-void handleMillisOverflow() {
-    unsigned long currentMillis = millis();
-    
-    // Sprawdź przepełnienie dla wszystkich timerów
-    if (currentMillis < status.pumpStartTime) status.pumpStartTime = 0;
-    if (currentMillis < status.pumpDelayStartTime) status.pumpDelayStartTime = 0;
-    if (currentMillis < status.lastSoundAlert) status.lastSoundAlert = 0;
-    if (currentMillis < status.lastSuccessfulMeasurement) status.lastSuccessfulMeasurement = 0;
-    if (currentMillis < lastMeasurement) lastMeasurement = 0;
-    
-    // Jeśli zbliża się przepełnienie, zresetuj wszystkie timery
-    if (currentMillis > MILLIS_OVERFLOW_THRESHOLD) {
-        status.pumpStartTime = 0;
-        status.pumpDelayStartTime = 0;
-        status.lastSoundAlert = 0;
-        status.lastSuccessfulMeasurement = 0;
-        lastMeasurement = 0;
-        
-        DEBUG_PRINT(F("Reset timerów - zbliża się przepełnienie millis()"));
-    }
+    warmRestart();
 }
 
 // Funkcje związane z konfiguracją (setDefaultConfig, loadConfig, saveConfig,
@@ -127,37 +116,35 @@ void handleMillisOverflow() {
 
 // ** FUNKCJE DŹWIĘKOWE **
 
+// Wzorce i priorytety dźwięków są w buzzer.cpp - tu tylko skróty dla reszty programu
+
 // Odtwórz krótki dźwięk ostrzegawczy
 void playShortWarningSound() {
-    if (config.soundEnabled) {
-        tone(BUZZER_PIN, 2000, 100); // Krótkie piknięcie (2000Hz, 100ms)
-    }
+    controlPostSound(SOUND_WARNING);  // Krótkie piknięcie (2000Hz, 100ms)
 }
 
 // Odtwórz dźwięk potwierdzenia
 void playConfirmationSound() {
-    if (config.soundEnabled) {
-        tone(BUZZER_PIN, 2000, 200); // Dłuższe piknięcie (2000Hz, 200ms)
-    }
+    controlPostSound(SOUND_CONFIRM);  // Dłuższe piknięcie (2000Hz, 200ms)
 }
 
 // ** FUNKCJE ALARMÓW I STEROWANIA POMPĄ **
 
 // Sprawdź warunki alarmowe
 void checkAlarmConditions() {
-    unsigned long currentTime = millis();
+    uint64_t currentTime = millis64();
 
     // Sprawdź czy minęła minuta od ostatniego alarmu
     if (currentTime - status.lastSoundAlert >= 60000) { // 60000ms = 1 minuta
         // Sprawdź czy dźwięk jest włączony i czy występuje alarm pompy lub tryb serwisowy
-        if (config.soundEnabled && (status.pumpSafetyLock || status.isServiceMode)) {
+        if (config.soundEnabled && (pumpIsLocked(status.pumpState) || pumpIsService(status.pumpState))) {
             playShortWarningSound();
             status.lastSoundAlert = currentTime;
             
             // Debug info
             DEBUG_PRINT(F("Alarm dźwiękowy - przyczyna:"));
-            if (status.pumpSafetyLock) DEBUG_PRINT(F("- Alarm pompy"));
-            if (status.isServiceMode) DEBUG_PRINT(F("- Tryb serwisowy"));
+            if (pumpIsLocked(status.pumpState)) DEBUG_PRINT(F("- Alarm pompy"));
+            if (pumpIsService(status.pumpState)) DEBUG_PRINT(F("- Tryb serwisowy"));
         }
     }
 }
@@ -199,6 +186,7 @@ void setupPin() {
     digitalWrite(PIN_ULTRASONIC_TRIG, LOW);  // Upewnij się że TRIG jest LOW na starcie
     
     pinMode(PIN_WATER_LEVEL, INPUT_PULLUP);  // Wejście z podciąganiem - czujnik poziomu
+    floatSwitchBegin();  // Przerwanie pływaka i poziom początkowy dla pierwszego updatePump()
     pinMode(PRZYCISK_PIN, INPUT_PULLUP);  // Wejście z podciąganiem - przycisk
     pinMode(BUZZER_PIN, OUTPUT);  // Wyjście - buzzer
     digitalWrite(BUZZER_PIN, LOW);  // Wyłączenie buzzera
@@ -206,14 +194,9 @@ void setupPin() {
     digitalWrite(POMPA_PIN, LOW);  // Wyłączenie pompy
 }
 
-// Odtwarzaj melodię powitalną
+// Odtwarzaj melodię powitalną (w tle, przez sekwencer buzzera)
 void welcomeMelody() {
-    tone(BUZZER_PIN, 1397, 100);  // F6
-    delay(150);
-    tone(BUZZER_PIN, 1568, 100);  // G6
-    delay(150);
-    tone(BUZZER_PIN, 1760, 150);  // A6
-    delay(200);
+    controlPostSound(SOUND_WELCOME);
 }
 
 // Wyślij pierwszą aktualizację stanu do Home Assistant
@@ -224,20 +207,11 @@ void firstUpdateHA() {
     status.waterAlarmActive = (initialDistance >= config.tank_empty);
     status.waterReserveActive = (initialDistance >= config.reserve_level);
     
-    // Wymuś stan OFF na początku
-    sensorAlarm.setValue("OFF");
-    sensorReserve.setValue("OFF");
-    switchSound.setState(false);  // Dodane - wymuś stan początkowy
-    mqtt.loop();
-    
-    // Ustawienie końcowych stanów i wysyłka do HA
+    // Stany trafiają do kolejki - wysyłka porcjami w haDiscoveryLoop() po połączeniu
     sensorAlarm.setValue(status.waterAlarmActive ? "ON" : "OFF");
     sensorReserve.setValue(status.waterReserveActive ? "ON" : "OFF");
-    switchSound.setState(status.soundEnabled);  // Dodane - ustaw aktualny stan dźwięku
-    mqtt.loop();
-
     sensorPumpWorkTime.setValue("0");
-    mqtt.loop();
+    switchSound.setState(status.soundEnabled, true);  // Wymuś publikację stanu dźwięku
 }
 
 // ** FUNKCJE ZWIĄZANE Z PRZYCISKIEM **
@@ -269,21 +243,12 @@ void handleButton() {
                 
                 // Sprawdzenie czy to było krótkie naciśnięcie
                 if (buttonState.releasedTime - buttonState.pressedTime < LONG_PRESS_TIME) {
-                    // Przełącz tryb serwisowy
-                    status.isServiceMode = !status.isServiceMode;
+                    // Przełącz tryb serwisowy (wyłączenie pompy obsługuje maszyna stanów)
+                    pumpDispatch(pumpIsService(status.pumpState) ? EV_SERVICE_OFF : EV_SERVICE_ON);
                     playConfirmationSound();  // Sygnał potwierdzenia zmiany trybu
-                    switchService.setState(status.isServiceMode, true);  // force update w HA
-                    
+
                     // Log zmiany stanu
-                    DEBUG_PRINTF("Tryb serwisowy: %s (przez przycisk)\n", status.isServiceMode ? "WŁĄCZONY" : "WYŁĄCZONY");
-                    
-                    // Jeśli włączono tryb serwisowy podczas pracy pompy
-                    if (status.isServiceMode && status.isPumpActive) {
-                        digitalWrite(POMPA_PIN, LOW);  // Wyłącz pompę
-                        status.isPumpActive = false;  // Reset flagi aktywności
-                        status.pumpStartTime = 0;  // Reset czasu startu
-                        sensorPump.setValue("OFF");  // Aktualizacja w HA
-                    }
+                    DEBUG_PRINTF("Tryb serwisowy: %s (przez przycisk)\n", pumpIsService(status.pumpState) ? "WŁĄCZONY" : "WYŁĄCZONY");
                 }
             }
         }
@@ -291,12 +256,10 @@ void handleButton() {
         // Obsługa długiego naciśnięcia (reset blokady pompy)
         if (reading == LOW && !buttonState.isLongPressHandled) {
             if (millis() - buttonState.pressedTime >= LONG_PRESS_TIME) {
-                ESP.wdtFeed();  // Reset przy długim naciśnięciu
-                status.pumpSafetyLock = false;  // Zdjęcie blokady pompy
+                platformWatchdogFeed();  // Reset przy długim naciśnięciu
+                pumpDispatch(EV_ALARM_RESET);  // Zdjęcie blokady pompy (i aktualizacja HA)
                 playConfirmationSound();  // Sygnał potwierdzenia zmiany trybu
-                switchPumpAlarm.setState(false, true);  // force update w HA
                 buttonState.isLongPressHandled = true;  // Oznacz jako obsłużone
-                DEBUG_PRINT("Alarm pompy skasowany");
             }
         }
     }
@@ -316,50 +279,96 @@ void handleButton() {
 
 // ** Funkcja setup - inicjalizacja urządzeń i konfiguracja **
 
+// Pierwszy pomiar przed uzbrojeniem pompy (SENSOR_AVG_SAMPLES próbek, ~110 ms)
+static void bootFirstMeasurement() {
+    const unsigned long BOOT_MEASUREMENT_TIMEOUT_US = 150000UL;
+    unsigned long start = micros();
+    updateWaterLevel();  // Start pomiaru
+    while (!measurementResultReady() && micros() - start < BOOT_MEASUREMENT_TIMEOUT_US) {
+        ultrasonicTask();
+        yield();
+    }
+    updateWaterLevel();  // Przetworzenie wyniku (i start kolejnego pomiaru)
+    timers.lastMeasurement = millis64();
+}
+
+// Etapy sieciowe startu - po jednym na iterację pętli, pompa działa już w tym czasie
+static void bootTask() {
+    if (!bootReached(BOOT_WIFI_STARTED)) {
+        setupWiFi();  // Nieblokujące łączenie WiFi
+        bootMark(BOOT_WIFI_STARTED);
+    } else if (!bootReached(BOOT_WEB_SERVER)) {
+        setupWebServer();  // Serwer www
+        webSocket.begin();
+        webSocket.onEvent(webSocketEvent);
+        bootMark(BOOT_WEB_SERVER);
+    } else if (!bootReached(BOOT_HA)) {
+        // Identyfikator z adresu MAC przed setupHA() - z niego powstają tematy
+        // MQTT urządzenia (discovery, config/set, OTA), więc musi być unikalny
+        byte mac[6];
+        WiFi.macAddress(mac);
+        device.setUniqueId(mac, sizeof(mac));
+        setupHA();  // Konfiguracja Home Assistant
+        firstUpdateHA();  // Pierwsze odczyty trafiają do kolejki publikacji
+        DEBUG_PRINT("Rozpoczynam połączenie MQTT...");
+        connectMQTT();
+        bootMark(BOOT_HA);
+    } else if (!bootReached(BOOT_OTA)) {
+        ArduinoOTA.setHostname("HydroSense");  // Ustaw nazwę urządzenia
+        ArduinoOTA.setPassword("hydrosense");  // Ustaw hasło dla OTA
+        ArduinoOTA.onEnd([]() { warmCheckpoint(); });  // Stan przetrwa restart po aktualizacji
+        ArduinoOTA.begin();  // Uruchom OTA
+        bootMark(BOOT_OTA);
+        DEBUG_PRINT("Setup zakończony pomyślnie!");
+        if (status.soundEnabled) {  // Gdy jest włączony dzwięk
+            welcomeMelody();  //  to odegraj muzyczkę, że program poprawnie wystartował
+        }
+    } else {
+        if (WiFi.status() == WL_CONNECTED) bootMark(BOOT_WIFI_CONNECTED);
+        if (mqtt.isConnected()) bootMark(BOOT_MQTT_CONNECTED);
+    }
+}
+
+static void controlIteration(uint64_t currentMillis);
+static void networkIteration(uint64_t currentMillis);
+#if defined(ARDUINO_ARCH_ESP32)
+static void networkTaskIteration(uint64_t currentMillis);
+#endif
+
 void setup() {
-    ESP.wdtEnable(WATCHDOG_TIMEOUT);  // Aktywacja watchdoga
+    // Etapy krytyczne: piny, konfiguracja, pomiar i pompa - reszta w tle (bootTask)
+    setupPin();  // Ustawienia GPIO - pompa wyłączona jak najwcześniej
+    bootRecorderInit();
+    loopWatchdogInit();  // Ślad etapu sprzed resetu (RTC) i przyczyna resetu
+    warmRestore();  // Filtr, alarmy, blokada pompy i oś czasu sprzed resetu programowego
+    bootMark(BOOT_PINS);
+    platformWatchdogBegin(WATCHDOG_TIMEOUT);  // Aktywacja watchdoga
     Serial.begin(115200);  // Inicjalizacja portu szeregowego
     DEBUG_PRINTF("\nHydroSense start...");  // Komunikat startowy
-    
-    // Wczytaj konfigurację na początku
+
+    // Konfiguracja wczytywana raz; przy błędzie loadConfig() zapisuje domyślną
     if (!loadConfig()) {
         DEBUG_PRINTF("Błąd wczytywania konfiguracji - używam ustawień domyślnych");
-        setDefaultConfig();
-        saveConfig();  // Zapisz domyślną konfigurację do EEPROM
-    }
-    
-    setupPin();  // Ustawienia GPIO
-    setupWiFi();  // Nawiązanie połączenia WiFi
-    setupWebServer();  // Serwer www    
-    webSocket.begin();
-    webSocket.onEvent(webSocketEvent);
-
-    // Próba połączenia MQTT
-    DEBUG_PRINT("Rozpoczynam połączenie MQTT...");
-    connectMQTT();
-
-    setupHA();  // Konfiguracja Home Assistant
-   
-    // Wczytaj konfigurację z EEPROM
-    if (loadConfig()) {        
-        status.soundEnabled = config.soundEnabled;  // Synchronizuj stan dźwięku z wczytanej konfiguracji
     }
-    
-    firstUpdateHA();  // Wyślij pierwsze odczyty do Home Assistant
-    status.lastSoundAlert = millis();
-    
-    // Konfiguracja OTA
-    ArduinoOTA.setHostname("HydroSense");  // Ustaw nazwę urządzenia
-    ArduinoOTA.setPassword("hydrosense");  // Ustaw hasło dla OTA
-    ArduinoOTA.begin();  // Uruchom OTA    
-    
-    DEBUG_PRINT("Setup zakończony pomyślnie!");
+    status.soundEnabled = config.soundEnabled;  // Synchronizuj stan dźwięku z wczytanej konfiguracji
+    bootMark(BOOT_CONFIG);
+
+    bootFirstMeasurement();
+    bootMark(BOOT_FIRST_MEASUREMENT);
+
+    updatePump();  // Maszyna stanów pompy na aktualnym pomiarze
+    status.lastSoundAlert = millis64();
+    bootMark(BOOT_PUMP_ARMED);
+
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%lu", (unsigned long)(bootTimelineAt(bootCurrent(), BOOT_PUMP_ARMED) / 1000UL));
+    sensorBootArmed.setValue(buf);
+
+#if defined(ARDUINO_ARCH_ESP32)
+    // Sterowanie na rdzeniu 1, sieć na rdzeniu 0 - wymiana przez kolejki (control_task.h)
+    controlStartTasks(controlIteration, networkTaskIteration);
+#endif
 
-    // Powitanie
-    if (status.soundEnabled) {  // Gdy jest włączony dzwięk
-        welcomeMelody();  //  to odegraj muzyczkę, że program poprawnie wystartował
-    }  
-        
     // Ustawienia fabryczne    
     // Czekaj 2 sekundy na wciśnięcie przycisku
     // unsigned long startTime = millis();
@@ -373,48 +382,97 @@ void setup() {
 
 // ** Funkcja loop - główny cykl pracy urządzenia **
 
-void loop() {
-    unsigned long currentMillis = millis();  // Pobierz bieżącą wartość millis()
-
+// Sterowanie: pomiar, pompa, przycisk, alarmy i buzzer - bez operacji sieciowych
+static void controlIteration(uint64_t currentMillis) {
     // KRYTYCZNE OPERACJE CZASOWE
-    handleMillisOverflow();  // Obsługa przepełnienia millis()
+    loopStage(LS_ULTRASONIC);
     ultrasonicTask(); // progresja stanu pomiaru ultradźwiękowego (nieblokująca)
+    loopStage(LS_PUMP);
     updatePump();   // Aktualizacja stanu pompy
-    ESP.wdtFeed();  // Reset watchdog timer ESP
+    platformWatchdogFeed();  // Reset watchdog timer ESP
     yield();        // Umożliwienie przetwarzania innych zadań
 
     // BEZPOŚREDNIA INTERAKCJA
+    loopStage(LS_BUTTON);
     handleButton();          // Obsługa naciśnięcia przycisku
+    loopStage(LS_ALARMS);
     checkAlarmConditions();  // Sprawdzenie warunków alarmowych
-    server.handleClient();   // Obsługa serwera WWW
-    webSocket.loop();
+    loopStage(LS_BUZZER);
+    buzzerTask();            // Kolejny krok wzorca dźwięku (bez delay)
 
     // POMIARY I AKTUALIZACJE
-    if (currentMillis - timers.lastMeasurement >= MEASUREMENT_INTERVAL) {
+    unsigned long measurementInterval = pumpOutputOn(status.pumpState) ? PUMP_MEASUREMENT_INTERVAL : MEASUREMENT_INTERVAL;
+    if (currentMillis - timers.lastMeasurement >= measurementInterval) {
+        loopStage(LS_MEASUREMENT);
         updateWaterLevel();                      // Aktualizacja poziomu wody
         timers.lastMeasurement = currentMillis;  // Aktualizacja znacznika czasu ostatniego pomiaru
+        heapStatsPublish();                      // Najgorsze wartości sterty do HA
+    }
+}
+
+// Sieć: start w tle, HTTP, WebSocket, MQTT/HA, OTA i utrzymanie połączeń
+static void networkIteration(uint64_t currentMillis) {
+    // START W TLE (sieć, HA, OTA - po jednym etapie na iterację)
+    if (!bootReached(BOOT_MQTT_CONNECTED)) {
+        loopStage(LS_BOOT_TASK);
+        bootTask();
+    }
+
+    if (bootReached(BOOT_OTA)) {
+        haMqttPoll();   // Przed HTTP - obsługa strony nie opóźnia poleceń
+    }
+
+    if (bootReached(BOOT_WEB_SERVER)) {
+        loopStage(LS_HTTP);
+        server.handleClient();   // Obsługa serwera WWW
+        loopStage(LS_HTTP_STREAM);
+        httpStreamLoop();        // Strumieniowe odpowiedzi (limit bajtów na iterację)
+        loopStage(LS_WEBSOCKET);
+        webSocket.loop();
+        logWebSocketLoop();      // Nowe wpisy dziennika do klientów WebSocket
     }
 
-    // KOMUNIKACJA
-    if (currentMillis - timers.lastMQTTLoop >= MQTT_LOOP_INTERVAL) {
-        mqtt.loop();  // Obsługa pętli MQTT
-        timers.lastMQTTLoop = currentMillis;  // Aktualizacja znacznika czasu ostatniej pętli MQTT
+    if (currentMillis - timers.lastHeapStats >= HEAP_STATS_INTERVAL) {
+        loopStage(LS_HEAP_STATS);
+        heapStatsUpdate();                       // Śledzenie minimum wolnej pamięci i fragmentacji
+        timers.lastHeapStats = currentMillis;
     }
 
+    // KOMUNIKACJA (dopiero po odpowiednich etapach startu)
+    if (!bootReached(BOOT_OTA)) return;
+
+    haMqttService(currentMillis);  // Keepalive, discovery HA i ponowne łączenie z brokerem
+
     if (currentMillis - timers.lastOTACheck >= OTA_CHECK_INTERVAL) {
+        loopStage(LS_OTA);
         ArduinoOTA.handle();                  // Obsługa aktualizacji OTA
         timers.lastOTACheck = currentMillis;  // Aktualizacja znacznika czasu ostatniego sprawdzenia OTA
     }
+    loopStage(LS_OTA);
+    otaPullLoop(currentMillis);  // Manifest z serwera i jedna porcja obrazu na iterację
 
     // ZARZĄDZANIE POŁĄCZENIEM (z backoffem)
+    loopStage(LS_WIFI);
     handleWiFiBackoff();
+}
 
-    if (!mqtt.isConnected() && 
-        (currentMillis - timers.lastMQTTRetry >= MQTT_RETRY_INTERVAL)) {
-        timers.lastMQTTRetry = currentMillis;                          // Aktualizacja znacznika czasu ostatniej próby połączenia MQTT
-        DEBUG_PRINT(F("Brak połączenia MQTT - próba połączenia..."));  // Wydrukuj komunikat debugowania
-        if (!mqtt.begin(config.mqtt_server, 1883, config.mqtt_user, config.mqtt_password)) {
-            DEBUG_PRINT(F("MQTT połączono ponownie!"));                // Wydrukuj komunikat debugowania
-        }
-    }
-}
\ No newline at end of file
+#if defined(ARDUINO_ARCH_ESP32)
+static void networkTaskIteration(uint64_t currentMillis) {
+    loopStatsRecord();  // Czas od poprzedniej iteracji zadania sieci (GET /loop)
+    loopWatchdogTick(); // Zawieszenia sieci - sterowanie działa dalej na drugim rdzeniu
+    networkIteration(currentMillis);
+}
+
+void loop() {
+    vTaskDelete(NULL);  // Pracę przejęły zadania sterowania i sieci (controlStartTasks)
+}
+#else
+void loop() {
+    loopStatsRecord();  // Czas od poprzedniej iteracji (GET /loop)
+    loopWatchdogTick(); // Zawieszenia dłuższe niż config.loop_stall_ms
+    uint64_t currentMillis = millis64();  // Czas monotoniczny - bez obsługi przepełnienia
+
+    controlIteration(currentMillis);
+    networkIteration(currentMillis);
+}
+#endif
@@ -1,6 +1,12 @@
 #include "measurements.h"
 #include "globals.h"
 #include "pins.h"
+#include "filters.h"
+#include "mono_clock.h"
+#include "pump_control.h"
+#include "sensor_health.h"
+#include "strbuf.h"
+#include "warm_restart.h"
 
 // Non-blocking ultrasonic measurement state machine
 enum USState { US_IDLE, US_TRIG, US_WAIT_HIGH, US_WAIT_LOW, US_DELAY, US_DONE };
@@ -9,23 +15,25 @@ static int us_samples[8];
 static int us_sampleIndex = 0;
 static unsigned long us_triggerMicros = 0;
 static unsigned long us_echoStartMicros = 0;
-static unsigned long us_timeoutMicros = 0;
-static unsigned long us_nextSampleMillis = 0;
+static unsigned long us_stageStartMicros = 0;   // start of the current wait (wrap-safe elapsed check)
+static uint64_t us_nextSampleMillis = 0;
+static const unsigned long US_ECHO_TIMEOUT_US = 25000UL;  // 25ms timeout
 static bool us_resultReady = false;
 static int us_resultDistance = -1;
+static RobustFilter us_filter = {};
+static SensorHealth us_health = {};
 
 static void startTrigger() {
     digitalWrite(PIN_ULTRASONIC_TRIG, LOW);
     // start pulse
     digitalWrite(PIN_ULTRASONIC_TRIG, HIGH);
     us_triggerMicros = micros();
-    us_timeoutMicros = us_triggerMicros + 25000UL; // 25ms timeout
     us_state = US_TRIG;
 }
 
 void ultrasonicTask() {
     unsigned long nowMicros = micros();
-    unsigned long nowMillis = millis();
+    uint64_t nowMillis = millis64();
 
     switch (us_state) {
         case US_IDLE:
@@ -36,16 +44,17 @@ void ultrasonicTask() {
             if (nowMicros - us_triggerMicros >= 10UL) {
                 digitalWrite(PIN_ULTRASONIC_TRIG, LOW);
                 us_state = US_WAIT_HIGH;
-                us_timeoutMicros = micros() + 25000UL;
+                us_stageStartMicros = micros();
             }
             break;
         case US_WAIT_HIGH:
             if (digitalRead(PIN_ULTRASONIC_ECHO) == HIGH) {
                 us_echoStartMicros = micros();
                 us_state = US_WAIT_LOW;
-                us_timeoutMicros = us_echoStartMicros + 25000UL;
-            } else if (micros() > us_timeoutMicros) {
+                us_stageStartMicros = us_echoStartMicros;
+            } else if (micros() - us_stageStartMicros > US_ECHO_TIMEOUT_US) {
                 // timeout waiting for high
+                healthSample(us_health, SAMPLE_TIMEOUT_HIGH, 0);
                 us_samples[us_sampleIndex++] = -1;
                 us_nextSampleMillis = nowMillis + ULTRASONIC_TIMEOUT;
                 us_state = (us_sampleIndex < SENSOR_AVG_SAMPLES) ? US_DELAY : US_DONE;
@@ -55,11 +64,13 @@ void ultrasonicTask() {
             if (digitalRead(PIN_ULTRASONIC_ECHO) == LOW) {
                 unsigned long duration = micros() - us_echoStartMicros;
                 int distance = (duration * 343) / 2000; // mm
+                healthSample(us_health, SAMPLE_OK, duration);
                 us_samples[us_sampleIndex++] = distance;
                 us_nextSampleMillis = nowMillis + ULTRASONIC_TIMEOUT;
                 us_state = (us_sampleIndex < SENSOR_AVG_SAMPLES) ? US_DELAY : US_DONE;
-            } else if (micros() > us_timeoutMicros) {
+            } else if (micros() - us_stageStartMicros > US_ECHO_TIMEOUT_US) {
                 // timeout waiting for low
+                healthSample(us_health, SAMPLE_TIMEOUT_LOW, 0);
                 us_samples[us_sampleIndex++] = -1;
                 us_nextSampleMillis = nowMillis + ULTRASONIC_TIMEOUT;
                 us_state = (us_sampleIndex < SENSOR_AVG_SAMPLES) ? US_DELAY : US_DONE;
@@ -70,56 +81,43 @@ void ultrasonicTask() {
                 startTrigger();
             }
             break;
-        case US_DONE:
-            // compute median of valid samples
-            {
-                int validCount = 0;
-                for (int i = 0; i < us_sampleIndex; ++i) if (us_samples[i] != -1) validCount++;
-                    if (validCount < (SENSOR_AVG_SAMPLES / 2)) {
-                        us_resultDistance = -1;
-                    } else {
-                    int tmp[validCount];
-                    int idx = 0;
-                    for (int i = 0; i < us_sampleIndex; ++i) if (us_samples[i] != -1) tmp[idx++] = us_samples[i];
-                    // simple sort
-                    for (int i = 0; i < validCount-1; ++i) for (int j = 0; j < validCount-i-1; ++j) if (tmp[j] > tmp[j+1]) { int t = tmp[j]; tmp[j]=tmp[j+1]; tmp[j+1]=t; }
-                    int median = (validCount % 2 == 0) ? ((tmp[validCount/2 -1] + tmp[validCount/2]) / 2) : tmp[validCount/2];
-                    // If we have more than 2 samples, compute trimmed mean (remove min/max) for stability
-                    if (validCount > 2) {
-                        long sum = 0;
-                        for (int i = 1; i < validCount-1; ++i) sum += tmp[i];
-                        int trimmedCount = validCount - 2;
-                        int trimmedMean = (int)(sum / trimmedCount);
-                        us_resultDistance = trimmedMean;
-                    } else {
-                        us_resultDistance = median;
-                    }
-                }
-                us_resultReady = true;
-                // Apply range check and smoothing (EMA) to produce a stable measurement
-                if (us_resultDistance >= 0) {
-                    if (us_resultDistance < SENSOR_MIN_RANGE || us_resultDistance > SENSOR_MAX_RANGE) {
-                        // reject out-of-range reading
-                        us_resultDistance = -1;
-                    } else {
-                        // if first valid measurement, initialize filter
-                        if (lastFilteredDistance <= 0) {
-                            lastFilteredDistance = (float)us_resultDistance;
-                        } else {
-                            float delta = fabs((float)us_resultDistance - lastFilteredDistance);
-                            // reject large spikes
-                            if (delta <= 200.0f) {
-                                lastFilteredDistance = (1.0f - EMA_ALPHA) * lastFilteredDistance + EMA_ALPHA * (float)us_resultDistance;
-                            } // else keep previous filtered value (ignore spike)
-                        }
-                    }
+        case US_DONE: {
+            // median / trimmed mean of valid samples, then range check and robust EMA
+            us_resultDistance = reduceSamples(us_samples, us_sampleIndex, SENSOR_AVG_SAMPLES / 2);
+            us_resultReady = true;
+            CycleOutcome outcome = CYCLE_TOO_FEW_SAMPLES;
+            if (us_resultDistance >= 0) {
+                if (us_resultDistance < SENSOR_MIN_RANGE || us_resultDistance > SENSOR_MAX_RANGE) {
+                    // reject out-of-range reading
+                    us_resultDistance = -1;
+                    outcome = CYCLE_OUT_OF_RANGE;
+                } else {
+                    // Hampel gate instead of a fixed 200 mm threshold: spikes are rejected,
+                    // but a sustained level change is accepted after ROBUST_CONFIRM cycles
+                    uint32_t rejectedBefore = us_filter.rejected;
+                    lastFilteredDistance = robustUpdate(us_filter, us_resultDistance, EMA_ALPHA);
+                    outcome = (us_filter.rejected != rejectedBefore) ? CYCLE_SPIKE_REJECTED : CYCLE_OK;
+                    // Odczyt czekający na potwierdzenie zmiany poziomu nie odświeża pomiaru
+                    if (us_filter.pendingCount == 0) status.lastSuccessfulMeasurement = nowMillis;
                 }
             }
+            healthCycle(us_health, outcome);
             us_state = US_IDLE;
             break;
+        }
     }
 }
 
+// Wynik pomiaru czeka na przetworzenie przez updateWaterLevel()
+bool measurementResultReady() {
+    return us_resultReady;
+}
+
+// Impuls wyzwalający lub oczekiwanie na echo - wymaga częstego odpytywania
+bool measurementInProgress() {
+    return us_state == US_TRIG || us_state == US_WAIT_HIGH || us_state == US_WAIT_LOW;
+}
+
 // Zwróć bieżący poziom wody w zbiorniku
 float getCurrentWaterLevel() {
     int distance = measureDistance();
@@ -162,27 +160,43 @@ void updateAlarmStates(float currentDistance) {
     }
 }
 
+// Jakość sygnału i alarm nieaktualnego pomiaru do HA (setValue pomija powtórzenia)
+static void publishSensorHealth() {
+    char buf[8];
+    snprintf(buf, sizeof(buf), "%d", healthScore(us_health));
+    sensorSignalQuality.setValue(buf);
+    bool stale = healthStale(status.lastSuccessfulMeasurement, millis64(), SENSOR_STALE_TIMEOUT);
+    sensorStale.setValue(stale ? "ON" : "OFF");
+}
+
+static void startMeasurement() {
+    us_sampleIndex = 0;
+    us_resultReady = false;
+    startTrigger();
+}
+
 // Aktualizuj poziom wody i wyślij dane do Home Assistant
 void updateWaterLevel() {
     // Non-blocking: if ultrasonic measurement not started, start it and return.
     if (us_state == US_IDLE && !us_resultReady) {
-        us_sampleIndex = 0;
-        us_resultReady = false;
-        startTrigger();
+        startMeasurement();
         return;
     }
 
     // If measurement not yet ready, skip processing this cycle
     if (!us_resultReady) return;
 
-    // Use measurement result
-    if (us_resultDistance < 0) {
-        us_resultReady = false;
-        return;
-    }
+    // Pomiar potokowy: wynik zużyty, od razu startuje następny, więc każde
+    // wywołanie (także co sekundę w trakcie pracy pompy) ma świeży odczyt
+    int resultDistance = us_resultDistance;
+    startMeasurement();
+    publishSensorHealth();
+    if (resultDistance < 0) return;
+
     // Use filtered value for downstream logic to avoid reacting to spikes
     currentDistance = (int)lastFilteredDistance;
-    us_resultReady = false;
+    if (pumpOutputOn(status.pumpState)) pumpFlowSample(millis64(), currentDistance);
+    else pumpIdleSample(millis64(), currentDistance);
 
     updateAlarmStates(currentDistance);
 
@@ -209,5 +223,45 @@ void updateWaterLevel() {
         lastReportedDistance = currentDistance;
     }
 
-    timers.lastMeasurement = millis();
+    timers.lastMeasurement = millis64();
+    warmCheckpoint();
+}
+
+RobustFilter& measurementFilter() {
+    return us_filter;
+}
+
+// GET /sensor - liczniki diagnostyczne czujnika
+void handleSensorHealth() {
+    static char out[320];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    sbAppend(sb, "{\"score\":");
+    sbAppendInt(sb, healthScore(us_health));
+    sbAppend(sb, ",\"stale\":");
+    sbAppend(sb, healthStale(status.lastSuccessfulMeasurement, millis64(), SENSOR_STALE_TIMEOUT) ? "true" : "false");
+    sbAppend(sb, ",\"cycles\":");
+    sbAppendUInt(sb, us_health.cycles);
+    sbAppend(sb, ",\"samples\":");
+    sbAppendUInt(sb, us_health.samples);
+    sbAppend(sb, ",\"valid_samples\":");
+    sbAppendUInt(sb, us_health.validSamples);
+    sbAppend(sb, ",\"timeout_high\":");
+    sbAppendUInt(sb, us_health.timeoutHigh);
+    sbAppend(sb, ",\"timeout_low\":");
+    sbAppendUInt(sb, us_health.timeoutLow);
+    sbAppend(sb, ",\"too_few_samples\":");
+    sbAppendUInt(sb, us_health.tooFewSamples);
+    sbAppend(sb, ",\"out_of_range\":");
+    sbAppendUInt(sb, us_health.outOfRange);
+    sbAppend(sb, ",\"spike_rejected\":");
+    sbAppendUInt(sb, us_health.spikeRejected);
+    sbAppend(sb, ",\"valid_ratio_pct\":");
+    sbAppendInt(sb, (long)(us_health.validRatio * 100.0f + 0.5f));
+    sbAppend(sb, ",\"jitter_mm10\":");
+    sbAppendInt(sb, (long)(healthJitterMm(us_health) * 10.0f + 0.5f));
+    sbAppend(sb, ",\"last_ok_age_s\":");
+    sbAppendUInt(sb, (unsigned long)((millis64() - status.lastSuccessfulMeasurement) / 1000ULL));
+    sbAppendChar(sb, '}');
+    server.send(200, "application/json", out);
 }
@@ -2,6 +2,7 @@
 #define MEASUREMENTS_H
 
 #include <Arduino.h>
+#include "filters.h"
 
 float getCurrentWaterLevel();
 int measureDistance();
@@ -9,5 +10,10 @@ int calculateWaterLevel(int distance);
 void updateWaterLevel();
 void updateAlarmStates(float currentDistance);
 void ultrasonicTask();
+bool measurementResultReady();
+bool measurementInProgress();
+void handleSensorHealth();
+// Stan filtra pomiaru (migawka ciepłego restartu)
+RobustFilter& measurementFilter();
 
 #endif // MEASUREMENTS_H
@@ -0,0 +1,34 @@
+#include "mono_clock.h"
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_timer.h>
+#endif
+
+uint64_t monoClockExtend(MonoClock& clock, uint32_t now32) {
+    if (now32 < clock.last) clock.wraps++;
+    clock.last = now32;
+    return clock.offset + (((uint64_t)clock.wraps << 32) | now32);
+}
+
+#ifdef ARDUINO
+static MonoClock systemClock = {0, 0, 0};
+
+#if defined(ARDUINO_ARCH_ESP32)
+// Wołane z zadań na obu rdzeniach - rozszerzanie millis() przez wspólny
+// MonoClock mogłoby policzyć przepełnienie dwa razy. Licznik esp_timer jest
+// 64-bitowy, więc wystarczy dodać przesunięcie z ciepłego restartu.
+uint64_t millis64() {
+    return systemClock.offset + (uint64_t)(esp_timer_get_time() / 1000);
+}
+#else
+uint64_t millis64() {
+    return monoClockExtend(systemClock, millis());
+}
+#endif
+
+void millis64Resume(uint64_t offsetMs) {
+    systemClock.offset = offsetMs;
+}
+#endif
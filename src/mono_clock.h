@@ -0,0 +1,27 @@
+#ifndef MONO_CLOCK_H
+#define MONO_CLOCK_H
+
+#include <stdint.h>
+
+// 64-bitowy monotoniczny czas w ms. Rozszerza 32-bitowy licznik millis()
+// o licznik przepełnień, więc znaczniki czasu nigdy się nie zawijają
+// (2^64 ms to ponad 500 mln lat) i nie wymagają specjalnej obsługi.
+// Warunek: odczyt co najmniej raz na 49,7 dnia - pętla główna robi to stale.
+struct MonoClock {
+    uint32_t last;    // Ostatni odczyt licznika 32-bitowego
+    uint32_t wraps;   // Liczba przepełnień
+    uint64_t offset;  // Czas sprzed ciepłego restartu (0 po włączeniu zasilania)
+};
+
+// Czysta funkcja rozszerzająca (testowana natywnie)
+uint64_t monoClockExtend(MonoClock& clock, uint32_t now32);
+
+// Czas od startu w ms (ESP8266: millis() rozszerzone, ESP32: 64-bitowy esp_timer)
+uint64_t millis64();
+
+#ifdef ARDUINO
+// Kontynuacja osi czasu po ciepłym restarcie - wywołać przed pierwszym millis64()
+void millis64Resume(uint64_t offsetMs);
+#endif
+
+#endif // MONO_CLOCK_H
@@ -1,9 +1,23 @@
 #include "network.h"
 #include "globals.h"
+#include "strbuf.h"
+#include "heap_stats.h"
+#include "boot_timeline.h"
+#include "config_schema.h"
+#include "measurements.h"
+#include "http_stream.h"
+#include "loop_stats.h"
+#include "loop_watchdog.h"
+#include "mono_clock.h"
+#include "warm_restart.h"
+#include "ha_discovery.h"
+#include "wifi_cache.h"
+#include "log_ring.h"
+#include "ota_pull.h"
 #include <WiFiManager.h>
 #include <EEPROM.h>
-#include <ESP8266HTTPUpdateServer.h>
-// Update API is provided by the ESP8266 core headers already included via other headers
+
+const size_t CONFIG_DOC_MAX = 1024;     // Maksymalny rozmiar dokumentu PUT /config
 
 // Konfiguracja strony i formularzy (przeniesione z main.cpp)
 const char CONFIG_PAGE[] PROGMEM = R"rawliteral(
@@ -79,7 +93,7 @@ const char CONFIG_PAGE[] PROGMEM = R"rawliteral(
                         if(obj && obj.status === 'ok'){
                             status.innerHTML = '<div style="color:#7bd389">'+(obj.message||'Zapisano')+'</div>';
                         } else {
-                            status.innerHTML = '<div style="color:#ff8a8a">'+(obj?obj.message:'Błąd serwera')+'</div>';
+                            status.innerHTML = '<div style="color:#ff8a8a">'+(obj&&obj.errors?'Błędne pola: '+Object.keys(obj.errors).join(', '):'Błąd serwera')+'</div>';
                         }
                     }).catch(err=>{ status.innerHTML = '<div style="color:#ff8a8a">Błąd połączenia</div>'; });
                 });
@@ -156,6 +170,34 @@ const char CONFIG_PAGE[] PROGMEM = R"rawliteral(
                                 </div>
                             </div>
 
+                            <div style="margin-top:12px" class="section-title"><strong>Pompa</strong><span class="muted">Czasy i kontrola przepływu</span></div>
+                            <div class="field-grid">
+                                <div>
+                                    <label>Opóźnienie startu [s]</label>
+                                    <input type='number' name='pump_delay' value='%PUMP_DELAY%'>
+                                </div>
+                                <div>
+                                    <label>Maks. czas pracy [s]</label>
+                                    <input type='number' name='pump_work_time' value='%PUMP_WORK_TIME%'>
+                                </div>
+                                <div>
+                                    <label>Okno kontroli przepływu [s] (0 = wył.)</label>
+                                    <input type='number' name='flow_check_window' value='%FLOW_CHECK_WINDOW%'>
+                                </div>
+                                <div>
+                                    <label>Min. spadek poziomu w oknie [mm]</label>
+                                    <input type='number' name='flow_min_drawdown' value='%FLOW_MIN_DRAWDOWN%'>
+                                </div>
+                                <div>
+                                    <label>Alarm wycieku: ubytek w postoju [mm/dobę] (0 = wył.)</label>
+                                    <input type='number' name='leak_limit' value='%LEAK_LIMIT%'>
+                                </div>
+                                <div>
+                                    <label>Okno oceny ubytku [h]</label>
+                                    <input type='number' name='leak_window' value='%LEAK_WINDOW%'>
+                                </div>
+                            </div>
+
                             <div style="margin-top:16px;display:flex;gap:10px;align-items:center">
                                 <button type='submit' class='btn'>Zapisz ustawienia</button>
                                 <button type='button' class='btn ghost' onclick="toggle('wifi-networks')">Pokaż sieci Wi‑Fi</button>
@@ -208,73 +250,79 @@ const char PAGE_FOOTER[] PROGMEM = R"rawliteral(
 </div>
 )rawliteral";
 
-String getConfigPage() {
-    String html = FPSTR(CONFIG_PAGE);
-    bool mqttConnected = client.connected();
-    String mqttStatus = mqttConnected ? "Połączony" : "Rozłączony";
-    String mqttStatusClass = mqttConnected ? "success" : "error";
-
-    String buttons = F(
-        "<div style='display:flex;flex-direction:column;gap:8px'>"
-        "<button class='btn ghost small' onclick='confirmAction(\"Czy na pewno zrestartować urządzenie?\", \"/reboot\")'>Restart</button>"
-        "<button class='btn ghost small' onclick='confirmAction(\"Przywrócić ustawienia fabryczne?\", \"/factory-reset\")'>Factory reset</button>"
-        "</div>"
-    );
-
-    html.replace("%MQTT_STATUS%", mqttStatus);
-    html.replace("%MQTT_STATUS_CLASS%", mqttStatusClass == "success" ? "Połączony" : "Rozłączony");
-    html.replace("%SOFTWARE_VERSION%", SOFTWARE_VERSION);
-    html.replace("%BUTTONS%", buttons);
-    html.replace("%UPDATE_FORM%", FPSTR(UPDATE_FORM));
-    html.replace("%FOOTER%", FPSTR(PAGE_FOOTER));
-
-    // Fill dynamic fields
-    html.replace("%MQTT_SERVER%", String(config.mqtt_server));
-    html.replace("%MQTT_PORT%", String(config.mqtt_port));
-    html.replace("%MQTT_USER%", String(config.mqtt_user));
-
-    html.replace("%TANK_EMPTY%", String(config.tank_empty));
-    html.replace("%TANK_FULL%", String(config.tank_full));
-    html.replace("%RESERVE_LEVEL%", String(config.reserve_level));
-    html.replace("%TANK_DIAMETER%", String(config.tank_diameter));
-
-    // Placeholder for WiFi list – client can call /scan_wifi to populate
-    html.replace("%WIFI_LIST%", "<div class='muted'>Kliknij 'Pokaż sieci Wi‑Fi', aby przeskanować sieci.</div>");
-
-#if DEBUG
-    if (html.indexOf('%') != -1) {
-        DEBUG_PRINT("Uwaga: Niektóre znaczniki nie zostały zastąpione!");
-        int pos = html.indexOf('%');
-        int start = pos > 20 ? pos - 20 : 0;
-        DEBUG_PRINT(html.substring(start, pos + 20));
-    }
-#endif
+const char PAGE_BUTTONS[] PROGMEM =
+    "<div style='display:flex;flex-direction:column;gap:8px'>"
+    "<button class='btn ghost small' onclick='confirmAction(\"Czy na pewno zrestartować urządzenie?\", \"/reboot\")'>Restart</button>"
+    "<button class='btn ghost small' onclick='confirmAction(\"Przywrócić ustawienia fabryczne?\", \"/factory-reset\")'>Factory reset</button>"
+    "</div>";
+
+const char PAGE_WIFI_HINT[] PROGMEM = "<div class='muted'>Kliknij 'Pokaż sieci Wi‑Fi', aby przeskanować sieci.</div>";
+
+static TplValue tplProgmem(const char* p) { return TplValue{p, true, false}; }
+static TplValue tplText(const char* t) { return TplValue{t, false, true}; }
+static TplValue tplInt(long v, char* scratch, size_t cap) {
+    snprintf(scratch, cap, "%ld", v);
+    return TplValue{scratch, false, false};
+}
 
-    return html;
+// Wartości znaczników strony konfiguracji - wywoływane w trakcie wysyłki,
+// więc strona nigdy nie jest składana w całości w pamięci
+static TplValue resolveConfigPage(const char* name, size_t len, char* scratch, size_t cap) {
+    (void)len;
+    if (!strcmp(name, "MQTT_STATUS") || !strcmp(name, "MQTT_STATUS_CLASS")) {
+        return TplValue{client.connected() ? "Połączony" : "Rozłączony", false, false};
+    }
+    if (!strcmp(name, "SOFTWARE_VERSION")) return tplText(SOFTWARE_VERSION);
+    if (!strcmp(name, "BUTTONS")) return tplProgmem(PAGE_BUTTONS);
+    if (!strcmp(name, "UPDATE_FORM")) return tplProgmem(UPDATE_FORM);
+    if (!strcmp(name, "FOOTER")) return tplProgmem(PAGE_FOOTER);
+    if (!strcmp(name, "WIFI_LIST")) return tplProgmem(PAGE_WIFI_HINT);
+    if (!strcmp(name, "MQTT_SERVER")) return tplText(config.mqtt_server);
+    if (!strcmp(name, "MQTT_USER")) return tplText(config.mqtt_user);
+    if (!strcmp(name, "MQTT_PORT")) return tplInt(config.mqtt_port, scratch, cap);
+    if (!strcmp(name, "TANK_EMPTY")) return tplInt(config.tank_empty, scratch, cap);
+    if (!strcmp(name, "TANK_FULL")) return tplInt(config.tank_full, scratch, cap);
+    if (!strcmp(name, "RESERVE_LEVEL")) return tplInt(config.reserve_level, scratch, cap);
+    if (!strcmp(name, "TANK_DIAMETER")) return tplInt(config.tank_diameter, scratch, cap);
+    if (!strcmp(name, "PUMP_DELAY")) return tplInt(config.pump_delay, scratch, cap);
+    if (!strcmp(name, "PUMP_WORK_TIME")) return tplInt(config.pump_work_time, scratch, cap);
+    if (!strcmp(name, "FLOW_CHECK_WINDOW")) return tplInt(config.flow_check_window, scratch, cap);
+    if (!strcmp(name, "FLOW_MIN_DRAWDOWN")) return tplInt(config.flow_min_drawdown, scratch, cap);
+    if (!strcmp(name, "LEAK_LIMIT")) return tplInt(config.leak_limit, scratch, cap);
+    if (!strcmp(name, "LEAK_WINDOW")) return tplInt(config.leak_window, scratch, cap);
+    DEBUG_PRINTF("Uwaga: nieznany znacznik %%%s%%\n", name);
+    return TplValue{NULL, false, false};
 }
 
+// Strona (~10 KB) wysyłana strumieniowo przez httpStreamLoop()
 void handleRoot() {
-    server.send(200, "text/html", getConfigPage());
+    if (!httpStreamBegin("text/html", CONFIG_PAGE, resolveConfigPage)) {
+        server.sendHeader("Retry-After", "1");
+        server.send(503, "text/plain", "Busy");
+    }
 }
 
 void handleScanWifi() {
+    // Bufor statyczny - odpowiedź nie alokuje niczego na stercie
+    static char out[1024];
+    LoopStage prev = loopStage(LS_WIFI_SCAN);  // Skan blokuje ~2 s
     int n = WiFi.scanNetworks();
-    String out = "[";
-    for (int i = 0; i < n; ++i) {
-        String ssid = WiFi.SSID(i);
-        int rssi = WiFi.RSSI(i);
-        bool secure = WiFi.encryptionType(i) != ENC_TYPE_NONE;
-        // Escape quotes in SSID
-        ssid.replace("\"", "\\\"");
-        out += "{\"ssid\":\"" + ssid + "\",\"rssi\":" + String(rssi) + ",\"secure\":" + String(secure?1:0) + "}";
-        if (i < n-1) out += ",";
-    }
-    out += "]";
+    loopStage(prev);
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    wifiScanJson(sb, n, platformScanEntry);
+    WiFi.scanDelete();
     server.send(200, "application/json", out);
 }
 
 bool connectMQTT() {   
-    if (!mqtt.begin(config.mqtt_server, 1883, config.mqtt_user, config.mqtt_password)) {
+    LoopStage prev = loopStage(LS_MQTT_CONNECT);
+    // begin() tylko zapamiętuje ustawienia - połączenie nawiązuje mqtt.loop()
+    mqtt.begin(config.mqtt_server, config.mqtt_port, config.mqtt_user, config.mqtt_password);
+    mqtt.loop();
+    bool ok = mqtt.isConnected();
+    loopStage(prev);
+    if (!ok) {
         DEBUG_PRINT("\nBŁĄD POŁĄCZENIA MQTT!");
         return false;
     }
@@ -289,100 +337,122 @@ void setupWiFi() {
     char savedPass[65] = {0};
     if (loadNetworkCredentials(savedSsid, sizeof(savedSsid), savedPass, sizeof(savedPass))) {
         DEBUG_PRINT("Znaleziono zapisane poświadczenia WiFi, łączenie...");
-        WiFi.begin(savedSsid, savedPass);
+        wifiBegin(savedSsid, savedPass);  // Szybka ścieżka, gdy znany jest ostatni punkt dostępowy
     } else {
         // Fall back to default non-blocking begin (uses stored WiFi config or WiFiManager)
         WiFi.begin();
         DEBUG_PRINT("Rozpoczęto asynchroniczne łączenie WiFi (brak zapisanej sieci)");
     }
-    timers.lastWiFiAttempt = millis();
+    timers.lastWiFiAttempt = millis64();
 }
 
-void handleSave() {
-    if (server.method() != HTTP_POST) { server.send(405, "text/plain", "Method Not Allowed"); return; }
-    bool needMqttReconnect = false;
-
-    String oldServer = config.mqtt_server;
-    int oldPort = config.mqtt_port;
-    String oldUser = config.mqtt_user;
-    String oldPassword = config.mqtt_password;
-
-    // Read raw arguments first
-    String arg_mqtt_server = server.arg("mqtt_server");
-    int arg_mqtt_port = server.arg("mqtt_port").toInt();
-    String arg_mqtt_user = server.arg("mqtt_user");
-    String arg_mqtt_password = server.arg("mqtt_password");
-
-    int arg_tank_full = server.arg("tank_full").toInt();
-    int arg_tank_empty = server.arg("tank_empty").toInt();
-    int arg_reserve_level = server.arg("reserve_level").toInt();
-    int arg_tank_diameter = server.arg("tank_diameter").toInt();
-
-    String arg_wifi_ssid = server.arg("wifi_ssid");
-    String arg_wifi_pass = server.arg("wifi_pass");
-
-    // Server-side validation
-    if (!(arg_mqtt_port >= 1 && arg_mqtt_port <= 65535)) {
-        server.send(400, "application/json", "{\"status\":\"error\",\"message\":\"Nieprawidłowy port MQTT\"}");
-        return;
-    }
-    if (!(arg_tank_empty > arg_tank_full)) {
-        server.send(400, "application/json", "{\"status\":\"error\",\"message\":\"'tank_empty' musi być większe niż 'tank_full'\"}");
-        return;
-    }
+bool applyConfigUpdate(const ConfigUpdate& u) {
+    if (!u.changed) return false;
+    memcpy(&config, &u.staged, sizeof(Config));
+    saveConfig();
+    LOG_I(LM_CONFIG_SAVED, u.changed);
+    return u.needMqttReconnect;
+}
 
-    // Apply to config
-    strlcpy(config.mqtt_server, arg_mqtt_server.c_str(), sizeof(config.mqtt_server));
-    config.mqtt_port = arg_mqtt_port;
-    strlcpy(config.mqtt_user, arg_mqtt_user.c_str(), sizeof(config.mqtt_user));
-    strlcpy(config.mqtt_password, arg_mqtt_password.c_str(), sizeof(config.mqtt_password));
+void reconnectMqttForConfig() {
+    haSetJsonState(config.mqtt_json_state);  // Nowe discovery po ponownym połączeniu
+    // Bez warunku: po nieudanym połączeniu klient zostaje zainicjalizowany
+    // i begin() z nowymi danymi brokera zostałby zignorowany
+    mqtt.disconnect();
+    connectMQTT();
+}
 
-    config.tank_full = arg_tank_full;
-    config.tank_empty = arg_tank_empty;
-    config.reserve_level = arg_reserve_level;
-    config.tank_diameter = arg_tank_diameter;
+// Zastosowanie zwalidowanej aktualizacji: jeden zapis do flash i ponowne
+// połączenie z MQTT tylko gdy zmieniły się pola brokera
+static void commitConfigUpdate(const ConfigUpdate& u) {
+    if (applyConfigUpdate(u)) reconnectMqttForConfig();
+}
 
-    config.pump_delay = server.arg("pump_delay").toInt();
-    config.pump_work_time = server.arg("pump_work_time").toInt();
+static void sendConfigUpdateReport(const ConfigUpdate& u) {
+    static char out[256];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    configUpdateReport(sb, u);
+    server.send(u.issueCount ? 400 : 200, "application/json", out);
+}
 
-    if (oldServer != String(config.mqtt_server) || oldPort != config.mqtt_port || oldUser != String(config.mqtt_user) || oldPassword != String(config.mqtt_password)) {
-        needMqttReconnect = true;
-    }
+void handleSave() {
+    if (server.method() != HTTP_POST) { server.send(405, "text/plain", "Method Not Allowed"); return; }
 
-    saveConfig();
+    // Pola formularza parsowane i walidowane według tabeli CONFIG_FIELDS;
+    // argumenty kopiowane do stałych buforów (platformArg) zamiast String
+    static ConfigUpdate update;
+    static ConfigForm form;
+    static char name[24];
+    static char value[CONFIG_FORM_VALUE_MAX];
+    configFormBegin(update, form, config);
+    for (int i = 0; i < server.args(); ++i) {
+        if (platformArg(server, i, name, sizeof(name), value, sizeof(value))) configFormArg(update, form, name, value);
+    }
+    if (!configUpdateFinish(update, config)) {
+        sendConfigUpdateReport(update);
+        return;
+    }
+    commitConfigUpdate(update);
 
-    if (arg_wifi_ssid.length() > 0) {
+    if (form.wifiSsid[0]) {
         // Persist network credentials and attempt immediate connect
-        saveNetworkCredentials(arg_wifi_ssid.c_str(), arg_wifi_pass.c_str());
+        saveNetworkCredentials(form.wifiSsid, form.wifiPass);
         WiFi.mode(WIFI_STA);
-        WiFi.begin(arg_wifi_ssid.c_str(), arg_wifi_pass.c_str());
-        timers.lastWiFiAttempt = millis();
+        wifiBegin(form.wifiSsid, form.wifiPass);
+        timers.lastWiFiAttempt = millis64();
         DEBUG_PRINT("Rozpoczęto łączenie do podanej sieci WiFi");
     }
 
-    if (needMqttReconnect) {
-        if (mqtt.isConnected()) mqtt.disconnect();
-        connectMQTT();
-    }
-
     // Respond with JSON so the client can show a message without reloading
-    String resp = "{\"status\":\"ok\",\"message\":\"Ustawienia zapisane\"}";
-    server.send(200, "application/json", resp);
+    server.send(200, "application/json", "{\"status\":\"ok\",\"message\":\"Ustawienia zapisane\"}");
+}
+
+// GET /config - bieżąca konfiguracja jako dokument JSON (bez hasła MQTT)
+void handleConfigGet() {
+    static char out[768];   // Najdłuższe łańcuchy z sekwencjami ucieczki
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    configExportJson(sb, config);
+    server.send(sb.overflow ? 500 : 200, "application/json", out);
+}
+
+// PUT /config - częściowy lub pełny dokument; wszystkie pola walidowane przed
+// zapisem, przy błędzie nic nie jest zmieniane
+void handleConfigPut() {
+    const String& body = server.arg("plain");
+    if (body.length() == 0 || body.length() > CONFIG_DOC_MAX) {
+        server.send(413, "application/json", "{\"status\":\"error\",\"errors\":{\"document\":\"size\"}}");
+        return;
+    }
+    static ConfigUpdate update;
+    configUpdateBegin(update, config);
+    configUpdateJson(update, body.c_str(), body.length());
+    if (configUpdateFinish(update, config)) commitConfigUpdate(update);
+    sendConfigUpdateReport(update);
 }
 
 void handleDoUpdate() {
+    static char msg[48];
+    static size_t imageSize = 0;
     HTTPUpload& upload = server.upload();
     if (upload.status == UPLOAD_FILE_START) {
-        if (upload.filename == "") { String m = "update:error:No file selected"; webSocket.broadcastTXT(m); server.send(204); return; }
-        if (!Update.begin(upload.contentLength)) { Update.printError(Serial); String m = "update:error:Update initialization failed"; webSocket.broadcastTXT(m); server.send(204); return; }
-        { String m = "update:0"; webSocket.broadcastTXT(m); }
+        if (upload.filename.length() == 0) { webSocket.broadcastTXT("update:error:No file selected"); server.send(204); return; }
+        imageSize = platformUploadSize(upload);
+        if (!platformUpdateBegin(imageSize)) { Update.printError(Serial); webSocket.broadcastTXT("update:error:Update initialization failed"); server.send(204); return; }
+        webSocket.broadcastTXT("update:0");
     } else if (upload.status == UPLOAD_FILE_WRITE) {
-        if (Update.write(upload.buf, upload.currentSize) != upload.currentSize) { Update.printError(Serial); String m = "update:error:Write failed"; webSocket.broadcastTXT(m); return; }
-        int progress = (upload.totalSize * 100) / upload.contentLength;
-        String progressMsg = String("update:") + String(progress);
-        webSocket.broadcastTXT(progressMsg);
+        LoopStage prev = loopStage(LS_OTA_WRITE);
+        size_t written = Update.write(upload.buf, upload.currentSize);
+        loopStage(prev);
+        if (written != upload.currentSize) { Update.printError(Serial); webSocket.broadcastTXT("update:error:Write failed"); return; }
+        if (imageSize > 0) {  // ESP32 nie zna rozmiaru z góry - bez postępu w %
+            int progress = (upload.totalSize * 100) / imageSize;
+            snprintf(msg, sizeof(msg), "update:%d", progress);
+            webSocket.broadcastTXT(msg);
+        }
     } else if (upload.status == UPLOAD_FILE_END) {
-        if (Update.end(true)) { String m = "update:100"; webSocket.broadcastTXT(m); server.send(204); delay(1000); ESP.restart(); } else { Update.printError(Serial); String m = "update:error:Update failed"; webSocket.broadcastTXT(m); server.send(204); }
+        if (Update.end(true)) { webSocket.broadcastTXT("update:100"); server.send(204); delay(1000); warmRestart(); } else { Update.printError(Serial); webSocket.broadcastTXT("update:error:Update failed"); server.send(204); }
     }
 }
 
@@ -392,11 +462,11 @@ void handleUpdateResult() {
     } else {
         server.send(200, "text/html", "<h1>Aktualizacja zakończona powodzeniem</h1>Urządzenie zostanie zrestartowane...");
         delay(1000);
-        ESP.restart();
+        warmRestart();
     }
 }
 
-void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
+void webSocketEvent(uint8_t num, WStype_t type, uint8_t *, size_t) {
     if (type == WStype_CONNECTED) {
         Serial.printf("[%u] Connected\n", num);
     }
@@ -407,7 +477,18 @@ void setupWebServer() {
     server.on("/update", HTTP_POST, handleUpdateResult, handleDoUpdate);
     server.on("/save", handleSave);
     server.on("/scan_wifi", HTTP_GET, handleScanWifi);
-    server.on("/reboot", HTTP_POST, [](){ server.send(200, "text/plain", "Restarting..."); delay(1000); ESP.restart(); });
+    server.on("/config", HTTP_GET, handleConfigGet);
+    server.on("/config", HTTP_PUT, handleConfigPut);
+    server.on("/heap", HTTP_GET, handleHeapStats);
+    server.on("/sensor", HTTP_GET, handleSensorHealth);
+    server.on("/loop", HTTP_GET, handleLoopStats);
+    server.on("/log", HTTP_GET, handleLog);
+    server.on("/mqtt", HTTP_GET, handleMqttStats);
+    server.on("/wifi", HTTP_GET, handleWifiStats);
+    server.on("/watchdog", HTTP_GET, handleLoopWatchdog);
+    server.on("/boot", HTTP_GET, handleBootTimeline);
+    server.on("/ota", handleOtaPull);
+    server.on("/reboot", HTTP_POST, [](){ server.send(200, "text/plain", "Restarting..."); delay(1000); warmRestart(); });
     server.on("/factory-reset", HTTP_POST, [](){ server.send(200, "text/plain", "Resetting to factory defaults..."); delay(200); factoryReset(); });
     server.begin();
 }
@@ -418,6 +499,8 @@ void handleWiFiBackoff() {
     static int attempts = 0;
     const unsigned long MAX_DELAY = 300000; // 5 minutes
 
+    // Szybkie łączenie nieudane - pełne skanowanie liczy się jako nowa próba
+    if (wifiConnectTask()) timers.lastWiFiAttempt = millis64();
     if (WiFi.status() == WL_CONNECTED) {
         // reset backoff on success
         attempts = 0;
@@ -425,13 +508,13 @@ void handleWiFiBackoff() {
         return;
     }
 
-    unsigned long now = millis();
+    uint64_t now = millis64();
     if (now - timers.lastWiFiAttempt < backoffDelay) return;
 
     timers.lastWiFiAttempt = now;
     attempts++;
-    DEBUG_PRINTF("WiFi reconnect attempt %d, delay %lu\n", attempts, backoffDelay);
-    WiFi.begin();
+    LOG_D(LM_WIFI_RETRY, attempts, backoffDelay);
+    wifiReconnect();
 
     // calculate next delay (exponential, capped)
     unsigned long next = backoffDelay * 2UL;
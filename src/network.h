@@ -3,17 +3,24 @@
 
 #include <Arduino.h>
 #include <WebSocketsServer.h>
+#include "config_schema.h"
 
 void setupWiFi();
 bool connectMQTT();
 void setupWebServer();
 void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length);
-String getConfigPage();
 void handleRoot();
 void handleSave();
+void handleConfigGet();
+void handleConfigPut();
 void handleDoUpdate();
 void handleUpdateResult();
 void handleWiFiBackoff();
 void handleScanWifi();
+// Zwalidowana aktualizacja jednym zapisem do flash (formularz, PUT /config,
+// konfiguracja zdalna); true gdy zmieniły się pola brokera
+bool applyConfigUpdate(const ConfigUpdate& u);
+// Nowe ustawienia brokera lub trybu stanów HA
+void reconnectMqttForConfig();
 
 #endif // NETWORK_H
@@ -0,0 +1,441 @@
+#include "ota_pull.h"
+#include "json_flat.h"
+#include <string.h>
+#include <stdlib.h>
+#ifdef ARDUINO
+#include "globals.h"
+#include "platform.h"
+#include "strbuf.h"
+#include "loop_watchdog.h"
+#include "log_ring.h"
+#include "warm_restart.h"
+#endif
+
+static const char* versionPart(const char* s, uint32_t& v) {
+    v = 0;
+    while (*s >= '0' && *s <= '9') v = v * 10 + (uint32_t)(*s++ - '0');
+    while (*s && *s != '.') s++;
+    return *s == '.' ? s + 1 : s;
+}
+
+int otaVersionCompare(const char* a, const char* b) {
+    while (*a || *b) {
+        uint32_t x, y;
+        a = versionPart(a, x);
+        b = versionPart(b, y);
+        if (x != y) return x < y ? -1 : 1;
+    }
+    return 0;
+}
+
+enum : uint8_t {
+    MF_VERSION = 1 << 0,
+    MF_URL = 1 << 1,
+    MF_SIZE = 1 << 2,
+    MF_MD5 = 1 << 3,
+    MF_ALL = MF_VERSION | MF_URL | MF_SIZE | MF_MD5,
+};
+
+struct ManifestCtx {
+    OtaManifest* m;
+    uint8_t seen;
+    bool bad;
+};
+
+static bool keyIs(const char* key, size_t keyLen, const char* name) {
+    return keyLen == strlen(name) && memcmp(key, name, keyLen) == 0;
+}
+
+static bool readString(const JsonValue& v, char* out, size_t cap) {
+    return v.type == JSON_STRING && jsonUnescape(v.raw, v.rawLen, out, cap) > 0;
+}
+
+static void onManifestPair(const char* key, size_t keyLen, const JsonValue& v, void* ctx) {
+    ManifestCtx& c = *(ManifestCtx*)ctx;
+    OtaManifest& m = *c.m;
+    if (keyIs(key, keyLen, "version")) {
+        if (!readString(v, m.version, sizeof(m.version)) || m.version[0] < '0' || m.version[0] > '9') c.bad = true;
+        c.seen |= MF_VERSION;
+    } else if (keyIs(key, keyLen, "url")) {
+        if (!readString(v, m.url, sizeof(m.url))) c.bad = true;
+        c.seen |= MF_URL;
+    } else if (keyIs(key, keyLen, "size")) {
+        if (v.type != JSON_INT || v.integer <= 0 || v.integer > 0x7FFFFFFFL) c.bad = true;
+        else m.size = (uint32_t)v.integer;
+        c.seen |= MF_SIZE;
+    } else if (keyIs(key, keyLen, "md5")) {
+        if (!readString(v, m.md5, sizeof(m.md5)) || strlen(m.md5) != 32) c.bad = true;
+        // Update porównuje z własnym zapisem małymi literami
+        for (char* p = m.md5; *p; ++p) {
+            if (*p >= 'A' && *p <= 'F') *p = (char)(*p - 'A' + 'a');
+            else if (!((*p >= '0' && *p <= '9') || (*p >= 'a' && *p <= 'f'))) c.bad = true;
+        }
+        c.seen |= MF_MD5;
+    }
+}
+
+bool otaParseManifest(const char* json, size_t len, OtaManifest& m) {
+    memset(&m, 0, sizeof(m));
+    ManifestCtx c = { &m, 0, false };
+    if (jsonFlatParse(json, len, onManifestPair, &c) != 0) return false;
+    return !c.bad && c.seen == MF_ALL;
+}
+
+bool otaParseUrl(const char* url, OtaUrl& out) {
+    static const char SCHEME[] = "http://";
+    if (strncmp(url, SCHEME, sizeof(SCHEME) - 1) != 0) return false;
+    const char* host = url + sizeof(SCHEME) - 1;
+    size_t hostLen = strcspn(host, ":/");
+    if (hostLen == 0 || hostLen >= sizeof(out.host)) return false;
+    memcpy(out.host, host, hostLen);
+    out.host[hostLen] = '\0';
+
+    const char* p = host + hostLen;
+    out.port = 80;
+    if (*p == ':') {
+        char* end;
+        long port = strtol(p + 1, &end, 10);
+        if (end == p + 1 || port < 1 || port > 65535 || (*end && *end != '/')) return false;
+        out.port = (uint16_t)port;
+        p = end;
+    }
+    if (!*p) p = "/";
+    if (strlen(p) >= sizeof(out.path)) return false;
+    strcpy(out.path, p);
+    return true;
+}
+
+void otaHttpHeadBegin(OtaHttpHead& h) {
+    memset(&h, 0, sizeof(h));
+    h.contentLength = -1;
+}
+
+static bool startsWithNoCase(const char* s, const char* prefix) {
+    for (; *prefix; ++s, ++prefix) {
+        char c = *s;
+        if (c >= 'A' && c <= 'Z') c = (char)(c - 'A' + 'a');
+        if (c != *prefix) return false;
+    }
+    return true;
+}
+
+static void headLine(OtaHttpHead& h) {
+    h.line[h.lineLen < sizeof(h.line) ? h.lineLen : sizeof(h.line) - 1] = '\0';
+    if (!h.statusSeen) {
+        h.statusSeen = true;
+        // "HTTP/1.x 200 ..."
+        if (h.lineLen < 12 || strncmp(h.line, "HTTP/1.", 7) != 0) h.error = true;
+        else h.status = (uint16_t)atoi(h.line + 9);
+    } else if (h.lineLen == 0) {
+        h.done = true;
+    } else if (startsWithNoCase(h.line, "content-length:")) {
+        h.contentLength = atol(h.line + 15);
+    }
+}
+
+size_t otaHttpHeadFeed(OtaHttpHead& h, const uint8_t* data, size_t len) {
+    size_t i = 0;
+    while (i < len && !h.done && !h.error) {
+        char c = (char)data[i++];
+        if (c == '\r') continue;
+        if (c == '\n') {
+            headLine(h);
+            h.lineLen = 0;
+            continue;
+        }
+        if (h.lineLen < sizeof(h.line) - 1) h.line[h.lineLen] = c;
+        if (h.lineLen < 255) h.lineLen++;    // Długie linie obcięte w line, ale niepuste
+    }
+    return i;
+}
+
+OtaImageKind otaImageKind(const uint8_t* data, size_t len) {
+    if (len >= 1 && data[0] == 0xE9) return OTA_IMAGE_ESP;
+    if (len >= 2 && data[0] == 0x1F && data[1] == 0x8B) return OTA_IMAGE_GZIP;
+    return OTA_IMAGE_UNKNOWN;
+}
+
+const char* otaResultName(OtaResult r) {
+    static const char* const NAMES[] = {
+        "none", "up_to_date", "updated", "connect", "http", "timeout",
+        "manifest", "image", "begin", "write", "verify",
+    };
+    return r < sizeof(NAMES) / sizeof(NAMES[0]) ? NAMES[r] : "none";
+}
+
+#ifdef ARDUINO
+enum OtaState : uint8_t {
+    OTA_IDLE,
+    OTA_WAIT,               // Losowe opóźnienie przed sprawdzeniem
+    OTA_MANIFEST,
+    OTA_DOWNLOAD,
+};
+static const char* const STATE_NAMES[] = { "idle", "wait", "manifest", "download" };
+
+static WiFiClient s_http;               // Osobny od klienta MQTT
+static OtaState s_state = OTA_IDLE;
+static OtaResult s_result = OTR_NONE;
+static uint64_t s_startAt = 0;
+static uint64_t s_nextCheck = 0;        // 0 = pierwsze sprawdzenie po starcie sieci
+static uint64_t s_lastData = 0;
+static bool s_requested = false;
+static bool s_requestStagger = false;
+static OtaHttpHead s_head;
+static char s_doc[OTA_MANIFEST_MAX];
+static size_t s_docLen = 0;
+static OtaManifest s_manifest;
+static uint32_t s_received = 0;
+static bool s_updateStarted = false;
+static uint64_t s_restartAt = 0;        // Obraz zapisany - ciepły restart o tej porze
+
+static char s_fleetTopic[32];
+static char s_deviceTopic[64];
+static char s_stateTopic[64];
+static bool s_subscribed = false;
+static bool s_statePending = true;
+
+static void appendStatus(StrBuf& sb) {
+    sbAppend(sb, "{\"state\":\"");
+    sbAppend(sb, STATE_NAMES[s_state]);
+    sbAppend(sb, "\",\"result\":\"");
+    sbAppend(sb, otaResultName(s_result));
+    sbAppend(sb, "\",\"version\":");
+    sbAppendJsonString(sb, SOFTWARE_VERSION, strlen(SOFTWARE_VERSION));
+    sbAppend(sb, ",\"available\":");
+    sbAppendJsonString(sb, s_manifest.version, strlen(s_manifest.version));
+    sbAppend(sb, ",\"received\":");
+    sbAppendUInt(sb, s_received);
+    sbAppend(sb, ",\"size\":");
+    sbAppendUInt(sb, s_manifest.size);
+    sbAppendChar(sb, '}');
+}
+
+// Stan na aha/<urządzenie>/ota/state (zachowany) - przy zmianie stanu
+static bool publishState() {
+    static char out[192];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    appendStatus(sb);
+    return sb.overflow || mqtt.publish(s_stateTopic, out, true);
+}
+
+static void setState(OtaState state) {
+    s_state = state;
+    s_statePending = true;
+}
+
+static void finish(OtaResult r, uint64_t nowMs) {
+    s_http.stop();
+    if (s_updateStarted && r != OTR_UPDATED) Update.end();  // Przerwanie - partycja startowa bez zmian
+    s_updateStarted = false;
+    s_result = r;
+    setState(OTA_IDLE);
+    if (r >= OTR_CONNECT) LOG_W(LM_OTA_PULL_RESULT, r, s_received, s_manifest.size);
+    else LOG_I(LM_OTA_PULL_RESULT, r, s_received, s_manifest.size);
+    // Serwer chwilowo niedostępny - ponowienie przed kolejnym terminem harmonogramu
+    if (r >= OTR_CONNECT && r <= OTR_TIMEOUT && config.ota_interval > 0 && s_nextCheck > nowMs + OTA_RETRY_MS) {
+        s_nextCheck = nowMs + OTA_RETRY_MS;
+    }
+    if (r == OTR_UPDATED) {
+        if (mqtt.isConnected()) publishState();
+        s_restartAt = nowMs + OTA_RESTART_DELAY_MS;    // Restart z otaPullLoop - pętla działa dalej
+    }
+}
+
+// HTTP/1.0 - serwer odpowiada bez kodowania chunked i zamyka połączenie
+static bool startGet(const char* url, uint64_t nowMs) {
+    OtaUrl u;
+    if (!otaParseUrl(url, u)) return false;
+    LoopStage prev = loopStage(LS_OTA);
+    bool ok = platformConnect(s_http, u.host, u.port, OTA_CONNECT_TIMEOUT_MS);
+    loopStage(prev);
+    if (!ok) return false;
+    static char req[256];
+    StrBuf sb;
+    sbInit(sb, req, sizeof(req));
+    sbAppend(sb, "GET ");
+    sbAppend(sb, u.path);
+    sbAppend(sb, " HTTP/1.0\r\nHost: ");
+    sbAppend(sb, u.host);
+    sbAppend(sb, "\r\nUser-Agent: HydroSense/");
+    sbAppend(sb, SOFTWARE_VERSION);
+    sbAppend(sb, "\r\n\r\n");
+    if (sb.overflow || s_http.write((const uint8_t*)req, sb.len) != sb.len) {
+        s_http.stop();
+        return false;
+    }
+    otaHttpHeadBegin(s_head);
+    s_lastData = nowMs;
+    return true;
+}
+
+// > 0 bajty, 0 = brak danych, -1 = serwer zamknął połączenie, -2 = przekroczony czas
+static int readSome(uint8_t* buf, size_t cap, uint64_t nowMs) {
+    int n = s_http.available();
+    if (n <= 0) {
+        if (!s_http.connected()) return -1;
+        return nowMs - s_lastData > OTA_IO_TIMEOUT_MS ? -2 : 0;
+    }
+    n = s_http.read(buf, (size_t)n < cap ? (size_t)n : cap);
+    if (n > 0) s_lastData = nowMs;
+    return n;
+}
+
+static void evaluateManifest(uint64_t nowMs) {
+    s_http.stop();
+    if (!otaParseManifest(s_doc, s_docLen, s_manifest)) { finish(OTR_MANIFEST, nowMs); return; }
+    if (otaVersionCompare(s_manifest.version, SOFTWARE_VERSION) <= 0) { finish(OTR_UP_TO_DATE, nowMs); return; }
+    if (!startGet(s_manifest.url, nowMs)) { finish(OTR_CONNECT, nowMs); return; }
+    s_received = 0;
+    LOG_I(LM_OTA_PULL_START, s_manifest.size);
+    setState(OTA_DOWNLOAD);
+}
+
+static void manifestStep(uint64_t nowMs) {
+    uint8_t buf[128];
+    int n = readSome(buf, sizeof(buf), nowMs);
+    if (n == -2) { finish(OTR_TIMEOUT, nowMs); return; }
+    if (n == -1) {
+        if (!s_head.done || s_head.status != 200) finish(OTR_HTTP, nowMs);
+        else evaluateManifest(nowMs);
+        return;
+    }
+    size_t off = s_head.done ? 0 : otaHttpHeadFeed(s_head, buf, (size_t)n);
+    if (s_head.error || (s_head.done && s_head.status != 200)) { finish(OTR_HTTP, nowMs); return; }
+    size_t len = (size_t)n - off;
+    if (s_docLen + len > sizeof(s_doc)) { finish(OTR_MANIFEST, nowMs); return; }
+    memcpy(s_doc + s_docLen, buf + off, len);
+    s_docLen += len;
+    if (s_head.done && s_head.contentLength >= 0 && s_docLen == (size_t)s_head.contentLength) evaluateManifest(nowMs);
+}
+
+static void downloadStep(uint64_t nowMs) {
+    static uint8_t buf[OTA_CHUNK];
+    int n = readSome(buf, sizeof(buf), nowMs);
+    if (n == -2) { finish(OTR_TIMEOUT, nowMs); return; }
+    if (n == -1) { finish(s_head.done && s_head.status == 200 ? OTR_IMAGE : OTR_HTTP, nowMs); return; }  // Obraz urwany
+    if (n == 0) return;
+
+    size_t off = 0;
+    if (!s_head.done) {
+        off = otaHttpHeadFeed(s_head, buf, (size_t)n);
+        if (s_head.error || (s_head.done && s_head.status != 200)) { finish(OTR_HTTP, nowMs); return; }
+        if (s_head.done && s_head.contentLength >= 0 && (uint32_t)s_head.contentLength != s_manifest.size) {
+            finish(OTR_IMAGE, nowMs);
+            return;
+        }
+        if (off == (size_t)n) return;
+    }
+    size_t len = (size_t)n - off;
+    if (!s_updateStarted) {
+        OtaImageKind kind = otaImageKind(buf + off, len);
+        if (kind == OTA_IMAGE_UNKNOWN || (kind == OTA_IMAGE_GZIP && !PLATFORM_OTA_GZIP)) { finish(OTR_IMAGE, nowMs); return; }
+        if (!platformUpdateBegin(s_manifest.size)) { finish(OTR_BEGIN, nowMs); return; }
+        Update.setMD5(s_manifest.md5);
+        s_updateStarted = true;
+    }
+    if (s_received + len > s_manifest.size) { finish(OTR_IMAGE, nowMs); return; }
+    LoopStage prev = loopStage(LS_OTA_WRITE);
+    size_t written = Update.write(buf + off, len);
+    loopStage(prev);
+    if (written != len) { finish(OTR_WRITE, nowMs); return; }
+    s_received += len;
+    if (s_received < s_manifest.size) return;
+
+    s_http.stop();
+    prev = loopStage(LS_OTA_WRITE);
+    bool ok = Update.end();     // Suma MD5 i nagłówek obrazu
+    loopStage(prev);
+    s_updateStarted = false;
+    finish(ok ? OTR_UPDATED : OTR_VERIFY, nowMs);
+}
+
+void otaPullBegin(const char* deviceId) {
+    StrBuf sb;
+    sbInit(sb, s_fleetTopic, sizeof(s_fleetTopic));
+    sbAppend(sb, "aha/fleet/ota/check");
+    sbInit(sb, s_deviceTopic, sizeof(s_deviceTopic));
+    sbAppend(sb, "aha/");
+    sbAppend(sb, deviceId);
+    sbAppend(sb, "/ota/check");
+    sbInit(sb, s_stateTopic, sizeof(s_stateTopic));
+    sbAppend(sb, "aha/");
+    sbAppend(sb, deviceId);
+    sbAppend(sb, "/ota/state");
+}
+
+void otaPullConnected() {
+    s_subscribed = false;
+    s_statePending = true;
+}
+
+bool otaPullMessage(const char* topic, const uint8_t* payload, uint16_t length) {
+    (void)payload;
+    (void)length;
+    if (strcmp(topic, s_fleetTopic) == 0) otaPullRequest(true);
+    else if (strcmp(topic, s_deviceTopic) == 0) otaPullRequest(false);
+    else return false;
+    return true;
+}
+
+void otaPullRequest(bool stagger) {
+    if (s_state != OTA_IDLE) return;
+    s_requested = true;
+    s_requestStagger |= stagger;
+}
+
+void otaPullLoop(uint64_t nowMs) {
+    if (!s_stateTopic[0]) return;  // Przed setupHA()
+    if (mqtt.isConnected()) {
+        // Po ponownym połączeniu otaPullConnected() zeruje s_subscribed
+        if (!s_subscribed) s_subscribed = mqtt.subscribe(s_fleetTopic) && mqtt.subscribe(s_deviceTopic);
+        else if (s_statePending) s_statePending = !publishState();
+    }
+    if (s_restartAt) {
+        // Nowy obraz zapisany - stan wychodzi w mqtt.loop(), sterowanie działa do restartu
+        if (nowMs >= s_restartAt) warmRestart();
+        return;
+    }
+
+    switch (s_state) {
+        case OTA_IDLE: {
+            if (!config.ota_url[0]) {
+                s_requested = s_requestStagger = false;
+                return;
+            }
+            bool scheduled = config.ota_interval > 0 && nowMs >= s_nextCheck;
+            if (!scheduled && !s_requested) return;
+            if (scheduled) s_nextCheck = nowMs + (uint64_t)config.ota_interval * 3600000ULL;
+            uint32_t window = (uint32_t)config.ota_stagger * 60000UL;
+            bool stagger = scheduled || s_requestStagger;
+            s_requested = s_requestStagger = false;
+            s_startAt = nowMs + (stagger && window ? platformRandom() % window : 0);
+            setState(OTA_WAIT);
+            return;
+        }
+        case OTA_WAIT:
+            if (nowMs < s_startAt) return;
+            memset(&s_manifest, 0, sizeof(s_manifest));
+            s_received = 0;
+            s_docLen = 0;
+            if (!startGet(config.ota_url, nowMs)) { finish(OTR_CONNECT, nowMs); return; }
+            setState(OTA_MANIFEST);
+            return;
+        case OTA_MANIFEST:
+            manifestStep(nowMs);
+            return;
+        case OTA_DOWNLOAD:
+            downloadStep(nowMs);
+            return;
+    }
+}
+
+void handleOtaPull() {
+    if (server.method() == HTTP_POST) otaPullRequest(false);
+    static char out[192];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    appendStatus(sb);
+    server.send(server.method() == HTTP_POST ? 202 : 200, "application/json", out);
+}
+#endif
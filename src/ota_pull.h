@@ -0,0 +1,105 @@
+#ifndef OTA_PULL_H
+#define OTA_PULL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Aktualizacja pobierana przez urządzenie (pull) z lokalnego serwera HTTP.
+// Urządzenie co config.ota_interval godzin, na polecenie MQTT lub POST /ota
+// pobiera manifest z config.ota_url:
+//   {"version":"26.12.01","url":"http://10.0.0.5:8000/hydrosense.bin.gz",
+//    "size":301234,"md5":"0123456789abcdef0123456789abcdef"}
+// i gdy wersja jest nowsza niż SOFTWARE_VERSION, strumieniuje obraz prosto
+// do Update porcjami po OTA_CHUNK bajtów na iterację pętli - bez bufora na
+// cały obraz. Jedyny blokujący krok to nawiązanie połączenia (najwyżej
+// OTA_CONNECT_TIMEOUT_MS na DNS i tyle samo na connect; adres IP w URL
+// pomija DNS). Suma MD5 (z manifestu, liczona
+// z pobranych bajtów) jest sprawdzana przez Update.end() przed przełączeniem
+// partycji. Obraz gzip rozpakowuje bootloader ESP8266; na ESP32 manifest
+// musi wskazywać obraz nieskompresowany (PLATFORM_OTA_GZIP).
+//
+// Sprawdzenie z harmonogramu i polecenie floty są opóźniane o losowy czas
+// z okna config.ota_stagger minut, więc flota nie pobiera obrazu naraz.
+// Zwykły serwer statyczny wystarcza (HTTP/1.0, bez kodowania transferu) -
+// zob. host/ota_publish.py.
+
+const size_t OTA_MANIFEST_MAX = 384;
+const size_t OTA_CHUNK = 1024;                  // Bajty obrazu na iterację pętli
+const uint32_t OTA_IO_TIMEOUT_MS = 15000;       // Brak danych od serwera
+const uint32_t OTA_CONNECT_TIMEOUT_MS = 1000;   // DNS + connect (blokuje pętlę ESP8266)
+const uint32_t OTA_RESTART_DELAY_MS = 1000;     // Publikacja stanu przed restartem
+const uint32_t OTA_RETRY_MS = 15UL * 60 * 1000; // Ponowienie po błędzie sieci
+
+struct OtaManifest {
+    char version[16];
+    char url[128];
+    uint32_t size;
+    char md5[33];
+};
+
+// Porównanie wersji liczbowych z kropkami ("26.11.24" < "26.12.1");
+// brakujące człony = 0, reszta członu po cyfrach jest pomijana
+int otaVersionCompare(const char* a, const char* b);
+// Wszystkie cztery pola wymagane; md5 jako 32 znaki szesnastkowe
+bool otaParseManifest(const char* json, size_t len, OtaManifest& m);
+
+struct OtaUrl {
+    char host[64];
+    uint16_t port;
+    char path[128];
+};
+// Tylko http:// (sieć lokalna); brak ścieżki = "/"
+bool otaParseUrl(const char* url, OtaUrl& out);
+
+// Nagłówek odpowiedzi HTTP parsowany przyrostowo, bajty w dowolnych porcjach
+struct OtaHttpHead {
+    char line[48];          // Początek bieżącej linii - wystarczy na nazwy pól
+    uint8_t lineLen;
+    bool statusSeen;
+    bool done;              // Pusta linia - dalej treść
+    bool error;             // Linia statusu nie jest HTTP
+    uint16_t status;
+    int32_t contentLength;  // -1 = brak nagłówka
+};
+void otaHttpHeadBegin(OtaHttpHead& h);
+// Zwraca liczbę zużytych bajtów; po done reszta porcji należy do treści
+size_t otaHttpHeadFeed(OtaHttpHead& h, const uint8_t* data, size_t len);
+
+enum OtaImageKind : uint8_t {
+    OTA_IMAGE_UNKNOWN,
+    OTA_IMAGE_ESP,          // Nagłówek aplikacji ESP (0xE9)
+    OTA_IMAGE_GZIP,         // 1F 8B
+};
+OtaImageKind otaImageKind(const uint8_t* data, size_t len);
+
+enum OtaResult : uint8_t {
+    OTR_NONE,
+    OTR_UP_TO_DATE,
+    OTR_UPDATED,            // Obraz zapisany i sprawdzony - restart
+    OTR_CONNECT,            // Brak połączenia z serwerem
+    OTR_HTTP,               // Status inny niż 200 albo zły nagłówek
+    OTR_TIMEOUT,
+    OTR_MANIFEST,           // Błędny lub za duży manifest
+    OTR_IMAGE,              // Nieznany format, gzip bez obsługi lub inny rozmiar niż w manifeście
+    OTR_BEGIN,              // Za mało miejsca na obraz
+    OTR_WRITE,
+    OTR_VERIFY,             // Update.end(): suma MD5 lub niepełny obraz
+};
+const char* otaResultName(OtaResult r);
+
+#ifdef ARDUINO
+void otaPullBegin(const char* deviceId);
+// Z wywołania zwrotnego MQTT; true gdy temat polecenia OTA
+bool otaPullMessage(const char* topic, const uint8_t* payload, uint16_t length);
+// Nowe połączenie (HAMqtt::onConnected) - subskrypcje i stan od nowa
+void otaPullConnected();
+// Sprawdzenie poza harmonogramem (stagger = z losowym opóźnieniem floty)
+void otaPullRequest(bool stagger);
+// Harmonogram, manifest i jedna porcja obrazu na wywołanie
+void otaPullLoop(uint64_t nowMs);
+// GET /ota - stan i ostatni wynik; POST /ota - sprawdzenie teraz, bez rozrzutu
+// {"state":"download","result":"none","version":"26.11.24","available":"26.12.01","received":1024,"size":301234}
+void handleOtaPull();
+#endif
+
+#endif // OTA_PULL_H
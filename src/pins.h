@@ -2,11 +2,21 @@
 #define PINS_H
 
 // Definicje pinów
+#if defined(ARDUINO_ARCH_ESP32)
+// ESP32 DevKit - numery GPIO (echo HC-SR04 przez dzielnik do 3,3 V)
+const int PIN_ULTRASONIC_TRIG = 18;
+const int PIN_ULTRASONIC_ECHO = 19;
+const int PIN_WATER_LEVEL = 23;
+const int POMPA_PIN = 25;
+const int BUZZER_PIN = 26;
+const int PRZYCISK_PIN = 27;
+#else
 const int PIN_ULTRASONIC_TRIG = D6;
 const int PIN_ULTRASONIC_ECHO = D7;
 const int PIN_WATER_LEVEL = D5;
 const int POMPA_PIN = D1;
 const int BUZZER_PIN = D2;
 const int PRZYCISK_PIN = D3;
+#endif
 
 #endif // PINS_H
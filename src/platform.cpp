@@ -0,0 +1,174 @@
+#include "platform.h"
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_system.h>
+#include <esp_task_wdt.h>
+#include <esp_wifi.h>
+#include <lwip/sockets.h>
+#include "rtc_store.h"
+
+// Pamięć RTC nie jest zerowana przy resecie programowym ani watchdogu
+RTC_NOINIT_ATTR uint32_t platformRtcMemory[RTC_BLOCK_END];
+
+uint8_t platformResetReason() {
+    switch (esp_reset_reason()) {
+        case ESP_RST_INT_WDT:
+        case ESP_RST_WDT: return 1;         // REASON_WDT_RST
+        case ESP_RST_PANIC: return 2;       // REASON_EXCEPTION_RST
+        case ESP_RST_TASK_WDT: return 3;    // REASON_SOFT_WDT_RST
+        case ESP_RST_SW: return 4;          // REASON_SOFT_RESTART
+        case ESP_RST_DEEPSLEEP: return 5;   // REASON_DEEP_SLEEP_AWAKE
+        case ESP_RST_EXT:
+        case ESP_RST_SDIO: return 6;        // REASON_EXT_SYS_RST
+        default: return 0;                  // Zasilanie, brownout - RTC nieważne
+    }
+}
+
+void platformWatchdogBegin(uint32_t timeoutMs) {
+    esp_task_wdt_init((timeoutMs + 999) / 1000, true);  // API IDF 4.4 (arduino-esp32 2.x)
+    esp_task_wdt_add(NULL);
+}
+
+void platformWatchdogFeed() {
+    esp_task_wdt_reset();  // Bez efektu w zadaniach spoza watchdoga
+}
+
+uint32_t platformRandom() {
+    return esp_random();
+}
+
+void platformRestart() {
+    ESP.restart();
+}
+
+void platformReset() {
+    ESP.restart();  // ESP32 nie rozróżnia resetu i restartu programowego
+}
+
+void platformEraseWifiConfig() {
+    esp_wifi_restore();
+}
+
+void platformHeapStats(uint32_t* freeHeap, uint32_t* maxBlock, uint8_t* frag) {
+    *freeHeap = ESP.getFreeHeap();
+    *maxBlock = ESP.getMaxAllocHeap();
+    *frag = *freeHeap ? (uint8_t)(100 - (uint64_t)*maxBlock * 100 / *freeHeap) : 0;
+}
+
+bool platformScanEntry(int index, PlatformScanEntry& entry) {
+    const wifi_ap_record_t* it = (const wifi_ap_record_t*)WiFi.getScanInfoByIndex(index);
+    if (!it) return false;
+    entry.ssid = (const char*)it->ssid;
+    entry.ssidLen = strnlen((const char*)it->ssid, sizeof(it->ssid));
+    entry.rssi = it->rssi;
+    entry.secure = it->authmode != WIFI_AUTH_OPEN;
+    return true;
+}
+
+bool platformArg(PlatformWebServer& server, int i, char* name, size_t nameCap, char* value, size_t valueCap) {
+    String n = server.argName(i);
+    if (n.length() >= nameCap) return false;
+    memcpy(name, n.c_str(), n.length() + 1);
+    strlcpy(value, server.arg(i).c_str(), valueCap);
+    return true;
+}
+
+size_t platformUploadSize(HTTPUpload& upload) {
+    (void)upload;
+    return 0;
+}
+
+bool platformUpdateBegin(size_t size) {
+    return Update.begin(size ? size : UPDATE_SIZE_UNKNOWN);
+}
+
+size_t platformClientRoom(WiFiClient& client) {
+    // Print::availableForWrite() zwraca tu 0, a lwIP nie udostępnia wolnego miejsca
+    // w buforze nadawczym. Gniazdo jest zapisywalne dopiero, gdy wolne miejsce
+    // przekracza TCP_SNDLOWAT (co najmniej 2 * MSS + 1 B), więc wtedy limit
+    // PLATFORM_CLIENT_ROOM_CAP zmieści się bez czekania w write(); inaczej 0
+    int fd = client.fd();
+    if (fd < 0 || !client.connected()) return 0;
+    fd_set writable;
+    FD_ZERO(&writable);
+    FD_SET(fd, &writable);
+    timeval now = {0, 0};
+    return select(fd + 1, nullptr, &writable, nullptr, &now) > 0 ? PLATFORM_CLIENT_ROOM_CAP : 0;
+}
+
+bool platformConnect(WiFiClient& client, const char* host, uint16_t port, uint32_t timeoutMs) {
+    return client.connect(host, port, (int32_t)timeoutMs);
+}
+
+#else
+
+uint8_t platformResetReason() {
+    return (uint8_t)ESP.getResetInfoPtr()->reason;
+}
+
+void platformWatchdogBegin(uint32_t timeoutMs) {
+    ESP.wdtEnable(timeoutMs);
+}
+
+void platformWatchdogFeed() {
+    ESP.wdtFeed();
+}
+
+uint32_t platformRandom() {
+    return ESP.random();
+}
+
+void platformRestart() {
+    ESP.restart();
+}
+
+void platformReset() {
+    ESP.reset();
+}
+
+void platformEraseWifiConfig() {
+    ESP.eraseConfig();
+}
+
+void platformHeapStats(uint32_t* freeHeap, uint32_t* maxBlock, uint8_t* frag) {
+    ESP.getHeapStats(freeHeap, maxBlock, frag);  // jedno przejście po stercie zamiast trzech
+}
+
+bool platformScanEntry(int index, PlatformScanEntry& entry) {
+    const bss_info* it = (const bss_info*)WiFi.getScanInfoByIndex(index);
+    if (!it) return false;
+    entry.ssid = (const char*)it->ssid;
+    entry.ssidLen = it->ssid_len;
+    entry.rssi = it->rssi;
+    entry.secure = it->authmode != AUTH_OPEN;
+    return true;
+}
+
+bool platformArg(PlatformWebServer& server, int i, char* name, size_t nameCap, char* value, size_t valueCap) {
+    const String& n = server.argName(i);
+    if (n.length() >= nameCap) return false;
+    memcpy(name, n.c_str(), n.length() + 1);
+    strlcpy(value, server.arg(i).c_str(), valueCap);
+    return true;
+}
+
+size_t platformUploadSize(HTTPUpload& upload) {
+    return upload.contentLength;
+}
+
+bool platformUpdateBegin(size_t size) {
+    return Update.begin(size);
+}
+
+size_t platformClientRoom(WiFiClient& client) {
+    return client.availableForWrite();
+}
+
+bool platformConnect(WiFiClient& client, const char* host, uint16_t port, uint32_t timeoutMs) {
+    IPAddress ip;
+    if (!ip.fromString(host) && !WiFi.hostByName(host, ip, timeoutMs)) return false;
+    client.setTimeout(timeoutMs);   // Limit czekania na SYN-ACK w connect()
+    return client.connect(ip, port);
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+// Cienka warstwa sprzętowa: ESP8266 (env:d1_mini) i ESP32 (env:esp32dev).
+// Wszystkie różnice rdzeni Arduino są tutaj i w platform.cpp - reszta
+// programu używa wyłącznie tych nazw zamiast ESP.*, bss_info itd.
+
+#include <Arduino.h>
+#include "wifi_scan.h"
+#if defined(ARDUINO_ARCH_ESP32)
+#include <WiFi.h>
+#include <WebServer.h>
+#include <Update.h>
+typedef WebServer PlatformWebServer;
+#define PLATFORM_MODEL "HS ESP32"
+#define PLATFORM_OTA_GZIP 0         // Update zapisuje obraz bez rozpakowania
+#else
+#include <ESP8266WiFi.h>
+#include <ESP8266WebServer.h>
+#include <Updater.h>
+typedef ESP8266WebServer PlatformWebServer;
+#define PLATFORM_MODEL "HS ESP8266"
+#define PLATFORM_OTA_GZIP 1         // Obraz gzip rozpakowuje eboot przy starcie
+#endif
+
+// Przyczyna ostatniego resetu w kodach rst_info.reason z ESP8266
+// (0 zasilanie ... 6 pin RST) - na ESP32 odwzorowana z esp_reset_reason()
+uint8_t platformResetReason();
+
+// Watchdog sprzętowy; na ESP32 watchdog zadań obejmuje wywołujące zadanie
+void platformWatchdogBegin(uint32_t timeoutMs);
+void platformWatchdogFeed();
+
+uint32_t platformRandom();
+void platformRestart();             // Restart programowy (ciepły)
+void platformReset();               // Natychmiastowy reset sprzętowy
+void platformEraseWifiConfig();     // Kasowanie ustawień WiFi zapisanych przez SDK
+
+// Wolna sterta, największy wolny blok i fragmentacja [%]
+void platformHeapStats(uint32_t* freeHeap, uint32_t* maxBlock, uint8_t* frag);
+
+// Wpis wyniku skanowania sieci (po WiFi.scanNetworks())
+bool platformScanEntry(int index, PlatformScanEntry& entry);
+
+// Argument żądania i (nazwa i wartość) kopiowany do buforów wywołującego;
+// false gdy nazwa się nie mieści. Na ESP8266 bez kopii String (referencje
+// rdzenia), ESP32 zwraca String przez wartość - tam jedna krótka alokacja.
+bool platformArg(PlatformWebServer& server, int i, char* name, size_t nameCap, char* value, size_t valueCap);
+
+// Rozmiar wysyłanego obrazu; 0 = nieznany (ESP32 nie podaje Content-Length)
+size_t platformUploadSize(HTTPUpload& upload);
+bool platformUpdateBegin(size_t size);
+
+// Bajty, które stos TCP przyjmie bez czekania na ACK. ESP32 nie podaje dokładnej
+// wartości - zwraca 0 albo ostrożny limit, gdy gniazdo jest zapisywalne
+const size_t PLATFORM_CLIENT_ROOM_CAP = 1024;
+size_t platformClientRoom(WiFiClient& client);
+
+// Połączenie TCP z limitem czasu (DNS + connect, gdy host nie jest adresem IP).
+// Na ESP8266 blokuje pętlę sterowania, stąd krótki limit zamiast 5 s rdzenia.
+bool platformConnect(WiFiClient& client, const char* host, uint16_t port, uint32_t timeoutMs);
+
+#endif // PLATFORM_H
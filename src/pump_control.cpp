@@ -2,96 +2,151 @@
 #include "globals.h"
 #include "pins.h"
 #include "measurements.h"
+#include "mono_clock.h"
+#include "pump_flow.h"
+#include "leak_detect.h"
+#include "buzzer.h"
+#include "warm_restart.h"
+#include "control_task.h"
+#include "log_ring.h"
+#include "float_switch.h"
+
+static FlowMonitor pumpFlow = {};
+static FlowTrend pumpFlowTrend = {};
+static LeakDetector pumpLeak = {};
 
 void sendPumpWorkTime() {
     if (status.pumpStartTime > 0) {
-        unsigned long totalWorkTime = (millis() - status.pumpStartTime) / 1000UL;
+        unsigned long totalWorkTime = (unsigned long)((millis64() - status.pumpStartTime) / 1000ULL);
         char timeStr[16];
         itoa(totalWorkTime, timeStr, 10);
         sensorPumpWorkTime.setValue(timeStr);
     }
 }
 
-void updatePump() {
-    // Zabezpieczenie przed przepełnieniem licznika millis()
-    if (millis() < status.pumpStartTime) status.pumpStartTime = millis();
-    if (millis() < status.pumpDelayStartTime) status.pumpDelayStartTime = millis();
+// Wydajność zakończonego cyklu i trend do HA
+static void publishPumpFlow(float lpm) {
+    if (lpm < 0) return;  // Za krótki cykl - brak wiarygodnego nachylenia
+    flowTrendAdd(pumpFlowTrend, lpm);
+    char buf[16];
+    dtostrf(lpm, 1, 2, buf);
+    sensorPumpFlow.setValue(buf);
+    float trend = flowTrendPercent(pumpFlowTrend);
+    if (trend >= 0) {
+        snprintf(buf, sizeof(buf), "%d", (int)(trend + 0.5f));
+        sensorPumpFlowTrend.setValue(buf);
+    }
+    LOG_I(LM_PUMP_FLOW, lpm);
+}
 
-    bool waterPresent = (digitalRead(PIN_WATER_LEVEL) == LOW);
-    sensorWater.setValue(waterPresent ? "ON" : "OFF");
+// Jedyne miejsce sterujące przekaźnikiem i stanem pompy w HA.
+// Wywoływane tylko przy zmianie stanu lub gdy przejście niesie akcję.
+static void applyPumpOutputs(PumpState from, PumpState to, PumpAction action) {
+    if (from != to) {
+        status.pumpStateSince = millis64();
 
-    if (status.isServiceMode) {
-        if (status.isPumpActive) {
+        if (pumpOutputOn(to) && !pumpOutputOn(from)) {
+            digitalWrite(POMPA_PIN, HIGH);
+            status.pumpStartTime = status.pumpStateSince;
+            status.waterLevelBeforePump = currentDistance;
+            flowStart(pumpFlow, status.pumpStateSince, currentDistance);
+            leakPause(pumpLeak);
+            sensorPump.setValue("ON");
+        } else if (pumpOutputOn(from) && !pumpOutputOn(to)) {
             digitalWrite(POMPA_PIN, LOW);
-            status.isPumpActive = false;
             sendPumpWorkTime();
             status.pumpStartTime = 0;
+            publishPumpFlow(flowFinish(pumpFlow, (float)config.tank_diameter));
+            leakResume(pumpLeak);
             sensorPump.setValue("OFF");
         }
-        return;
-    }
-
-    if (status.isPumpActive && (millis() - status.pumpStartTime > (unsigned long)config.pump_work_time * 1000UL)) {
-        digitalWrite(POMPA_PIN, LOW);
-        status.isPumpActive = false;
-        sendPumpWorkTime();
-        status.pumpStartTime = 0;
-        sensorPump.setValue("OFF");
-        status.pumpSafetyLock = true;
-        switchPumpAlarm.setState(true);
-        DEBUG_PRINTF("ALARM: Pompa pracowała za długo - aktywowano blokadę bezpieczeństwa!");
-        return;
-    }
 
-    if (status.pumpSafetyLock || status.waterAlarmActive) {
-        if (status.isPumpActive) {
-            digitalWrite(POMPA_PIN, LOW);
-            status.isPumpActive = false;
-            sendPumpWorkTime();
-            status.pumpStartTime = 0;
-            sensorPump.setValue("OFF");
+        if (pumpIsService(from) != pumpIsService(to)) {
+            controlSetSwitch(switchService, pumpIsService(to), true);  // force update w HA
+        }
+        if (pumpIsLocked(to) && !pumpIsLocked(from)) {
+            controlSetSwitch(switchPumpAlarm, true);
         }
-        return;
-    }
 
-    // Use last measured distance to avoid blocking ultrasonic measurement here
-    float dist = currentDistance;
-    if (status.isPumpActive && dist >= 0 && dist >= config.tank_empty) {
-        digitalWrite(POMPA_PIN, LOW);
-        status.isPumpActive = false;
-        sendPumpWorkTime();
-        status.pumpStartTime = 0;
-        status.isPumpDelayActive = false;
-        sensorPump.setValue("OFF");
-        switchPumpAlarm.setState(true);
-        DEBUG_PRINT(F("ALARM: Zatrzymano pompę - brak wody w zbiorniku!"));
-        return;
+        LOG_I(LM_PUMP_STATE, from, to);
     }
 
-    if (!waterPresent && status.isPumpActive) {
-        digitalWrite(POMPA_PIN, LOW);
-        status.isPumpActive = false;
-        sendPumpWorkTime();
-        status.pumpStartTime = 0;
-        status.isPumpDelayActive = false;
-        sensorPump.setValue("OFF");
-        return;
+    switch (action) {
+        case ACT_ALARM_RUN_TIMEOUT:
+            buzzerPlay(SOUND_ALARM_PUMP);
+            LOG_E(LM_ALARM_RUN_TIMEOUT);
+            break;
+        case ACT_ALARM_DRY_RUN:
+            controlSetSwitch(switchPumpAlarm, true);
+            buzzerPlay(SOUND_ALARM_DRY_RUN);
+            LOG_E(LM_ALARM_DRY_RUN);
+            break;
+        case ACT_ALARM_NO_FLOW:
+            sensorPumpNoFlow.setValue("ON");
+            buzzerPlay(SOUND_ALARM_PUMP);
+            LOG_E(LM_ALARM_NO_FLOW);
+            break;
+        case ACT_ALARM_CLEAR:
+            controlSetSwitch(switchPumpAlarm, false, true);
+            sensorPumpNoFlow.setValue("OFF");
+            LOG_I(LM_ALARM_CLEAR);
+            break;
+        default:
+            break;
     }
+}
 
-    if (waterPresent && !status.isPumpActive && !status.isPumpDelayActive) {
-        status.isPumpDelayActive = true;
-        status.pumpDelayStartTime = millis();
-        return;
-    }
+void pumpDispatch(PumpEvent event) {
+    PumpState from = status.pumpState;
+    const PumpTransition& t = pumpTransition(from, event);
+    if (t.next == from && t.action == ACT_NONE) return;
+    status.pumpState = t.next;
+    applyPumpOutputs(from, t.next, t.action);
+    if (from != t.next) warmCheckpoint();  // Blokada i tryb serwisowy przetrwają reset
+}
 
-    if (status.isPumpDelayActive && !status.isPumpActive) {
-        if (millis() - status.pumpDelayStartTime >= ((unsigned long)config.pump_delay * 1000UL)) {
-            digitalWrite(POMPA_PIN, HIGH);
-            status.isPumpActive = true;
-            status.pumpStartTime = millis();
-            status.isPumpDelayActive = false;
-            sensorPump.setValue("ON");
-        }
+void pumpFlowSample(uint64_t nowMs, float distanceMm) {
+    flowSample(pumpFlow, nowMs, distanceMm);
+}
+
+void pumpIdleSample(uint64_t nowMs, float distanceMm) {
+    float windowH = (float)config.leak_window;
+    leakSample(pumpLeak, nowMs, distanceMm, windowH);
+    bool wasAlarm = pumpLeak.alarm;
+    bool alarm = leakUpdateAlarm(pumpLeak, nowMs, (float)config.leak_limit, windowH);
+
+    // Ubytek [mm/dobę] przeliczony na litry z geometrii zbiornika
+    float litresPerDay = flowLitresPerMinute(leakRateMmPerDay(pumpLeak) / 86400.0f, (float)config.tank_diameter) * 1440.0f;
+    char buf[16];
+    dtostrf(litresPerDay > 0 ? litresPerDay : 0, 1, 1, buf);
+    sensorLeakRate.setValue(buf);
+    sensorLeak.setValue(alarm ? "ON" : "OFF");
+    if (alarm && !wasAlarm) {
+        buzzerPlay(SOUND_WARNING);
+        LOG_W(LM_LEAK_ALARM, litresPerDay);
+    } else if (!alarm && wasAlarm) {
+        LOG_I(LM_LEAK_CLEAR);
     }
 }
+
+FlowTrend& pumpFlowTrendState() {
+    return pumpFlowTrend;
+}
+
+void updatePump() {
+    bool waterPresent = floatSwitchWater();  // Zbocza z przerwania po filtrze czasowym
+    sensorWater.setValue(waterPresent ? "ON" : "OFF");
+
+    PumpInputs in;
+    in.waterPresent = waterPresent;
+    // Use last measured distance to avoid blocking ultrasonic measurement here
+    in.tankEmpty = status.waterAlarmActive || (currentDistance > 0 && currentDistance >= config.tank_empty);
+    uint64_t now = millis64();
+    in.noFlow = flowStalled(pumpFlow, now, (uint32_t)config.flow_check_window * 1000UL, (float)config.flow_min_drawdown);
+    in.elapsedMs = now - status.pumpStateSince;
+    in.delayMs = (uint64_t)config.pump_delay * 1000ULL;
+    in.runLimitMs = (uint64_t)config.pump_work_time * 1000ULL;
+
+    pumpDispatch(pumpPollEvent(status.pumpState, in));
+}
 // onPumpAlarmCommand handled in ha.cpp
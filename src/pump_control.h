@@ -2,10 +2,20 @@
 #define PUMP_CONTROL_H
 
 #include <Arduino.h>
+#include "pump_fsm.h"
+#include "pump_flow.h"
 
 class HASwitch;
 
 void updatePump();
+// Przekaż zdarzenie do maszyny stanów pompy (przycisk, HA, pętla główna)
+void pumpDispatch(PumpEvent event);
+// Pomiar odległości w trakcie pracy pompy (szacowanie przepływu)
+void pumpFlowSample(uint64_t nowMs, float distanceMm);
+// Pomiar odległości w postoju pompy (wykrywanie wycieku)
+void pumpIdleSample(uint64_t nowMs, float distanceMm);
 void onPumpAlarmCommand(bool state, HASwitch* sender);
+// Trend wydajności (migawka ciepłego restartu)
+FlowTrend& pumpFlowTrendState();
 
 #endif // PUMP_CONTROL_H
@@ -0,0 +1,74 @@
+#include "pump_flow.h"
+
+static const float PI_F = 3.14159265f;
+
+void flowStart(FlowMonitor& m, uint64_t nowMs, float distanceMm) {
+    m.active = true;
+    m.startMs = nowMs;
+    m.startDistance = distanceMm;
+    m.n = 0;
+    m.sumT = m.sumD = m.sumTT = m.sumTD = 0;
+}
+
+void flowSample(FlowMonitor& m, uint64_t nowMs, float distanceMm) {
+    if (!m.active || distanceMm <= 0) return;
+    // Wartości względem startu - małe liczby, więc float wystarcza
+    float t = (float)(nowMs - m.startMs) / 1000.0f;
+    float d = distanceMm - m.startDistance;
+    m.n++;
+    m.sumT += t;
+    m.sumD += d;
+    m.sumTT += t * t;
+    m.sumTD += t * d;
+}
+
+float flowSlope(const FlowMonitor& m) {
+    if (m.n < FLOW_MIN_SAMPLES) return 0;
+    float n = (float)m.n;
+    float den = n * m.sumTT - m.sumT * m.sumT;
+    if (den <= 0) return 0;
+    return (n * m.sumTD - m.sumT * m.sumD) / den;
+}
+
+bool flowStalled(const FlowMonitor& m, uint64_t nowMs, uint32_t windowMs, float minDrawdownMm) {
+    if (!m.active || windowMs == 0) return false;
+    if (nowMs - m.startMs < windowMs) return false;
+    // Bez pomiarów nie da się ocenić przepływu - chroni limit czasu pracy
+    if (m.n < FLOW_MIN_SAMPLES) return false;
+    float expectedDrop = flowSlope(m) * ((float)windowMs / 1000.0f);
+    return expectedDrop < minDrawdownMm;
+}
+
+float flowLitresPerMinute(float slopeMmPerS, float tankDiameterMm) {
+    float radius = tankDiameterMm / 2.0f;
+    float areaMm2 = PI_F * radius * radius;
+    return slopeMmPerS * areaMm2 * 60.0f / 1000000.0f;  // mm^3/s -> l/min
+}
+
+float flowFinish(FlowMonitor& m, float tankDiameterMm) {
+    bool valid = m.active && m.n >= FLOW_MIN_SAMPLES;
+    float lpm = valid ? flowLitresPerMinute(flowSlope(m), tankDiameterMm) : -1.0f;
+    m.active = false;
+    if (lpm < 0 && valid) lpm = 0;
+    return lpm;
+}
+
+void flowTrendAdd(FlowTrend& t, float lpm) {
+    if (lpm < 0) return;
+    t.runs++;
+    t.lastLpm = lpm;
+    if (t.runs == 1) {
+        t.recentLpm = lpm;
+        t.baselineLpm = lpm;
+        return;
+    }
+    t.recentLpm += FLOW_RECENT_ALPHA * (lpm - t.recentLpm);
+    // Odniesienie zamrożone po FLOW_BASELINE_RUNS cyklach - powolna degradacja
+    // pompy nie może go "wciągnąć" za sobą
+    if (t.runs <= FLOW_BASELINE_RUNS) t.baselineLpm += (lpm - t.baselineLpm) / (float)t.runs;
+}
+
+float flowTrendPercent(const FlowTrend& t) {
+    if (t.runs < FLOW_BASELINE_RUNS || t.baselineLpm <= 0) return -1.0f;
+    return t.recentLpm / t.baselineLpm * 100.0f;
+}
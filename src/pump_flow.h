@@ -0,0 +1,49 @@
+#ifndef PUMP_FLOW_H
+#define PUMP_FLOW_H
+
+#include <stdint.h>
+
+// Monitorowanie skuteczności pompy. Czysta logika (bez Arduino): nachylenie
+// spadku poziomu w zbiorniku (regresja liniowa odległości w czasie pracy),
+// przeliczenie na l/min z geometrii zbiornika i trend wydajności kolejnych cykli.
+
+const int FLOW_MIN_SAMPLES = 3;          // Minimum pomiarów do oceny nachylenia
+const float FLOW_RECENT_ALPHA = 0.3f;    // Wygładzanie bieżącej wydajności (na cykl)
+const int FLOW_BASELINE_RUNS = 5;        // Pierwsze cykle uśredniane jako wydajność odniesienia
+
+struct FlowMonitor {
+    bool active;
+    uint64_t startMs;
+    float startDistance;    // Odległość [mm] na starcie pompy
+    uint16_t n;             // Sumy regresji: t [s], d = odległość - start [mm]
+    float sumT, sumD, sumTT, sumTD;
+};
+
+struct FlowTrend {
+    uint16_t runs;          // Cykle z poprawnym pomiarem wydajności
+    float lastLpm;          // Wydajność ostatniego cyklu [l/min]
+    float recentLpm;        // Średnia krocząca ostatnich cykli
+    float baselineLpm;      // Wydajność odniesienia (średnia pierwszych cykli od startu)
+};
+
+void flowStart(FlowMonitor& m, uint64_t nowMs, float distanceMm);
+void flowSample(FlowMonitor& m, uint64_t nowMs, float distanceMm);
+
+// Nachylenie spadku poziomu [mm/s] (dodatnie = woda ubywa), 0 przy zbyt małej liczbie próbek
+float flowSlope(const FlowMonitor& m);
+
+// true, gdy po upływie okna kontroli spadek poziomu jest mniejszy niż oczekiwany.
+// windowMs == 0 wyłącza kontrolę.
+bool flowStalled(const FlowMonitor& m, uint64_t nowMs, uint32_t windowMs, float minDrawdownMm);
+
+// Przeliczenie nachylenia na l/min dla zbiornika cylindrycznego o średnicy w mm
+float flowLitresPerMinute(float slopeMmPerS, float tankDiameterMm);
+
+// Zakończenie cyklu: zwraca wydajność [l/min] lub -1, gdy pomiarów było za mało
+float flowFinish(FlowMonitor& m, float tankDiameterMm);
+
+void flowTrendAdd(FlowTrend& t, float lpm);
+// Bieżąca wydajność względem odniesienia [%], -1 przed zebraniem linii bazowej
+float flowTrendPercent(const FlowTrend& t);
+
+#endif // PUMP_FLOW_H
@@ -0,0 +1,54 @@
+#include "pump_fsm.h"
+
+// Skróty dla czytelności tablicy
+#define T(s, a) { s, a }
+#define STAY(s) { s, ACT_NONE }
+
+// Wiersz = stan bieżący, kolumna = zdarzenie (kolejność jak w PumpEvent):
+// NONE, WATER_ON, WATER_OFF, DELAY_ELAPSED, RUN_TIMEOUT, TANK_EMPTY, SERVICE_ON, SERVICE_OFF, ALARM_RESET, NO_FLOW
+const PumpTransition PUMP_TRANSITIONS[PUMP_STATE_COUNT][PUMP_EVENT_COUNT] = {
+    // PUMP_IDLE
+    { STAY(PUMP_IDLE), STAY(PUMP_DELAY), STAY(PUMP_IDLE), STAY(PUMP_IDLE), STAY(PUMP_IDLE),
+      STAY(PUMP_IDLE), STAY(PUMP_SERVICE), STAY(PUMP_IDLE), T(PUMP_IDLE, ACT_ALARM_CLEAR), STAY(PUMP_IDLE) },
+    // PUMP_DELAY
+    { STAY(PUMP_DELAY), STAY(PUMP_DELAY), STAY(PUMP_IDLE), STAY(PUMP_RUNNING), STAY(PUMP_DELAY),
+      STAY(PUMP_IDLE), STAY(PUMP_SERVICE), STAY(PUMP_DELAY), T(PUMP_DELAY, ACT_ALARM_CLEAR), STAY(PUMP_DELAY) },
+    // PUMP_RUNNING
+    { STAY(PUMP_RUNNING), STAY(PUMP_RUNNING), STAY(PUMP_IDLE), STAY(PUMP_RUNNING), T(PUMP_LOCKED, ACT_ALARM_RUN_TIMEOUT),
+      T(PUMP_IDLE, ACT_ALARM_DRY_RUN), STAY(PUMP_SERVICE), STAY(PUMP_RUNNING), T(PUMP_RUNNING, ACT_ALARM_CLEAR),
+      T(PUMP_LOCKED, ACT_ALARM_NO_FLOW) },
+    // PUMP_LOCKED
+    { STAY(PUMP_LOCKED), STAY(PUMP_LOCKED), STAY(PUMP_LOCKED), STAY(PUMP_LOCKED), STAY(PUMP_LOCKED),
+      STAY(PUMP_LOCKED), STAY(PUMP_SERVICE_LOCKED), STAY(PUMP_LOCKED), T(PUMP_IDLE, ACT_ALARM_CLEAR), STAY(PUMP_LOCKED) },
+    // PUMP_SERVICE
+    { STAY(PUMP_SERVICE), STAY(PUMP_SERVICE), STAY(PUMP_SERVICE), STAY(PUMP_SERVICE), STAY(PUMP_SERVICE),
+      STAY(PUMP_SERVICE), STAY(PUMP_SERVICE), STAY(PUMP_IDLE), T(PUMP_SERVICE, ACT_ALARM_CLEAR), STAY(PUMP_SERVICE) },
+    // PUMP_SERVICE_LOCKED
+    { STAY(PUMP_SERVICE_LOCKED), STAY(PUMP_SERVICE_LOCKED), STAY(PUMP_SERVICE_LOCKED), STAY(PUMP_SERVICE_LOCKED), STAY(PUMP_SERVICE_LOCKED),
+      STAY(PUMP_SERVICE_LOCKED), STAY(PUMP_SERVICE_LOCKED), STAY(PUMP_LOCKED), T(PUMP_SERVICE, ACT_ALARM_CLEAR),
+      STAY(PUMP_SERVICE_LOCKED) },
+};
+
+#undef T
+#undef STAY
+
+PumpEvent pumpPollEvent(PumpState state, const PumpInputs& in) {
+    if (state == PUMP_RUNNING && in.elapsedMs >= in.runLimitMs) return EV_RUN_TIMEOUT;
+    if (in.tankEmpty) return EV_TANK_EMPTY;
+    if (state == PUMP_RUNNING && in.noFlow) return EV_NO_FLOW;
+    if (!in.waterPresent) return EV_WATER_OFF;
+    if (state == PUMP_DELAY && in.elapsedMs >= in.delayMs) return EV_DELAY_ELAPSED;
+    return EV_WATER_ON;
+}
+
+const char* pumpStateName(PumpState s) {
+    switch (s) {
+        case PUMP_IDLE: return "idle";
+        case PUMP_DELAY: return "delay";
+        case PUMP_RUNNING: return "running";
+        case PUMP_LOCKED: return "locked";
+        case PUMP_SERVICE: return "service";
+        case PUMP_SERVICE_LOCKED: return "service_locked";
+        default: return "?";
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef PUMP_FSM_H
+#define PUMP_FSM_H
+
+#include <stdint.h>
+
+// Maszyna stanów pompy. Czysta logika (bez Arduino) - stan, zdarzenie
+// i tablica przejść; wyjścia (przekaźnik, HA) obsługuje pump_control.cpp.
+
+enum PumpState : uint8_t {
+    PUMP_IDLE,              // Czeka na sygnał z czujnika wody
+    PUMP_DELAY,             // Odliczanie opóźnienia przed startem
+    PUMP_RUNNING,           // Pompa pracuje
+    PUMP_LOCKED,            // Blokada bezpieczeństwa (wymaga skasowania alarmu)
+    PUMP_SERVICE,           // Tryb serwisowy
+    PUMP_SERVICE_LOCKED,    // Tryb serwisowy przy aktywnej blokadzie
+    PUMP_STATE_COUNT
+};
+
+enum PumpEvent : uint8_t {
+    EV_NONE,
+    EV_WATER_ON,            // Czujnik wody zgłasza potrzebę dolania
+    EV_WATER_OFF,           // Czujnik wody nie zgłasza potrzeby
+    EV_DELAY_ELAPSED,       // Minęło opóźnienie startu
+    EV_RUN_TIMEOUT,         // Przekroczony maksymalny czas pracy
+    EV_TANK_EMPTY,          // Brak wody w zbiorniku (pomiar odległości)
+    EV_SERVICE_ON,
+    EV_SERVICE_OFF,
+    EV_ALARM_RESET,         // Skasowanie alarmu (przycisk lub HA)
+    EV_NO_FLOW,             // Pompa pracuje, ale poziom w zbiorniku nie spada
+    PUMP_EVENT_COUNT
+};
+
+enum PumpAction : uint8_t {
+    ACT_NONE,
+    ACT_ALARM_RUN_TIMEOUT,  // Pompa pracowała za długo
+    ACT_ALARM_DRY_RUN,      // Pompa zatrzymana z braku wody w zbiorniku
+    ACT_ALARM_CLEAR,        // Alarm skasowany
+    ACT_ALARM_NO_FLOW,      // Pompa nie tłoczy wody (zapchana / zapowietrzona)
+};
+
+struct PumpTransition {
+    PumpState next;
+    PumpAction action;
+};
+
+extern const PumpTransition PUMP_TRANSITIONS[PUMP_STATE_COUNT][PUMP_EVENT_COUNT];
+
+// Wejścia odczytywane raz na iterację pętli
+struct PumpInputs {
+    bool waterPresent;
+    bool tankEmpty;
+    bool noFlow;                // Brak oczekiwanego spadku poziomu w oknie kontroli
+    uint64_t elapsedMs;         // Czas od wejścia w bieżący stan
+    uint64_t delayMs;           // Opóźnienie startu (config.pump_delay)
+    uint64_t runLimitMs;        // Maksymalny czas pracy (config.pump_work_time)
+};
+
+// Zdarzenie o najwyższym priorytecie wynikające z wejść (stały koszt)
+PumpEvent pumpPollEvent(PumpState state, const PumpInputs& in);
+
+inline const PumpTransition& pumpTransition(PumpState state, PumpEvent event) {
+    return PUMP_TRANSITIONS[state][event];
+}
+
+inline bool pumpOutputOn(PumpState s) { return s == PUMP_RUNNING; }
+inline bool pumpIsLocked(PumpState s) { return s == PUMP_LOCKED || s == PUMP_SERVICE_LOCKED; }
+inline bool pumpIsService(PumpState s) { return s == PUMP_SERVICE || s == PUMP_SERVICE_LOCKED; }
+
+const char* pumpStateName(PumpState s);
+
+#endif // PUMP_FSM_H
@@ -0,0 +1,116 @@
+#include "remote_config.h"
+#include <string.h>
+#ifdef ARDUINO
+#include "globals.h"
+#include "network.h"
+#include "log_ring.h"
+#endif
+
+static const char* const SOURCE_NAMES[RCS_COUNT] = { "fleet", "device" };
+
+uint32_t remoteConfigRev(const Config& cfg, RemoteConfigSource src) {
+    return src == RCS_FLEET ? cfg.remote_rev_fleet : cfg.remote_rev_device;
+}
+
+RemoteConfigResult remoteConfigEvaluate(ConfigUpdate& u, const Config& current, RemoteConfigSource src,
+                                        const char* json, size_t len) {
+    configUpdateBegin(u, current);
+    if (len > REMOTE_CONFIG_DOC_MAX) return RCR_TOO_LARGE;
+    configUpdateJson(u, json, len);
+    if (!u.issueCount && !u.rev) return RCR_NO_REV;
+    // Przed walidacją pól - błędny dokument z tym samym rev był już potwierdzony
+    if (u.rev && u.rev <= remoteConfigRev(current, src)) return RCR_STALE;
+    if (!configUpdateFinish(u, current)) return RCR_REJECTED;
+    if (src == RCS_FLEET) u.staged.remote_rev_fleet = u.rev;
+    else u.staged.remote_rev_device = u.rev;
+    return RCR_APPLY;
+}
+
+void remoteConfigAck(StrBuf& sb, RemoteConfigSource src, RemoteConfigResult r,
+                     const ConfigUpdate& u, const Config& cfg) {
+    char hash[9];
+    configHashHex(cfg, hash);
+    sbAppend(sb, "{\"source\":\"");
+    sbAppend(sb, SOURCE_NAMES[src]);
+    sbAppend(sb, "\",\"rev\":");
+    sbAppendUInt(sb, u.rev);
+    sbAppend(sb, ",\"hash\":\"");
+    sbAppend(sb, hash);
+    sbAppend(sb, "\",\"result\":");
+    if (r == RCR_TOO_LARGE) sbAppend(sb, "{\"status\":\"error\",\"errors\":{\"document\":\"size\"}}");
+    else if (r == RCR_NO_REV) sbAppend(sb, "{\"status\":\"error\",\"errors\":{\"rev\":\"missing\"}}");
+    else configUpdateReport(sb, u);
+    sbAppendChar(sb, '}');
+}
+
+#ifdef ARDUINO
+static char s_topics[RCS_COUNT][64];
+static char s_stateTopic[64];
+static char s_docs[RCS_COUNT][REMOTE_CONFIG_DOC_MAX];
+static size_t s_docLen[RCS_COUNT];
+static bool s_pending[RCS_COUNT];
+static uint32_t s_seenRev[RCS_COUNT];      // Także odrzucone i bez zmian - bez zapisu do flash
+static bool s_subscribed = false;
+static ConfigUpdate s_update;
+
+void remoteConfigBegin(const char* deviceId) {
+    StrBuf sb;
+    sbInit(sb, s_topics[RCS_FLEET], sizeof(s_topics[RCS_FLEET]));
+    sbAppend(sb, "aha/fleet/config/set");
+    sbInit(sb, s_topics[RCS_DEVICE], sizeof(s_topics[RCS_DEVICE]));
+    sbAppend(sb, "aha/");
+    sbAppend(sb, deviceId);
+    sbAppend(sb, "/config/set");
+    sbInit(sb, s_stateTopic, sizeof(s_stateTopic));
+    sbAppend(sb, "aha/");
+    sbAppend(sb, deviceId);
+    sbAppend(sb, "/config/state");
+}
+
+bool remoteConfigMessage(const char* topic, const uint8_t* payload, uint16_t length) {
+    for (uint8_t src = 0; src < RCS_COUNT; ++src) {
+        if (strcmp(topic, s_topics[src]) != 0) continue;
+        // Za duży dokument: tylko długość - potwierdzenie z błędem "size"
+        if (length <= REMOTE_CONFIG_DOC_MAX) memcpy(s_docs[src], payload, length);
+        s_docLen[src] = length;
+        s_pending[src] = true;
+        return true;
+    }
+    return false;
+}
+
+void remoteConfigConnected() {
+    s_subscribed = false;
+}
+
+void remoteConfigLoop() {
+    if (!mqtt.isConnected()) return;
+    if (!s_subscribed) {
+        // Kolejność subskrypcji = kolejność zachowanych dokumentów od brokera
+        s_subscribed = mqtt.subscribe(s_topics[RCS_FLEET]) && mqtt.subscribe(s_topics[RCS_DEVICE]);
+        return;
+    }
+
+    bool reconnect = false;
+    for (uint8_t i = 0; i < RCS_COUNT; ++i) {
+        if (!s_pending[i]) continue;
+        s_pending[i] = false;
+        RemoteConfigSource src = (RemoteConfigSource)i;
+        RemoteConfigResult r = remoteConfigEvaluate(s_update, config, src, s_docs[i], s_docLen[i]);
+        if (r == RCR_STALE) continue;
+        if (s_update.rev) {
+            if (s_update.rev <= s_seenRev[i]) continue;
+            s_seenRev[i] = s_update.rev;
+        }
+        if (r == RCR_APPLY) reconnect |= applyConfigUpdate(s_update);
+        LOG_I(LM_REMOTE_CONFIG, i, s_update.rev, r);
+
+        static char ack[512];     // Lista wszystkich zmienionych pól
+        StrBuf sb;
+        sbInit(sb, ack, sizeof(ack));
+        remoteConfigAck(sb, src, r, s_update, config);
+        if (!sb.overflow) mqtt.publish(s_stateTopic, ack, true);
+    }
+    if (reconnect) reconnectMqttForConfig();   // Po potwierdzeniach - trafią jeszcze starym połączeniem
+}
+#endif
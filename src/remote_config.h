@@ -0,0 +1,57 @@
+#ifndef REMOTE_CONFIG_H
+#define REMOTE_CONFIG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "config.h"
+#include "config_schema.h"
+#include "strbuf.h"
+
+// Zdalna konfiguracja przez MQTT: częściowe dokumenty jak PUT /config
+// ({"version":1,"rev":17,"pump_delay":10}) na tematach zachowanych
+// (retained) - wspólnym dla floty i własnym urządzenia. Dokument przechodzi
+// walidację z config_schema.h i trafia do flash jednym zapisem razem z "rev";
+// starszy lub ten sam rev jest pomijany, więc zachowany dokument nie nadpisuje
+// po ponownym połączeniu zmian z formularza WWW. Wynik wraz ze skrótem
+// nowej konfiguracji idzie na aha/<urządzenie>/config/state.
+//
+// Payload jest kopiowany z bufora klienta MQTT do stałego bufora źródła
+// i parsowany w miejscu (json_flat.h) - bez String i bez sterty. Dokument
+// urządzenia jest stosowany po dokumencie floty, więc jego pola wygrywają.
+
+const size_t REMOTE_CONFIG_DOC_MAX = 640;                           // Pełny eksport GET /config mieści się
+const uint16_t REMOTE_CONFIG_MQTT_BUFFER = REMOTE_CONFIG_DOC_MAX + 128;  // Bufor klienta: payload + temat
+
+enum RemoteConfigSource : uint8_t {
+    RCS_FLEET,              // aha/fleet/config/set
+    RCS_DEVICE,             // aha/<urządzenie>/config/set
+    RCS_COUNT
+};
+
+enum RemoteConfigResult : uint8_t {
+    RCR_APPLY,              // Poprawny i nowszy - do zapisu (może nic nie zmieniać)
+    RCR_REJECTED,           // Błędy pól lub składni - konfiguracja bez zmian
+    RCR_STALE,              // rev nie nowszy niż zastosowany - bez potwierdzenia
+    RCR_NO_REV,             // Dokument zdalny musi mieć "rev"
+    RCR_TOO_LARGE,          // Ponad REMOTE_CONFIG_DOC_MAX
+};
+
+uint32_t remoteConfigRev(const Config& cfg, RemoteConfigSource src);
+// Walidacja dokumentu; przy RCR_APPLY u.staged zawiera też nowy rev źródła
+RemoteConfigResult remoteConfigEvaluate(ConfigUpdate& u, const Config& current, RemoteConfigSource src,
+                                        const char* json, size_t len);
+// {"source":"fleet","rev":17,"hash":"89abcdef","result":{...jak PUT /config...}}
+void remoteConfigAck(StrBuf& sb, RemoteConfigSource src, RemoteConfigResult r,
+                     const ConfigUpdate& u, const Config& cfg);
+
+#ifdef ARDUINO
+void remoteConfigBegin(const char* deviceId);
+// Z wywołania zwrotnego MQTT - tylko kopia payloadu; true gdy temat konfiguracji
+bool remoteConfigMessage(const char* topic, const uint8_t* payload, uint16_t length);
+// Nowe połączenie (HAMqtt::onConnected) - subskrypcje od nowa
+void remoteConfigConnected();
+// Subskrypcja po połączeniu, zapis i potwierdzenie poza wywołaniem zwrotnym
+void remoteConfigLoop();
+#endif
+
+#endif // REMOTE_CONFIG_H
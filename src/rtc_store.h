@@ -0,0 +1,70 @@
+#ifndef RTC_STORE_H
+#define RTC_STORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+// Wspólny podział pamięci RTC użytkownika (512 B = 128 bloków po 4 B).
+// Przetrwa reset i watchdog, ale nie zanik zasilania. Bloki 0-31 nadpisuje
+// eboot przy aktualizacji OTA - nie wolno ich używać. Na ESP32 ten sam układ
+// leży w tablicy RTC_NOINIT_ATTR (platform.cpp).
+const uint32_t RTC_BLOCK_BOOT_TIMELINE = 32;    // Oś czasu startu (32 bloki)
+const uint32_t RTC_BLOCK_WATCHDOG = 64;         // Ślad etapu pętli i ostatnie zawieszenie (16 bloków)
+const uint32_t RTC_BLOCK_WARM = 80;             // Migawka stanu do ciepłego restartu (do 36 bloków)
+const uint32_t RTC_BLOCK_WIFI = 116;            // Ostatni punkt dostępowy i dzierżawa IP (8 bloków)
+const uint32_t RTC_BLOCK_FREE = 124;            // Pierwszy wolny blok
+const uint32_t RTC_BLOCK_END = 128;
+
+#define RTC_BLOCKS(T) ((sizeof(T) + 3) / 4)
+
+// Suma kontrolna rekordów w RTC (FNV-1a) - odróżnia dane od śmieci po zaniku zasilania
+inline uint32_t rtcChecksum(const void* data, size_t size) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t h = 2166136261UL;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 16777619UL;
+    }
+    return h;
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <string.h>
+
+extern uint32_t platformRtcMemory[RTC_BLOCK_END];
+
+inline bool rtcRead(uint32_t block, void* data, size_t size) {
+    if (block + (size + 3) / 4 > RTC_BLOCK_END) return false;
+    memcpy(data, &platformRtcMemory[block], size);
+    return true;
+}
+
+inline bool rtcWrite(uint32_t block, const void* data, size_t size) {
+    if (block + (size + 3) / 4 > RTC_BLOCK_END) return false;
+    memcpy(&platformRtcMemory[block], data, size);
+    return true;
+}
+
+inline void rtcWriteWord(uint32_t block, uint32_t value) {
+    ((volatile uint32_t*)platformRtcMemory)[block] = value;
+}
+#elif defined(ARDUINO)
+inline bool rtcRead(uint32_t block, void* data, size_t size) {
+    return ESP.rtcUserMemoryRead(block, (uint32_t*)data, size);
+}
+
+inline bool rtcWrite(uint32_t block, const void* data, size_t size) {
+    return ESP.rtcUserMemoryWrite(block, (uint32_t*)data, size);
+}
+
+// Bezpośredni zapis jednego słowa (kilka cykli) - dla danych zapisywanych
+// bardzo często; blok 0 pamięci użytkownika leży pod 0x60001200
+inline void rtcWriteWord(uint32_t block, uint32_t value) {
+    ((volatile uint32_t*)0x60001200)[block] = value;
+}
+#endif
+
+#endif // RTC_STORE_H
@@ -0,0 +1,77 @@
+#include "sensor_health.h"
+#include <string.h>
+#include <math.h>
+
+void healthInit(SensorHealth& h) {
+    memset(&h, 0, sizeof(h));
+}
+
+void healthSample(SensorHealth& h, SampleOutcome outcome, uint32_t echoUs) {
+    h.samples++;
+    if (h.cycleSamples < 255) h.cycleSamples++;
+    switch (outcome) {
+        case SAMPLE_OK: {
+            h.validSamples++;
+            if (h.cycleValid++ == 0) h.cycleRef = echoUs;
+            float d = (float)((int32_t)(echoUs - h.cycleRef));
+            h.cycleSum += d;
+            h.cycleSumSq += d * d;
+            break;
+        }
+        case SAMPLE_TIMEOUT_HIGH: h.timeoutHigh++; break;
+        case SAMPLE_TIMEOUT_LOW: h.timeoutLow++; break;
+    }
+}
+
+static float ema(float prev, float sample, bool primed) {
+    return primed ? prev + HEALTH_ALPHA * (sample - prev) : sample;
+}
+
+void healthCycle(SensorHealth& h, CycleOutcome outcome) {
+    h.cycles++;
+    switch (outcome) {
+        case CYCLE_TOO_FEW_SAMPLES: h.tooFewSamples++; break;
+        case CYCLE_OUT_OF_RANGE: h.outOfRange++; break;
+        case CYCLE_SPIKE_REJECTED: h.spikeRejected++; break;
+        default: break;
+    }
+
+    float ratio = h.cycleSamples ? (float)h.cycleValid / (float)h.cycleSamples : 0.0f;
+    // Rozrzut tylko z cykli z co najmniej dwiema poprawnymi próbkami
+    float jitter = h.jitterUs;
+    if (h.cycleValid >= 2) {
+        float mean = h.cycleSum / h.cycleValid;
+        float var = h.cycleSumSq / h.cycleValid - mean * mean;
+        jitter = var > 0 ? sqrtf(var) : 0.0f;
+    }
+    bool failed = (outcome == CYCLE_TOO_FEW_SAMPLES || outcome == CYCLE_OUT_OF_RANGE);
+
+    h.validRatio = ema(h.validRatio, ratio, h.primed);
+    h.failRate = ema(h.failRate, failed ? 1.0f : 0.0f, h.primed);
+    h.spikeRate = ema(h.spikeRate, outcome == CYCLE_SPIKE_REJECTED ? 1.0f : 0.0f, h.primed);
+    h.jitterUs = ema(h.jitterUs, jitter, h.primed);
+    h.primed = true;
+
+    h.cycleSamples = h.cycleValid = 0;
+    h.cycleSum = h.cycleSumSq = 0;
+}
+
+float healthJitterMm(const SensorHealth& h) {
+    return h.jitterUs * 0.1715f;  // us * 343 m/s / 2
+}
+
+// Jakość = udział poprawnych próbek x udział cykli z wynikiem, pomniejszona
+// o połowę udziału odrzuconych skoków i o karę za rozrzut echa
+int healthScore(const SensorHealth& h) {
+    if (!h.primed) return 100;
+    float score = 100.0f * h.validRatio * (1.0f - h.failRate) * (1.0f - 0.5f * h.spikeRate);
+    float jitterPart = healthJitterMm(h) / HEALTH_JITTER_FULL_MM;
+    if (jitterPart > 1.0f) jitterPart = 1.0f;
+    score -= HEALTH_JITTER_PENALTY * jitterPart;
+    if (score < 0) score = 0;
+    return (int)(score + 0.5f);
+}
+
+bool healthStale(uint64_t lastOkMs, uint64_t nowMs, uint32_t staleMs) {
+    return nowMs >= lastOkMs && nowMs - lastOkMs > staleMs;
+}
@@ -0,0 +1,61 @@
+#ifndef SENSOR_HEALTH_H
+#define SENSOR_HEALTH_H
+
+#include <stdint.h>
+
+// Diagnostyka czujnika ultradźwiękowego. Czysta logika (bez Arduino):
+// liczniki błędów próbek i cykli, rozrzut czasu echa w cyklu oraz wskaźnik
+// jakości sygnału 0-100 wyliczany ze średnich kroczących.
+
+const float HEALTH_ALPHA = 0.1f;            // Wygładzanie wskaźników (na cykl pomiarowy)
+const float HEALTH_JITTER_FULL_MM = 20.0f;  // Rozrzut echa odbierający pełną karę
+const float HEALTH_JITTER_PENALTY = 20.0f;  // Maksymalna kara za rozrzut [pkt]
+
+enum SampleOutcome : uint8_t {
+    SAMPLE_OK,
+    SAMPLE_TIMEOUT_HIGH,    // Brak początku echa (brak odbicia, odłączony czujnik)
+    SAMPLE_TIMEOUT_LOW,     // Echo nie zakończyło się w czasie (zakłócenia, zbyt daleko)
+};
+
+enum CycleOutcome : uint8_t {
+    CYCLE_OK,
+    CYCLE_TOO_FEW_SAMPLES,  // Za mało poprawnych próbek do wyniku
+    CYCLE_OUT_OF_RANGE,     // Wynik poza zakresem czujnika
+    CYCLE_SPIKE_REJECTED,   // Wynik odrzucony przez bramkę filtra
+};
+
+struct SensorHealth {
+    uint32_t cycles;
+    uint32_t samples;
+    uint32_t validSamples;
+    uint32_t timeoutHigh;
+    uint32_t timeoutLow;
+    uint32_t tooFewSamples;
+    uint32_t outOfRange;
+    uint32_t spikeRejected;
+    // Bieżący cykl: liczba próbek i sumy odchyleń czasu echa od pierwszej
+    // poprawnej próbki (przesunięcie chroni precyzję float)
+    uint8_t cycleSamples;
+    uint8_t cycleValid;
+    uint32_t cycleRef;
+    float cycleSum, cycleSumSq;
+    // Średnie kroczące (inicjalizowane pierwszym cyklem)
+    bool primed;
+    float validRatio;       // Udział poprawnych próbek
+    float failRate;         // Udział cykli bez wyniku
+    float spikeRate;        // Udział cykli odrzuconych przez filtr
+    float jitterUs;         // Rozrzut czasu echa w cyklu [us]
+};
+
+void healthInit(SensorHealth& h);
+void healthSample(SensorHealth& h, SampleOutcome outcome, uint32_t echoUs);
+void healthCycle(SensorHealth& h, CycleOutcome outcome);
+
+// Rozrzut echa przeliczony na mm (droga w obie strony, 343 m/s)
+float healthJitterMm(const SensorHealth& h);
+// 0-100; 100 przed pierwszym cyklem
+int healthScore(const SensorHealth& h);
+// Brak poprawnego pomiaru od staleMs (lastOkMs = 0 liczone od startu)
+bool healthStale(uint64_t lastOkMs, uint64_t nowMs, uint32_t staleMs);
+
+#endif // SENSOR_HEALTH_H
@@ -0,0 +1,50 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+// Kolejka bez blokad dla jednego producenta i jednego konsumenta (np. dwóch
+// zadań na różnych rdzeniach). Producent zapisuje tylko head, konsument tylko
+// tail; publikację elementu zapewnia para release/acquire. Pełna kolejka
+// odrzuca nowy element (liczony w dropped) - producent nigdy nie czeka.
+// Obiekty globalne lub statyczne (inicjalizacja zerami).
+
+template <typename T, uint16_t N>
+struct SpscQueue {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "Rozmiar kolejki musi być potęgą 2");
+    std::atomic<uint16_t> head;     // Następny zapis (producent)
+    std::atomic<uint16_t> tail;     // Następny odczyt (konsument)
+    uint32_t dropped;               // Odrzucone przy pełnej kolejce (producent)
+    T items[N];
+};
+
+// Wywoływana także z przerwań (float_switch.cpp) - zawsze wstawiana w miejscu
+// wywołania, żeby kod procedury przerwania pozostał w IRAM
+template <typename T, uint16_t N>
+__attribute__((always_inline)) inline bool spscPush(SpscQueue<T, N>& q, const T& item) {
+    uint16_t head = q.head.load(std::memory_order_relaxed);
+    if ((uint16_t)(head - q.tail.load(std::memory_order_acquire)) >= N) {
+        q.dropped++;
+        return false;
+    }
+    q.items[head & (N - 1)] = item;
+    q.head.store((uint16_t)(head + 1), std::memory_order_release);
+    return true;
+}
+
+template <typename T, uint16_t N>
+bool spscPop(SpscQueue<T, N>& q, T& out) {
+    uint16_t tail = q.tail.load(std::memory_order_relaxed);
+    if (tail == q.head.load(std::memory_order_acquire)) return false;
+    out = q.items[tail & (N - 1)];
+    q.tail.store((uint16_t)(tail + 1), std::memory_order_release);
+    return true;
+}
+
+template <typename T, uint16_t N>
+uint16_t spscSize(const SpscQueue<T, N>& q) {
+    return (uint16_t)(q.head.load(std::memory_order_acquire) - q.tail.load(std::memory_order_acquire));
+}
+
+#endif // SPSC_QUEUE_H
@@ -2,20 +2,18 @@
 #define STATUS_H
 
 #include <Arduino.h>
+#include "pump_fsm.h"
 
 struct Status {
     bool soundEnabled;
     bool waterAlarmActive;
     bool waterReserveActive;
-    bool isPumpActive;
-    bool isPumpDelayActive;
-    bool pumpSafetyLock;
-    bool isServiceMode;
-    float waterLevelBeforePump;
-    unsigned long pumpStartTime;
-    unsigned long pumpDelayStartTime;
-    unsigned long lastSoundAlert;
-    unsigned long lastSuccessfulMeasurement;
+    PumpState pumpState;
+    float waterLevelBeforePump;           // Odległość [mm] w chwili startu pompy
+    uint64_t pumpStateSince;              // Znaczniki czasu z millis64()
+    uint64_t pumpStartTime;
+    uint64_t lastSoundAlert;
+    uint64_t lastSuccessfulMeasurement;
 };
 
 extern Status status;
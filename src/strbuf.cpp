@@ -0,0 +1,77 @@
+#include "strbuf.h"
+#include <string.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#define strlen_P strlen
+#define memcpy_P memcpy
+#endif
+
+void sbInit(StrBuf& sb, char* buf, size_t cap) {
+    sb.buf = buf;
+    sb.cap = cap;
+    sb.len = 0;
+    sb.overflow = false;
+    if (cap) buf[0] = 0;
+}
+
+void sbAppendN(StrBuf& sb, const char* s, size_t n) {
+    if (sb.cap == 0) { sb.overflow = true; return; }
+    size_t room = sb.cap - 1 - sb.len;
+    if (n > room) { n = room; sb.overflow = true; }
+    memcpy(sb.buf + sb.len, s, n);
+    sb.len += n;
+    sb.buf[sb.len] = 0;
+}
+
+void sbAppend(StrBuf& sb, const char* s) {
+    sbAppendN(sb, s, strlen(s));
+}
+
+void sbAppendP(StrBuf& sb, const char* progmemStr) {
+    if (sb.cap == 0) { sb.overflow = true; return; }
+    size_t n = strlen_P(progmemStr);
+    size_t room = sb.cap - 1 - sb.len;
+    if (n > room) { n = room; sb.overflow = true; }
+    memcpy_P(sb.buf + sb.len, progmemStr, n);
+    sb.len += n;
+    sb.buf[sb.len] = 0;
+}
+
+void sbAppendChar(StrBuf& sb, char c) {
+    sbAppendN(sb, &c, 1);
+}
+
+void sbAppendUInt(StrBuf& sb, unsigned long v) {
+    char tmp[12];
+    int i = sizeof(tmp);
+    do { tmp[--i] = (char)('0' + v % 10); v /= 10; } while (v && i > 0);
+    sbAppendN(sb, tmp + i, sizeof(tmp) - i);
+}
+
+void sbAppendInt(StrBuf& sb, long v) {
+    if (v < 0) {
+        sbAppendChar(sb, '-');
+        sbAppendUInt(sb, 0UL - (unsigned long)v);
+    } else {
+        sbAppendUInt(sb, (unsigned long)v);
+    }
+}
+
+void sbAppendJsonString(StrBuf& sb, const char* s, size_t n) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    sbAppendChar(sb, '"');
+    for (size_t i = 0; i < n && s[i]; ++i) {
+        char c = s[i];
+        if (c == '"' || c == '\\') {
+            char esc[2] = {'\\', c};
+            sbAppendN(sb, esc, 2);
+        } else if ((uint8_t)c < 0x20) {
+            char esc[6] = {'\\', 'u', '0', '0', HEX_DIGITS[(c >> 4) & 0xF], HEX_DIGITS[c & 0xF]};
+            sbAppendN(sb, esc, 6);
+        } else {
+            sbAppendChar(sb, c);
+        }
+    }
+    sbAppendChar(sb, '"');
+}
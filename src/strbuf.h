@@ -0,0 +1,27 @@
+#ifndef STRBUF_H
+#define STRBUF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Składanie tekstu (JSON, komunikaty) w buforze o stałym rozmiarze - bez
+// alokacji na stercie. Po przepełnieniu bufor pozostaje zakończony zerem,
+// a flaga overflow jest ustawiona.
+struct StrBuf {
+    char* buf;
+    size_t cap;
+    size_t len;
+    bool overflow;
+};
+
+void sbInit(StrBuf& sb, char* buf, size_t cap);
+void sbAppend(StrBuf& sb, const char* s);
+void sbAppendN(StrBuf& sb, const char* s, size_t n);
+void sbAppendP(StrBuf& sb, const char* progmemStr);
+void sbAppendChar(StrBuf& sb, char c);
+void sbAppendInt(StrBuf& sb, long v);
+void sbAppendUInt(StrBuf& sb, unsigned long v);
+// Łańcuch JSON w cudzysłowach, ze znakami sterującymi i " \ zamienionymi na sekwencje
+void sbAppendJsonString(StrBuf& sb, const char* s, size_t n);
+
+#endif // STRBUF_H
@@ -3,13 +3,15 @@
 
 #include <Arduino.h>
 
+// Znaczniki czasu z millis64() - bez problemu przepełnienia po 49 dniach
 struct Timers {
-    unsigned long lastMQTTRetry;
-    unsigned long lastMeasurement;
-    unsigned long lastOTACheck;
-    unsigned long lastMQTTLoop;
-    unsigned long lastWiFiAttempt;
-    Timers() : lastMQTTRetry(0), lastMeasurement(0), lastOTACheck(0), lastMQTTLoop(0) {}
+    uint64_t lastMQTTRetry;
+    uint64_t lastMeasurement;
+    uint64_t lastOTACheck;
+    uint64_t lastMQTTLoop;
+    uint64_t lastWiFiAttempt;
+    uint64_t lastHeapStats;
+    Timers() : lastMQTTRetry(0), lastMeasurement(0), lastOTACheck(0), lastMQTTLoop(0), lastWiFiAttempt(0), lastHeapStats(0) {}
 };
 
 extern Timers timers;
@@ -0,0 +1,89 @@
+#include "warm_restart.h"
+#include "rtc_store.h"
+#include <stddef.h>
+#include <string.h>
+#ifdef ARDUINO
+#include "globals.h"
+#include "measurements.h"
+#include "pump_control.h"
+#include "mono_clock.h"
+#include "log_ring.h"
+#endif
+
+static_assert(RTC_BLOCKS(WarmSnapshot) <= RTC_BLOCK_WIFI - RTC_BLOCK_WARM, "Migawka nie mieści się w przydzielonych blokach RTC");
+
+void warmSeal(WarmSnapshot& s) {
+    s.magic = WARM_MAGIC;
+    s.layout = WARM_LAYOUT;
+    s.size = sizeof(WarmSnapshot);
+    s.checksum = rtcChecksum(&s, offsetof(WarmSnapshot, checksum));
+}
+
+bool warmValid(const WarmSnapshot& s) {
+    return s.magic == WARM_MAGIC && s.layout == WARM_LAYOUT && s.size == sizeof(WarmSnapshot) &&
+           s.pumpState < PUMP_STATE_COUNT && s.checksum == rtcChecksum(&s, offsetof(WarmSnapshot, checksum));
+}
+
+PumpState warmResumeState(uint8_t saved) {
+    switch (saved) {
+        case PUMP_LOCKED:
+        case PUMP_SERVICE:
+        case PUMP_SERVICE_LOCKED:
+            return (PumpState)saved;
+        default:
+            return PUMP_IDLE;
+    }
+}
+
+#ifdef ARDUINO
+static WarmSnapshot s_snapshot;
+
+bool warmRestore() {
+    rtcRead(RTC_BLOCK_WARM, &s_snapshot, sizeof(s_snapshot));
+    // Po włączeniu zasilania RTC zawiera przypadkowe dane - suma kontrolna to odrzuci
+    if (platformResetReason() == 0 || !warmValid(s_snapshot)) {
+        memset(&s_snapshot, 0, sizeof(s_snapshot));
+        return false;
+    }
+
+    millis64Resume(s_snapshot.monoMs);
+    measurementFilter() = s_snapshot.filter;
+    pumpFlowTrendState() = s_snapshot.flowTrend;
+    lastFilteredDistance = s_snapshot.lastFilteredDistance;
+    currentDistance = s_snapshot.currentDistance;
+    status.lastSuccessfulMeasurement = s_snapshot.lastSuccessfulMeasurement;
+    status.waterAlarmActive = (s_snapshot.flags & WARM_WATER_ALARM) != 0;
+    status.waterReserveActive = (s_snapshot.flags & WARM_WATER_RESERVE) != 0;
+    status.pumpState = warmResumeState(s_snapshot.pumpState);
+    sensorAlarm.setValue(status.waterAlarmActive ? "ON" : "OFF");
+    sensorReserve.setValue(status.waterReserveActive ? "ON" : "OFF");
+    LOG_I(LM_WARM_RESTORE, s_snapshot.seq, currentDistance, status.pumpState);
+    return true;
+}
+
+void warmCheckpoint() {
+    s_snapshot.seq++;
+    s_snapshot.reserved = 0;
+    s_snapshot.monoMs = millis64();
+    s_snapshot.lastSuccessfulMeasurement = status.lastSuccessfulMeasurement;
+    s_snapshot.lastFilteredDistance = lastFilteredDistance;
+    s_snapshot.currentDistance = currentDistance;
+    s_snapshot.filter = measurementFilter();
+    s_snapshot.flowTrend = pumpFlowTrendState();
+    s_snapshot.pumpState = status.pumpState;
+    s_snapshot.flags = (status.waterAlarmActive ? WARM_WATER_ALARM : 0) | (status.waterReserveActive ? WARM_WATER_RESERVE : 0);
+    s_snapshot.reserved2 = 0;
+    warmSeal(s_snapshot);
+    rtcWrite(RTC_BLOCK_WARM, &s_snapshot, sizeof(s_snapshot));
+}
+
+void warmRestart() {
+    warmCheckpoint();
+    platformRestart();
+}
+
+void warmInvalidate() {
+    memset(&s_snapshot, 0, sizeof(s_snapshot));
+    rtcWrite(RTC_BLOCK_WARM, &s_snapshot, sizeof(s_snapshot));
+}
+#endif
@@ -0,0 +1,55 @@
+#ifndef WARM_RESTART_H
+#define WARM_RESTART_H
+
+#include <stdint.h>
+#include "filters.h"
+#include "pump_flow.h"
+#include "pump_fsm.h"
+
+// Ciepły restart: migawka stanu w pamięci RTC zapisywana po każdym pomiarze,
+// przy zmianie stanu pompy i przed zamierzonym restartem (OTA, /reboot).
+// Po resecie programowym lub watchdogu filtr pomiaru, alarmy, blokada pompy,
+// statystyki wydajności i oś czasu millis64() wracają od razu, zamiast
+// budować się od zera przez kilka cykli pomiarowych.
+
+const uint32_t WARM_MAGIC = 0x48535752UL;   // "HSWR"
+const uint16_t WARM_LAYOUT = 1;             // Zmiana układu struktury = nowa wersja
+
+enum WarmFlags : uint8_t {
+    WARM_WATER_ALARM = 1,
+    WARM_WATER_RESERVE = 2,
+};
+
+struct WarmSnapshot {
+    uint32_t magic;
+    uint16_t layout;
+    uint16_t size;          // sizeof(WarmSnapshot) - odrzuca zapis innej wersji firmware
+    uint32_t seq;           // Numer zapisu (diagnostyka)
+    uint32_t reserved;
+    uint64_t monoMs;        // millis64() w chwili zapisu
+    uint64_t lastSuccessfulMeasurement;
+    float lastFilteredDistance;
+    float currentDistance;
+    RobustFilter filter;
+    FlowTrend flowTrend;
+    uint8_t pumpState;
+    uint8_t flags;          // WarmFlags
+    uint16_t reserved2;
+    uint32_t checksum;
+};
+
+void warmSeal(WarmSnapshot& s);
+bool warmValid(const WarmSnapshot& s);
+// Stan pompy po restarcie: blokada i tryb serwisowy zostają, praca i
+// odliczanie zaczynają się od nowa (pompa po resecie jest wyłączona)
+PumpState warmResumeState(uint8_t saved);
+
+#ifdef ARDUINO
+// Na początku setup(), przed pierwszym millis64(); true gdy stan przywrócono
+bool warmRestore();
+void warmCheckpoint();
+void warmRestart();         // Migawka i platformRestart()
+void warmInvalidate();      // Ustawienia fabryczne - bez przywracania stanu
+#endif
+
+#endif // WARM_RESTART_H
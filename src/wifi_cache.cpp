@@ -0,0 +1,168 @@
+#include "wifi_cache.h"
+#include "rtc_store.h"
+#include <stddef.h>
+#include <string.h>
+#ifdef ARDUINO
+#include "globals.h"
+#include "config.h"
+#include "mono_clock.h"
+#include "strbuf.h"
+#include "log_ring.h"
+#endif
+
+static_assert(RTC_BLOCKS(WifiCache) <= RTC_BLOCK_FREE - RTC_BLOCK_WIFI, "Wpis WiFi nie mieści się w przydzielonych blokach RTC");
+
+uint32_t wifiSsidHash(const char* ssid) {
+    return rtcChecksum(ssid, strlen(ssid));
+}
+
+void wifiCacheSeal(WifiCache& c, const char* ssid) {
+    c.ssidHash = wifiSsidHash(ssid);
+    c.reserved = 0;
+    c.checksum = rtcChecksum(&c, offsetof(WifiCache, checksum));
+}
+
+bool wifiCacheValid(const WifiCache& c, const char* ssid) {
+    if (c.checksum != rtcChecksum(&c, offsetof(WifiCache, checksum))) return false;
+    if (c.channel < 1 || c.channel > 14) return false;
+    return c.ssidHash == wifiSsidHash(ssid);
+}
+
+void wifiStatsRecord(WifiConnectStats& s, WifiConnectMode mode, uint32_t elapsedMs) {
+    uint8_t b = 0;
+    uint32_t limit = 1UL << WIFI_HIST_SHIFT;
+    while (b < WIFI_HIST_BUCKETS - 1 && elapsedMs >= limit) {
+        b++;
+        limit <<= 1;
+    }
+    s.count[mode]++;
+    s.hist[mode][b]++;
+}
+
+#ifdef ARDUINO
+static char s_ssid[33];
+static char s_pass[65];
+static WifiCache s_cache;
+static bool s_cacheFromRtc = false;
+static bool s_connecting = false;
+static WifiConnectMode s_mode = WIFI_MODE_FULL;
+static uint64_t s_startMs = 0;
+static WifiConnectStats s_stats = {};
+
+// Wpis z RTC (świeży, z dzierżawą IP) lub z EEPROM (tylko punkt dostępowy)
+static bool loadCache() {
+    rtcRead(RTC_BLOCK_WIFI, &s_cache, sizeof(s_cache));
+    s_cacheFromRtc = wifiCacheValid(s_cache, s_ssid);
+    if (s_cacheFromRtc) return true;
+    return loadWifiCache(s_cache) && wifiCacheValid(s_cache, s_ssid);
+}
+
+static void beginFull() {
+    WiFi.config(0U, 0U, 0U);  // DHCP
+    WiFi.begin(s_ssid, s_pass);
+    s_mode = WIFI_MODE_FULL;
+}
+
+static void beginAttempt() {
+    s_connecting = true;
+    s_startMs = millis64();
+    if (!loadCache()) {
+        beginFull();
+        return;
+    }
+    if (s_cacheFromRtc && s_cache.ip) {
+        WiFi.config(IPAddress(s_cache.ip), IPAddress(s_cache.gateway), IPAddress(s_cache.mask), IPAddress(s_cache.dns));
+    } else {
+        WiFi.config(0U, 0U, 0U);
+    }
+    WiFi.begin(s_ssid, s_pass, s_cache.channel, s_cache.bssid);
+    s_mode = WIFI_MODE_FAST;
+    DEBUG_PRINTF("WiFi: szybkie łączenie, kanał %u%s\n", s_cache.channel, s_cacheFromRtc ? ", IP z RTC" : "");
+}
+
+void wifiBegin(const char* ssid, const char* pass) {
+    strlcpy(s_ssid, ssid, sizeof(s_ssid));
+    strlcpy(s_pass, pass, sizeof(s_pass));
+    beginAttempt();
+}
+
+void wifiReconnect() {
+    if (s_ssid[0]) {
+        beginAttempt();
+    } else {
+        WiFi.begin();  // Poświadczenia zapisane przez SDK / WiFiManager - bez wpisu
+    }
+}
+
+static void storeCache() {
+    WifiCache c;
+    memset(&c, 0, sizeof(c));
+    memcpy(c.bssid, WiFi.BSSID(), sizeof(c.bssid));
+    c.channel = (uint8_t)WiFi.channel();
+    c.ip = (uint32_t)WiFi.localIP();
+    c.gateway = (uint32_t)WiFi.gatewayIP();
+    c.mask = (uint32_t)WiFi.subnetMask();
+    c.dns = (uint32_t)WiFi.dnsIP();
+    wifiCacheSeal(c, s_ssid);
+    rtcWrite(RTC_BLOCK_WIFI, &c, sizeof(c));
+    saveWifiCache(c);  // Zapis do flash tylko przy zmianie
+}
+
+bool wifiConnectTask() {
+    if (!s_connecting) return false;
+    uint64_t elapsed = millis64() - s_startMs;
+    if (WiFi.status() == WL_CONNECTED) {
+        s_connecting = false;
+        wifiStatsRecord(s_stats, s_mode, (uint32_t)elapsed);
+        LOG_I(LM_WIFI_CONNECTED, s_mode, (uint32_t)elapsed);
+        if (s_ssid[0]) storeCache();
+        return false;
+    }
+    if (s_mode == WIFI_MODE_FAST && elapsed >= WIFI_FAST_TIMEOUT_MS) {
+        // Punkt dostępowy zmienił kanał / BSSID lub adres jest zajęty - pełne łączenie
+        s_stats.fallbacks++;
+        WifiCache empty;
+        memset(&empty, 0, sizeof(empty));
+        rtcWrite(RTC_BLOCK_WIFI, &empty, sizeof(empty));
+        saveWifiCache(empty);
+        LOG_W(LM_WIFI_FALLBACK);
+        beginFull();
+        return true;
+    }
+    return false;
+}
+
+static void appendHist(StrBuf& sb, WifiConnectMode mode) {
+    sbAppend(sb, "{\"count\":");
+    sbAppendUInt(sb, s_stats.count[mode]);
+    sbAppend(sb, ",\"hist\":[");
+    for (uint8_t b = 0; b < WIFI_HIST_BUCKETS; ++b) {
+        if (b) sbAppendChar(sb, ',');
+        sbAppendUInt(sb, s_stats.hist[mode][b]);
+    }
+    sbAppend(sb, "]}");
+}
+
+void handleWifiStats() {
+    if (server.arg("reset") == "1") {
+        s_stats = WifiConnectStats();
+        server.send(200, "application/json", "{\"status\":\"ok\"}");
+        return;
+    }
+    static char out[256];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    sbAppend(sb, "{\"hist_first_ms\":");
+    sbAppendUInt(sb, 1UL << WIFI_HIST_SHIFT);
+    sbAppend(sb, ",\"fast\":");
+    appendHist(sb, WIFI_MODE_FAST);
+    sbAppend(sb, ",\"full\":");
+    appendHist(sb, WIFI_MODE_FULL);
+    sbAppend(sb, ",\"fallbacks\":");
+    sbAppendUInt(sb, s_stats.fallbacks);
+    sbAppend(sb, ",\"channel\":");
+    sbAppendUInt(sb, WiFi.status() == WL_CONNECTED ? WiFi.channel() : 0);
+    sbAppendChar(sb, '}');
+    server.send(200, "application/json", out);
+}
+#endif
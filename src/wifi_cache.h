@@ -0,0 +1,58 @@
+#ifndef WIFI_CACHE_H
+#define WIFI_CACHE_H
+
+#include <stdint.h>
+
+// Szybkie łączenie WiFi: ostatni dobry punkt dostępowy (BSSID, kanał) i
+// dzierżawa IP zapamiętane w RTC (reset programowy) oraz w EEPROM obok
+// poświadczeń (zanik zasilania). Łączenie z podanym BSSID i kanałem pomija
+// skanowanie, a adres z RTC - wymianę DHCP. Dzierżawa z EEPROM mogła już
+// wygasnąć, więc z niej brany jest tylko punkt dostępowy. Gdy szybkie
+// łączenie nie powiedzie się w WIFI_FAST_TIMEOUT_MS, wpis jest unieważniany
+// i następuje pełne skanowanie z DHCP.
+
+const uint32_t WIFI_FAST_TIMEOUT_MS = 4000;
+const uint8_t WIFI_HIST_BUCKETS = 8;        // Czas połączenia: < 256 ms ... >= 16 s
+const uint8_t WIFI_HIST_SHIFT = 8;
+
+struct WifiCache {
+    uint32_t ssidHash;      // Inna sieć w poświadczeniach unieważnia wpis
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint8_t reserved;
+    uint32_t ip;            // Adresy w kolejności bajtów jak IPAddress (uint32_t)
+    uint32_t gateway;
+    uint32_t mask;
+    uint32_t dns;
+    uint32_t checksum;
+};
+
+enum WifiConnectMode : uint8_t {
+    WIFI_MODE_FAST,         // BSSID + kanał z pamięci (bez skanowania)
+    WIFI_MODE_FULL,         // Skanowanie i DHCP
+    WIFI_MODE_COUNT
+};
+
+struct WifiConnectStats {
+    uint32_t count[WIFI_MODE_COUNT];
+    uint32_t hist[WIFI_MODE_COUNT][WIFI_HIST_BUCKETS];
+    uint32_t fallbacks;     // Szybkie łączenie nieudane - pełne skanowanie
+};
+
+uint32_t wifiSsidHash(const char* ssid);
+void wifiCacheSeal(WifiCache& c, const char* ssid);
+bool wifiCacheValid(const WifiCache& c, const char* ssid);
+void wifiStatsRecord(WifiConnectStats& s, WifiConnectMode mode, uint32_t elapsedMs);
+
+#ifdef ARDUINO
+// Łączenie z podaną siecią (zapamiętuje poświadczenia do ponownych prób)
+void wifiBegin(const char* ssid, const char* pass);
+// Ponowna próba z zapamiętanymi poświadczeniami (lub konfiguracją SDK)
+void wifiReconnect();
+// Z pętli głównej: pomiar czasu, zapis wpisu po połączeniu, powrót do pełnego
+// skanowania; true gdy rozpoczęto nową próbę
+bool wifiConnectTask();
+void handleWifiStats();     // GET /wifi[?reset=1]
+#endif
+
+#endif // WIFI_CACHE_H
@@ -0,0 +1,29 @@
+#include "wifi_scan.h"
+
+void wifiScanJson(StrBuf& sb, int count, ScanEntryFn entry) {
+    sbAppendChar(sb, '[');
+    bool first = true;
+    for (int i = 0; i < count; ++i) {
+        PlatformScanEntry it;
+        if (!entry(i, it)) continue;
+        size_t mark = sb.len;
+        // Separator zależy od tego, czy coś już wypisano - wpis 0 mógł zostać pominięty
+        if (!first) sbAppendChar(sb, ',');
+        sbAppend(sb, "{\"ssid\":");
+        sbAppendJsonString(sb, it.ssid, it.ssidLen);
+        sbAppend(sb, ",\"rssi\":");
+        sbAppendInt(sb, it.rssi);
+        sbAppend(sb, ",\"secure\":");
+        sbAppendChar(sb, it.secure ? '1' : '0');
+        sbAppendChar(sb, '}');
+        // Lista nie mieści się w buforze - utnij na ostatnim pełnym wpisie
+        if (sb.overflow || sb.len + 2 > sb.cap - 1) {
+            sb.len = mark;
+            sb.buf[sb.len] = 0;
+            break;
+        }
+        first = false;
+    }
+    sb.overflow = false;
+    sbAppendChar(sb, ']');
+}
@@ -0,0 +1,22 @@
+#ifndef WIFI_SCAN_H
+#define WIFI_SCAN_H
+
+#include <stddef.h>
+#include "strbuf.h"
+
+// Wpis wyniku skanowania sieci (po WiFi.scanNetworks()) - wypełnia go
+// platformScanEntry() z platform.h, testy natywne podają własne dane
+struct PlatformScanEntry {
+    const char* ssid;
+    size_t ssidLen;
+    int rssi;
+    bool secure;
+};
+
+typedef bool (*ScanEntryFn)(int index, PlatformScanEntry& entry);
+
+// Odpowiedź GET /scan_wifi: [{"ssid":"Dom","rssi":-48,"secure":1},...]
+// Lista, która nie mieści się w buforze, jest ucinana na ostatnim pełnym wpisie
+void wifiScanJson(StrBuf& sb, int count, ScanEntryFn entry);
+
+#endif // WIFI_SCAN_H
@@ -0,0 +1,56 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include <string.h>
+#include "boot_timeline.h"
+#include "rtc_store.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+void test_marks_recorded_once_in_order(void) {
+    BootTimeline t;
+    bootTimelineBegin(t, 7, 4);
+    TEST_ASSERT_TRUE(bootTimelineMark(t, BOOT_PINS, 60000));
+    TEST_ASSERT_TRUE(bootTimelineMark(t, BOOT_CONFIG, 75000));
+    TEST_ASSERT_FALSE(bootTimelineMark(t, BOOT_PINS, 90000));
+    TEST_ASSERT_EQUAL_UINT32(60000, bootTimelineAt(t, BOOT_PINS));
+    TEST_ASSERT_EQUAL_UINT32(0, bootTimelineAt(t, BOOT_PUMP_ARMED));
+    TEST_ASSERT_EQUAL(2, t.count);
+    TEST_ASSERT_TRUE(bootTimelineValid(t));
+}
+
+void test_all_stages_fit(void) {
+    BootTimeline t;
+    bootTimelineBegin(t, 1, 0);
+    for (int s = 0; s < BOOT_STAGE_COUNT; ++s) TEST_ASSERT_TRUE(bootTimelineMark(t, (BootStage)s, 1000u * (s + 1)));
+    TEST_ASSERT_FALSE(bootTimelineMark(t, BOOT_STAGE_COUNT, 1));
+    TEST_ASSERT_TRUE(bootTimelineValid(t));
+    TEST_ASSERT_TRUE(RTC_BLOCK_BOOT_TIMELINE + RTC_BLOCKS(BootTimeline) <= RTC_BLOCK_FREE);
+}
+
+// Pamięć RTC po zaniku zasilania zawiera przypadkowe dane
+void test_garbage_rejected(void) {
+    BootTimeline t;
+    memset(&t, 0xA5, sizeof(t));
+    TEST_ASSERT_FALSE(bootTimelineValid(t));
+    bootTimelineBegin(t, 3, 0);
+    bootTimelineMark(t, BOOT_PINS, 1234);
+    t.marks[0].atUs ^= 1;  // uszkodzony bit
+    TEST_ASSERT_FALSE(bootTimelineValid(t));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_marks_recorded_once_in_order);
+    RUN_TEST(test_all_stages_fit);
+    RUN_TEST(test_garbage_rejected);
+    UNITY_END();
+    return 0;
+}
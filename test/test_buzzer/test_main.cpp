@@ -0,0 +1,71 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include "buzzer.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+static const BuzzerStep BEEP[] = { {2000, 200}, {0, 0} };
+static const BuzzerStep TWO_TONES[] = { {1000, 100}, {0, 50}, {1500, 100}, {0, 0} };
+static const BuzzerStep ALARM[] = { {2800, 120}, {0, 80}, {2800, 120}, {0, 0} };
+
+// Symulacja pętli co 1 ms; zwraca częstotliwość po zadanym czasie
+static uint16_t runUntil(BuzzerSeq& s, uint64_t& now, uint64_t until) {
+    for (; now <= until; ++now) buzzerTick(s, now);
+    return s.outputFreq;
+}
+
+void test_pattern_timing(void) {
+    BuzzerSeq s = {};
+    uint64_t now = 1000;
+    TEST_ASSERT_TRUE(buzzerStart(s, TWO_TONES, BUZZ_PRIO_INFO));
+    BuzzerOutput o = buzzerTick(s, now);
+    TEST_ASSERT_TRUE(o.change);
+    TEST_ASSERT_EQUAL(1000, o.freq);
+    TEST_ASSERT_EQUAL(1000, runUntil(s, now, 1099));
+    TEST_ASSERT_EQUAL(0, runUntil(s, now, 1149));     // pauza
+    TEST_ASSERT_EQUAL(1500, runUntil(s, now, 1249));
+    TEST_ASSERT_TRUE(s.active);
+    TEST_ASSERT_EQUAL(0, runUntil(s, now, 1250));     // koniec wzorca - cisza
+    TEST_ASSERT_FALSE(s.active);
+}
+
+void test_output_changes_only_on_step_boundaries(void) {
+    BuzzerSeq s = {};
+    buzzerStart(s, BEEP, BUZZ_PRIO_INFO);
+    int changes = 0;
+    for (uint64_t t = 0; t < 1000; ++t) if (buzzerTick(s, t).change) changes++;
+    TEST_ASSERT_EQUAL(2, changes);  // włączenie i wyłączenie
+}
+
+void test_alarm_preempts_confirmation(void) {
+    BuzzerSeq s = {};
+    uint64_t now = 0;
+    buzzerStart(s, BEEP, BUZZ_PRIO_INFO);
+    runUntil(s, now, 50);
+    TEST_ASSERT_TRUE(buzzerStart(s, ALARM, BUZZ_PRIO_ALARM));
+    TEST_ASSERT_EQUAL(2800, runUntil(s, now, 51));
+    // Potwierdzenie nie przerywa alarmu
+    TEST_ASSERT_FALSE(buzzerStart(s, BEEP, BUZZ_PRIO_INFO));
+    TEST_ASSERT_EQUAL(0, runUntil(s, now, 51 + 120 + 10));
+    TEST_ASSERT_EQUAL(2800, runUntil(s, now, 51 + 200 + 10));
+    // Po zakończeniu alarmu dowolny dźwięk może grać
+    runUntil(s, now, 1000);
+    TEST_ASSERT_TRUE(buzzerStart(s, BEEP, BUZZ_PRIO_INFO));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_pattern_timing);
+    RUN_TEST(test_output_changes_only_on_step_boundaries);
+    RUN_TEST(test_alarm_preempts_confirmation);
+    UNITY_END();
+    return 0;
+}
@@ -34,10 +34,28 @@ void test_checksum_values(void) {
     TEST_ASSERT_EQUAL_INT8(expected, cs);
 }
 
+// Zapis starszej wersji (krótszy prefiks) - nowe pola dostają wartości domyślne
+void test_legacy_prefix_keeps_new_defaults(void) {
+    Config old;
+    memset(&old, 0, sizeof(Config));
+    old.tank_full = 80;
+    old.pump_work_time = 45;
+    old.flow_check_window = 999;  // poza prefiksem - nie może zostać wczytane
+
+    Config c;
+    applyConfigPrefix(c, (const uint8_t*)&old, offsetof(Config, flow_check_window));
+    TEST_ASSERT_EQUAL_INT(80, c.tank_full);
+    TEST_ASSERT_EQUAL_INT(45, c.pump_work_time);
+    TEST_ASSERT_EQUAL_INT(15, c.flow_check_window);
+    TEST_ASSERT_EQUAL_INT(2, c.flow_min_drawdown);
+    TEST_ASSERT_EQUAL_INT8(calculateChecksum(c), c.checksum);
+}
+
 int main(int argc, char **argv) {
     UNITY_BEGIN();
     RUN_TEST(test_checksum_zero);
     RUN_TEST(test_checksum_values);
+    RUN_TEST(test_legacy_prefix_keeps_new_defaults);
     UNITY_END();
     return 0;
 }
@@ -0,0 +1,141 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include <string.h>
+#include "config_schema.h"
+#include "json_flat.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+static Config base;
+static ConfigUpdate u;
+
+static bool applyJson(const char* json) {
+    fillDefaultConfig(base);
+    configUpdateBegin(u, base);
+    configUpdateJson(u, json, strlen(json));
+    return configUpdateFinish(u, base);
+}
+
+static bool changed(const char* key) {
+    return (u.changed & (1UL << configFieldIndex(key, strlen(key)))) != 0;
+}
+
+void test_defaults_come_from_table(void) {
+    Config c;
+    fillDefaultConfig(c);
+    TEST_ASSERT_TRUE(c.soundEnabled);
+    TEST_ASSERT_EQUAL_INT(1883, c.mqtt_port);
+    TEST_ASSERT_EQUAL_INT(1050, c.tank_empty);
+    TEST_ASSERT_EQUAL_INT(30, c.pump_work_time);
+    TEST_ASSERT_EQUAL_STRING("", c.mqtt_server);
+    // Każda wartość domyślna musi przejść własną walidację
+    configUpdateBegin(u, c);
+    TEST_ASSERT_TRUE(configUpdateFinish(u, c));
+    TEST_ASSERT_EQUAL_UINT32(0, u.changed);
+}
+
+void test_only_changed_fields_applied(void) {
+    TEST_ASSERT_TRUE(applyJson("{\"version\":1,\"tank_full\":80,\"pump_delay\":5,\"mqtt_server\":\"10.0.0.2\"}"));
+    TEST_ASSERT_EQUAL_INT(80, u.staged.tank_full);
+    TEST_ASSERT_EQUAL_STRING("10.0.0.2", u.staged.mqtt_server);
+    TEST_ASSERT_TRUE(changed("tank_full"));
+    TEST_ASSERT_TRUE(changed("mqtt_server"));
+    TEST_ASSERT_FALSE(changed("pump_delay"));  // Ta sama wartość co domyślna
+    TEST_ASSERT_TRUE(u.needMqttReconnect);
+
+    TEST_ASSERT_TRUE(applyJson("{\"sound_enabled\":false}"));
+    TEST_ASSERT_FALSE(u.staged.soundEnabled);
+    TEST_ASSERT_FALSE(u.needMqttReconnect);
+}
+
+void test_per_field_errors_reject_whole_document(void) {
+    TEST_ASSERT_FALSE(applyJson("{\"mqtt_port\":70000,\"pump_delay\":\"5\",\"tank_diameter\":120,"
+                                "\"mqtt_user\":\"0123456789012345678901234567890123\"}"));
+    TEST_ASSERT_EQUAL_UINT8(3, u.issueCount);
+    TEST_ASSERT_EQUAL_UINT32(0, u.changed);
+
+    static char out[192];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    configUpdateReport(sb, u);
+    TEST_ASSERT_EQUAL_STRING("{\"status\":\"error\",\"errors\":{\"mqtt_port\":\"range\",\"pump_delay\":\"type\","
+                             "\"mqtt_user\":\"too_long\"}}", out);
+
+    TEST_ASSERT_FALSE(applyJson("{\"tank_full\":1200}"));
+    TEST_ASSERT_EQUAL(CFE_CONFLICT, u.issues[0].error);
+    TEST_ASSERT_FALSE(applyJson("{\"version\":2}"));
+    TEST_ASSERT_EQUAL(CFE_VERSION, u.issues[0].error);
+    TEST_ASSERT_FALSE(applyJson("{\"tank_full\":80,}"));
+    TEST_ASSERT_EQUAL(CFE_SYNTAX, u.issues[0].error);
+    TEST_ASSERT_FALSE(applyJson("{\"tank_full\":80.5}"));
+    TEST_ASSERT_EQUAL(CFE_TYPE, u.issues[0].error);
+}
+
+void test_unknown_keys_ignored(void) {
+    TEST_ASSERT_TRUE(applyJson("{\"future_option\":{\"a\":[1,2]},\"pump_delay\":7}"));
+    TEST_ASSERT_EQUAL_UINT8(1, u.ignoredCount);
+    TEST_ASSERT_EQUAL_STRING("future_option", u.ignoredKey);
+    TEST_ASSERT_EQUAL_INT(7, u.staged.pump_delay);
+}
+
+void test_form_text_and_secret(void) {
+    fillDefaultConfig(base);
+    strncpy(base.mqtt_password, "secret", sizeof(base.mqtt_password));
+    configUpdateBegin(u, base);
+    configUpdateText(u, configFieldIndex("mqtt_password", 13), "");   // puste = bez zmian
+    configUpdateText(u, configFieldIndex("pump_work_time", 14), "0");
+    configUpdateText(u, configFieldIndex("tank_full", 9), "abc");
+    TEST_ASSERT_FALSE(configUpdateFinish(u, base));
+    TEST_ASSERT_EQUAL_UINT8(2, u.issueCount);
+    TEST_ASSERT_EQUAL_STRING("secret", u.staged.mqtt_password);
+}
+
+void test_export_roundtrip(void) {
+    Config c;
+    fillDefaultConfig(c);
+    c.tank_full = 120;
+    strncpy(c.mqtt_user, "ha \"user\"", sizeof(c.mqtt_user));
+    strncpy(c.mqtt_password, "secret", sizeof(c.mqtt_password));
+
+    static char out[512];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    configExportJson(sb, c);
+    TEST_ASSERT_FALSE(sb.overflow);
+    TEST_ASSERT_NULL(strstr(out, "secret"));
+
+    TEST_ASSERT_TRUE(applyJson(out));
+    TEST_ASSERT_EQUAL_INT(120, u.staged.tank_full);
+    TEST_ASSERT_EQUAL_STRING("ha \"user\"", u.staged.mqtt_user);
+    TEST_ASSERT_EQUAL_UINT8(0, u.ignoredCount);
+}
+
+void test_unescape(void) {
+    char out[8];
+    TEST_ASSERT_EQUAL_INT(3, jsonUnescape("a\\n\\\"", 5, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("a\n\"", out);
+    TEST_ASSERT_EQUAL_INT(2, jsonUnescape("\\u00f3", 6, out, sizeof(out)));  // ó
+    TEST_ASSERT_EQUAL_INT(-1, jsonUnescape("\\u0000", 6, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_INT(-1, jsonUnescape("12345678", 8, out, sizeof(out)));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_defaults_come_from_table);
+    RUN_TEST(test_only_changed_fields_applied);
+    RUN_TEST(test_per_field_errors_reject_whole_document);
+    RUN_TEST(test_unknown_keys_ignored);
+    RUN_TEST(test_form_text_and_secret);
+    RUN_TEST(test_export_roundtrip);
+    RUN_TEST(test_unescape);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,115 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include "filters.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+static const float ALPHA = 0.2f;
+
+static float feed(RobustFilter& f, int value, int times) {
+    float out = 0;
+    for (int i = 0; i < times; ++i) out = robustUpdate(f, value + ((i % 3) - 1), ALPHA);
+    return out;
+}
+
+void test_reduce_samples(void) {
+    int s1[] = {500, -1, 504};
+    TEST_ASSERT_EQUAL_INT(502, reduceSamples(s1, 3, 1));
+    int s2[] = {500, 900, 502, 498, 100};
+    TEST_ASSERT_EQUAL_INT(500, reduceSamples(s2, 5, 1));
+    int s3[] = {-1, -1, -1};
+    TEST_ASSERT_EQUAL_INT(-1, reduceSamples(s3, 3, 1));
+}
+
+void test_isolated_spike_rejected(void) {
+    RobustFilter f;
+    robustInit(f);
+    feed(f, 500, 10);
+    float before = f.value;
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, before, robustUpdate(f, 850, ALPHA));
+    float after = feed(f, 500, 3);
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, 500.0f, after);
+    TEST_ASSERT_EQUAL_UINT32(1, f.rejected);
+    TEST_ASSERT_EQUAL_UINT32(0, f.steps);
+}
+
+void test_alternating_spikes_never_accepted(void) {
+    RobustFilter f;
+    robustInit(f);
+    feed(f, 500, 10);
+    for (int i = 0; i < 50; ++i) {
+        // dwa różne skoki pod rząd nie są zgodne ze sobą - nie potwierdzają zmiany
+        robustUpdate(f, (i % 2) ? 800 : 200, ALPHA);
+        robustUpdate(f, 500, ALPHA);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, 500.0f, f.value);
+    TEST_ASSERT_EQUAL_UINT32(0, f.steps);
+}
+
+void test_sustained_step_accepted_within_bound(void) {
+    RobustFilter f;
+    robustInit(f);
+    feed(f, 300, 10);
+    int cycles = 0;
+    while (cycles < 10 && f.value < 650.0f) {
+        robustUpdate(f, 700, ALPHA);
+        cycles++;
+    }
+    TEST_ASSERT_EQUAL_INT(ROBUST_CONFIRM, cycles);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 700.0f, f.value);
+    TEST_ASSERT_EQUAL_UINT32(1, f.steps);
+}
+
+void test_slow_ramp_tracked(void) {
+    RobustFilter f;
+    robustInit(f);
+    float out = 0;
+    for (int i = 0; i < 100; ++i) out = robustUpdate(f, 300 + 6 * i, ALPHA);
+    // EMA ma opóźnienie nachylenie * (1 - alpha) / alpha = 24 mm
+    TEST_ASSERT_FLOAT_WITHIN(30.0f, 300.0f + 6 * 99, out);
+    TEST_ASSERT_EQUAL_UINT32(0, f.rejected);
+}
+
+void test_dropout_keeps_value(void) {
+    RobustFilter f;
+    robustInit(f);
+    feed(f, 400, 5);
+    float v = f.value;
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, v, robustUpdate(f, -1, ALPHA));
+}
+
+// Powtórzony odczyt zastępuje najstarszy - okno dalej usuwa w kolejności napływania
+void test_equal_samples_keep_fifo_order(void) {
+    RobustFilter f;
+    robustInit(f);
+    const int first[] = {500, 501, 502, 503, 504, 500, 500};
+    for (int i = 0; i < 7; ++i) robustUpdate(f, first[i], ALPHA);
+    // Okno: 502 503 504 500 500; kolejne trzy odczyty usuwają 502, 503, 504
+    robustUpdate(f, 510, ALPHA);
+    robustUpdate(f, 511, ALPHA);
+    robustUpdate(f, 512, ALPHA);
+    const int expected[] = {500, 500, 510, 511, 512};
+    for (int i = 0; i < HAMPEL_WINDOW; ++i) TEST_ASSERT_EQUAL_INT(expected[i], f.sorted[i]);
+    TEST_ASSERT_EQUAL_INT(510, f.median);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_reduce_samples);
+    RUN_TEST(test_isolated_spike_rejected);
+    RUN_TEST(test_alternating_spikes_never_accepted);
+    RUN_TEST(test_sustained_step_accepted_within_bound);
+    RUN_TEST(test_slow_ramp_tracked);
+    RUN_TEST(test_dropout_keeps_value);
+    RUN_TEST(test_equal_samples_keep_fifo_order);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,65 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include "float_switch.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+static void edge(FloatDebounce& d, uint32_t ms, uint8_t level) {
+    FloatEdge e = { ms, level };
+    floatEdge(d, e);
+}
+
+// Seria drgań daje jedną zmianę - FLOAT_DEBOUNCE_MS po ostatnim zboczu
+void test_bounce_burst_settles_once(void) {
+    FloatDebounce d;
+    floatInit(d, 1, 0);
+    for (uint32_t t = 1000; t < 1040; t += 4) edge(d, t, (t / 4) & 1);
+    edge(d, 1040, 0);
+    TEST_ASSERT_FALSE(floatSettle(d, 1040 + FLOAT_DEBOUNCE_MS - 1));
+    TEST_ASSERT_EQUAL_UINT8(1, d.stable);
+    TEST_ASSERT_TRUE(floatSettle(d, 1040 + FLOAT_DEBOUNCE_MS));
+    TEST_ASSERT_EQUAL_UINT8(0, d.stable);
+    TEST_ASSERT_FALSE(floatSettle(d, 5000));
+    TEST_ASSERT_EQUAL_UINT32(11, d.edges);
+}
+
+// Krótki impuls wracający do poprzedniego poziomu nic nie zmienia
+void test_glitch_rejected(void) {
+    FloatDebounce d;
+    floatInit(d, 1, 0);
+    edge(d, 500, 0);
+    edge(d, 530, 1);
+    TEST_ASSERT_FALSE(floatSettle(d, 2000));
+    TEST_ASSERT_EQUAL_UINT8(1, d.stable);
+}
+
+// Zbocze nowsze niż czas pętli (przerwanie po odczycie millis) i przepełnienie licznika
+void test_edge_time_order_and_wrap(void) {
+    FloatDebounce d;
+    floatInit(d, 1, 0);
+    edge(d, 1010, 0);
+    TEST_ASSERT_FALSE(floatSettle(d, 1000));
+    TEST_ASSERT_EQUAL_UINT8(1, d.stable);
+
+    floatInit(d, 1, 0xFFFFFFF0UL);
+    edge(d, 0xFFFFFFF0UL, 0);
+    TEST_ASSERT_FALSE(floatSettle(d, 0x10));
+    TEST_ASSERT_TRUE(floatSettle(d, FLOAT_DEBOUNCE_MS));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_bounce_burst_settles_once);
+    RUN_TEST(test_glitch_rejected);
+    RUN_TEST(test_edge_time_order_and_wrap);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,179 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include <string.h>
+#include "ha_discovery.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+// Te same encje i nazwy co w ha.cpp - pula musi pomieścić komplet z zapasem
+static HsSensor s0("water_level"), s1("water_level_percent"), s2("water_volume"),
+    s3("pump_work_time"), s4("pump"), s5("water"), s6("pump_flow"), s7("pump_flow_trend"),
+    s8("pump_no_flow"), s9("water_alarm"), s10("water_reserve"), s11("heap_free_min"),
+    s12("heap_block_min"), s13("heap_frag_max"), s14("boot_armed_ms"), s15("signal_quality"),
+    s16("sensor_stale"), s17("reset_cause"), s18("loop_stalls"), s19("leak_rate"), s20("leak");
+static HsSensor* const sensors[] = { &s0, &s1, &s2, &s3, &s4, &s5, &s6, &s7, &s8, &s9, &s10, &s11, &s12, &s13, &s14,
+    &s15, &s16, &s17, &s18, &s19, &s20 };
+static const char* NAMES[] = {
+    "Pomiar odległości", "Poziom wody", "Objętość wody", "Czas pracy pompy", "Status pompy",
+    "Czujnik wody", "Wydajność pompy", "Trend wydajności pompy", "Pompa nie tłoczy wody",
+    "Brak wody", "Rezerwa wody", "Min. wolna pamięć", "Min. największy blok pamięci",
+    "Maks. fragmentacja pamięci", "Start: pompa gotowa po", "Jakość sygnału czujnika",
+    "Brak aktualnego pomiaru", "Przyczyna resetu", "Zawieszenia pętli", "Ubytek wody w postoju",
+    "Wyciek wody",
+};
+static const int COUNT = sizeof(sensors) / sizeof(sensors[0]);
+static const HaDeviceInfo DEV = { "a4cf12b3c4d5", "HydroSense", "HS ESP8266", "PMW", "26.11.24" };
+
+static void configureAll() {
+    for (int i = 0; i < COUNT; ++i) {
+        sensors[i]->setName(NAMES[i]);
+        sensors[i]->setIcon("mdi:water-pump-off-outline");
+        sensors[i]->setUnitOfMeasurement("L/min");
+    }
+}
+
+void test_pool_fits_all_entities(void) {
+    configureAll();
+    TEST_ASSERT_TRUE(haDiscoveryBuild(DEV));
+    // Zapas na kolejne encje
+    TEST_ASSERT_LESS_THAN(HA_DISCOVERY_POOL * 3 / 4, haDiscoveryPoolUsed());
+}
+
+void test_payload_and_topics(void) {
+    char buf[256];
+    StrBuf sb;
+    sbInit(sb, buf, sizeof(buf));
+    HsSensor& s = s0;
+    s.setName("Poziom \"testowy\"");
+    s.setIcon(nullptr);
+    s.setUnitOfMeasurement("mm");
+    haBuildSensorConfig(sb, s, DEV, false);
+    TEST_ASSERT_EQUAL_STRING("{\"name\":\"Poziom \\\"testowy\\\"\",\"uniq_id\":\"a4cf12b3c4d5_water_level\",\"unit_of_meas\":\"mm\","
+                             "\"stat_t\":\"aha/a4cf12b3c4d5/water_level/stat_t\",\"dev\":{\"ids\":\"a4cf12b3c4d5\"}}", buf);
+
+    sbInit(sb, buf, sizeof(buf));
+    haBuildConfigTopic(sb, DEV, s.objectId());
+    TEST_ASSERT_EQUAL_STRING("homeassistant/sensor/a4cf12b3c4d5/water_level/config", buf);
+
+    // Konfiguracje spod stałego identyfikatora czyszczone po aktualizacji
+    sbInit(sb, buf, sizeof(buf));
+    haBuildDiscoveryTopic(sb, "switch", HA_LEGACY_DEVICE_ID, "pump_alarm");
+    TEST_ASSERT_EQUAL_STRING("homeassistant/switch/HydroSense/pump_alarm/config", buf);
+}
+
+// Dwa urządzenia floty - różne uniq_id tej samej encji
+void test_unique_id_per_device(void) {
+    static const HaDeviceInfo other = { "a4cf12b3c4d6", "HydroSense", "HS ESP8266", "PMW", "26.11.24" };
+    char a[256], b[256];
+    StrBuf sa, sbb;
+    sbInit(sa, a, sizeof(a));
+    sbInit(sbb, b, sizeof(b));
+    haBuildSensorConfig(sa, s1, DEV, false);
+    haBuildSensorConfig(sbb, s1, other, false);
+    TEST_ASSERT_TRUE(strstr(a, "\"uniq_id\":\"a4cf12b3c4d5_water_level_percent\"") != nullptr);
+    TEST_ASSERT_TRUE(strstr(b, "\"uniq_id\":\"a4cf12b3c4d6_water_level_percent\"") != nullptr);
+}
+
+void test_hash_tracks_configuration(void) {
+    configureAll();
+    haDiscoveryBuild(DEV);
+    char first[9];
+    strcpy(first, haDiscoveryHash());
+    TEST_ASSERT_EQUAL(8, (int)strlen(first));
+
+    haDiscoveryBuild(DEV);
+    TEST_ASSERT_EQUAL_STRING(first, haDiscoveryHash());
+
+    sensors[2]->setName("Objętość");
+    haDiscoveryBuild(DEV);
+    TEST_ASSERT_TRUE(strcmp(first, haDiscoveryHash()) != 0);
+}
+
+void test_set_value_queues_only_changes(void) {
+    HsSensor& s = s13;
+    TEST_ASSERT_FALSE(s._dirty);
+    s.setValue("12");
+    TEST_ASSERT_TRUE(s._dirty);
+    s._dirty = false;  // opublikowane
+    s.setValue("12");
+    TEST_ASSERT_FALSE(s._dirty);
+    s.setValue("13");
+    TEST_ASSERT_TRUE(s._dirty);
+    TEST_ASSERT_EQUAL_STRING("13", s.value());
+}
+
+// Tryb JSON: wspólny temat, pole wybierane przez value_template, liczby bez cudzysłowów
+void test_json_state_mode(void) {
+    char buf[256];
+    StrBuf sb;
+    s0.setName("Poziom");
+    s0.setIcon(nullptr);
+    s0.setUnitOfMeasurement(nullptr);
+    haSetJsonState(true);
+    sbInit(sb, buf, sizeof(buf));
+    haBuildSensorConfig(sb, s0, DEV, false);
+    TEST_ASSERT_EQUAL_STRING("{\"name\":\"Poziom\",\"uniq_id\":\"a4cf12b3c4d5_water_level\",\"stat_t\":\"aha/a4cf12b3c4d5/state\","
+                             "\"val_tpl\":\"{{value_json.water_level}}\",\"dev\":{\"ids\":\"a4cf12b3c4d5\"}}", buf);
+
+    s0.setValue("612");
+    s9.setValue("OFF");
+    s15.setValue("-0.5");
+    s16.setValue("007");
+    static char doc[HA_STATE_DOC_MAX];
+    sbInit(sb, doc, sizeof(doc));
+    haBuildStateDocument(sb);
+    TEST_ASSERT_FALSE(sb.overflow);
+    TEST_ASSERT_TRUE(strstr(doc, "\"water_level\":612") != nullptr);
+    TEST_ASSERT_TRUE(strstr(doc, "\"water_alarm\":\"OFF\"") != nullptr);
+    TEST_ASSERT_TRUE(strstr(doc, "\"signal_quality\":-0.5") != nullptr);
+    TEST_ASSERT_TRUE(strstr(doc, "\"sensor_stale\":\"007\"") != nullptr);
+    TEST_ASSERT_TRUE(strstr(doc, "water_volume") == nullptr);  // bez wartości - pominięty
+
+    // Wszystkie encje z wartościami o maksymalnej długości (HA_VALUE_MAX - 1,
+    // jako napis w cudzysłowie) mieszczą się w dokumencie
+    char longest[HA_VALUE_MAX];
+    memset(longest, 'x', sizeof(longest) - 1);
+    longest[sizeof(longest) - 1] = '\0';
+    for (int i = 0; i < COUNT; ++i) sensors[i]->setValue(longest);
+    sbInit(sb, doc, sizeof(doc));
+    haBuildStateDocument(sb);
+    TEST_ASSERT_FALSE(sb.overflow);
+    TEST_ASSERT_EQUAL_INT((int)HA_VALUE_MAX - 1, (int)strlen(s20.value()));
+
+    configureAll();
+    TEST_ASSERT_TRUE(haDiscoveryBuild(DEV));
+    TEST_ASSERT_LESS_THAN(HA_DISCOVERY_POOL * 3 / 4, haDiscoveryPoolUsed());
+    haSetJsonState(false);
+}
+
+void test_publish_packet_size(void) {
+    // Nagłówek stały (1) + długość pozostała (1-2) + długość tematu (2)
+    TEST_ASSERT_EQUAL_INT(1 + 1 + 2 + 10 + 3, (int)haPublishPacketSize(10, 3));
+    TEST_ASSERT_EQUAL_INT(1 + 2 + 2 + 20 + 300, (int)haPublishPacketSize(20, 300));
+    HaPublishStats st = {};
+    haPublishCount(st, 10, 3);
+    haPublishCount(st, 20, 300);
+    TEST_ASSERT_EQUAL_UINT32(2, st.packets);
+    TEST_ASSERT_EQUAL_UINT32(17 + 325, st.bytes);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_pool_fits_all_entities);
+    RUN_TEST(test_payload_and_topics);
+    RUN_TEST(test_unique_id_per_device);
+    RUN_TEST(test_hash_tracks_configuration);
+    RUN_TEST(test_set_value_queues_only_changes);
+    RUN_TEST(test_json_state_mode);
+    RUN_TEST(test_publish_packet_size);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,77 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include <string.h>
+#include <stdio.h>
+#include "http_stream.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+static const char TPL[] = "<p style='width:100%'>%NAME% v%VER%, %MISSING%, %PORT%</p>%%";
+
+static TplValue resolve(const char* name, size_t len, char* scratch, size_t cap) {
+    (void)len;
+    if (!strcmp(name, "NAME")) return TplValue{"<\"A&B\">", false, true};
+    if (!strcmp(name, "VER")) return TplValue{"1.2", false, false};
+    if (!strcmp(name, "PORT")) { snprintf(scratch, cap, "%d", 1883); return TplValue{scratch, false, false}; }
+    return TplValue{NULL, false, false};
+}
+
+static const char* EXPECTED =
+    "<p style='width:100%'>&lt;&quot;A&amp;B&quot;&gt; v1.2, %MISSING%, 1883</p>%%";
+
+static void readAll(size_t cap, char* out, size_t outCap) {
+    TplStream s;
+    tplBegin(s, TPL, resolve);
+    size_t total = 0;
+    char buf[64];
+    size_t n;
+    while ((n = tplRead(s, buf, cap)) > 0) {
+        TEST_ASSERT_TRUE(n <= cap);
+        TEST_ASSERT_TRUE(total + n < outCap);
+        memcpy(out + total, buf, n);
+        total += n;
+    }
+    out[total] = '\0';
+}
+
+// Wynik nie zależy od podziału na porcje (encje i znaczniki na granicach)
+void test_template_any_chunk_size(void) {
+    char out[256];
+    for (size_t cap = TPL_MIN_READ; cap <= 64; ++cap) {
+        readAll(cap, out, sizeof(out));
+        TEST_ASSERT_EQUAL_STRING(EXPECTED, out);
+    }
+}
+
+void test_chunk_frame(void) {
+    char buf[HTTP_CHUNK_HEAD + HTTP_CHUNK_DATA + 2];
+    memcpy(buf + HTTP_CHUNK_HEAD, "hello", 5);
+    size_t len = 0;
+    size_t start = httpChunkFrame(buf, 5, &len);
+    TEST_ASSERT_EQUAL_INT(10, len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf + start, "5\r\nhello\r\n", len));
+
+    start = httpChunkFrame(buf, HTTP_CHUNK_DATA, &len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf + start, "100\r\n", 5));
+    TEST_ASSERT_EQUAL_INT(5 + HTTP_CHUNK_DATA + 2, len);
+
+    start = httpChunkFrame(buf, 0, &len);
+    TEST_ASSERT_EQUAL_INT(5, len);
+    TEST_ASSERT_EQUAL_INT(0, memcmp(buf + start, "0\r\n\r\n", len));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_template_any_chunk_size);
+    RUN_TEST(test_chunk_frame);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,107 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include "leak_detect.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+static const uint64_t MINUTE = 60000ULL;
+static const float WINDOW_H = 12.0f;
+static const float LIMIT = 10.0f;   // mm/dobę
+
+static uint32_t rng = 0xBADC0DEu;
+static float noise() {
+    rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5;
+    return (float)(rng % 5) - 2.0f;  // +-2 mm
+}
+
+// Pomiary co minutę; ubytek lossMmDay, co pumpEveryMin minut pompa zabiera pumpDropMm
+static float simulate(LeakDetector& l, uint64_t& now, float& level, int minutes, float lossMmDay,
+                      int pumpEveryMin, float pumpDropMm) {
+    for (int i = 0; i < minutes; ++i, now += MINUTE) {
+        level += lossMmDay / 1440.0f;
+        if (pumpEveryMin > 0 && i % pumpEveryMin == pumpEveryMin - 1) {
+            leakPause(l);
+            level += pumpDropMm;
+            // Filtr doganiający spadek po pracy pompy - pierwsze pomiary zaniżone
+            for (int k = 0; k < 3; ++k) {
+                now += MINUTE;
+                leakResume(l);
+                leakSample(l, now, level - pumpDropMm / (k + 2), WINDOW_H);
+            }
+            continue;
+        }
+        leakSample(l, now, level + noise(), WINDOW_H);
+        leakUpdateAlarm(l, now, LIMIT, WINDOW_H);
+    }
+    return leakRateMmPerDay(l);
+}
+
+void test_stable_level_no_alarm(void) {
+    LeakDetector l;
+    leakReset(l);
+    uint64_t now = 0;
+    float level = 500;
+    float rate = simulate(l, now, level, 48 * 60, 0, 0, 0);
+    TEST_ASSERT_FLOAT_WITHIN(1.5f, 0.0f, rate);
+    TEST_ASSERT_FALSE(l.alarm);
+}
+
+void test_slow_leak_detected(void) {
+    LeakDetector l;
+    leakReset(l);
+    uint64_t now = 0;
+    float level = 500;
+    simulate(l, now, level, 6 * 60, 15, 0, 0);
+    TEST_ASSERT_FALSE(l.alarm);  // Seria krótsza niż okno
+    float rate = simulate(l, now, level, 24 * 60, 15, 0, 0);
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, 15.0f, rate);
+    TEST_ASSERT_TRUE(l.alarm);
+    TEST_ASSERT_FALSE(leakUpdateAlarm(l, now, 0, WINDOW_H));  // Limit 0 wyłącza alarm
+}
+
+// Praca pompy (duży, szybki spadek poziomu) nie jest liczona jako wyciek
+void test_pump_runs_excluded(void) {
+    LeakDetector l;
+    leakReset(l);
+    uint64_t now = 0;
+    float level = 300;
+    // Krótkie odcinki między cyklami pompy - mniej informacji o nachyleniu, większy rozrzut
+    float rate = simulate(l, now, level, 48 * 60, 0, 90, 25);
+    TEST_ASSERT_FLOAT_WITHIN(LIMIT / 2, 0.0f, rate);
+    TEST_ASSERT_FALSE(l.alarm);
+
+    rate = simulate(l, now, level, 48 * 60, 20, 90, 25);
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, 20.0f, rate);
+    TEST_ASSERT_TRUE(l.alarm);
+}
+
+// Dolanie wody (skok poziomu w górę) zaczyna nowy odcinek zamiast zaniżać ubytek
+void test_refill_starts_new_segment(void) {
+    LeakDetector l;
+    leakReset(l);
+    uint64_t now = 0;
+    float level = 800;
+    simulate(l, now, level, 24 * 60, 15, 0, 0);
+    level -= 300;
+    float rate = simulate(l, now, level, 6 * 60, 15, 0, 0);
+    TEST_ASSERT_FLOAT_WITHIN(2.0f, 15.0f, rate);
+    TEST_ASSERT_TRUE(l.alarm);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_stable_level_no_alarm);
+    RUN_TEST(test_slow_leak_detected);
+    RUN_TEST(test_pump_runs_excluded);
+    RUN_TEST(test_refill_starts_new_segment);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,84 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include "log_ring.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+static void push(LogRing& r, uint32_t ms, uint16_t msg, uint32_t a0, uint32_t a1, uint8_t argc) {
+    const uint32_t args[LOG_MAX_ARGS] = { a0, a1 };
+    logPush(r, ms, LOG_LEVEL_INFO, msg, argc, args);
+}
+
+// Po przepełnieniu zostaje LOG_RING_ENTRIES najnowszych wpisów
+void test_ring_keeps_newest(void) {
+    static LogRing r;
+    for (uint32_t i = 0; i < LOG_RING_ENTRIES + 10; ++i) push(r, i, LM_PUMP_STATE, i, 0, 2);
+    TEST_ASSERT_EQUAL_UINT32(10, logOldest(r));
+    LogEntry e;
+    TEST_ASSERT_FALSE(logGet(r, 9, e));
+    TEST_ASSERT_TRUE(logGet(r, 10, e));
+    TEST_ASSERT_EQUAL_UINT32(10, e.args[0]);
+    TEST_ASSERT_TRUE(logGet(r, LOG_RING_ENTRIES + 9, e));
+    TEST_ASSERT_EQUAL_UINT32(LOG_RING_ENTRIES + 9, e.ms);
+    TEST_ASSERT_FALSE(logGet(r, LOG_RING_ENTRIES + 10, e));
+}
+
+void test_format_on_read(void) {
+    static LogRing r;
+    push(r, 65432, LM_PUMP_STATE, 1, 2, 2);
+    push(r, 0, LM_PUMP_FLOW, logArg(3.14159f), 0, 1);
+    push(r, 0, LM_CONFIG_SAVED, 0x1A2B, 0, 1);
+    push(r, 0, LM_WIFI_RETRY, logArg(-3), 5000, 2);
+    char line[LOG_LINE_MAX];
+    LogEntry e;
+
+    logGet(r, 0, e);
+    logFormatLine(e, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("65.432 I Pompa: 1 -> 2", line);
+    logGet(r, 1, e);
+    logFormatMessage(e, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("Wydajność pompy: 3.14 l/min", line);
+    logGet(r, 2, e);
+    logFormatMessage(e, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("Konfiguracja: zmienione pola 0x00001a2b", line);
+    logGet(r, 3, e);
+    logFormatMessage(e, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("WiFi: próba -3, następna za 5000 ms", line);
+}
+
+// Brakujące argumenty, nieznany komunikat i za mały bufor nie psują odczytu
+void test_format_defensive(void) {
+    LogEntry e = {};
+    e.msg = LM_PUMP_STATE;
+    e.argc = 1;
+    e.args[0] = 4;
+    char line[LOG_LINE_MAX];
+    logFormatMessage(e, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("Pompa: 4 -> ?", line);
+
+    e.msg = 999;
+    logFormatMessage(e, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("? komunikat 999", line);
+
+    e.msg = LM_ALARM_DRY_RUN;
+    char small[10];
+    TEST_ASSERT_EQUAL_UINT32(9, logFormatMessage(e, small, sizeof(small)));
+    TEST_ASSERT_EQUAL_STRING("ALARM: br", small);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_ring_keeps_newest);
+    RUN_TEST(test_format_on_read);
+    RUN_TEST(test_format_defensive);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,48 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include "loop_stats.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+void test_max_and_percentiles(void) {
+    LoopStats s;
+    loopStatsReset(s);
+    uint32_t t = 0xFFFFF000UL;   // Przepełnienie micros() w trakcie serii
+    loopStatsTick(s, t);
+    for (int i = 0; i < 990; ++i) loopStatsTick(s, t += 100);
+    for (int i = 0; i < 10; ++i) loopStatsTick(s, t += 3000);
+    loopStatsTick(s, t += 40000);
+    TEST_ASSERT_EQUAL_UINT32(1001, s.count);
+    TEST_ASSERT_EQUAL_UINT32(40000, s.maxUs);
+    TEST_ASSERT_EQUAL_UINT32(128, loopStatsPercentile(s, 50));
+    TEST_ASSERT_EQUAL_UINT32(4096, loopStatsPercentile(s, 99));
+    TEST_ASSERT_EQUAL_UINT32(65536, loopStatsPercentile(s, 100));
+}
+
+// Próbki podawane wprost (opóźnienie poleceń MQTT) - bez pary wywołań
+void test_add_samples(void) {
+    LoopStats s;
+    loopStatsReset(s);
+    loopStatsAdd(s, 900);
+    loopStatsAdd(s, 12000);
+    TEST_ASSERT_EQUAL_UINT32(2, s.count);
+    TEST_ASSERT_EQUAL_UINT32(12000, s.maxUs);
+    TEST_ASSERT_EQUAL_UINT32(1024, loopStatsPercentile(s, 50));
+    TEST_ASSERT_EQUAL_UINT32(16384, loopStatsPercentile(s, 99));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_max_and_percentiles);
+    RUN_TEST(test_add_samples);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,66 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include "loop_watchdog.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+void test_fast_iterations_not_flagged(void) {
+    LoopWatchdog w;
+    loopWatchdogBegin(w, 1000);
+    uint32_t t = 1000;
+    for (int i = 0; i < 100; ++i) {
+        loopWatchdogEnter(w, LS_ULTRASONIC, t += 1);
+        loopWatchdogEnter(w, LS_HTTP, t += 2);
+        TEST_ASSERT_FALSE(loopWatchdogIteration(w, t += 3, 500));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, w.last.count);
+    TEST_ASSERT_FALSE(loopStallValid(w.last));
+}
+
+void test_stall_records_longest_stage(void) {
+    LoopWatchdog w;
+    loopWatchdogBegin(w, 0);
+    loopWatchdogEnter(w, LS_PUMP, 5);
+    loopWatchdogEnter(w, LS_MQTT_CONNECT, 10);
+    TEST_ASSERT_EQUAL(LS_MQTT_CONNECT, loopWatchdogEnter(w, LS_EEPROM_COMMIT, 700));
+    loopWatchdogEnter(w, LS_MQTT_CONNECT, 820);   // Powrót po zapisie EEPROM
+    TEST_ASSERT_TRUE(loopWatchdogIteration(w, 830, 500));
+    TEST_ASSERT_TRUE(loopStallValid(w.last));
+    TEST_ASSERT_EQUAL(LS_MQTT_CONNECT, w.last.stage);
+    TEST_ASSERT_EQUAL_UINT32(690, w.last.stageMs);
+    TEST_ASSERT_EQUAL_UINT32(830, w.last.iterationMs);
+    TEST_ASSERT_EQUAL_UINT32(1, w.last.count);
+
+    // Następna iteracja liczona od nowa
+    loopWatchdogEnter(w, LS_PUMP, 840);
+    TEST_ASSERT_FALSE(loopWatchdogIteration(w, 850, 500));
+    w.last.stageMs++;   // Uszkodzony zapis w RTC
+    TEST_ASSERT_FALSE(loopStallValid(w.last));
+}
+
+void test_crumb_word(void) {
+    LoopStage s = LS_NONE;
+    TEST_ASSERT_TRUE(loopCrumbDecode(loopCrumbWord(LS_OTA_WRITE), &s));
+    TEST_ASSERT_EQUAL(LS_OTA_WRITE, s);
+    TEST_ASSERT_FALSE(loopCrumbDecode(0xDEADBEEFUL, &s));
+    TEST_ASSERT_FALSE(loopCrumbDecode((LOOP_CRUMB_MAGIC << 16) | 200, &s));
+    TEST_ASSERT_EQUAL_STRING("ota_write", loopStageName(LS_OTA_WRITE));
+    TEST_ASSERT_EQUAL_STRING("hw_wdt", resetReasonName(1));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fast_iterations_not_flagged);
+    RUN_TEST(test_stall_records_longest_stage);
+    RUN_TEST(test_crumb_word);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,103 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include "mono_clock.h"
+#include "pump_fsm.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+static const uint64_t WRAP = 1ULL << 32;
+
+// Przewijanie licznika 32-bitowego o dowolny czas w krokach < 2^31
+static uint64_t advance(MonoClock& clock, uint32_t& raw, uint64_t ms) {
+    uint64_t t = 0;
+    while (ms > 0) {
+        uint32_t step = ms > 0x40000000ULL ? 0x40000000UL : (uint32_t)ms;
+        raw += step;
+        ms -= step;
+        t = monoClockExtend(clock, raw);
+    }
+    return t;
+}
+
+void test_extend_across_several_wraps(void) {
+    MonoClock clock = {0, 0, 0};
+    uint32_t raw = 0;
+    uint64_t prev = monoClockExtend(clock, raw);
+    for (int i = 0; i < 5; ++i) {
+        uint64_t now = advance(clock, raw, WRAP);
+        TEST_ASSERT_TRUE(now == prev + WRAP);
+        prev = now;
+    }
+    TEST_ASSERT_EQUAL_UINT32(5, clock.wraps);
+}
+
+void test_extend_exact_at_wrap_point(void) {
+    MonoClock clock = {0, 0, 0};
+    uint32_t raw = 0xFFFFFFF0UL;
+    uint64_t before = monoClockExtend(clock, raw);
+    raw += 0x20;  // przepełnienie
+    uint64_t after = monoClockExtend(clock, raw);
+    TEST_ASSERT_TRUE(after - before == 0x20);
+    // Ten sam odczyt nie liczy się jako kolejne przepełnienie
+    TEST_ASSERT_TRUE(monoClockExtend(clock, raw) == after);
+}
+
+// Po ciepłym restarcie oś czasu startuje od zapisanego offsetu i rośnie dalej
+void test_offset_continues_timeline(void) {
+    const uint64_t SAVED = 0x100000010ULL;  // Jedno przepełnienie przed restartem
+    MonoClock clock = {0, 0, SAVED};
+    TEST_ASSERT_TRUE(monoClockExtend(clock, 150) == SAVED + 150);
+    TEST_ASSERT_TRUE(monoClockExtend(clock, 5) == SAVED + 0x100000005ULL);
+}
+
+// Pompa sterowana czasem rozszerzonym z surowego licznika startującego tuż przed
+// przepełnieniem: opóźnienie i limit pracy muszą wypaść dokładnie, także w kolejnych cyklach.
+void test_pump_limits_exact_across_wraps(void) {
+    const uint64_t DELAY_MS = 5000, RUN_LIMIT_MS = 30000;
+    MonoClock clock = {0, 0, 0};
+    const uint32_t START = 0xFFFFFFFFUL - 2000;
+    uint32_t raw = START;
+    uint64_t now = monoClockExtend(clock, raw);
+
+    for (int cycle = 0; cycle < 4; ++cycle) {
+        PumpState state = PUMP_IDLE;
+        uint64_t since = now, delayEnteredAt = 0, runningAt = 0, lockedAt = 0;
+
+        while (lockedAt == 0) {
+            PumpInputs in = {true, false, false, now - since, DELAY_MS, RUN_LIMIT_MS};
+            const PumpTransition& t = pumpTransition(state, pumpPollEvent(state, in));
+            if (t.next != state) {
+                if (t.next == PUMP_DELAY) delayEnteredAt = now;
+                if (t.next == PUMP_RUNNING) runningAt = now;
+                if (t.next == PUMP_LOCKED) lockedAt = now;
+                since = now;
+                state = t.next;
+            }
+            now = advance(clock, raw, 1);
+        }
+        TEST_ASSERT_TRUE(runningAt - delayEnteredAt == DELAY_MS);
+        TEST_ASSERT_TRUE(lockedAt - runningAt == RUN_LIMIT_MS);
+
+        // Przeskok do chwili tuż przed następnym przepełnieniem
+        now = advance(clock, raw, (uint32_t)(START - raw));
+    }
+    TEST_ASSERT_GREATER_OR_EQUAL(4, clock.wraps);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_extend_across_several_wraps);
+    RUN_TEST(test_extend_exact_at_wrap_point);
+    RUN_TEST(test_offset_continues_timeline);
+    RUN_TEST(test_pump_limits_exact_across_wraps);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,87 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include <string.h>
+#include "ota_pull.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+void test_version_compare(void) {
+    TEST_ASSERT_TRUE(otaVersionCompare("26.12.1", "26.11.24") > 0);
+    TEST_ASSERT_TRUE(otaVersionCompare("26.11.24", "26.11.24") == 0);
+    TEST_ASSERT_TRUE(otaVersionCompare("26.11", "26.11.0") == 0);
+    TEST_ASSERT_TRUE(otaVersionCompare("26.9.30", "26.10.1") < 0);     // Liczbowo, nie tekstowo
+    TEST_ASSERT_TRUE(otaVersionCompare("27.1.2-rc1", "27.1.1") > 0);
+}
+
+void test_manifest_requires_all_fields(void) {
+    OtaManifest m;
+    const char* ok = "{\"version\":\"26.12.01\",\"url\":\"http://10.0.0.5:8000/hs.bin.gz\","
+                     "\"size\":301234,\"md5\":\"0123456789ABCDEF0123456789abcdef\",\"notes\":\"x\"}";
+    TEST_ASSERT_TRUE(otaParseManifest(ok, strlen(ok), m));
+    TEST_ASSERT_EQUAL_STRING("26.12.01", m.version);
+    TEST_ASSERT_EQUAL_INT(301234, (int)m.size);
+    TEST_ASSERT_EQUAL_STRING("0123456789abcdef0123456789abcdef", m.md5);
+
+    const char* noMd5 = "{\"version\":\"26.12.01\",\"url\":\"http://h/a\",\"size\":10}";
+    TEST_ASSERT_FALSE(otaParseManifest(noMd5, strlen(noMd5), m));
+    const char* badMd5 = "{\"version\":\"26.12.01\",\"url\":\"http://h/a\",\"size\":10,\"md5\":\"xyz\"}";
+    TEST_ASSERT_FALSE(otaParseManifest(badMd5, strlen(badMd5), m));
+    const char* badSize = "{\"version\":\"1\",\"url\":\"http://h/a\",\"size\":0,\"md5\":\"0123456789abcdef0123456789abcdef\"}";
+    TEST_ASSERT_FALSE(otaParseManifest(badSize, strlen(badSize), m));
+}
+
+void test_url_parse(void) {
+    OtaUrl u;
+    TEST_ASSERT_TRUE(otaParseUrl("http://10.0.0.5:8000/fw/manifest.json", u));
+    TEST_ASSERT_EQUAL_STRING("10.0.0.5", u.host);
+    TEST_ASSERT_EQUAL_INT(8000, u.port);
+    TEST_ASSERT_EQUAL_STRING("/fw/manifest.json", u.path);
+    TEST_ASSERT_TRUE(otaParseUrl("http://nas.local", u));
+    TEST_ASSERT_EQUAL_INT(80, u.port);
+    TEST_ASSERT_EQUAL_STRING("/", u.path);
+    TEST_ASSERT_FALSE(otaParseUrl("https://nas.local/m.json", u));
+    TEST_ASSERT_FALSE(otaParseUrl("http://nas.local:0/m.json", u));
+    TEST_ASSERT_FALSE(otaParseUrl("http:///m.json", u));
+}
+
+// Nagłówek w porcjach po 3 bajty; treść zaczyna się zaraz po pustej linii
+void test_http_head_split_feed(void) {
+    const char* resp = "HTTP/1.0 200 OK\r\nServer: SimpleHTTP/0.6\r\ncontent-LENGTH: 5\r\n\r\n\xE9" "abcd";
+    OtaHttpHead h;
+    otaHttpHeadBegin(h);
+    size_t total = strlen(resp), pos = 0, used = 0;
+    while (!h.done && pos < total) {
+        size_t n = total - pos < 3 ? total - pos : 3;
+        used = otaHttpHeadFeed(h, (const uint8_t*)resp + pos, n);
+        pos += used;
+        if (used < n) break;
+    }
+    TEST_ASSERT_TRUE(h.done);
+    TEST_ASSERT_FALSE(h.error);
+    TEST_ASSERT_EQUAL_INT(200, h.status);
+    TEST_ASSERT_EQUAL_INT(5, h.contentLength);
+    TEST_ASSERT_EQUAL(OTA_IMAGE_ESP, otaImageKind((const uint8_t*)resp + pos, total - pos));
+
+    otaHttpHeadBegin(h);
+    const char* notHttp = "<html>\n";
+    otaHttpHeadFeed(h, (const uint8_t*)notHttp, strlen(notHttp));
+    TEST_ASSERT_TRUE(h.error);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_version_compare);
+    RUN_TEST(test_manifest_requires_all_fields);
+    RUN_TEST(test_url_parse);
+    RUN_TEST(test_http_head_split_feed);
+    UNITY_END();
+    return 0;
+}
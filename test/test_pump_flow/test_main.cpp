@@ -0,0 +1,82 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include "pump_flow.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+static const float DIAMETER = 300.0f;  // mm -> 0,0707 l na mm spadku
+
+// Cykl pompy: pomiar co sekundę, spadek slope mm/s z szumem +-noise mm
+static void runPump(FlowMonitor& m, uint64_t start, int seconds, float slope, int noise) {
+    flowStart(m, start, 500);
+    for (int s = 1; s <= seconds; ++s) {
+        int jitter = noise ? (s * 7919) % (2 * noise + 1) - noise : 0;
+        flowSample(m, start + s * 1000ULL, 500 + slope * s + jitter);
+    }
+}
+
+void test_litres_per_minute_from_slope(void) {
+    FlowMonitor m = {};
+    runPump(m, 1000, 20, 0.5f, 0);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.5f, flowSlope(m));
+    // 0,5 mm/s * 70686 mm^2 * 60 s = 2,12 l/min
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 2.12f, flowFinish(m, DIAMETER));
+    TEST_ASSERT_FALSE(m.active);
+}
+
+void test_stall_detected_only_after_window(void) {
+    FlowMonitor m = {};
+    runPump(m, 0, 14, 0.0f, 1);
+    TEST_ASSERT_FALSE(flowStalled(m, 14000, 15000, 2));
+    flowSample(m, 15000, 500);
+    TEST_ASSERT_TRUE(flowStalled(m, 15000, 15000, 2));
+    // Okno 0 wyłącza kontrolę
+    TEST_ASSERT_FALSE(flowStalled(m, 15000, 0, 2));
+}
+
+void test_noisy_drawdown_not_stalled(void) {
+    FlowMonitor m = {};
+    runPump(m, 0, 15, 0.3f, 3);
+    TEST_ASSERT_FALSE(flowStalled(m, 15000, 15000, 2));
+}
+
+void test_no_samples_no_verdict(void) {
+    FlowMonitor m = {};
+    flowStart(m, 0, 500);
+    flowSample(m, 1000, 500);
+    TEST_ASSERT_FALSE(flowStalled(m, 60000, 15000, 2));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, -1.0f, flowFinish(m, DIAMETER));
+}
+
+void test_trend_reports_degradation(void) {
+    FlowTrend t = {};
+    for (int i = 0; i < FLOW_BASELINE_RUNS; ++i) flowTrendAdd(t, 2.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 100.0f, flowTrendPercent(t));
+    // Powolny spadek wydajności nie przesuwa odniesienia
+    for (int i = 0; i < 50; ++i) flowTrendAdd(t, 2.0f - 0.02f * i);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 2.0f, t.baselineLpm);
+    TEST_ASSERT_LESS_THAN(60.0f, flowTrendPercent(t));
+    // Cykle bez pomiaru są pomijane
+    uint16_t runs = t.runs;
+    flowTrendAdd(t, -1.0f);
+    TEST_ASSERT_EQUAL(runs, t.runs);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_litres_per_minute_from_slope);
+    RUN_TEST(test_stall_detected_only_after_window);
+    RUN_TEST(test_noisy_drawdown_not_stalled);
+    RUN_TEST(test_no_samples_no_verdict);
+    RUN_TEST(test_trend_reports_degradation);
+    UNITY_END();
+    return 0;
+}
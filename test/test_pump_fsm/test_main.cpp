@@ -0,0 +1,154 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include "pump_fsm.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+static bool isLeavingLockWithoutReset(PumpState from, PumpEvent ev, PumpState to) {
+    return pumpIsLocked(from) && !pumpIsLocked(to) && ev != EV_ALARM_RESET;
+}
+
+// Każda kombinacja stan x zdarzenie musi spełniać niezmienniki bezpieczeństwa
+void test_every_state_event_combination(void) {
+    for (int s = 0; s < PUMP_STATE_COUNT; ++s) {
+        for (int e = 0; e < PUMP_EVENT_COUNT; ++e) {
+            PumpState from = (PumpState)s;
+            PumpEvent ev = (PumpEvent)e;
+            const PumpTransition& t = pumpTransition(from, ev);
+
+            TEST_ASSERT_TRUE(t.next < PUMP_STATE_COUNT);
+            // Brak zdarzenia nic nie zmienia
+            if (ev == EV_NONE) { TEST_ASSERT_EQUAL(from, t.next); TEST_ASSERT_EQUAL(ACT_NONE, t.action); }
+            // Pompa startuje tylko po odliczeniu opóźnienia
+            if (pumpOutputOn(t.next) && !pumpOutputOn(from)) {
+                TEST_ASSERT_EQUAL(PUMP_DELAY, from);
+                TEST_ASSERT_EQUAL(EV_DELAY_ELAPSED, ev);
+            }
+            // Blokadę zdejmuje wyłącznie skasowanie alarmu
+            TEST_ASSERT_FALSE(isLeavingLockWithoutReset(from, ev, t.next));
+            // Tryb serwisowy zawsze wyłącza pompę i tylko SERVICE_OFF go kończy
+            if (ev == EV_SERVICE_ON) TEST_ASSERT_TRUE(pumpIsService(t.next));
+            if (pumpIsService(from) && ev != EV_SERVICE_OFF) TEST_ASSERT_TRUE(pumpIsService(t.next));
+            if (pumpIsService(from) && ev == EV_SERVICE_OFF) TEST_ASSERT_FALSE(pumpIsService(t.next));
+            // Blokada przetrwa wejście i wyjście z trybu serwisowego
+            if (ev == EV_SERVICE_ON || ev == EV_SERVICE_OFF) TEST_ASSERT_EQUAL(pumpIsLocked(from), pumpIsLocked(t.next));
+            // Warunki zatrzymania
+            if (ev == EV_TANK_EMPTY || ev == EV_WATER_OFF || ev == EV_RUN_TIMEOUT || ev == EV_NO_FLOW) TEST_ASSERT_FALSE(pumpOutputOn(t.next));
+            if (from == PUMP_RUNNING && (ev == EV_RUN_TIMEOUT || ev == EV_NO_FLOW)) TEST_ASSERT_EQUAL(PUMP_LOCKED, t.next);
+            if (ev == EV_ALARM_RESET) TEST_ASSERT_EQUAL(ACT_ALARM_CLEAR, t.action);
+        }
+    }
+}
+
+void test_key_transitions(void) {
+    TEST_ASSERT_EQUAL(PUMP_DELAY, pumpTransition(PUMP_IDLE, EV_WATER_ON).next);
+    TEST_ASSERT_EQUAL(PUMP_IDLE, pumpTransition(PUMP_DELAY, EV_WATER_OFF).next);
+    TEST_ASSERT_EQUAL(PUMP_RUNNING, pumpTransition(PUMP_DELAY, EV_DELAY_ELAPSED).next);
+    TEST_ASSERT_EQUAL(ACT_ALARM_RUN_TIMEOUT, pumpTransition(PUMP_RUNNING, EV_RUN_TIMEOUT).action);
+    TEST_ASSERT_EQUAL(ACT_ALARM_DRY_RUN, pumpTransition(PUMP_RUNNING, EV_TANK_EMPTY).action);
+    TEST_ASSERT_EQUAL(ACT_ALARM_NO_FLOW, pumpTransition(PUMP_RUNNING, EV_NO_FLOW).action);
+    TEST_ASSERT_EQUAL(PUMP_SERVICE_LOCKED, pumpTransition(PUMP_LOCKED, EV_SERVICE_ON).next);
+    TEST_ASSERT_EQUAL(PUMP_LOCKED, pumpTransition(PUMP_SERVICE_LOCKED, EV_SERVICE_OFF).next);
+    TEST_ASSERT_EQUAL(PUMP_IDLE, pumpTransition(PUMP_LOCKED, EV_ALARM_RESET).next);
+}
+
+void test_poll_priorities(void) {
+    PumpInputs in = {true, false, false, 0, 5000, 30000};
+    TEST_ASSERT_EQUAL(EV_WATER_ON, pumpPollEvent(PUMP_IDLE, in));
+    TEST_ASSERT_EQUAL(EV_WATER_ON, pumpPollEvent(PUMP_DELAY, in));
+    in.elapsedMs = 5000;
+    TEST_ASSERT_EQUAL(EV_DELAY_ELAPSED, pumpPollEvent(PUMP_DELAY, in));
+    in.tankEmpty = true;
+    TEST_ASSERT_EQUAL(EV_TANK_EMPTY, pumpPollEvent(PUMP_DELAY, in));
+    in.tankEmpty = false;
+    in.noFlow = true;
+    TEST_ASSERT_EQUAL(EV_DELAY_ELAPSED, pumpPollEvent(PUMP_DELAY, in));
+    TEST_ASSERT_EQUAL(EV_NO_FLOW, pumpPollEvent(PUMP_RUNNING, in));
+    in.elapsedMs = 30000;
+    TEST_ASSERT_EQUAL(EV_RUN_TIMEOUT, pumpPollEvent(PUMP_RUNNING, in));
+}
+
+// Symulacja wielu lat pracy w krokach 1 s: losowy czujnik wody, zbiornik,
+// tryb serwisowy i kasowanie alarmów. Sprawdza niezmienniki w każdym kroku.
+static uint32_t rng = 0xC0FFEEu;
+static uint32_t nextRand() { rng ^= rng << 13; rng ^= rng >> 17; rng ^= rng << 5; return rng; }
+
+void test_simulate_years(void) {
+    const unsigned long STEP_MS = 1000;
+    const unsigned long SIM_SECONDS = 2UL * 365UL * 24UL * 3600UL;
+    const unsigned long DELAY_MS = 5000, RUN_LIMIT_MS = 30000;
+
+    PumpState state = PUMP_IDLE;
+    unsigned long now = 0, since = 0, waterOnSince = 0;
+    bool water = false, tankEmpty = false;
+    unsigned long runs = 0, locks = 0;
+    long waterToggleIn = 600, tankToggleIn = 86400, serviceIn = 7 * 86400;
+
+    for (unsigned long sec = 0; sec < SIM_SECONDS; ++sec, now += STEP_MS) {
+        if (--waterToggleIn <= 0) {
+            water = !water;
+            if (water) waterOnSince = now;
+            // Dolewanie trwa zwykle kilka-kilkadziesiąt sekund, czasem dłużej niż limit
+            waterToggleIn = water ? 1 + (long)(nextRand() % 45) : 60 + (long)(nextRand() % 7200);
+        }
+        if (--tankToggleIn <= 0) {
+            tankEmpty = !tankEmpty;
+            tankToggleIn = tankEmpty ? 3600 : 30 * 86400L + (long)(nextRand() % 86400);
+        }
+
+        PumpEvent external = EV_NONE;
+        if (--serviceIn <= 0) {
+            external = pumpIsService(state) ? EV_SERVICE_OFF : EV_SERVICE_ON;
+            serviceIn = pumpIsService(state) ? 7 * 86400L : 600;
+        } else if (pumpIsLocked(state) && (nextRand() % 3600) == 0) {
+            external = EV_ALARM_RESET;
+        }
+
+        if (external != EV_NONE) {
+            const PumpTransition& t = pumpTransition(state, external);
+            if (t.next != state) since = now;
+            state = t.next;
+        }
+
+        PumpInputs in = {water, tankEmpty, false, now - since, DELAY_MS, RUN_LIMIT_MS};
+        const PumpTransition& t = pumpTransition(state, pumpPollEvent(state, in));
+        if (t.next != state) {
+            if (pumpOutputOn(t.next)) {
+                runs++;
+                // Start dopiero po pełnym opóźnieniu od wejścia w DELAY
+                TEST_ASSERT_GREATER_OR_EQUAL(DELAY_MS, now - since);
+                TEST_ASSERT_GREATER_OR_EQUAL(DELAY_MS, now - waterOnSince);
+            }
+            if (pumpIsLocked(t.next) && !pumpIsLocked(state)) locks++;
+            since = now;
+            state = t.next;
+        }
+
+        if (pumpOutputOn(state)) {
+            TEST_ASSERT_TRUE(water);
+            TEST_ASSERT_FALSE(tankEmpty);
+            TEST_ASSERT_FALSE(pumpIsService(state));
+            TEST_ASSERT_LESS_THAN(RUN_LIMIT_MS, now - since);
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(1000UL, runs);
+    TEST_ASSERT_GREATER_THAN(10UL, locks);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_state_event_combination);
+    RUN_TEST(test_key_transitions);
+    RUN_TEST(test_poll_priorities);
+    RUN_TEST(test_simulate_years);
+    UNITY_END();
+    return 0;
+}
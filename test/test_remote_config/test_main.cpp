@@ -0,0 +1,97 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "remote_config.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+static Config cfg;
+static ConfigUpdate u;
+
+static RemoteConfigResult eval(RemoteConfigSource src, const char* json) {
+    return remoteConfigEvaluate(u, cfg, src, json, strlen(json));
+}
+
+// Zastosowany dokument zapisuje rev źródła razem z polami; ten sam rev
+// (zachowany dokument po ponownym połączeniu) jest pomijany
+void test_rev_applied_then_stale(void) {
+    fillDefaultConfig(cfg);
+    TEST_ASSERT_EQUAL(RCR_APPLY, eval(RCS_FLEET, "{\"version\":1,\"rev\":7,\"pump_delay\":12}"));
+    TEST_ASSERT_EQUAL_INT(12, u.staged.pump_delay);
+    TEST_ASSERT_EQUAL_UINT32(7, u.staged.remote_rev_fleet);
+    TEST_ASSERT_EQUAL_UINT32(0, u.staged.remote_rev_device);
+    memcpy(&cfg, &u.staged, sizeof(Config));
+
+    TEST_ASSERT_EQUAL(RCR_STALE, eval(RCS_FLEET, "{\"version\":1,\"rev\":7,\"pump_delay\":12}"));
+    TEST_ASSERT_EQUAL(RCR_STALE, eval(RCS_FLEET, "{\"rev\":6,\"pump_delay\":3}"));
+    // Rev urządzenia liczony osobno
+    TEST_ASSERT_EQUAL(RCR_APPLY, eval(RCS_DEVICE, "{\"rev\":1,\"pump_delay\":20}"));
+    TEST_ASSERT_EQUAL_UINT32(1, u.staged.remote_rev_device);
+}
+
+void test_missing_rev_and_invalid_fields(void) {
+    fillDefaultConfig(cfg);
+    TEST_ASSERT_EQUAL(RCR_NO_REV, eval(RCS_DEVICE, "{\"pump_delay\":12}"));
+    TEST_ASSERT_EQUAL(RCR_REJECTED, eval(RCS_DEVICE, "{\"rev\":0,\"pump_delay\":12}"));
+    TEST_ASSERT_EQUAL(RCR_REJECTED, eval(RCS_DEVICE, "{\"rev\":2,\"mqtt_port\":70000}"));
+    TEST_ASSERT_EQUAL_UINT32(0, u.staged.remote_rev_device);
+
+    static char big[REMOTE_CONFIG_DOC_MAX + 2];
+    memset(big, ' ', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+    TEST_ASSERT_EQUAL(RCR_TOO_LARGE, eval(RCS_FLEET, big));
+}
+
+void test_ack_document(void) {
+    fillDefaultConfig(cfg);
+    char hash[9];
+    char buf[320];
+    StrBuf sb;
+
+    RemoteConfigResult r = eval(RCS_FLEET, "{\"rev\":3,\"tank_full\":80}");
+    memcpy(&cfg, &u.staged, sizeof(Config));
+    configHashHex(cfg, hash);
+    sbInit(sb, buf, sizeof(buf));
+    remoteConfigAck(sb, RCS_FLEET, r, u, cfg);
+    TEST_ASSERT_FALSE(sb.overflow);
+    char prefix[48];
+    snprintf(prefix, sizeof(prefix), "{\"source\":\"fleet\",\"rev\":3,\"hash\":\"%s\"", hash);
+    TEST_ASSERT_EQUAL_INT(0, strncmp(buf, prefix, strlen(prefix)));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"result\":{\"status\":\"ok\""));
+
+    r = eval(RCS_DEVICE, "{\"pump_delay\":5}");
+    sbInit(sb, buf, sizeof(buf));
+    remoteConfigAck(sb, RCS_DEVICE, r, u, cfg);
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"source\":\"device\",\"rev\":0"));
+    TEST_ASSERT_NOT_NULL(strstr(buf, "\"errors\":{\"rev\":\"missing\"}"));
+}
+
+// Skrót zależy od pól tabeli, nie od hasła ani rev dokumentów zdalnych
+void test_hash_skips_secrets_and_revs(void) {
+    fillDefaultConfig(cfg);
+    uint32_t h = configHash(cfg);
+    strcpy(cfg.mqtt_password, "tajne");
+    cfg.remote_rev_fleet = 9;
+    TEST_ASSERT_EQUAL_UINT32(h, configHash(cfg));
+    cfg.pump_delay++;
+    TEST_ASSERT_TRUE(configHash(cfg) != h);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_rev_applied_then_stale);
+    RUN_TEST(test_missing_rev_and_invalid_fields);
+    RUN_TEST(test_ack_document);
+    RUN_TEST(test_hash_skips_secrets_and_revs);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,84 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include "sensor_health.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+// Cykl trzech próbek: echo ~2900 us (~500 mm) z zadanym rozrzutem
+static void cleanCycle(SensorHealth& h, uint32_t spreadUs) {
+    healthSample(h, SAMPLE_OK, 2900 - spreadUs);
+    healthSample(h, SAMPLE_OK, 2900);
+    healthSample(h, SAMPLE_OK, 2900 + spreadUs);
+    healthCycle(h, CYCLE_OK);
+}
+
+void test_clean_sensor_scores_full(void) {
+    SensorHealth h;
+    healthInit(h);
+    TEST_ASSERT_EQUAL_INT(100, healthScore(h));
+    for (int i = 0; i < 50; ++i) cleanCycle(h, 5);
+    TEST_ASSERT_EQUAL_UINT32(150, h.validSamples);
+    TEST_ASSERT_GREATER_OR_EQUAL(98, healthScore(h));
+}
+
+void test_counters_by_failure_kind(void) {
+    SensorHealth h;
+    healthInit(h);
+    healthSample(h, SAMPLE_TIMEOUT_HIGH, 0);
+    healthSample(h, SAMPLE_TIMEOUT_LOW, 0);
+    healthSample(h, SAMPLE_OK, 2900);
+    healthCycle(h, CYCLE_TOO_FEW_SAMPLES);
+    cleanCycle(h, 0);
+    healthCycle(h, CYCLE_OUT_OF_RANGE);
+    healthCycle(h, CYCLE_SPIKE_REJECTED);
+    TEST_ASSERT_EQUAL_UINT32(1, h.timeoutHigh);
+    TEST_ASSERT_EQUAL_UINT32(1, h.timeoutLow);
+    TEST_ASSERT_EQUAL_UINT32(1, h.tooFewSamples);
+    TEST_ASSERT_EQUAL_UINT32(1, h.outOfRange);
+    TEST_ASSERT_EQUAL_UINT32(1, h.spikeRejected);
+    TEST_ASSERT_EQUAL_UINT32(4, h.cycles);
+}
+
+// Brudny czujnik: co druga próbka bez echa i duży rozrzut - wynik spada wyraźnie
+void test_degraded_sensor_scores_low(void) {
+    SensorHealth h;
+    healthInit(h);
+    for (int i = 0; i < 50; ++i) cleanCycle(h, 5);
+    int healthy = healthScore(h);
+    for (int i = 0; i < 50; ++i) {
+        healthSample(h, SAMPLE_TIMEOUT_HIGH, 0);
+        healthSample(h, SAMPLE_OK, 2700);
+        healthSample(h, SAMPLE_OK, 3100);
+        healthCycle(h, (i % 4 == 0) ? CYCLE_SPIKE_REJECTED : CYCLE_OK);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, 34.3f, healthJitterMm(h));  // 200 us
+    TEST_ASSERT_LESS_THAN(healthy - 40, healthScore(h));
+    // Po oczyszczeniu czujnika wynik wraca
+    for (int i = 0; i < 80; ++i) cleanCycle(h, 5);
+    TEST_ASSERT_GREATER_OR_EQUAL(95, healthScore(h));
+}
+
+void test_stale(void) {
+    TEST_ASSERT_FALSE(healthStale(0, 100000, 190000));
+    TEST_ASSERT_TRUE(healthStale(0, 200000, 190000));
+    TEST_ASSERT_FALSE(healthStale(500000, 600000, 190000));
+    TEST_ASSERT_TRUE(healthStale(500000, 700001, 190000));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_clean_sensor_scores_full);
+    RUN_TEST(test_counters_by_failure_kind);
+    RUN_TEST(test_degraded_sensor_scores_low);
+    RUN_TEST(test_stale);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,61 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include "spsc_queue.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+void test_fifo_order(void) {
+    static SpscQueue<int, 4> q;
+    for (int i = 1; i <= 3; ++i) TEST_ASSERT_TRUE(spscPush(q, i));
+    TEST_ASSERT_EQUAL_INT(3, spscSize(q));
+    int v = 0;
+    for (int i = 1; i <= 3; ++i) {
+        TEST_ASSERT_TRUE(spscPop(q, v));
+        TEST_ASSERT_EQUAL_INT(i, v);
+    }
+    TEST_ASSERT_FALSE(spscPop(q, v));
+}
+
+// Pełna kolejka odrzuca nowe elementy, zachowując starsze
+void test_full_drops_newest(void) {
+    static SpscQueue<int, 4> q;
+    for (int i = 0; i < 6; ++i) spscPush(q, i);
+    TEST_ASSERT_EQUAL_INT(4, spscSize(q));
+    TEST_ASSERT_EQUAL_UINT32(2, q.dropped);
+    int v = -1;
+    spscPop(q, v);
+    TEST_ASSERT_EQUAL_INT(0, v);
+    TEST_ASSERT_TRUE(spscPush(q, 9));
+}
+
+// Liczniki 16-bitowe przechodzą przez przepełnienie bez utraty elementów
+void test_counter_wraparound(void) {
+    static SpscQueue<uint32_t, 8> q;
+    uint32_t next = 0, expected = 0, v = 0;
+    for (uint32_t round = 0; round < 70000; ++round) {
+        while (spscPush(q, next)) next++;
+        for (int k = 0; k < 5 && spscPop(q, v); ++k) {
+            TEST_ASSERT_EQUAL_UINT32(expected, v);
+            expected++;
+        }
+    }
+    while (spscPop(q, v)) TEST_ASSERT_EQUAL_UINT32(expected++, v);
+    TEST_ASSERT_EQUAL_UINT32(next, expected);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fifo_order);
+    RUN_TEST(test_full_drops_newest);
+    RUN_TEST(test_counter_wraparound);
+    UNITY_END();
+    return 0;
+}
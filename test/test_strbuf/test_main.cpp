@@ -0,0 +1,189 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include "strbuf.h"
+#include "wifi_scan.h"
+#include "config_schema.h"
+
+// Licznik alokacji - każda alokacja przez operator new jest liczona,
+// aby test długotrwały mógł sprawdzić, że składanie odpowiedzi nie używa sterty
+static unsigned long allocCount = 0;
+static long liveBytes = 0;
+
+void* operator new(size_t size) {
+    allocCount++;
+    liveBytes += (long)size;
+    void* p = malloc(size + sizeof(size_t));
+    if (!p) throw std::bad_alloc();
+    *(size_t*)p = size;
+    return (size_t*)p + 1;
+}
+
+void operator delete(void* p) noexcept {
+    if (!p) return;
+    size_t* base = (size_t*)p - 1;
+    liveBytes -= (long)*base;
+    free(base);
+}
+
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+struct FakeNetwork {
+    const char* ssid;
+    int rssi;
+    bool secure;
+};
+
+static const FakeNetwork NETWORKS[] = {
+    {"Dom", -48, true},
+    {"Sieć \"gościnna\"", -71, false},
+    {"back\\slash", -80, true},
+    {"IoT_2.4GHz", -62, true},
+};
+
+const int NETWORK_COUNT = sizeof(NETWORKS) / sizeof(NETWORKS[0]);
+
+// Zamiast platformScanEntry() - dane testowe dla wifiScanJson() z handleScanWifi()
+static bool fakeScanEntry(int index, PlatformScanEntry& e) {
+    e.ssid = NETWORKS[index].ssid;
+    e.ssidLen = strlen(NETWORKS[index].ssid);
+    e.rssi = NETWORKS[index].rssi;
+    e.secure = NETWORKS[index].secure;
+    return true;
+}
+
+// Skanowanie, w którym platforma odrzuca wpisy parzyste - w tym pierwszy
+static bool fakeScanEntryOddOnly(int index, PlatformScanEntry& e) {
+    if (index % 2 == 0) return false;
+    return fakeScanEntry(index, e);
+}
+
+// Argumenty formularza /save w kolejności, w jakiej podaje je serwer WWW
+static const char* const FORM[][2] = {
+    {"mqtt_server", "10.0.0.2"}, {"mqtt_port", "1884"}, {"pump_delay", "7"},
+    {"sound_enabled", "off"}, {"wifi_ssid", "Dom"}, {"wifi_pass", "tajne-haslo"}, {"plain", "x"},
+};
+
+// Ta sama ścieżka co handleSave() po skopiowaniu argumentów
+static bool submitForm(ConfigUpdate& u, ConfigForm& form, const Config& current) {
+    configFormBegin(u, form, current);
+    for (size_t i = 0; i < sizeof(FORM) / sizeof(FORM[0]); ++i) configFormArg(u, form, FORM[i][0], FORM[i][1]);
+    return configUpdateFinish(u, current);
+}
+
+void test_json_escaping(void) {
+    char out[64];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    sbAppendJsonString(sb, "a\"b\\c\n", 6);
+    TEST_ASSERT_EQUAL_STRING("\"a\\\"b\\\\c\\u000a\"", out);
+}
+
+void test_numbers(void) {
+    char out[32];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    sbAppendInt(sb, -2147483647L - 1);
+    sbAppendChar(sb, ' ');
+    sbAppendUInt(sb, 4294967295UL);
+    TEST_ASSERT_EQUAL_STRING("-2147483648 4294967295", out);
+}
+
+void test_scan_json_truncates_whole_entries(void) {
+    char out[80];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    wifiScanJson(sb, NETWORK_COUNT, fakeScanEntry);
+    TEST_ASSERT_EQUAL_STRING("[{\"ssid\":\"Dom\",\"rssi\":-48,\"secure\":1}]", out);
+}
+
+void test_scan_json_skipped_first_entry(void) {
+    char out[160];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    wifiScanJson(sb, NETWORK_COUNT, fakeScanEntryOddOnly);
+    TEST_ASSERT_EQUAL_STRING("[{\"ssid\":\"Sieć \\\"gościnna\\\"\",\"rssi\":-71,\"secure\":0},"
+                             "{\"ssid\":\"IoT_2.4GHz\",\"rssi\":-62,\"secure\":1}]", out);
+}
+
+void test_form_fields_and_wifi(void) {
+    static Config current;
+    static ConfigUpdate u;
+    static ConfigForm form;
+    fillDefaultConfig(current);
+    TEST_ASSERT_TRUE(submitForm(u, form, current));
+    TEST_ASSERT_EQUAL_STRING("10.0.0.2", u.staged.mqtt_server);
+    TEST_ASSERT_EQUAL_INT(1884, u.staged.mqtt_port);
+    TEST_ASSERT_FALSE(u.staged.soundEnabled);
+    TEST_ASSERT_EQUAL_STRING("Dom", form.wifiSsid);
+    TEST_ASSERT_EQUAL_STRING("tajne-haslo", form.wifiPass);
+    TEST_ASSERT_EQUAL(0, u.ignoredCount);
+}
+
+void test_overflow_truncates(void) {
+    char out[8];
+    StrBuf sb;
+    sbInit(sb, out, sizeof(out));
+    sbAppend(sb, "0123456789");
+    TEST_ASSERT_TRUE(sb.overflow);
+    TEST_ASSERT_EQUAL(7, sb.len);
+    TEST_ASSERT_EQUAL_STRING("0123456", out);
+}
+
+// Test długotrwały: 100 tys. "żądań" GET /scan_wifi i POST /save (kod
+// handlerów bez warstwy serwera) nie może alokować ani zmieniać zajętości sterty
+void test_soak_no_heap_growth(void) {
+    static char scanOut[1024];
+    static char msg[48];
+    static char expected[1024];
+    static Config current;
+    static ConfigUpdate u;
+    static ConfigForm form;
+    fillDefaultConfig(current);
+
+    StrBuf sb;
+    sbInit(sb, expected, sizeof(expected));
+    wifiScanJson(sb, NETWORK_COUNT, fakeScanEntry);
+
+    unsigned long allocsBefore = allocCount;
+    long liveBefore = liveBytes;
+    bool formOk = true;
+    for (long request = 0; request < 100000L; ++request) {
+        sbInit(sb, scanOut, sizeof(scanOut));
+        wifiScanJson(sb, NETWORK_COUNT, fakeScanEntry);
+        if (strcmp(scanOut, expected) != 0) break;
+
+        formOk = formOk && submitForm(u, form, current);
+        sbInit(sb, msg, sizeof(msg));
+        configUpdateReport(sb, u);
+    }
+    TEST_ASSERT_EQUAL_STRING(expected, scanOut);
+    TEST_ASSERT_TRUE(formOk);
+    TEST_ASSERT_EQUAL(allocsBefore, allocCount);
+    TEST_ASSERT_EQUAL(liveBefore, liveBytes);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_json_escaping);
+    RUN_TEST(test_numbers);
+    RUN_TEST(test_overflow_truncates);
+    RUN_TEST(test_scan_json_truncates_whole_entries);
+    RUN_TEST(test_scan_json_skipped_first_entry);
+    RUN_TEST(test_form_fields_and_wifi);
+    RUN_TEST(test_soak_no_heap_growth);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,80 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include <string.h>
+#include "warm_restart.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+static WarmSnapshot sample() {
+    WarmSnapshot s;
+    memset(&s, 0, sizeof(s));
+    s.seq = 7;
+    s.monoMs = 5000000000ULL;  // Powyżej 32 bitów - oś czasu po przepełnieniu millis()
+    s.lastFilteredDistance = 612.5f;
+    s.currentDistance = 612.0f;
+    robustInit(s.filter);
+    s.filter.value = 612.5f;
+    s.pumpState = PUMP_LOCKED;
+    s.flags = WARM_WATER_RESERVE;
+    warmSeal(s);
+    return s;
+}
+
+void test_sealed_snapshot_valid(void) {
+    WarmSnapshot s = sample();
+    TEST_ASSERT_TRUE(warmValid(s));
+    TEST_ASSERT_EQUAL_UINT32(WARM_MAGIC, s.magic);
+}
+
+// Losowa zawartość RTC po włączeniu zasilania i każda zmiana bajtu są odrzucane
+void test_tampered_snapshot_rejected(void) {
+    WarmSnapshot zero;
+    memset(&zero, 0, sizeof(zero));
+    TEST_ASSERT_FALSE(warmValid(zero));
+
+    const WarmSnapshot good = sample();
+    for (size_t i = 0; i < sizeof(WarmSnapshot); ++i) {
+        WarmSnapshot s = good;
+        ((uint8_t*)&s)[i] ^= 0x10;
+        TEST_ASSERT_FALSE(warmValid(s));
+    }
+
+    WarmSnapshot other = good;
+    other.layout = WARM_LAYOUT + 1;
+    warmSeal(other);  // warmSeal nadpisuje wersję - symulacja starszego firmware
+    other.layout = WARM_LAYOUT + 1;
+    TEST_ASSERT_FALSE(warmValid(other));
+
+    WarmSnapshot badState = good;
+    badState.pumpState = PUMP_STATE_COUNT;
+    warmSeal(badState);
+    TEST_ASSERT_FALSE(warmValid(badState));
+}
+
+// Po restarcie przekaźnik jest wyłączony - praca i odliczanie nie są wznawiane
+void test_resume_pump_state(void) {
+    TEST_ASSERT_EQUAL(PUMP_IDLE, warmResumeState(PUMP_IDLE));
+    TEST_ASSERT_EQUAL(PUMP_IDLE, warmResumeState(PUMP_DELAY));
+    TEST_ASSERT_EQUAL(PUMP_IDLE, warmResumeState(PUMP_RUNNING));
+    TEST_ASSERT_EQUAL(PUMP_LOCKED, warmResumeState(PUMP_LOCKED));
+    TEST_ASSERT_EQUAL(PUMP_SERVICE, warmResumeState(PUMP_SERVICE));
+    TEST_ASSERT_EQUAL(PUMP_SERVICE_LOCKED, warmResumeState(PUMP_SERVICE_LOCKED));
+    TEST_ASSERT_EQUAL(PUMP_IDLE, warmResumeState(200));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_sealed_snapshot_valid);
+    RUN_TEST(test_tampered_snapshot_rejected);
+    RUN_TEST(test_resume_pump_state);
+    UNITY_END();
+    return 0;
+}
@@ -0,0 +1,74 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <unity.h>
+#include <string.h>
+#include "wifi_cache.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#ifdef ARDUINO
+void setup() {}
+void loop() {}
+#endif
+
+static WifiCache sample() {
+    WifiCache c;
+    memset(&c, 0, sizeof(c));
+    const uint8_t bssid[6] = {0x24, 0x4b, 0xfe, 0x01, 0x02, 0x03};
+    memcpy(c.bssid, bssid, sizeof(bssid));
+    c.channel = 6;
+    c.ip = 0x6401A8C0UL;       // 192.168.1.100
+    c.gateway = 0x0101A8C0UL;
+    c.mask = 0x00FFFFFFUL;
+    c.dns = 0x0101A8C0UL;
+    wifiCacheSeal(c, "Dom");
+    return c;
+}
+
+void test_valid_only_for_same_network(void) {
+    WifiCache c = sample();
+    TEST_ASSERT_TRUE(wifiCacheValid(c, "Dom"));
+    TEST_ASSERT_FALSE(wifiCacheValid(c, "Dom2"));   // Nowe poświadczenia - pełne łączenie
+    TEST_ASSERT_FALSE(wifiCacheValid(c, ""));
+}
+
+void test_corrupted_or_empty_rejected(void) {
+    WifiCache empty;
+    memset(&empty, 0, sizeof(empty));
+    TEST_ASSERT_FALSE(wifiCacheValid(empty, "Dom"));
+    TEST_ASSERT_FALSE(wifiCacheValid(empty, ""));   // Wyzerowany wpis po nieudanym szybkim łączeniu
+
+    WifiCache c = sample();
+    c.bssid[5] ^= 1;
+    TEST_ASSERT_FALSE(wifiCacheValid(c, "Dom"));
+
+    c = sample();
+    c.channel = 15;
+    wifiCacheSeal(c, "Dom");
+    TEST_ASSERT_FALSE(wifiCacheValid(c, "Dom"));
+}
+
+void test_stats_histogram(void) {
+    WifiConnectStats s = {};
+    wifiStatsRecord(s, WIFI_MODE_FAST, 0);
+    wifiStatsRecord(s, WIFI_MODE_FAST, 255);
+    wifiStatsRecord(s, WIFI_MODE_FAST, 256);
+    wifiStatsRecord(s, WIFI_MODE_FULL, 3500);
+    wifiStatsRecord(s, WIFI_MODE_FULL, 60000);
+    TEST_ASSERT_EQUAL_UINT32(3, s.count[WIFI_MODE_FAST]);
+    TEST_ASSERT_EQUAL_UINT32(2, s.hist[WIFI_MODE_FAST][0]);
+    TEST_ASSERT_EQUAL_UINT32(1, s.hist[WIFI_MODE_FAST][1]);
+    TEST_ASSERT_EQUAL_UINT32(1, s.hist[WIFI_MODE_FULL][4]);   // 2048..4095 ms
+    TEST_ASSERT_EQUAL_UINT32(1, s.hist[WIFI_MODE_FULL][WIFI_HIST_BUCKETS - 1]);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_valid_only_for_same_network);
+    RUN_TEST(test_corrupted_or_empty_rejected);
+    RUN_TEST(test_stats_histogram);
+    UNITY_END();
+    return 0;
+}